@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2025 Jared Woolston
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/spinlock.h>
+#include <zephyr/zbus/zbus.h>
+
+#include "events.h"
+
+LOG_MODULE_REGISTER(events, CONFIG_APP_LOG_LEVEL);
+
+#if defined(CONFIG_ZBUS_MSG_SUBSCRIBER_BUF_ALLOC_STATIC)
+/* Message subscribers copy every message into a pool buffer */
+BUILD_ASSERT(sizeof(union app_evt_msg) <=
+	     CONFIG_ZBUS_MSG_SUBSCRIBER_NET_BUF_STATIC_DATA_SIZE,
+	     "Message subscriber buffers are too small for the app messages");
+#endif
+
+static struct app_evt_probe adc_probe;
+static struct app_evt_probe encoder_probe;
+static struct app_evt_probe imu_probe;
+static struct app_evt_probe motor_probe;
+
+ZBUS_CHAN_DEFINE(app_adc_chan, struct app_adc_msg, NULL, &adc_probe,
+		 ZBUS_OBSERVERS_EMPTY, ZBUS_MSG_INIT(0));
+ZBUS_CHAN_DEFINE(app_encoder_chan, struct app_encoder_msg, NULL, &encoder_probe,
+		 ZBUS_OBSERVERS_EMPTY, ZBUS_MSG_INIT(0));
+ZBUS_CHAN_DEFINE(app_imu_chan, struct app_imu_msg, NULL, &imu_probe,
+		 ZBUS_OBSERVERS_EMPTY, ZBUS_MSG_INIT(0));
+ZBUS_CHAN_DEFINE(app_motor_chan, struct app_motor_msg, NULL, &motor_probe,
+		 ZBUS_OBSERVERS_EMPTY, ZBUS_MSG_INIT(0));
+
+static const struct {
+	const struct zbus_channel *chan;
+	const char *name;
+} channels[] = {
+	{&app_adc_chan, "adc"},
+	{&app_encoder_chan, "encoder"},
+	{&app_imu_chan, "imu"},
+	{&app_motor_chan, "motor"},
+};
+
+K_THREAD_STACK_DEFINE(app_svc_stack, CONFIG_APP_SVC_STACK_SIZE);
+struct k_work_q app_svc_wq;
+
+int app_evt_pub(const struct zbus_channel *chan, void *msg)
+{
+	struct app_evt_probe *probe = zbus_chan_user_data(chan);
+	struct app_evt_hdr *hdr = msg;
+	k_spinlock_key_t key;
+	int ret;
+
+	hdr->cycles = k_cycle_get_32();
+
+	ret = zbus_chan_pub(chan, msg, K_NO_WAIT);
+	if (ret < 0) {
+		key = k_spin_lock(&probe->lock);
+		probe->dropped++;
+		k_spin_unlock(&probe->lock, key);
+	}
+
+	return ret;
+}
+
+void app_evt_handled(const struct zbus_channel *chan, const void *msg)
+{
+	struct app_evt_probe *probe = zbus_chan_user_data(chan);
+	const struct app_evt_hdr *hdr = msg;
+	uint32_t latency = k_cycle_get_32() - hdr->cycles;
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&probe->lock);
+	probe->count++;
+	probe->latency_last = latency;
+	probe->latency_max = MAX(probe->latency_max, latency);
+	probe->latency_sum += latency;
+	k_spin_unlock(&probe->lock, key);
+}
+
+void app_evt_report(void)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(channels); i++) {
+		struct app_evt_probe *probe = zbus_chan_user_data(channels[i].chan);
+		struct app_evt_probe snap;
+		k_spinlock_key_t key;
+
+		key = k_spin_lock(&probe->lock);
+		snap = *probe;
+		probe->count = 0;
+		probe->dropped = 0;
+		probe->latency_max = 0;
+		probe->latency_sum = 0;
+		k_spin_unlock(&probe->lock, key);
+
+		if (snap.count == 0 && snap.dropped == 0) {
+			continue;
+		}
+
+		LOG_INF("%s: %u events, %u dropped, latency avg %u us max %u us",
+			channels[i].name, snap.count, snap.dropped,
+			k_cyc_to_us_floor32(snap.latency_sum / MAX(snap.count, 1)),
+			k_cyc_to_us_floor32(snap.latency_max));
+	}
+}
+
+static int app_svc_wq_init(void)
+{
+	const struct k_work_queue_config cfg = {
+		.name = "app_svc",
+	};
+
+	k_work_queue_start(&app_svc_wq, app_svc_stack,
+			   K_THREAD_STACK_SIZEOF(app_svc_stack),
+			   CONFIG_APP_SVC_PRIORITY, &cfg);
+
+	return 0;
+}
+
+SYS_INIT(app_svc_wq_init, APPLICATION, 0);
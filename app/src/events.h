@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2025 Jared Woolston
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef APP_EVENTS_H_
+#define APP_EVENTS_H_
+
+#include <stdint.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/zbus/zbus.h>
+
+/*
+ * Application event channels.
+ *
+ * Each service publishes typed messages on its own zbus channel as soon as
+ * it has something new, and consumers block on the channels they need
+ * instead of polling in a loop. Every message starts with a header stamped
+ * at publish time, the consumer records the delay to its handler in the
+ * latency probe of the channel.
+ */
+
+/* Common header, first member of every message */
+struct app_evt_hdr {
+	/* Cycle counter at publish time */
+	uint32_t cycles;
+};
+
+/* ADC channel sample */
+struct app_adc_msg {
+	struct app_evt_hdr hdr;
+	/* Index in the zephyr,user io-channels */
+	uint8_t index;
+	/* Input voltage in mV, before any divider */
+	int32_t mv;
+};
+
+/* Encoder input event */
+struct app_encoder_msg {
+	struct app_evt_hdr hdr;
+	/* Input event type, code and value, e.g. INPUT_EV_REL and a step count */
+	uint8_t type;
+	uint16_t code;
+	int32_t value;
+	/* Absolute encoder count when the event was reported */
+	int32_t count;
+};
+
+/* IMU sample, raw as the driver fetched it */
+struct app_imu_msg {
+	struct app_evt_hdr hdr;
+	int16_t acc[3];
+	int16_t gyro[3];
+	int16_t temp;
+};
+
+/* Motor channel status */
+struct app_motor_msg {
+	struct app_evt_hdr hdr;
+	uint8_t channel;
+	/* enum motor_fault */
+	uint8_t fault;
+	uint32_t current_ma;
+	int32_t emf_mv;
+};
+
+/* Any message, the receive buffer of a consumer of several channels */
+union app_evt_msg {
+	struct app_evt_hdr hdr;
+	struct app_adc_msg adc;
+	struct app_encoder_msg encoder;
+	struct app_imu_msg imu;
+	struct app_motor_msg motor;
+};
+
+ZBUS_CHAN_DECLARE(app_adc_chan, app_encoder_chan, app_imu_chan, app_motor_chan);
+
+/* Event to handler delay of one channel, in hardware cycles */
+struct app_evt_probe {
+	struct k_spinlock lock;
+	/* Handled messages */
+	uint32_t count;
+	/* Messages that could not be published */
+	uint32_t dropped;
+	uint32_t latency_last;
+	uint32_t latency_max;
+	uint64_t latency_sum;
+};
+
+/* Work queue of the sampling services */
+extern struct k_work_q app_svc_wq;
+
+/*
+ * Stamps the header of msg and publishes it without blocking, so it can be
+ * called from any thread. Counts the message as dropped on failure.
+ */
+int app_evt_pub(const struct zbus_channel *chan, void *msg);
+
+/* Records the delay from the publication of msg, at handler entry */
+void app_evt_handled(const struct zbus_channel *chan, const void *msg);
+
+/* Logs and resets the latency probes of all channels */
+void app_evt_report(void);
+
+/* Services, each publishing on its channel once started */
+int app_adc_svc_start(void);
+int app_encoder_svc_start(void);
+int app_imu_svc_start(void);
+int app_motor_svc_start(void);
+
+#endif /* APP_EVENTS_H_ */
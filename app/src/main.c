@@ -6,18 +6,23 @@
 #include <zephyr/kernel.h>
 #include <zephyr/device.h>
 #include <zephyr/devicetree.h>
-#include <zephyr/drivers/adc.h>
 #include <zephyr/drivers/led.h>
 #include <zephyr/drivers/gpio.h>
 #include <zephyr/drivers/pwm.h>
 #include <zephyr/sys/util.h>
 #include <zephyr/drivers/display.h>
+#include <zephyr/input/input.h>
+#include <zephyr/zbus/zbus.h>
 /* <lvgl.h>
 #include <lvgl_mem.h>
 #include <lv_demos.h>*/
 
 #include <zephyr/logging/log.h>
 
+#include <app/drivers/motor.h>
+
+#include "events.h"
+
 LOG_MODULE_REGISTER(main, CONFIG_LOG_DEFAULT_LEVEL);
 
 /* The devicetree node identifier for the "led0" alias. */
@@ -29,20 +34,6 @@ LOG_MODULE_REGISTER(main, CONFIG_LOG_DEFAULT_LEVEL);
  */
 static const struct gpio_dt_spec led = GPIO_DT_SPEC_GET(LED0_NODE, gpios);
 
-#if !DT_NODE_EXISTS(DT_PATH(zephyr_user)) || \
-!DT_NODE_HAS_PROP(DT_PATH(zephyr_user), io_channels)
-#error "No suitable devicetree overlay specified"
-#endif
-
-#define DT_SPEC_AND_COMMA(node_id, prop, idx) \
-ADC_DT_SPEC_GET_BY_IDX(node_id, idx),
-
-/* Data of ADC io-channels specified in devicetree. */
-static const struct adc_dt_spec adc_channels[] = {
-    DT_FOREACH_PROP_ELEM(DT_PATH(zephyr_user), io_channels,
-                         DT_SPEC_AND_COMMA)
-};
-
 //const struct device *qdec0 = DEVICE_DT_GET(DT_NODELABEL(pio1_qdec));
 
 //static uint32_t count;
@@ -364,135 +355,115 @@ int sample(void)
 }
 
 
-int main(void) {
-    int err;
-    //uint32_t count = 0;
-    uint16_t buf;
-    struct adc_sequence sequence = {
-        .buffer = &buf,
-        /* buffer size in bytes, not number of samples */
-        .buffer_size = sizeof(buf),
-    };
-
-    /* Configure channels individually prior to sampling. */
-    for (size_t i = 0U; i < ARRAY_SIZE(adc_channels); i++) {
-        if (!adc_is_ready_dt(&adc_channels[i])) {
-            LOG_ERR("ADC controller device %s not ready\n", adc_channels[i].dev->name);
-            return 0;
-        }
-
-        err = adc_channel_setup_dt(&adc_channels[i]);
-        if (err < 0) {
-            LOG_ERR("Could not setup channel #%d (%d)\n", i, err);
-            return 0;
-        }
-    }
-
-    if (!gpio_is_ready_dt(&led)) {
-        return 0;
-    }
-
-    int ret = gpio_pin_configure_dt(&led, GPIO_OUTPUT_ACTIVE);
-    if (ret < 0) {
-        return 0;
-    }
-    //ret = gpio_pin_set_dt(&led, true);
-
-    //char count_str[11] = {0};
-
-    /*const struct device* display_dev = DEVICE_DT_GET(DT_CHOSEN(zephyr_display));
-    if (!device_is_ready(display_dev)) {
-        LOG_ERR("Device not ready, aborting test");
-        return 0;
-    }*/
-
-    /*uint16_t Color = 0xFFFF;
-    uint16_t j;
-    uint16_t Image[240*240];
-
-    Color = ((Color<<8)&0xff00)|(Color>>8);
-
-    for (j = 0; j < 240*240; j++) {
-        Image[j] = Color;
-    }
-
-    struct display_buffer_descriptor desc;
-    desc.buf_size = 240 * 240 * 2;
-    desc.width = 240;
-    desc.height = 240;
-    desc.pitch = 240;
-    desc.frame_incomplete = false;
-
-    display_write(display_dev, 0, 0, &desc, (void *)Image);*/
-
-    /*lv_obj_t* hello_world_button = lv_button_create(lv_screen_active());
-    lv_obj_align(hello_world_button, LV_ALIGN_CENTER, 0, -15);
-    lv_obj_add_event_cb(hello_world_button, lv_btn_click_callback, LV_EVENT_CLICKED, NULL);
-    lv_obj_t* hello_world_label = lv_label_create(hello_world_button);
-
-    lv_label_set_text(hello_world_label, "Hello world!");
-    lv_obj_align(hello_world_label, LV_ALIGN_CENTER, 0, 0);
-
-    lv_obj_t* count_label = lv_label_create(lv_screen_active());
-    lv_obj_align(count_label, LV_ALIGN_BOTTOM_MID, 0, 0);
-    lv_obj_set_style_bg_color(hello_world_label, lv_color_make(255, 0, 0), LV_STATE_DEFAULT);
-
-    lv_timer_handler();
-    display_blanking_on(display_dev);
-    k_sleep(K_MSEC(120));
-    display_blanking_off(display_dev);
-    k_sleep(K_MSEC(1000));
-    lvgl_print_heap_info(false);*/
-    sample();
-    while (1) {
-        /*f (lv_screen_active() == NULL) {
-            LOG_ERR("No display attached");
-        }*/
-        /*if ((count % 10) == 0U) {
-            sprintf(count_str, "%d", count / 100U);
-            lv_label_set_text(count_label, count_str);
-        }
-        lv_timer_handler();*/
-        //uint32_t sleep_ms = lv_timer_handler();
-
-        //k_msleep(MIN(sleep_ms, INT32_MAX));
-        //++count;
-        k_sleep(K_MSEC(10));
-        k_sleep(K_MSEC(490));
-        //LOG_INF("ADC reading[%u]:\n", count++);
-        for (size_t i = 0U; i < ARRAY_SIZE(adc_channels); i++) {
-            int32_t val_mv;
-
-            (void)adc_sequence_init_dt(&adc_channels[i], &sequence);
-
-            err = adc_read_dt(&adc_channels[i], &sequence);
-            if (err < 0) {
-                LOG_ERR("Could not read (%d)\n", err);
-                continue;
-            }
-
-            /*
-             * If using differential mode, the 16 bit value
-             * in the ADC sample buffer should be a signed 2's
-             * complement value.
-             */
-            if (adc_channels[i].channel_cfg.differential) {
-                val_mv = (int32_t)((int16_t)buf);
-            } else {
-                val_mv = (int32_t)buf;
-            }
-            err = adc_raw_to_millivolts_dt(&adc_channels[i],
-                                           &val_mv);
-            val_mv = (val_mv * 3) / 2;
-            /* conversion to mV may not be supported, skip if not */
-            if (err < 0) {
-                LOG_ERR(" (value in mV not available)\n");
-            /*} else {
-                LOG_INF("- %s, channel %d: %"PRId32" mV\n", adc_channels[i].dev->name,
-                        adc_channels[i].channel_id, val_mv);*/
-            }
-        }
-    }
-
-    return 0;
-}
\ No newline at end of file
+/* Consumer of all the service channels, run by the main thread */
+ZBUS_MSG_SUBSCRIBER_DEFINE(app_sub);
+ZBUS_CHAN_ADD_OBS(app_adc_chan, app_sub, 3);
+ZBUS_CHAN_ADD_OBS(app_encoder_chan, app_sub, 3);
+ZBUS_CHAN_ADD_OBS(app_imu_chan, app_sub, 3);
+ZBUS_CHAN_ADD_OBS(app_motor_chan, app_sub, 3);
+
+static struct app_imu_msg imu_last;
+static uint8_t motor_faults[MOTOR_MAX_CHANNELS];
+
+static void on_adc(const struct app_adc_msg *msg)
+{
+	/* The input is behind a 2/3 divider */
+	LOG_DBG("ADC #%u: %d mV", msg->index, (msg->mv * 3) / 2);
+}
+
+static void on_encoder(const struct app_encoder_msg *msg)
+{
+	if (msg->type == INPUT_EV_KEY && msg->value != 0) {
+		LOG_DBG("Key %u at count %d", msg->code, msg->count);
+		(void)gpio_pin_toggle_dt(&led);
+	} else if (msg->type == INPUT_EV_REL) {
+		LOG_DBG("Rotation %d, count %d", msg->value, msg->count);
+	}
+}
+
+static void on_imu(const struct app_imu_msg *msg)
+{
+	/* At the output data rate, only kept for the display */
+	imu_last = *msg;
+}
+
+static void on_motor(const struct app_motor_msg *msg)
+{
+	if (msg->channel >= ARRAY_SIZE(motor_faults) ||
+	    msg->fault == motor_faults[msg->channel]) {
+		return;
+	}
+
+	motor_faults[msg->channel] = msg->fault;
+	if (msg->fault != MOTOR_FAULT_NONE) {
+		LOG_WRN("Motor channel %u fault %u at %u mA", msg->channel,
+			msg->fault, msg->current_ma);
+	}
+}
+
+int main(void)
+{
+	const struct zbus_channel *chan;
+	union app_evt_msg msg;
+	int64_t report_ms = 0;
+	int ret;
+
+	if (!gpio_is_ready_dt(&led)) {
+		return 0;
+	}
+
+	ret = gpio_pin_configure_dt(&led, GPIO_OUTPUT_ACTIVE);
+	if (ret < 0) {
+		return 0;
+	}
+
+	sample();
+
+	/* A missing service only leaves its channel silent */
+	ret = app_adc_svc_start();
+	if (ret < 0) {
+		LOG_ERR("ADC service not started (%d)", ret);
+	}
+	if (app_encoder_svc_start() < 0) {
+		LOG_INF("No encoder");
+	}
+	if (app_imu_svc_start() < 0) {
+		LOG_INF("No IMU");
+	}
+	if (app_motor_svc_start() < 0) {
+		LOG_INF("No motor driver");
+	}
+
+	if (CONFIG_APP_PROBE_REPORT_INTERVAL > 0) {
+		report_ms = k_uptime_get() + CONFIG_APP_PROBE_REPORT_INTERVAL * MSEC_PER_SEC;
+	}
+
+	while (1) {
+		k_timeout_t timeout = K_FOREVER;
+
+		if (report_ms != 0) {
+			timeout = K_MSEC(MAX(report_ms - k_uptime_get(), 0));
+		}
+
+		if (zbus_sub_wait_msg(&app_sub, &chan, &msg, timeout) == 0) {
+			app_evt_handled(chan, &msg);
+
+			if (chan == &app_adc_chan) {
+				on_adc(&msg.adc);
+			} else if (chan == &app_encoder_chan) {
+				on_encoder(&msg.encoder);
+			} else if (chan == &app_imu_chan) {
+				on_imu(&msg.imu);
+			} else if (chan == &app_motor_chan) {
+				on_motor(&msg.motor);
+			}
+		}
+
+		if (report_ms != 0 && k_uptime_get() >= report_ms) {
+			app_evt_report();
+			report_ms += CONFIG_APP_PROBE_REPORT_INTERVAL * MSEC_PER_SEC;
+		}
+	}
+
+	return 0;
+}
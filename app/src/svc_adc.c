@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2025 Jared Woolston
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/adc.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include "events.h"
+
+LOG_MODULE_REGISTER(svc_adc, CONFIG_APP_LOG_LEVEL);
+
+#if !DT_NODE_EXISTS(DT_PATH(zephyr_user)) || \
+	!DT_NODE_HAS_PROP(DT_PATH(zephyr_user), io_channels)
+#error "No suitable devicetree overlay specified"
+#endif
+
+#define DT_SPEC_AND_COMMA(node_id, prop, idx) \
+	ADC_DT_SPEC_GET_BY_IDX(node_id, idx),
+
+/* Data of ADC io-channels specified in devicetree. */
+static const struct adc_dt_spec adc_channels[] = {
+	DT_FOREACH_PROP_ELEM(DT_PATH(zephyr_user), io_channels, DT_SPEC_AND_COMMA)
+};
+
+static void adc_sample(struct k_work *work)
+{
+	struct app_adc_msg msg;
+	uint16_t buf;
+	struct adc_sequence sequence = {
+		.buffer = &buf,
+		/* buffer size in bytes, not number of samples */
+		.buffer_size = sizeof(buf),
+	};
+	int err;
+
+	ARG_UNUSED(work);
+
+	for (size_t i = 0U; i < ARRAY_SIZE(adc_channels); i++) {
+		(void)adc_sequence_init_dt(&adc_channels[i], &sequence);
+
+		err = adc_read_dt(&adc_channels[i], &sequence);
+		if (err < 0) {
+			LOG_ERR("Could not read channel #%zu (%d)", i, err);
+			continue;
+		}
+
+		/*
+		 * If using differential mode, the 16 bit value in the ADC
+		 * sample buffer should be a signed 2's complement value.
+		 */
+		if (adc_channels[i].channel_cfg.differential) {
+			msg.mv = (int32_t)((int16_t)buf);
+		} else {
+			msg.mv = (int32_t)buf;
+		}
+
+		/* conversion to mV may not be supported, skip if not */
+		err = adc_raw_to_millivolts_dt(&adc_channels[i], &msg.mv);
+		if (err < 0) {
+			LOG_ERR("Value in mV not available on channel #%zu", i);
+			continue;
+		}
+
+		msg.index = i;
+		(void)app_evt_pub(&app_adc_chan, &msg);
+	}
+}
+
+static K_WORK_DEFINE(adc_work, adc_sample);
+
+/* The timer keeps the period, the sampling runs in the service queue */
+static void adc_expiry(struct k_timer *timer)
+{
+	ARG_UNUSED(timer);
+
+	k_work_submit_to_queue(&app_svc_wq, &adc_work);
+}
+
+static K_TIMER_DEFINE(adc_timer, adc_expiry, NULL);
+
+int app_adc_svc_start(void)
+{
+	int err;
+
+	/* Configure channels individually prior to sampling. */
+	for (size_t i = 0U; i < ARRAY_SIZE(adc_channels); i++) {
+		if (!adc_is_ready_dt(&adc_channels[i])) {
+			LOG_ERR("ADC controller device %s not ready",
+				adc_channels[i].dev->name);
+			return -ENODEV;
+		}
+
+		err = adc_channel_setup_dt(&adc_channels[i]);
+		if (err < 0) {
+			LOG_ERR("Could not setup channel #%zu (%d)", i, err);
+			return err;
+		}
+	}
+
+	k_timer_start(&adc_timer, K_NO_WAIT, K_MSEC(CONFIG_APP_ADC_PERIOD_MS));
+
+	return 0;
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2025 Jared Woolston
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/input/input.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include <app/drivers/input/rpi_pico_pio_qdec.h>
+
+#include "events.h"
+
+LOG_MODULE_REGISTER(svc_encoder, CONFIG_APP_LOG_LEVEL);
+
+#define QDEC_NODE DT_COMPAT_GET_ANY_STATUS_OKAY(raspberrypi_pico_qdec_pio)
+
+#if DT_NODE_EXISTS(QDEC_NODE)
+
+static const struct device *const qdec = DEVICE_DT_GET(QDEC_NODE);
+static atomic_t started;
+
+/* Called from the input thread, for every rotation and button event */
+static void encoder_input(struct input_event *evt, void *user_data)
+{
+	struct app_encoder_msg msg = {
+		.type = evt->type,
+		.code = evt->code,
+		.value = evt->value,
+	};
+
+	ARG_UNUSED(user_data);
+
+	if (!atomic_get(&started)) {
+		return;
+	}
+
+	(void)rpi_pico_pio_qdec_count_get(qdec, &msg.count);
+	(void)app_evt_pub(&app_encoder_chan, &msg);
+}
+
+INPUT_CALLBACK_DEFINE(DEVICE_DT_GET(QDEC_NODE), encoder_input, NULL);
+
+int app_encoder_svc_start(void)
+{
+	if (!device_is_ready(qdec)) {
+		LOG_ERR("Encoder %s not ready", qdec->name);
+		return -ENODEV;
+	}
+
+	atomic_set(&started, 1);
+
+	return 0;
+}
+
+#else
+
+int app_encoder_svc_start(void)
+{
+	return -ENODEV;
+}
+
+#endif /* DT_NODE_EXISTS(QDEC_NODE) */
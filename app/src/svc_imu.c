@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2025 Jared Woolston
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include <app/drivers/sensor/qmi8658c.h>
+
+#include "events.h"
+
+LOG_MODULE_REGISTER(svc_imu, CONFIG_APP_LOG_LEVEL);
+
+#define IMU_NODE DT_COMPAT_GET_ANY_STATUS_OKAY(qst_qmi8658c)
+
+#if DT_NODE_EXISTS(IMU_NODE) && defined(CONFIG_QMI8658C_TRIGGER)
+
+static const struct device *const imu = DEVICE_DT_GET(IMU_NODE);
+
+static const struct sensor_trigger drdy = {
+	.type = SENSOR_TRIG_DATA_READY,
+	.chan = SENSOR_CHAN_ACCEL_XYZ,
+};
+
+/* Called from the driver trigger thread, once per sample */
+static void imu_data_ready(const struct device *dev,
+			   const struct sensor_trigger *trig)
+{
+	struct qmi8658c_snapshot snap;
+	struct app_imu_msg msg;
+
+	ARG_UNUSED(trig);
+
+	/* Served from the burst the driver just read */
+	if (sensor_sample_fetch(dev) < 0 || qmi8658c_snapshot_get(dev, &snap) < 0) {
+		return;
+	}
+
+	memcpy(msg.acc, snap.acc, sizeof(msg.acc));
+	memcpy(msg.gyro, snap.gyro, sizeof(msg.gyro));
+	msg.temp = snap.temp;
+
+	(void)app_evt_pub(&app_imu_chan, &msg);
+}
+
+int app_imu_svc_start(void)
+{
+	int err;
+
+	if (!device_is_ready(imu)) {
+		LOG_ERR("IMU %s not ready", imu->name);
+		return -ENODEV;
+	}
+
+	err = sensor_trigger_set(imu, &drdy, imu_data_ready);
+	if (err < 0) {
+		LOG_ERR("Could not set the data ready trigger (%d)", err);
+	}
+
+	return err;
+}
+
+#else
+
+int app_imu_svc_start(void)
+{
+	return -ENODEV;
+}
+
+#endif /* DT_NODE_EXISTS(IMU_NODE) && defined(CONFIG_QMI8658C_TRIGGER) */
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2025 Jared Woolston
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include <app/drivers/motor.h>
+
+#include "events.h"
+
+LOG_MODULE_REGISTER(svc_motor, CONFIG_APP_LOG_LEVEL);
+
+#define MOTOR_NODE DT_COMPAT_GET_ANY_STATUS_OKAY(motor_l298n)
+
+#if DT_NODE_EXISTS(MOTOR_NODE) && defined(CONFIG_MOTOR)
+
+static const struct device *const motor = DEVICE_DT_GET(MOTOR_NODE);
+
+/* Publishes the status of every channel sensing its current or back-EMF */
+static void motor_sample(struct k_work *work)
+{
+	struct motor_status status;
+	struct app_motor_msg msg;
+	uint8_t count = motor_channel_count(motor);
+
+	ARG_UNUSED(work);
+
+	for (uint8_t ch = 0; ch < count; ch++) {
+		if (motor_status_get(motor, ch, &status) < 0) {
+			continue;
+		}
+
+		msg.channel = ch;
+		msg.fault = status.fault;
+		msg.current_ma = status.current_valid ? status.current_ma : 0;
+		msg.emf_mv = status.emf_valid ? status.emf_mv : 0;
+		(void)app_evt_pub(&app_motor_chan, &msg);
+	}
+}
+
+static K_WORK_DEFINE(motor_work, motor_sample);
+
+static void motor_expiry(struct k_timer *timer)
+{
+	ARG_UNUSED(timer);
+
+	k_work_submit_to_queue(&app_svc_wq, &motor_work);
+}
+
+static K_TIMER_DEFINE(motor_timer, motor_expiry, NULL);
+
+int app_motor_svc_start(void)
+{
+	if (!device_is_ready(motor)) {
+		LOG_ERR("Motor driver %s not ready", motor->name);
+		return -ENODEV;
+	}
+
+	k_timer_start(&motor_timer, K_NO_WAIT,
+		      K_MSEC(CONFIG_APP_MOTOR_STATUS_PERIOD_MS));
+
+	return 0;
+}
+
+#else
+
+int app_motor_svc_start(void)
+{
+	return -ENODEV;
+}
+
+#endif /* DT_NODE_EXISTS(MOTOR_NODE) && defined(CONFIG_MOTOR) */
@@ -19,6 +19,7 @@
 #include <zephyr/pm/device.h>
 #include <zephyr/sys/util.h>
 
+#include <app/drivers/input/rpi_pico_pio_qdec.h>
 
 #include <hardware/dma.h>
 #include <hardware/pio.h>
@@ -37,6 +38,11 @@ struct pio_qdec_config {
     const uint32_t dt_pin;
     const uint16_t axis;
     const uint16_t button;
+    const uint16_t long_press_key;
+    const uint16_t double_click_key;
+    const uint32_t debounce_ms;
+    const uint32_t long_press_ms;
+    const uint32_t double_click_ms;
     const int max_step_rate;
 };
 
@@ -46,6 +52,14 @@ struct pio_qdec_data {
     struct dma_config dma_cfg;
     struct dma_block_config dma_block_cfg;
     struct gpio_callback button_cb_data;
+    struct k_work_delayable btn_debounce_work;
+    struct k_work_delayable btn_long_press_work;
+    volatile int64_t btn_edge_ticks; // Uptime of the first edge of a bounce burst
+    volatile bool btn_edge_pending;
+    int64_t btn_release_ticks;       // Uptime of the last debounced release
+    bool btn_pressed;                // Debounced button state
+    bool btn_click_armed;            // A short click may still become a double click
+    bool btn_long_fired;
     const uint8_t channel;
     const uint8_t slot;
     const uint8_t channel_config;
@@ -160,15 +174,103 @@ static void dma_user_callback(const struct device *dev, void *user_data,
     }
 }
 
-static void button_pressed(const struct device *dev, struct gpio_callback *cb,
-                    uint32_t pins)
+int rpi_pico_pio_qdec_count_get(const struct device *dev, int32_t *count)
 {
-    const struct pio_qdec_config *config = dev->config;
     struct pio_qdec_data *data = dev->data;
 
-    printk("Button pressed at %" PRIu32 "\n", k_cycle_get_32());
-    // Report the input event
-    input_report_key(data->dev, config->button, 1, true, K_FOREVER);
+    // A single word written by the DMA, no lock needed
+    *count = (int32_t)data->qdec_count;
+
+    return 0;
+}
+
+static void button_edge_isr(const struct device *dev, struct gpio_callback *cb,
+                            uint32_t pins)
+{
+    struct pio_qdec_data *data = CONTAINER_OF(cb, struct pio_qdec_data, button_cb_data);
+    const struct pio_qdec_config *config = data->dev->config;
+
+    ARG_UNUSED(dev);
+    ARG_UNUSED(pins);
+
+    // Only timestamp the burst and (re)arm the debounce timer, the rest happens in thread context
+    if (!data->btn_edge_pending) {
+        data->btn_edge_ticks = k_uptime_ticks();
+        data->btn_edge_pending = true;
+    }
+    k_work_reschedule(&data->btn_debounce_work, K_MSEC(config->debounce_ms));
+}
+
+static void button_report_gesture(const struct device *dev, uint16_t code)
+{
+    if (code == INPUT_KEY_RESERVED) {
+        return;
+    }
+
+    input_report_key(dev, code, 1, true, K_FOREVER);
+    input_report_key(dev, code, 0, true, K_FOREVER);
+}
+
+static void button_long_press_handler(struct k_work *work)
+{
+    struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+    struct pio_qdec_data *data = CONTAINER_OF(dwork, struct pio_qdec_data, btn_long_press_work);
+    const struct pio_qdec_config *config = data->dev->config;
+
+    if (!data->btn_pressed) {
+        return;
+    }
+
+    LOG_DBG("Button long press");
+    data->btn_long_fired = true;
+    data->btn_click_armed = false;
+    button_report_gesture(data->dev, config->long_press_key);
+}
+
+static void button_debounce_handler(struct k_work *work)
+{
+    struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+    struct pio_qdec_data *data = CONTAINER_OF(dwork, struct pio_qdec_data, btn_debounce_work);
+    const struct pio_qdec_config *config = data->dev->config;
+    const int64_t edge_ticks = data->btn_edge_ticks;
+
+    data->btn_edge_pending = false;
+
+    // The pin has been quiet for the debounce interval, so its level is now stable
+    const int level = gpio_pin_get_dt(&config->btn_pin);
+    if (level < 0 || (level != 0) == data->btn_pressed) {
+        // Read failure or the bounce settled back to the previous state
+        return;
+    }
+
+    data->btn_pressed = (level != 0);
+    LOG_DBG("Button %s at %" PRId64 " ms", data->btn_pressed ? "pressed" : "released",
+            k_ticks_to_ms_floor64(edge_ticks));
+
+    input_report_key(data->dev, config->button, data->btn_pressed, true, K_FOREVER);
+
+    if (data->btn_pressed) {
+        data->btn_long_fired = false;
+        if (config->long_press_key != INPUT_KEY_RESERVED) {
+            // Measure the hold time from the first edge rather than from now
+            const int64_t elapsed = k_uptime_ticks() - edge_ticks;
+            const int64_t remaining = k_ms_to_ticks_ceil64(config->long_press_ms) - elapsed;
+
+            k_work_reschedule(&data->btn_long_press_work, K_TICKS(MAX(remaining, 0)));
+        }
+
+        if (data->btn_click_armed &&
+            (edge_ticks - data->btn_release_ticks) <= k_ms_to_ticks_ceil64(config->double_click_ms)) {
+            LOG_DBG("Button double click");
+            data->btn_click_armed = false;
+            button_report_gesture(data->dev, config->double_click_key);
+        }
+    } else {
+        k_work_cancel_delayable(&data->btn_long_press_work);
+        // A release ending a long press must not count towards a double click
+        data->btn_click_armed = !data->btn_long_fired;
+        data->btn_release_ticks = edge_ticks;
+    }
 }
 
 static int pio_qdec_btn_init(const struct device *dev) {
@@ -176,29 +278,36 @@ static int pio_qdec_btn_init(const struct device *dev) {
     struct pio_qdec_data *data = dev->data;
 
     if (!gpio_is_ready_dt(&config->btn_pin)) {
-        printk("Error: button device %s is not ready\n",
-               config->btn_pin.port->name);
+        LOG_ERR("Button device %s is not ready", config->btn_pin.port->name);
         return -EAGAIN;
     }
 
     int retval = gpio_pin_configure_dt(&config->btn_pin, GPIO_INPUT);
     if (retval != 0) {
-        printk("Error %d: failed to configure %s pin %d\n",
-               retval, config->btn_pin.port->name, config->btn_pin.pin);
+        LOG_ERR("Error %d: failed to configure %s pin %d",
+                retval, config->btn_pin.port->name, config->btn_pin.pin);
         return 0;
     }
 
-    retval = gpio_pin_interrupt_configure_dt(&config->btn_pin,
-                                          GPIO_INT_EDGE_TO_ACTIVE);
+    k_work_init_delayable(&data->btn_debounce_work, button_debounce_handler);
+    k_work_init_delayable(&data->btn_long_press_work, button_long_press_handler);
+    data->btn_edge_pending = false;
+    data->btn_click_armed = false;
+    data->btn_long_fired = false;
+    data->btn_pressed = gpio_pin_get_dt(&config->btn_pin) > 0;
+
+    gpio_init_callback(&data->button_cb_data, button_edge_isr, BIT(config->btn_pin.pin));
+    gpio_add_callback(config->btn_pin.port, &data->button_cb_data);
+
+    // Both edges are needed to report releases, the debounce timer filters the bounces
+    retval = gpio_pin_interrupt_configure_dt(&config->btn_pin, GPIO_INT_EDGE_BOTH);
     if (retval != 0) {
-        printk("Error %d: failed to configure interrupt on %s pin %d\n",
+        LOG_ERR("Error %d: failed to configure interrupt on %s pin %d",
                 retval, config->btn_pin.port->name, config->btn_pin.pin);
         return 0;
     }
 
-    gpio_init_callback(&data->button_cb_data, button_pressed, BIT(config->btn_pin.pin));
-    gpio_add_callback(config->btn_pin.port, &data->button_cb_data);
-    printk("Set up button at %s pin %d\n", config->btn_pin.port->name, config->btn_pin.pin);
+    LOG_DBG("Set up button at %s pin %d", config->btn_pin.port->name, config->btn_pin.pin);
 
     return 0;
 }
@@ -209,6 +318,8 @@ static int pio_qdec_init(const struct device *dev)
     struct pio_qdec_data *data = dev->data;
     size_t qdec_sm;
 
+    data->dev = dev;
+
     // Ensure the DMA is available
     if (data->dma_dev == NULL || !device_is_ready(data->dma_dev)) {
         return  -ENODEV;
@@ -295,6 +406,11 @@ static int pio_qdec_init(const struct device *dev)
             .max_step_rate = DT_INST_PROP_OR(idx, max_step_rate, 0),			\
             .axis = DT_INST_PROP(idx, zephyr_axis),			        	\
             .button = DT_INST_PROP(idx, zephyr_key),			        	\
+            .long_press_key = DT_INST_PROP_OR(idx, long_press_key, INPUT_KEY_RESERVED),\
+            .double_click_key = DT_INST_PROP_OR(idx, double_click_key, INPUT_KEY_RESERVED),\
+            .debounce_ms = DT_INST_PROP(idx, debounce_interval_ms),			\
+            .long_press_ms = DT_INST_PROP(idx, long_press_ms),				\
+            .double_click_ms = DT_INST_PROP(idx, double_click_ms),			\
         };										\
         static struct pio_qdec_data pio_qdec##idx##_data = {       			\
             .channel = DT_INST_DMAS_CELL_BY_IDX(idx, 0, channel),                       \
@@ -0,0 +1,357 @@
+/*
+ * Copyright (c) 2025 Jared Woolston
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define DT_DRV_COMPAT motor_l298n_emul
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/gpio/gpio_emul.h>
+#include <zephyr/drivers/pwm.h>
+#include <zephyr/kernel.h>
+#include <zephyr/spinlock.h>
+#include <zephyr/sys/util.h>
+
+#include <app/drivers/motor.h>
+#include <app/drivers/motor/l298n_emul.h>
+
+#define L298N_EMUL_CHANNELS	2
+#define STEP_US			CONFIG_EMUL_MOTOR_L298N_STEP_US
+
+/* Speeds are Q48.16 counts/s, positions Q48.16 counts */
+#define Q16_SHIFT		16
+
+/* Direction inputs of a motor channel on an emulator channel */
+struct l298n_emul_wiring {
+	const struct device *dev;
+	uint32_t channel;
+	struct gpio_dt_spec in[2];
+	uint8_t num_in;
+};
+
+struct l298n_emul_channel {
+	struct motor_l298n_emul_model model;
+	const struct l298n_emul_wiring *wiring;
+	uint32_t period;
+	uint32_t pulse;
+	bool inverted;
+	/* Inputs of the current step: duty, and 1, -1 or 0 to brake */
+	uint16_t duty;
+	int8_t dir;
+	int64_t speed;
+	int64_t pos;
+	int64_t rem;
+};
+
+struct l298n_emul_config {
+	uint64_t frequency;
+	struct motor_l298n_emul_model model;
+};
+
+struct l298n_emul_data {
+	struct k_spinlock lock;
+	struct l298n_emul_channel ch[L298N_EMUL_CHANNELS];
+	bool started;
+	uint64_t last_us;
+};
+
+#define L298N_EMUL_WIRING_CH(node, idx, prop)						\
+	COND_CODE_1(DT_PROP_HAS_IDX(node, pwms, idx),					\
+		    (COND_CODE_1(DT_NODE_HAS_COMPAT(DT_PWMS_CTLR_BY_IDX(node, idx),	\
+						    DT_DRV_COMPAT),			\
+				 ({							\
+					.dev = DEVICE_DT_GET(DT_PWMS_CTLR_BY_IDX(node, idx)),\
+					.channel = DT_PWMS_CHANNEL_BY_IDX(node, idx),	\
+					.in = {						\
+						GPIO_DT_SPEC_GET_BY_IDX_OR(node, prop, 0, {0}),\
+						GPIO_DT_SPEC_GET_BY_IDX_OR(node, prop, 1, {0}),\
+					},						\
+					.num_in = COND_CODE_1(DT_NODE_HAS_PROP(node, prop),\
+							      (MIN(DT_PROP_LEN(node, prop), 2)),\
+							      (0)),			\
+				 },),							\
+				 ())),							\
+		    ())
+
+#define L298N_EMUL_WIRING(node)								\
+	L298N_EMUL_WIRING_CH(node, 0, ch_1_dir_gpios)					\
+	L298N_EMUL_WIRING_CH(node, 1, ch_2_dir_gpios)
+
+/* The enable inputs of every motor-l298n channel driven by an emulator */
+static const struct l298n_emul_wiring wirings[] = {
+	DT_FOREACH_STATUS_OKAY(motor_l298n, L298N_EMUL_WIRING)
+};
+
+static int l298n_emul_in(const struct gpio_dt_spec *spec)
+{
+	int level = gpio_emul_output_get(spec->port, spec->pin);
+
+	return (level > 0) != ((spec->dt_flags & GPIO_ACTIVE_LOW) != 0);
+}
+
+/* Samples the enable and direction inputs for the next steps */
+static void l298n_emul_latch(struct l298n_emul_channel *ch)
+{
+	const struct l298n_emul_wiring *w = ch->wiring;
+	uint32_t pulse = ch->inverted ? ch->period - ch->pulse : ch->pulse;
+	int in1 = 1, in2 = 0;
+
+	ch->duty = (ch->period == 0) ? 0 :
+		   (uint16_t)(((uint64_t)pulse * MOTOR_SPEED_MAX) / ch->period);
+
+	if (w != NULL && w->num_in > 0) {
+		in1 = l298n_emul_in(&w->in[0]);
+		in2 = (w->num_in > 1) ? l298n_emul_in(&w->in[1]) : !in1;
+	}
+
+	ch->dir = (in1 == in2) ? 0 : (in1 ? 1 : -1);
+}
+
+/* One step of the model, false at rest where it stays */
+static bool l298n_emul_step(struct l298n_emul_channel *ch)
+{
+	const int64_t w = ch->speed;
+	const int64_t f = (int64_t)ch->model.load << Q16_SHIFT;
+	int64_t u = (((int64_t)ch->model.max_speed << Q16_SHIFT) * ch->duty) /
+		    MOTOR_SPEED_MAX;
+	int64_t acc, next;
+
+	if (ch->duty == 0) {
+		/* Disabled, floating: friction only */
+		acc = 0;
+	} else if (ch->dir == 0) {
+		/* Shorted during the pulse */
+		acc = -(w * ch->duty) / MOTOR_SPEED_MAX;
+	} else {
+		acc = ch->dir * u - w;
+	}
+
+	/* Friction opposes the motion, and holds the motor at rest */
+	if (w != 0) {
+		acc -= (w > 0) ? f : -f;
+	} else if (llabs(acc) <= f) {
+		return false;
+	} else {
+		acc -= (acc > 0) ? f : -f;
+	}
+
+	next = w + (acc * STEP_US) / ch->model.time_constant_us;
+
+	/* Friction stops the motor, it does not reverse it */
+	if (w != 0 && (next > 0) != (w > 0)) {
+		next = 0;
+	}
+
+	ch->speed = next;
+	ch->rem += next * STEP_US;
+	ch->pos += ch->rem / USEC_PER_SEC;
+	ch->rem %= USEC_PER_SEC;
+
+	return true;
+}
+
+/* Advances the model to the simulated time, called with the lock held */
+static void l298n_emul_advance(const struct device *dev)
+{
+	struct l298n_emul_data *data = dev->data;
+	uint64_t now = k_cyc_to_us_floor64(k_cycle_get_64());
+	uint64_t steps;
+
+	if (!data->started) {
+		data->last_us = now;
+		data->started = true;
+	}
+
+	steps = (now - data->last_us) / STEP_US;
+	data->last_us += steps * STEP_US;
+
+	for (int i = 0; i < L298N_EMUL_CHANNELS; i++) {
+		struct l298n_emul_channel *ch = &data->ch[i];
+
+		for (uint64_t k = 0; k < steps; k++) {
+			if (!l298n_emul_step(ch)) {
+				break;
+			}
+		}
+		l298n_emul_latch(ch);
+	}
+}
+
+static int l298n_emul_model_check(const struct motor_l298n_emul_model *model)
+{
+	if (model->max_speed <= 0 || model->time_constant_us < STEP_US ||
+	    model->load < 0) {
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+int motor_l298n_emul_model_set(const struct device *dev, uint8_t channel,
+			       const struct motor_l298n_emul_model *model)
+{
+	struct l298n_emul_data *data = dev->data;
+	k_spinlock_key_t key;
+	int ret;
+
+	if (channel >= L298N_EMUL_CHANNELS) {
+		return -EINVAL;
+	}
+
+	ret = l298n_emul_model_check(model);
+	if (ret < 0) {
+		return ret;
+	}
+
+	key = k_spin_lock(&data->lock);
+	l298n_emul_advance(dev);
+	data->ch[channel].model = *model;
+	k_spin_unlock(&data->lock, key);
+
+	return 0;
+}
+
+int motor_l298n_emul_reset(const struct device *dev, uint8_t channel)
+{
+	struct l298n_emul_data *data = dev->data;
+	k_spinlock_key_t key;
+
+	if (channel >= L298N_EMUL_CHANNELS) {
+		return -EINVAL;
+	}
+
+	key = k_spin_lock(&data->lock);
+	l298n_emul_advance(dev);
+	data->ch[channel].speed = 0;
+	data->ch[channel].pos = 0;
+	data->ch[channel].rem = 0;
+	k_spin_unlock(&data->lock, key);
+
+	return 0;
+}
+
+int motor_l298n_emul_state_get(const struct device *dev, uint8_t channel,
+			       struct motor_l298n_emul_state *state)
+{
+	struct l298n_emul_data *data = dev->data;
+	const struct l298n_emul_channel *ch;
+	k_spinlock_key_t key;
+
+	if (channel >= L298N_EMUL_CHANNELS) {
+		return -EINVAL;
+	}
+
+	key = k_spin_lock(&data->lock);
+	l298n_emul_advance(dev);
+	ch = &data->ch[channel];
+	state->position = (int32_t)(ch->pos >> Q16_SHIFT);
+	state->speed = (int32_t)(ch->speed >> Q16_SHIFT);
+	state->duty = ch->duty;
+	k_spin_unlock(&data->lock, key);
+
+	return 0;
+}
+
+int motor_l298n_emul_encoder_read(void *user_data, int32_t *count)
+{
+	const struct motor_l298n_emul_encoder *enc = user_data;
+	struct l298n_emul_data *data = enc->dev->data;
+	k_spinlock_key_t key;
+
+	if (enc->channel >= L298N_EMUL_CHANNELS) {
+		return -EINVAL;
+	}
+
+	key = k_spin_lock(&data->lock);
+	l298n_emul_advance(enc->dev);
+	*count = (int32_t)(data->ch[enc->channel].pos >> Q16_SHIFT);
+	k_spin_unlock(&data->lock, key);
+
+	return 0;
+}
+
+static int l298n_emul_set_cycles(const struct device *dev, uint32_t channel,
+				 uint32_t period_cycles, uint32_t pulse_cycles,
+				 pwm_flags_t flags)
+{
+	struct l298n_emul_data *data = dev->data;
+	struct l298n_emul_channel *ch;
+	k_spinlock_key_t key;
+
+	if (channel >= L298N_EMUL_CHANNELS || pulse_cycles > period_cycles) {
+		return -EINVAL;
+	}
+
+	key = k_spin_lock(&data->lock);
+	/* The old inputs up to now, the new ones from now on */
+	l298n_emul_advance(dev);
+	ch = &data->ch[channel];
+	ch->period = period_cycles;
+	ch->pulse = pulse_cycles;
+	ch->inverted = (flags & PWM_POLARITY_INVERTED) != 0;
+	l298n_emul_latch(ch);
+	k_spin_unlock(&data->lock, key);
+
+	return 0;
+}
+
+static int l298n_emul_get_cycles_per_sec(const struct device *dev, uint32_t channel,
+					 uint64_t *cycles)
+{
+	const struct l298n_emul_config *cfg = dev->config;
+
+	ARG_UNUSED(channel);
+
+	*cycles = cfg->frequency;
+
+	return 0;
+}
+
+static DEVICE_API(pwm, l298n_emul_api) = {
+	.set_cycles = l298n_emul_set_cycles,
+	.get_cycles_per_sec = l298n_emul_get_cycles_per_sec,
+};
+
+static int l298n_emul_init(const struct device *dev)
+{
+	const struct l298n_emul_config *cfg = dev->config;
+	struct l298n_emul_data *data = dev->data;
+
+	for (int i = 0; i < L298N_EMUL_CHANNELS; i++) {
+		struct l298n_emul_channel *ch = &data->ch[i];
+
+		ch->model = cfg->model;
+		for (size_t j = 0; j < ARRAY_SIZE(wirings); j++) {
+			if (wirings[j].dev == dev && wirings[j].channel == i) {
+				ch->wiring = &wirings[j];
+			}
+		}
+	}
+
+	return l298n_emul_model_check(&cfg->model);
+}
+
+#define L298N_EMUL_INIT(inst)								\
+	static const struct l298n_emul_config l298n_emul_config_##inst = {		\
+		.frequency = DT_INST_PROP(inst, clock_frequency),			\
+		.model = {								\
+			.max_speed = DT_INST_PROP(inst, max_speed),			\
+			.time_constant_us = DT_INST_PROP(inst, time_constant_us),	\
+			.load = DT_INST_PROP(inst, load),				\
+		},									\
+	};										\
+											\
+	static struct l298n_emul_data l298n_emul_data_##inst;				\
+											\
+	/* Before the motor-l298n using it, which needs the kernel */		\
+	DEVICE_DT_INST_DEFINE(inst, l298n_emul_init, NULL,				\
+			      &l298n_emul_data_##inst, &l298n_emul_config_##inst,	\
+			      PRE_KERNEL_1, CONFIG_KERNEL_INIT_PRIORITY_DEVICE,		\
+			      &l298n_emul_api);
+
+DT_INST_FOREACH_STATUS_OKAY(L298N_EMUL_INIT)
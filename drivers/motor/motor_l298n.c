@@ -1,96 +1,1175 @@
 /*
-* Copyright 2025 Jared Woolston
+ * Copyright (c) 2025 Jared Woolston
  * SPDX-License-Identifier: Apache-2.0
  */
 
 #define DT_DRV_COMPAT motor_l298n
 
 #include <stdint.h>
-#include <stdlib.h>
 
 #include <zephyr/device.h>
 #include <zephyr/devicetree.h>
+#include <zephyr/drivers/dma.h>
 #include <zephyr/drivers/gpio.h>
 #include <zephyr/drivers/pwm.h>
+#include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/spinlock.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
 
-#if DT_NUM_INST_STATUS_OKAY(DT_DRV_COMPAT) == 0
-#error"L298N Motor controller is not defined in DTS"
+#include <app/drivers/motor.h>
+
+#if defined(CONFIG_PWM_RPI_PICO)
+#include <hardware/pwm.h>
+#endif
+
+#if defined(CONFIG_MOTOR_L298N_ADC)
+#include <hardware/adc.h>
 #endif
 
 LOG_MODULE_REGISTER(motor_l298n, CONFIG_MOTOR_LOG_LEVEL);
 
-struct motor_l298n_channel {
-    const struct pwm_dt_spec enable_pin;
-    const struct gpio_dt_spec dir_pins[2];
-};
+#define L298N_NUM_CHANNELS	2
 
-struct motor_l298n_channel_state {
-    bool enabled; // Will default to false
-    bool forward; // Will default to true
-    uint32_t pulse_width; // 100% on when this value is equal to the device
-    // tree configured period
+/* IN1 and IN2 of one bridge, IN1 high and IN2 low is forward */
+#define L298N_IN1		0
+#define L298N_IN2		1
+
+/* RP2xxx ADC, 12 bits */
+#define L298N_ADC_COUNTS	4096
+
+struct motor_l298n_channel_config {
+	/* ENA/ENB, the duty cycle is the speed */
+	struct pwm_dt_spec en;
+	struct gpio_dt_spec in[2];
+	/* 2 for direction and brake, 1 for direction only, 0 for neither */
+	uint8_t num_in;
+#if defined(CONFIG_MOTOR_L298N_RAMP)
+	/* Ramps are written to the compare register, paced by the PWM wrap */
+	const struct device *dma_dev;
+	uint32_t dma_channel;
+	uint32_t dma_slot;
+#endif
+#if defined(CONFIG_MOTOR_L298N_CURRENT)
+	/* The SENSE resistor is on this ADC input */
+	bool sense;
+	uint8_t sense_input;
+#endif
+#if defined(CONFIG_MOTOR_L298N_EMF)
+	/* OUT1 and OUT2 through dividers are on these ADC inputs */
+	bool emf;
+	uint8_t emf_input[2];
+#endif
 };
 
 struct motor_l298n_config {
-    //const struct device *motor_dev;
-    const struct motor_l298n_channel ch1;
-    const struct motor_l298n_channel ch2; // If NULL, this channel is not enabled
+	struct motor_l298n_channel_config ch[L298N_NUM_CHANNELS];
+	uint8_t num_channels;
+	/* Both enables are the A and B outputs of one RP2xxx PWM slice */
+	bool same_slice;
+#if defined(CONFIG_MOTOR_L298N_CURRENT)
+	/* Limits in ADC counts, the stall one for stall_periods samples */
+	uint16_t overcurrent_raw;
+	uint16_t stall_raw;
+	uint8_t stall_periods;
+	uint16_t sense_delay_us;
+	/* ADC counts to mA */
+	uint32_t sense_mohm;
+#endif
+#if defined(CONFIG_MOTOR_L298N_EMF)
+	/* One floating period every emf_interval */
+	uint16_t emf_interval;
+	uint16_t emf_settle_us;
+	/* Motor mV per 1000 ADC mV */
+	uint32_t emf_scale;
+	uint8_t emf_filter_shift;
+#endif
+#if defined(CONFIG_MOTOR_L298N_ADC)
+	uint32_t vref_mv;
+#endif
 };
 
 struct motor_l298n_data {
-    struct motor_l298n_channel_state ch1;
-    struct motor_l298n_channel_state ch2; // If NULL, this channel is not enabled
+	/* Serializes the calls, the direction GPIOs are written under it */
+	struct k_mutex lock;
+	/* Commands, levels and sensing state shared with the interrupts */
+	struct k_spinlock isr_lock;
+	struct motor_cmd cmd[L298N_NUM_CHANNELS];
+	uint32_t period_cycles[L298N_NUM_CHANNELS];
+	uint32_t pulse_cycles[L298N_NUM_CHANNELS];
+#if defined(CONFIG_MOTOR_L298N_RAMP)
+	/* Channels with a ramp in progress */
+	atomic_t ramping;
+	motor_ramp_callback_t ramp_cb[L298N_NUM_CHANNELS];
+	void *ramp_user_data[L298N_NUM_CHANNELS];
+	struct dma_config dma_cfg[L298N_NUM_CHANNELS];
+	struct dma_block_config dma_block[L298N_NUM_CHANNELS];
+	/* Compare register values, both outputs of the slice */
+	uint32_t ramp_cc[L298N_NUM_CHANNELS][CONFIG_MOTOR_L298N_RAMP_LEN];
+	size_t ramp_len[L298N_NUM_CHANNELS];
+#endif
+#if defined(CONFIG_MOTOR_L298N_CURRENT)
+	/* Written by the PWM wrap interrupt */
+	uint16_t current_raw[L298N_NUM_CHANNELS];
+	uint8_t over[L298N_NUM_CHANNELS];
+	enum motor_fault fault[L298N_NUM_CHANNELS];
+	uint32_t fault_latency_ns[L298N_NUM_CHANNELS];
+	uint32_t fault_latency_max_ns[L298N_NUM_CHANNELS];
+	uint32_t sense_delay_cycles[L298N_NUM_CHANNELS];
+	/* Faults to log, from the interrupt, kept when cleared meanwhile */
+	const struct device *dev;
+	atomic_t fault_log;
+	enum motor_fault fault_last[L298N_NUM_CHANNELS];
+	struct k_work fault_work;
+#endif
+#if defined(CONFIG_MOTOR_L298N_EMF)
+	/* Written by the PWM wrap interrupt, the back-EMF is Q24.8 mV */
+	bool emf_armed[L298N_NUM_CHANNELS];
+	uint16_t emf_count[L298N_NUM_CHANNELS];
+	int32_t emf_q8[L298N_NUM_CHANNELS];
+	uint32_t emf_settle_cycles[L298N_NUM_CHANNELS];
+#endif
+};
+
+/* Bridge inputs and enable duty cycle of a command */
+struct motor_l298n_output {
+	bool in[2];
+	bool set_in;
+	uint32_t pulse;
+};
+
+static int motor_l298n_output_get(const struct motor_l298n_channel_config *ch,
+				  uint32_t period, const struct motor_cmd *cmd,
+				  struct motor_l298n_output *out)
+{
+	switch (cmd->mode) {
+	case MOTOR_MODE_DRIVE:
+		if (cmd->speed > MOTOR_SPEED_MAX ||
+		    (cmd->dir != MOTOR_DIR_FORWARD && cmd->dir != MOTOR_DIR_REVERSE)) {
+			return -EINVAL;
+		}
+		if (cmd->dir == MOTOR_DIR_REVERSE && ch->num_in == 0) {
+			return -ENOTSUP;
+		}
+		out->in[L298N_IN1] = (cmd->dir == MOTOR_DIR_FORWARD);
+		out->in[L298N_IN2] = !out->in[L298N_IN1];
+		out->set_in = true;
+		out->pulse = (uint32_t)(((uint64_t)period * cmd->speed) / MOTOR_SPEED_MAX);
+		return 0;
+	case MOTOR_MODE_BRAKE:
+		/* Fast motor stop: enabled with both inputs at the same level */
+		if (ch->num_in < 2) {
+			return -ENOTSUP;
+		}
+		out->in[L298N_IN1] = false;
+		out->in[L298N_IN2] = false;
+		out->set_in = true;
+		out->pulse = period;
+		return 0;
+	case MOTOR_MODE_COAST:
+		/* Free running: disabled, the inputs do not matter */
+		out->set_in = false;
+		out->pulse = 0;
+		return 0;
+	default:
+		return -EINVAL;
+	}
+}
+
+/* A faulted channel only coasts until its fault is cleared */
+static bool motor_l298n_faulted(const struct motor_l298n_data *data, int i,
+				const struct motor_cmd *cmd)
+{
+#if defined(CONFIG_MOTOR_L298N_CURRENT)
+	return data->fault[i] != MOTOR_FAULT_NONE && cmd->mode != MOTOR_MODE_COAST;
+#else
+	ARG_UNUSED(data);
+	ARG_UNUSED(i);
+	ARG_UNUSED(cmd);
+
+	return false;
+#endif
+}
+
+/*
+ * Two outputs of one RP2xxx slice share the compare register, which is
+ * double buffered until the counter wraps. Writing both levels at once
+ * changes them in the same PWM period. Elsewhere both channels are
+ * written back to back, without preemption by other threads.
+ */
+static int motor_l298n_pwm_update(const struct device *dev, uint32_t channels)
+{
+	const struct motor_l298n_config *cfg = dev->config;
+	struct motor_l298n_data *data = dev->data;
+	int ret = 0;
+
+#if defined(CONFIG_PWM_RPI_PICO)
+	if (cfg->same_slice) {
+		uint16_t level[2];
+
+#if defined(CONFIG_MOTOR_L298N_RAMP)
+		/* The ramp of the other output owns its level, keep it */
+		if (atomic_get(&data->ramping) != 0) {
+			for (int i = 0; i < L298N_NUM_CHANNELS; i++) {
+				if (channels & BIT(i)) {
+					pwm_set_chan_level(cfg->ch[i].en.channel / 2,
+							   cfg->ch[i].en.channel & 1,
+							   data->pulse_cycles[i]);
+				}
+			}
+
+			return 0;
+		}
+#endif
+
+		for (int i = 0; i < L298N_NUM_CHANNELS; i++) {
+			level[cfg->ch[i].en.channel & 1] = data->pulse_cycles[i];
+		}
+		pwm_set_both_levels(cfg->ch[0].en.channel / 2, level[0], level[1]);
+
+		return 0;
+	}
+#endif
+
+	k_sched_lock();
+	for (int i = 0; i < cfg->num_channels && ret == 0; i++) {
+		const struct pwm_dt_spec *en = &cfg->ch[i].en;
+
+		if (channels & BIT(i)) {
+			ret = pwm_set_cycles(en->dev, en->channel, data->period_cycles[i],
+					     data->pulse_cycles[i], en->flags);
+		}
+	}
+	k_sched_unlock();
+
+	return ret;
+}
+
+#if defined(CONFIG_MOTOR_L298N_RAMP)
+/* Output of a channel in the compare register of its slice */
+#define L298N_CC_SHIFT(ch)	(((ch)->en.channel & 1) ? PWM_CH0_CC_B_LSB : PWM_CH0_CC_A_LSB)
+
+static volatile uint32_t *motor_l298n_cc(const struct motor_l298n_channel_config *ch)
+{
+	return &pwm_hw->slice[ch->en.channel / 2].cc;
+}
+
+/*
+ * Ends the ramp of a channel where it is. The compare register holds the
+ * speed reached, which the channel keeps. Called with the interrupt lock
+ * held.
+ */
+static void motor_l298n_ramp_stop(const struct device *dev, int i)
+{
+	const struct motor_l298n_config *cfg = dev->config;
+	struct motor_l298n_data *data = dev->data;
+	const struct motor_l298n_channel_config *ch = &cfg->ch[i];
+	uint32_t level;
+
+	if (!atomic_test_and_clear_bit(&data->ramping, i)) {
+		return;
+	}
+
+	dma_stop(ch->dma_dev, ch->dma_channel);
+
+	level = (*motor_l298n_cc(ch) >> L298N_CC_SHIFT(ch)) & UINT16_MAX;
+	data->pulse_cycles[i] = level;
+	data->cmd[i].speed = (uint16_t)(((uint64_t)level * MOTOR_SPEED_MAX) /
+					data->period_cycles[i]);
+}
+
+/*
+ * The ramp of the other output of a slice writes the whole compare
+ * register, the level of a channel is kept in its table as well. Called
+ * with the interrupt lock held, after a new level of the channel.
+ */
+static void motor_l298n_ramp_share(const struct device *dev, int i)
+{
+	const struct motor_l298n_config *cfg = dev->config;
+	struct motor_l298n_data *data = dev->data;
+	const int other = !i;
+	const uint32_t shift = L298N_CC_SHIFT(&cfg->ch[i]);
+	const uint32_t mask = (uint32_t)UINT16_MAX << shift;
+
+	if (!cfg->same_slice || !atomic_test_bit(&data->ramping, other)) {
+		return;
+	}
+
+	for (size_t k = 0; k < data->ramp_len[other]; k++) {
+		data->ramp_cc[other][k] = (data->ramp_cc[other][k] & ~mask) |
+					  (data->pulse_cycles[i] << shift);
+	}
+}
+
+static void motor_l298n_ramp_done(const struct device *dma_dev, void *user_data,
+				  uint32_t dma_channel, int status)
+{
+	const struct device *dev = user_data;
+	const struct motor_l298n_config *cfg = dev->config;
+	struct motor_l298n_data *data = dev->data;
+
+	ARG_UNUSED(dma_dev);
+
+	for (int i = 0; i < cfg->num_channels; i++) {
+		if (cfg->ch[i].dma_channel != dma_channel ||
+		    !atomic_test_and_clear_bit(&data->ramping, i)) {
+			continue;
+		}
+
+		if (data->ramp_cb[i] != NULL) {
+			data->ramp_cb[i](dev, i, (status < 0) ? -EIO : 0,
+					 data->ramp_user_data[i]);
+		}
+	}
+}
+
+static int motor_l298n_ramp(const struct device *dev, uint8_t channel,
+			    const struct motor_ramp *ramp)
+{
+	const struct motor_l298n_config *cfg = dev->config;
+	struct motor_l298n_data *data = dev->data;
+	const struct motor_l298n_channel_config *ch;
+	const struct motor_cmd end = {
+		.mode = MOTOR_MODE_DRIVE,
+		.dir = ramp->dir,
+		.speed = (ramp->len > 0) ? ramp->speeds[ramp->len - 1] : 0,
+	};
+	struct motor_l298n_output out;
+	struct dma_config *dma_cfg;
+	struct dma_block_config *blk;
+	k_spinlock_key_t key;
+	uint32_t period, other, shift;
+	int ret = 0;
+
+	if (channel >= cfg->num_channels || ramp->len == 0 ||
+	    ramp->len > CONFIG_MOTOR_L298N_RAMP_LEN) {
+		return -EINVAL;
+	}
+
+	ch = &cfg->ch[channel];
+	if (ch->dma_dev == NULL) {
+		return -ENOTSUP;
+	}
+
+	period = data->period_cycles[channel];
+	ret = motor_l298n_output_get(ch, period, &end, &out);
+	if (ret < 0) {
+		return ret;
+	}
+
+	for (size_t k = 0; k < ramp->len; k++) {
+		if (ramp->speeds[k] > MOTOR_SPEED_MAX) {
+			return -EINVAL;
+		}
+	}
+
+	k_mutex_lock(&data->lock, K_FOREVER);
+
+	key = k_spin_lock(&data->isr_lock);
+	/* Two ramps of one slice would write each other's output */
+	if (cfg->same_slice && atomic_test_bit(&data->ramping, !channel)) {
+		ret = -EBUSY;
+	} else if (motor_l298n_faulted(data, channel, &end)) {
+		ret = -EIO;
+	} else {
+		motor_l298n_ramp_stop(dev, channel);
+	}
+	k_spin_unlock(&data->isr_lock, key);
+	if (ret < 0) {
+		goto unlock;
+	}
+
+	for (int j = 0; j < ch->num_in && ret == 0; j++) {
+		ret = gpio_pin_set_dt(&ch->in[j], out.in[j]);
+	}
+	if (ret < 0) {
+		goto unlock;
+	}
+
+	blk = &data->dma_block[channel];
+	*blk = (struct dma_block_config){
+		.source_address = (uint32_t)data->ramp_cc[channel],
+		.dest_address = (uint32_t)motor_l298n_cc(ch),
+		.block_size = ramp->len * sizeof(uint32_t),
+		.source_addr_adj = DMA_ADDR_ADJ_INCREMENT,
+		.dest_addr_adj = DMA_ADDR_ADJ_NO_CHANGE,
+	};
+
+	dma_cfg = &data->dma_cfg[channel];
+	*dma_cfg = (struct dma_config){
+		.dma_slot = ch->dma_slot,
+		.channel_direction = MEMORY_TO_PERIPHERAL,
+		.source_data_size = sizeof(uint32_t),
+		.dest_data_size = sizeof(uint32_t),
+		.source_burst_length = 1U,
+		.dest_burst_length = 1U,
+		.block_count = 1U,
+		.head_block = blk,
+		.user_data = (void *)dev,
+		.dma_callback = motor_l298n_ramp_done,
+	};
+
+	ret = dma_config(ch->dma_dev, ch->dma_channel, dma_cfg);
+	if (ret < 0) {
+		goto unlock;
+	}
+
+	/* A fault since the check stopped the channel, it must not restart */
+	key = k_spin_lock(&data->isr_lock);
+	if (motor_l298n_faulted(data, channel, &end)) {
+		ret = -EIO;
+		goto unlock_isr;
+	}
+
+	/* The other output of the slice keeps its level, not a floating period */
+	shift = L298N_CC_SHIFT(ch);
+	if (cfg->same_slice) {
+		other = data->pulse_cycles[!channel] << L298N_CC_SHIFT(&cfg->ch[!channel]);
+	} else {
+		other = *motor_l298n_cc(ch) & ~((uint32_t)UINT16_MAX << shift);
+	}
+	for (size_t k = 0; k < ramp->len; k++) {
+		uint32_t level = (uint32_t)(((uint64_t)period * ramp->speeds[k]) /
+					    MOTOR_SPEED_MAX);
+
+		data->ramp_cc[channel][k] = other | (MIN(level, UINT16_MAX) << shift);
+	}
+
+	data->ramp_len[channel] = ramp->len;
+	data->ramp_cb[channel] = ramp->callback;
+	data->ramp_user_data[channel] = ramp->user_data;
+	data->pulse_cycles[channel] = out.pulse;
+	data->cmd[channel] = end;
+
+	atomic_set_bit(&data->ramping, channel);
+	ret = dma_start(ch->dma_dev, ch->dma_channel);
+	if (ret < 0) {
+		atomic_clear_bit(&data->ramping, channel);
+	}
+
+unlock_isr:
+	k_spin_unlock(&data->isr_lock, key);
+unlock:
+	k_mutex_unlock(&data->lock);
+
+	if (ret < 0 && ret != -EBUSY && ret != -EIO) {
+		LOG_ERR("failed to start ramp: %d", ret);
+	}
+
+	return ret;
+}
+#endif /* CONFIG_MOTOR_L298N_RAMP */
+
+#if defined(CONFIG_MOTOR_L298N_ADC)
+/*
+ * The PWM wrap interrupt selects the inputs and converts on its own, the
+ * ADC is not shared with the Zephyr ADC driver, see MOTOR_L298N_INIT.
+ */
+static const struct device *adc_devs[DT_NUM_INST_STATUS_OKAY(DT_DRV_COMPAT)];
+static size_t num_adc_devs;
+
+static uint32_t motor_l298n_adc_mv(const struct motor_l298n_config *cfg, uint8_t input)
+{
+	adc_select_input(input);
+
+	return (adc_read() * cfg->vref_mv) / L298N_ADC_COUNTS;
+}
+
+/* Busy waits until a phase of the PWM period, the counter passes it */
+static void motor_l298n_wait_phase(const struct motor_l298n_channel_config *ch,
+				   uint32_t cycles)
+{
+	while (pwm_hw->slice[ch->en.channel / 2].ctr < cycles) {
+	}
+}
+
+/* PWM counter cycles of a delay in us */
+static uint32_t motor_l298n_us_to_cycles(const struct motor_l298n_channel_config *ch,
+					 uint32_t period, uint32_t us)
+{
+	uint64_t cycles = ((uint64_t)us * NSEC_PER_USEC * period) / ch->en.period;
+
+	return (uint32_t)MIN(cycles, period - 1);
+}
+#endif /* CONFIG_MOTOR_L298N_ADC */
+
+#if defined(CONFIG_MOTOR_L298N_CURRENT)
+/*
+ * Stops a channel from the interrupt: the enable compare is double
+ * buffered, the output is off from the next wrap on. The time from the
+ * first sample over the limit to that wrap is the fault latency.
+ */
+static void motor_l298n_cut(const struct device *dev, int i, enum motor_fault fault,
+			    uint32_t ctr)
+{
+	const struct motor_l298n_config *cfg = dev->config;
+	struct motor_l298n_data *data = dev->data;
+	const struct motor_l298n_channel_config *ch = &cfg->ch[i];
+	const uint32_t slice = ch->en.channel / 2;
+	const uint32_t period = data->period_cycles[i];
+	uint64_t counts;
+
+#if defined(CONFIG_MOTOR_L298N_RAMP)
+	if (atomic_test_and_clear_bit(&data->ramping, i)) {
+		dma_stop(ch->dma_dev, ch->dma_channel);
+		if (data->ramp_cb[i] != NULL) {
+			data->ramp_cb[i](dev, i, -ECANCELED, data->ramp_user_data[i]);
+		}
+	}
+#endif
+
+	pwm_set_chan_level(slice, ch->en.channel & 1, 0);
+	data->pulse_cycles[i] = 0;
+#if defined(CONFIG_MOTOR_L298N_RAMP)
+	motor_l298n_ramp_share(dev, i);
+#endif
+
+	counts = (uint64_t)(data->over[i] - 1) * period + period - ctr;
+	if (pwm_hw->slice[slice].ctr < ctr) {
+		/* Wrapped before the write, the output is off one period later */
+		counts += period;
+	}
+
+	data->cmd[i] = (struct motor_cmd){.mode = MOTOR_MODE_COAST};
+	data->fault[i] = fault;
+	data->fault_latency_ns[i] = (uint32_t)((counts * ch->en.period) / period);
+	data->fault_latency_max_ns[i] = MAX(data->fault_latency_max_ns[i],
+					    data->fault_latency_ns[i]);
+
+	data->fault_last[i] = fault;
+	atomic_set_bit(&data->fault_log, i);
+	k_work_submit(&data->fault_work);
+}
+
+/* Logs the faults of the interrupt from the system work queue */
+static void motor_l298n_fault_work(struct k_work *work)
+{
+	struct motor_l298n_data *data = CONTAINER_OF(work, struct motor_l298n_data,
+						     fault_work);
+	enum motor_fault fault;
+	k_spinlock_key_t key;
+	uint32_t latency_ns;
+
+	for (int i = 0; i < L298N_NUM_CHANNELS; i++) {
+		if (!atomic_test_and_clear_bit(&data->fault_log, i)) {
+			continue;
+		}
+
+		key = k_spin_lock(&data->isr_lock);
+		fault = data->fault_last[i];
+		latency_ns = data->fault_latency_ns[i];
+		k_spin_unlock(&data->isr_lock, key);
+
+		LOG_WRN("%s channel %d %s, off after %u ns", data->dev->name, i,
+			(fault == MOTOR_FAULT_STALL) ? "stalled" : "overcurrent",
+			latency_ns);
+	}
+}
+
+static void motor_l298n_current_sample(const struct device *dev, int i)
+{
+	const struct motor_l298n_config *cfg = dev->config;
+	struct motor_l298n_data *data = dev->data;
+	const struct motor_l298n_channel_config *ch = &cfg->ch[i];
+	enum motor_fault fault = MOTOR_FAULT_NONE;
+	k_spinlock_key_t key;
+	uint16_t raw;
+	uint32_t ctr;
+
+	/* Past the switching transient at the start of the pulse */
+	motor_l298n_wait_phase(ch, data->sense_delay_cycles[i]);
+
+	ctr = pwm_hw->slice[ch->en.channel / 2].ctr;
+	adc_select_input(ch->sense_input);
+	raw = adc_read();
+
+	key = k_spin_lock(&data->isr_lock);
+	data->current_raw[i] = raw;
+
+	/* Braking current flows through the sense resistor too */
+	if (data->cmd[i].mode != MOTOR_MODE_DRIVE || raw < cfg->stall_raw) {
+		data->over[i] = 0;
+	} else {
+		data->over[i]++;
+		if (raw >= cfg->overcurrent_raw) {
+			fault = MOTOR_FAULT_OVERCURRENT;
+		} else if (data->over[i] >= cfg->stall_periods) {
+			fault = MOTOR_FAULT_STALL;
+		}
+	}
+
+	if (fault != MOTOR_FAULT_NONE) {
+		motor_l298n_cut(dev, i, fault, ctr);
+		data->over[i] = 0;
+#if defined(CONFIG_MOTOR_L298N_EMF)
+		data->emf_armed[i] = false;
+#endif
+	}
+	k_spin_unlock(&data->isr_lock, key);
+}
+
+static int motor_l298n_fault_clear(const struct device *dev, uint8_t channel)
+{
+	const struct motor_l298n_config *cfg = dev->config;
+	struct motor_l298n_data *data = dev->data;
+	k_spinlock_key_t key;
+
+	if (channel >= cfg->num_channels) {
+		return -EINVAL;
+	}
+
+	if (!cfg->ch[channel].sense) {
+		return -ENOTSUP;
+	}
+
+	key = k_spin_lock(&data->isr_lock);
+	data->fault[channel] = MOTOR_FAULT_NONE;
+	data->over[channel] = 0;
+	k_spin_unlock(&data->isr_lock, key);
+
+	return 0;
+}
+#endif /* CONFIG_MOTOR_L298N_CURRENT */
+
+#if defined(CONFIG_MOTOR_L298N_EMF)
+/*
+ * One period every emf_interval is left floating: the compare is zeroed at
+ * a wrap and restored at the next one, within the period the bridge is
+ * off. Once the inductive current has decayed through the diodes, the
+ * voltage across the motor is its back-EMF. The drive time lost is 1 in
+ * emf_interval periods, the interrupt waits up to emf_settle_us in the
+ * floating ones. A coasting motor floats anyway. Returns true in the
+ * floating periods.
+ */
+static bool motor_l298n_emf_sample(const struct device *dev, int i)
+{
+	const struct motor_l298n_config *cfg = dev->config;
+	struct motor_l298n_data *data = dev->data;
+	const struct motor_l298n_channel_config *ch = &cfg->ch[i];
+	const uint32_t slice = ch->en.channel / 2;
+	const uint32_t shift = (ch->en.channel & 1) ? PWM_CH0_CC_B_LSB : PWM_CH0_CC_A_LSB;
+	bool armed, sample = false;
+	k_spinlock_key_t key;
+	int32_t mv;
+
+	key = k_spin_lock(&data->isr_lock);
+	armed = data->emf_armed[i];
+	data->emf_armed[i] = false;
+
+	if (armed) {
+		/* A command changed the level since, the period is driven */
+		sample = ((pwm_hw->slice[slice].cc >> shift) & UINT16_MAX) == 0;
+	} else if (++data->emf_count[i] >= cfg->emf_interval) {
+		data->emf_count[i] = 0;
+
+		if (data->cmd[i].mode == MOTOR_MODE_DRIVE) {
+#if defined(CONFIG_MOTOR_L298N_RAMP)
+			/* A ramp of the slice writes the level back at the wrap */
+			if (cfg->same_slice ? atomic_get(&data->ramping) != 0 :
+					      atomic_test_bit(&data->ramping, i)) {
+				k_spin_unlock(&data->isr_lock, key);
+				return false;
+			}
+#endif
+			pwm_set_chan_level(slice, ch->en.channel & 1, 0);
+			data->emf_armed[i] = true;
+		}
+
+		/* Braking shorts the motor, there is nothing to measure */
+		sample = (data->cmd[i].mode == MOTOR_MODE_COAST);
+	}
+	k_spin_unlock(&data->isr_lock, key);
+
+	if (!sample) {
+		return false;
+	}
+
+	/* The settling wait is out of the lock, the callers are not held up */
+	motor_l298n_wait_phase(ch, data->emf_settle_cycles[i]);
+	mv = (int32_t)motor_l298n_adc_mv(cfg, ch->emf_input[0]) -
+	     (int32_t)motor_l298n_adc_mv(cfg, ch->emf_input[1]);
+	mv = (int32_t)(((int64_t)mv * cfg->emf_scale) / 1000);
+
+	key = k_spin_lock(&data->isr_lock);
+#if defined(CONFIG_MOTOR_L298N_RAMP)
+	/* A ramp started meanwhile owns the level */
+	armed = armed && !atomic_test_bit(&data->ramping, i);
+#endif
+	if (armed) {
+		pwm_set_chan_level(slice, ch->en.channel & 1, data->pulse_cycles[i]);
+	}
+	data->emf_q8[i] += ((mv << 8) - data->emf_q8[i]) >> cfg->emf_filter_shift;
+	k_spin_unlock(&data->isr_lock, key);
+
+	return true;
+}
+#endif /* CONFIG_MOTOR_L298N_EMF */
+
+#if defined(CONFIG_MOTOR_L298N_ADC)
+static void motor_l298n_pwm_isr(const void *arg)
+{
+	uint32_t wrapped = pwm_get_irq_status_mask();
+
+	ARG_UNUSED(arg);
+
+	pwm_hw->intr = wrapped;
+
+	for (size_t d = 0; d < num_adc_devs; d++) {
+		const struct device *dev = adc_devs[d];
+		const struct motor_l298n_config *cfg = dev->config;
+
+		for (int i = 0; i < cfg->num_channels; i++) {
+			const struct motor_l298n_channel_config *ch = &cfg->ch[i];
+
+			if (!(wrapped & BIT(ch->en.channel / 2))) {
+				continue;
+			}
+#if defined(CONFIG_MOTOR_L298N_EMF)
+			/* No current flows in the floating periods */
+			if (ch->emf && motor_l298n_emf_sample(dev, i)) {
+				continue;
+			}
+#endif
+#if defined(CONFIG_MOTOR_L298N_CURRENT)
+			if (ch->sense) {
+				motor_l298n_current_sample(dev, i);
+			}
+#endif
+		}
+	}
+}
+
+static int motor_l298n_status_get(const struct device *dev, uint8_t channel,
+				  struct motor_status *status)
+{
+	const struct motor_l298n_config *cfg = dev->config;
+	__maybe_unused struct motor_l298n_data *data = dev->data;
+	__maybe_unused const struct motor_l298n_channel_config *ch;
+	bool supported = false;
+	k_spinlock_key_t key;
+
+	if (channel >= cfg->num_channels) {
+		return -EINVAL;
+	}
+
+	ch = &cfg->ch[channel];
+	*status = (struct motor_status){0};
+
+	key = k_spin_lock(&data->isr_lock);
+#if defined(CONFIG_MOTOR_L298N_CURRENT)
+	if (ch->sense) {
+		status->current_ma = (uint32_t)(((uint64_t)data->current_raw[channel] *
+						 cfg->vref_mv * 1000U) /
+						((uint64_t)L298N_ADC_COUNTS * cfg->sense_mohm));
+		status->fault = data->fault[channel];
+		status->fault_latency_ns = data->fault_latency_ns[channel];
+		status->fault_latency_max_ns = data->fault_latency_max_ns[channel];
+		status->current_valid = true;
+		supported = true;
+	}
+#endif
+#if defined(CONFIG_MOTOR_L298N_EMF)
+	if (ch->emf) {
+		status->emf_mv = data->emf_q8[channel] >> 8;
+		status->emf_valid = true;
+		supported = true;
+	}
+#endif
+	k_spin_unlock(&data->isr_lock, key);
+
+	return supported ? 0 : -ENOTSUP;
+}
+
+static void motor_l298n_adc_init(const struct device *dev)
+{
+	const struct motor_l298n_config *cfg = dev->config;
+	struct motor_l298n_data *data = dev->data;
+	static bool irq_connected;
+	bool used = false;
+
+#if defined(CONFIG_MOTOR_L298N_CURRENT)
+	data->dev = dev;
+	k_work_init(&data->fault_work, motor_l298n_fault_work);
+#endif
+
+	for (int i = 0; i < cfg->num_channels; i++) {
+		const struct motor_l298n_channel_config *ch = &cfg->ch[i];
+		bool sampled = false;
+
+#if defined(CONFIG_MOTOR_L298N_CURRENT)
+		data->sense_delay_cycles[i] =
+			motor_l298n_us_to_cycles(ch, data->period_cycles[i],
+						 cfg->sense_delay_us);
+		sampled = sampled || ch->sense;
+#endif
+#if defined(CONFIG_MOTOR_L298N_EMF)
+		data->emf_settle_cycles[i] =
+			motor_l298n_us_to_cycles(ch, data->period_cycles[i],
+						 cfg->emf_settle_us);
+		sampled = sampled || ch->emf;
+#endif
+		if (sampled) {
+			pwm_clear_irq(ch->en.channel / 2);
+			pwm_set_irq_enabled(ch->en.channel / 2, true);
+			used = true;
+		}
+	}
+
+	if (!used) {
+		return;
+	}
+
+	adc_devs[num_adc_devs++] = dev;
+
+	if (!irq_connected) {
+		adc_init();
+		IRQ_CONNECT(PWM_DEFAULT_IRQ_NUM(), CONFIG_MOTOR_L298N_ADC_IRQ_PRIORITY,
+			    motor_l298n_pwm_isr, NULL, 0);
+		irq_enable(PWM_DEFAULT_IRQ_NUM());
+		irq_connected = true;
+	}
+}
+#endif /* CONFIG_MOTOR_L298N_ADC */
+
+static int motor_l298n_set(const struct device *dev, uint32_t channels,
+			   const struct motor_cmd *cmds)
+{
+	const struct motor_l298n_config *cfg = dev->config;
+	struct motor_l298n_data *data = dev->data;
+	struct motor_l298n_output out[L298N_NUM_CHANNELS];
+	k_spinlock_key_t key;
+	int ret = 0, err;
+
+	if (channels & ~BIT_MASK(cfg->num_channels)) {
+		return -EINVAL;
+	}
+
+	/* Check every command before touching any output */
+	for (int i = 0; i < cfg->num_channels; i++) {
+		if (channels & BIT(i)) {
+			ret = motor_l298n_output_get(&cfg->ch[i], data->period_cycles[i],
+						     &cmds[i], &out[i]);
+			if (ret < 0) {
+				return ret;
+			}
+		}
+	}
+
+	k_mutex_lock(&data->lock, K_FOREVER);
+
+	key = k_spin_lock(&data->isr_lock);
+	for (int i = 0; i < cfg->num_channels; i++) {
+		if ((channels & BIT(i)) && motor_l298n_faulted(data, i, &cmds[i])) {
+			ret = -EIO;
+		}
+	}
+#if defined(CONFIG_MOTOR_L298N_RAMP)
+	/* Only the ramps of the commanded channels end */
+	for (int i = 0; i < cfg->num_channels && ret == 0; i++) {
+		if (channels & BIT(i)) {
+			motor_l298n_ramp_stop(dev, i);
+		}
+	}
+#endif
+	k_spin_unlock(&data->isr_lock, key);
+	if (ret < 0) {
+		goto unlock;
+	}
+
+	for (int i = 0; i < cfg->num_channels && ret == 0; i++) {
+		const struct motor_l298n_channel_config *ch = &cfg->ch[i];
+
+		if (!(channels & BIT(i))) {
+			continue;
+		}
+
+		for (int j = 0; j < ch->num_in && out[i].set_in && ret == 0; j++) {
+			ret = gpio_pin_set_dt(&ch->in[j], out[i].in[j]);
+		}
+	}
+	if (ret < 0) {
+		goto unlock;
+	}
+
+	/* A fault since the check stopped a channel, it keeps coasting */
+	key = k_spin_lock(&data->isr_lock);
+	for (int i = 0; i < cfg->num_channels; i++) {
+		if (!(channels & BIT(i))) {
+			continue;
+		}
+
+		if (motor_l298n_faulted(data, i, &cmds[i])) {
+			channels &= ~BIT(i);
+			ret = -EIO;
+			continue;
+		}
+
+		data->pulse_cycles[i] = out[i].pulse;
+		data->cmd[i] = cmds[i];
+#if defined(CONFIG_MOTOR_L298N_RAMP)
+		motor_l298n_ramp_share(dev, i);
+#endif
+	}
+
+#if defined(CONFIG_MOTOR_L298N_ADC)
+	/* Sensed channels are on the RP2xxx PWM, its writes do not block */
+	err = motor_l298n_pwm_update(dev, channels);
+	k_spin_unlock(&data->isr_lock, key);
+#else
+	k_spin_unlock(&data->isr_lock, key);
+	err = motor_l298n_pwm_update(dev, channels);
+#endif
+	ret = (err < 0) ? err : ret;
+
+unlock:
+	k_mutex_unlock(&data->lock);
+
+	if (ret < 0 && ret != -EIO) {
+		LOG_ERR("failed to update outputs: %d", ret);
+	}
+
+	return ret;
+}
+
+static int motor_l298n_get(const struct device *dev, uint8_t channel,
+			   struct motor_cmd *cmd)
+{
+	const struct motor_l298n_config *cfg = dev->config;
+	struct motor_l298n_data *data = dev->data;
+	k_spinlock_key_t key;
+
+	if (channel >= cfg->num_channels) {
+		return -EINVAL;
+	}
+
+	key = k_spin_lock(&data->isr_lock);
+	*cmd = data->cmd[channel];
+	k_spin_unlock(&data->isr_lock, key);
+
+	return 0;
+}
+
+static uint8_t motor_l298n_channel_count(const struct device *dev)
+{
+	const struct motor_l298n_config *cfg = dev->config;
+
+	return cfg->num_channels;
+}
+
+static DEVICE_API(motor, motor_l298n_api) = {
+	.set = motor_l298n_set,
+	.get = motor_l298n_get,
+	.channel_count = motor_l298n_channel_count,
+#if defined(CONFIG_MOTOR_L298N_RAMP)
+	.ramp = motor_l298n_ramp,
+#endif
+#if defined(CONFIG_MOTOR_L298N_ADC)
+	.status_get = motor_l298n_status_get,
+#endif
+#if defined(CONFIG_MOTOR_L298N_CURRENT)
+	.fault_clear = motor_l298n_fault_clear,
+#endif
 };
 
 static int motor_l298n_init(const struct device *dev)
 {
-    const struct motor_l298n_config *config = dev->config;
-    struct motor_l298n_data *data = dev->data;
+	const struct motor_l298n_config *cfg = dev->config;
+	struct motor_l298n_data *data = dev->data;
+	uint64_t cycles_per_sec;
+	int ret;
+
+	k_mutex_init(&data->lock);
+
+	for (int i = 0; i < cfg->num_channels; i++) {
+		const struct motor_l298n_channel_config *ch = &cfg->ch[i];
+
+#if defined(CONFIG_MOTOR_L298N_RAMP)
+		if (ch->dma_dev != NULL) {
+			if (!device_is_ready(ch->dma_dev)) {
+				LOG_ERR("channel %d DMA not ready", i);
+				return -ENODEV;
+			}
+			if (ch->dma_slot != pwm_get_dreq(ch->en.channel / 2)) {
+				LOG_ERR("channel %d DMA slot is not the PWM wrap", i);
+				return -EINVAL;
+			}
+		}
+#endif
 
+		if (!pwm_is_ready_dt(&ch->en)) {
+			LOG_ERR("channel %d PWM not ready", i);
+			return -ENODEV;
+		}
+
+		for (int j = 0; j < ch->num_in; j++) {
+			if (!gpio_is_ready_dt(&ch->in[j])) {
+				LOG_ERR("channel %d direction GPIO not ready", i);
+				return -ENODEV;
+			}
+
+			ret = gpio_pin_configure_dt(&ch->in[j], GPIO_OUTPUT_INACTIVE);
+			if (ret < 0) {
+				return ret;
+			}
+		}
+
+		ret = pwm_get_cycles_per_sec(ch->en.dev, ch->en.channel,
+					     &cycles_per_sec);
+		if (ret < 0) {
+			return ret;
+		}
+
+		data->period_cycles[i] = (uint32_t)((ch->en.period * cycles_per_sec) /
+						    NSEC_PER_SEC);
+		data->pulse_cycles[i] = 0;
+		data->cmd[i] = (struct motor_cmd){.mode = MOTOR_MODE_COAST};
+
+		/* Sets the period and polarity, the level is all that changes after */
+		ret = pwm_set_cycles(ch->en.dev, ch->en.channel, data->period_cycles[i],
+				     0, ch->en.flags);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+#if defined(CONFIG_MOTOR_L298N_ADC)
+	motor_l298n_adc_init(dev);
+#endif
 
-    return 0;
+	return 0;
 }
 
-/**
- * Create a channel instance or return NULL based on the existance of the channel
- * in the devicetree.
- *
- * @param idx The instance index of the Motor L298N driver.
- * @param channel The channel being configured, 0 based.
- * @return A configured motor_l298n_channel struct or NULL
+#define MOTOR_L298N_DIR_GPIOS(inst, prop)						\
+	.in = {										\
+		GPIO_DT_SPEC_INST_GET_BY_IDX_OR(inst, prop, 0, {0}),			\
+		GPIO_DT_SPEC_INST_GET_BY_IDX_OR(inst, prop, 1, {0}),			\
+	},										\
+	.num_in = COND_CODE_1(DT_INST_NODE_HAS_PROP(inst, prop),			\
+			      (MIN(DT_INST_PROP_LEN(inst, prop), 2)), (0)),
+
+#if defined(CONFIG_MOTOR_L298N_RAMP)
+#define MOTOR_L298N_DMA(inst, name)							\
+	COND_CODE_1(DT_INST_DMAS_HAS_NAME(inst, name),					\
+		    (.dma_dev = DEVICE_DT_GET(DT_INST_DMAS_CTLR_BY_NAME(inst, name)),	\
+		     .dma_channel = DT_INST_DMAS_CELL_BY_NAME(inst, name, channel),	\
+		     .dma_slot = DT_INST_DMAS_CELL_BY_NAME(inst, name, slot),),	\
+		    ())
+#else
+#define MOTOR_L298N_DMA(inst, name)
+#endif
+
+#if defined(CONFIG_MOTOR_L298N_CURRENT)
+#define MOTOR_L298N_SENSE(inst, name)							\
+	COND_CODE_1(DT_INST_PROP_HAS_NAME(inst, io_channels, name),			\
+		    (.sense = true,							\
+		     .sense_input = DT_INST_IO_CHANNELS_INPUT_BY_NAME(inst, name),),	\
+		    ())
+
+/* A current in mA as ADC counts */
+#define MOTOR_L298N_CURRENT_RAW(inst, prop)						\
+	MIN((uint64_t)DT_INST_PROP(inst, prop) *					\
+	    DT_INST_PROP(inst, sense_resistor_milliohms) * L298N_ADC_COUNTS /		\
+	    (1000ULL * DT_INST_PROP(inst, adc_reference_millivolts)),			\
+	    L298N_ADC_COUNTS - 1)
+
+#define MOTOR_L298N_CURRENT(inst)							\
+	.overcurrent_raw = MOTOR_L298N_CURRENT_RAW(inst, overcurrent_milliamps),	\
+	.stall_raw = MOTOR_L298N_CURRENT_RAW(inst, stall_milliamps),			\
+	.stall_periods = DT_INST_PROP(inst, stall_periods),				\
+	.sense_delay_us = DT_INST_PROP(inst, sense_delay_us),				\
+	.sense_mohm = DT_INST_PROP(inst, sense_resistor_milliohms),
+#else
+#define MOTOR_L298N_SENSE(inst, name)
+#define MOTOR_L298N_CURRENT(inst)
+#endif
+
+#if defined(CONFIG_MOTOR_L298N_EMF)
+#define MOTOR_L298N_EMF_INPUTS(inst, out1, out2)					\
+	COND_CODE_1(UTIL_AND(DT_INST_PROP_HAS_NAME(inst, io_channels, out1),		\
+			     DT_INST_PROP_HAS_NAME(inst, io_channels, out2)),		\
+		    (.emf = true,							\
+		     .emf_input = {							\
+			DT_INST_IO_CHANNELS_INPUT_BY_NAME(inst, out1),			\
+			DT_INST_IO_CHANNELS_INPUT_BY_NAME(inst, out2),			\
+		     },),								\
+		    ())
+
+#define MOTOR_L298N_EMF(inst)								\
+	.emf_interval = DT_INST_PROP(inst, emf_interval_periods),			\
+	.emf_settle_us = DT_INST_PROP(inst, emf_settle_us),				\
+	.emf_scale = DT_INST_PROP(inst, emf_divider_permille),				\
+	.emf_filter_shift = DT_INST_PROP(inst, emf_filter_shift),
+#else
+#define MOTOR_L298N_EMF_INPUTS(inst, out1, out2)
+#define MOTOR_L298N_EMF(inst)
+#endif
+
+#if defined(CONFIG_MOTOR_L298N_ADC)
+#define MOTOR_L298N_ADC(inst)								\
+	.vref_mv = DT_INST_PROP(inst, adc_reference_millivolts),
+#else
+#define MOTOR_L298N_ADC(inst)
+#endif
+
+/*
+ * Channel n is the n-th pwms entry with the ch-<n+1>-dir-gpios inputs, the
+ * ch-<n+1> DMA channel and the ch-<n+1>, ch-<n+1>-emf-1 and ch-<n+1>-emf-2
+ * ADC inputs
  */
-#define MOTOR_L298N_CONFIGURE_CHANNEL(idx, channel)                                 \
-    COND_CODE_1(DT_INST_PROP_HAS_IDX(idx, pwms, channel),                           \
-    ({                                                                              \
-        .enable_pin = PWM_DT_SPEC_INST_GET_BY_IDX_OR(idx, channel, NULL),           \
-        .dir_pins = {                                                               \
-            GPIO_DT_SPEC_INST_GET_BY_IDX_OR(idx, ch_##channel##_dir_gpios, 0, NULL),\
-            GPIO_DT_SPEC_INST_GET_BY_IDX_OR(idx, ch_##channel##_dir_gpios, 1, NULL) \
-        }                                                                           \
-    }), NULL)                                                                       \
-
-#define MOTOR_L298N_INIT(idx)						            \
-        static const struct motor_l298n_config motor_l298n##idx##_config = {        \
-            .ch1 = MOTOR_L298N_CONFIGURE_CHANNEL(idx, 0),                           \
-            .ch2 = MOTOR_L298N_CONFIGURE_CHANNEL(idx, 1)                            \
-        };								            \
-                                                                                    \
-        static struct motor_l298n_data motor_l298n##idx##_data = {                  \
-            .ch1 = {                                                                \
-                .enabled = false,                                                   \
-                .forward = true,                                                    \
-                .pulse_width = 0                                                    \
-            },                                                                      \
-            .ch2 = {                                                                \
-                .enabled = false,                                                   \
-                .forward = true,                                                    \
-                .pulse_width = 0                                                    \
-            }                                                                       \
-        };                                                                          \
-                                                                                    \
-        DEVICE_DT_INST_DEFINE(idx, motor_l298n_init, NULL,                          \
-                              &motor_l298n##idx##_data, &motor_l298n##idx##_config, \
-                              POST_KERNEL, CONFIG_MOTOR_INIT_PRIORITY, NULL);
+#define MOTOR_L298N_CHANNEL(inst, idx, prop, name, out1, out2)			\
+	COND_CODE_1(DT_INST_PROP_HAS_IDX(inst, pwms, idx),				\
+		    ({									\
+			.en = PWM_DT_SPEC_INST_GET_BY_IDX(inst, idx),			\
+			MOTOR_L298N_DIR_GPIOS(inst, prop)				\
+			MOTOR_L298N_DMA(inst, name)					\
+			MOTOR_L298N_SENSE(inst, name)					\
+			MOTOR_L298N_EMF_INPUTS(inst, out1, out2)			\
+		    }),									\
+		    ({0}))
+
+#define MOTOR_L298N_SAME_SLICE(inst)							\
+	COND_CODE_1(DT_INST_PROP_HAS_IDX(inst, pwms, 1),				\
+		    (DT_NODE_HAS_COMPAT(DT_INST_PWMS_CTLR_BY_IDX(inst, 0),		\
+					raspberrypi_pico_pwm) &&			\
+		     DT_SAME_NODE(DT_INST_PWMS_CTLR_BY_IDX(inst, 0),			\
+				  DT_INST_PWMS_CTLR_BY_IDX(inst, 1)) &&			\
+		     (DT_INST_PWMS_CHANNEL_BY_IDX(inst, 0) / 2 ==			\
+		      DT_INST_PWMS_CHANNEL_BY_IDX(inst, 1) / 2)),			\
+		    (false))
+
+#define MOTOR_L298N_INIT(inst)								\
+	BUILD_ASSERT(DT_INST_PROP_LEN(inst, pwms) <= L298N_NUM_CHANNELS,		\
+		     "L298N has two channels");						\
+	BUILD_ASSERT(DT_INST_PROP(inst, stall_milliamps) <=				\
+		     DT_INST_PROP(inst, overcurrent_milliamps),				\
+		     "stall current above the overcurrent limit");			\
+	BUILD_ASSERT(DT_INST_PROP(inst, stall_periods) > 0, "no stall periods");	\
+	BUILD_ASSERT(DT_INST_PROP(inst, emf_interval_periods) > 1,			\
+		     "back-EMF sampled every period");					\
+	BUILD_ASSERT(!DT_INST_NODE_HAS_PROP(inst, io_channels) ||			\
+		     !IS_ENABLED(CONFIG_ADC_RPI_PICO),					\
+		     "L298N sensing owns the ADC, disable the Zephyr ADC driver");	\
+											\
+	static const struct motor_l298n_config motor_l298n_config_##inst = {		\
+		.ch = {									\
+			MOTOR_L298N_CHANNEL(inst, 0, ch_1_dir_gpios, ch_1,		\
+					    ch_1_emf_1, ch_1_emf_2),			\
+			MOTOR_L298N_CHANNEL(inst, 1, ch_2_dir_gpios, ch_2,		\
+					    ch_2_emf_1, ch_2_emf_2),			\
+		},									\
+		.num_channels = DT_INST_PROP_LEN(inst, pwms),				\
+		.same_slice = MOTOR_L298N_SAME_SLICE(inst),				\
+		MOTOR_L298N_CURRENT(inst)						\
+		MOTOR_L298N_EMF(inst)							\
+		MOTOR_L298N_ADC(inst)							\
+	};										\
+											\
+	static struct motor_l298n_data motor_l298n_data_##inst;			\
+											\
+	DEVICE_DT_INST_DEFINE(inst, motor_l298n_init, NULL,				\
+			      &motor_l298n_data_##inst, &motor_l298n_config_##inst,	\
+			      POST_KERNEL, CONFIG_MOTOR_INIT_PRIORITY,			\
+			      &motor_l298n_api);
 
 DT_INST_FOREACH_STATUS_OKAY(MOTOR_L298N_INIT)
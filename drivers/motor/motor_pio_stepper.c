@@ -0,0 +1,507 @@
+/*
+ * Copyright (c) 2025 Jared Woolston
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define DT_DRV_COMPAT raspberrypi_pico_stepper_pio
+
+#include <stdint.h>
+
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/dma.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/misc/pio_rpi_pico/pio_rpi_pico.h>
+#include <zephyr/drivers/pinctrl.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+
+#include <app/drivers/motor.h>
+
+#include <hardware/clocks.h>
+#include <hardware/pio.h>
+
+LOG_MODULE_REGISTER(motor_pio_stepper, CONFIG_MOTOR_LOG_LEVEL);
+
+/* PIO cycles of the STEP pulse and of the DIR setup before it */
+#define STEPPER_PULSE_CYCLES	8
+
+/* PIO cycles of a step besides the interval of its command */
+#define STEPPER_STEP_CYCLES	19
+
+/* Largest interval of a command, 31 bits */
+#define STEPPER_INTERVAL_MAX	(UINT32_MAX >> 1)
+
+/* The address of the wait of a step, where it is safe to restart */
+#define STEPPER_PC_WAIT		6
+
+struct motor_pio_stepper_config {
+	const struct device *piodev;
+	const struct pinctrl_dev_config *pcfg;
+	uint32_t step_pin;
+	uint32_t dir_pin;
+	/* Driver enable, optional, active while driving or holding */
+	struct gpio_dt_spec en;
+	uint32_t max_step_rate;
+	uint32_t pulse_ns;
+	/* Ramps write the TX FIFO of the state machine, paced by its DREQ */
+	const struct device *dma_dev;
+	uint32_t dma_channel;
+	uint32_t dma_slot;
+};
+
+struct motor_pio_stepper_data {
+	struct k_mutex lock;
+	struct motor_cmd cmd;
+	PIO pio;
+	size_t sm;
+	uint32_t offset;
+	/* State machine clock, from the pulse width */
+	uint32_t sm_hz;
+	/* A ramp is in progress */
+	atomic_t ramping;
+	motor_ramp_callback_t ramp_cb;
+	void *ramp_user_data;
+	struct dma_config dma_cfg;
+	struct dma_block_config dma_block;
+	uint32_t ramp_words[CONFIG_MOTOR_PIO_STEPPER_RAMP_LEN];
+};
+
+/*
+ * Every command is one word, the interval in bits 31:1 and DIR in bit 0,
+ * high forward. A step is STEP high for 8 cycles then low for the interval
+ * plus 11 cycles, DIR is set 8 cycles before STEP rises. The pull does not
+ * block: with the FIFO empty it reloads the last command from X, so the
+ * state machine keeps stepping at the last rate. An interval of 0 stops.
+ *
+ *     .side_set 1
+ *     .wrap_target
+ * 0:  pull noblock    side 0
+ * 1:  mov x, osr      side 0
+ * 2:  out pins, 1     side 0 [5]
+ * 3:  out y, 31       side 0
+ * 4:  jmp !y, 0       side 0
+ * 5:  nop             side 1 [7]
+ * 6:  jmp y--, 6      side 0
+ *     .wrap
+ */
+RPI_PICO_PIO_DEFINE_PROGRAM(stepper, 0, 6,
+	0x8080, /* 0: pull noblock side 0 */
+	0xa027, /* 1: mov x, osr side 0 */
+	0x6501, /* 2: out pins, 1 side 0 [5] */
+	0x605f, /* 3: out y, 31 side 0 */
+	0x0060, /* 4: jmp !y, 0 side 0 */
+	0xb742, /* 5: nop side 1 [7] */
+	0x0086, /* 6: jmp y--, 6 side 0 */
+);
+
+/* Command word of a speed */
+static uint32_t motor_pio_stepper_word(const struct motor_pio_stepper_config *cfg,
+				       const struct motor_pio_stepper_data *data,
+				       enum motor_direction dir, uint16_t speed)
+{
+	uint32_t dir_bit = (dir == MOTOR_DIR_FORWARD) ? 1U : 0U;
+	uint64_t rate = ((uint64_t)cfg->max_step_rate * speed) / MOTOR_SPEED_MAX;
+	uint64_t interval;
+
+	if (rate == 0) {
+		return dir_bit;
+	}
+
+	interval = DIV_ROUND_CLOSEST((uint64_t)data->sm_hz, rate);
+	interval = CLAMP(interval, STEPPER_STEP_CYCLES + 1,
+			 STEPPER_INTERVAL_MAX + STEPPER_STEP_CYCLES);
+
+	return ((uint32_t)(interval - STEPPER_STEP_CYCLES) << 1) | dir_bit;
+}
+
+static int motor_pio_stepper_check(const struct motor_pio_stepper_config *cfg,
+				   const struct motor_cmd *cmd)
+{
+	switch (cmd->mode) {
+	case MOTOR_MODE_DRIVE:
+		if (cmd->speed > MOTOR_SPEED_MAX ||
+		    (cmd->dir != MOTOR_DIR_FORWARD && cmd->dir != MOTOR_DIR_REVERSE)) {
+			return -EINVAL;
+		}
+		return 0;
+	case MOTOR_MODE_BRAKE:
+		/* Stopped with the coils energized, holding */
+		return 0;
+	case MOTOR_MODE_COAST:
+		return (cfg->en.port != NULL) ? 0 : -ENOTSUP;
+	default:
+		return -EINVAL;
+	}
+}
+
+/*
+ * Ends a ramp in progress, the commands queued in the FIFO are dropped.
+ * Called with the lock held.
+ */
+static void motor_pio_stepper_ramp_stop(const struct device *dev)
+{
+	const struct motor_pio_stepper_config *cfg = dev->config;
+	struct motor_pio_stepper_data *data = dev->data;
+
+	if (atomic_test_and_clear_bit(&data->ramping, 0)) {
+		dma_stop(cfg->dma_dev, cfg->dma_channel);
+	}
+
+	pio_sm_clear_fifos(data->pio, data->sm);
+}
+
+/*
+ * Applies the command queued in the FIFO now rather than after the step in
+ * progress, which may be long at low rates. Only the wait of a step is cut
+ * short, the state machine is never restarted within a STEP pulse: it is
+ * at least 10 PIO cycles from the wait to the pulse, at least 10/8 of the
+ * pulse width. The PIO runs on its own, so the PC read and the jump must
+ * follow each other within that time: with interrupts locked they are two
+ * bus accesses a few system clocks apart, far below the shortest pulse.
+ */
+static void motor_pio_stepper_kick(struct motor_pio_stepper_data *data)
+{
+	const uint32_t jmp = pio_encode_jmp(data->offset);
+	unsigned int key = irq_lock();
+
+	if (pio_sm_get_pc(data->pio, data->sm) == data->offset + STEPPER_PC_WAIT) {
+		pio_sm_exec(data->pio, data->sm, jmp);
+	}
+
+	irq_unlock(key);
+}
+
+/*
+ * The DMA completes on the last write to the FIFO, the callback comes with
+ * up to 8 commands still queued in the joined FIFO and the step in progress
+ * ahead of the last speed.
+ */
+static void motor_pio_stepper_ramp_done(const struct device *dma_dev, void *user_data,
+					uint32_t dma_channel, int status)
+{
+	const struct device *dev = user_data;
+	struct motor_pio_stepper_data *data = dev->data;
+
+	ARG_UNUSED(dma_dev);
+	ARG_UNUSED(dma_channel);
+
+	if (!atomic_test_and_clear_bit(&data->ramping, 0)) {
+		return;
+	}
+
+	if (data->ramp_cb != NULL) {
+		data->ramp_cb(dev, 0, (status < 0) ? -EIO : 0, data->ramp_user_data);
+	}
+}
+
+static int motor_pio_stepper_ramp(const struct device *dev, uint8_t channel,
+				  const struct motor_ramp *ramp)
+{
+	const struct motor_pio_stepper_config *cfg = dev->config;
+	struct motor_pio_stepper_data *data = dev->data;
+	const struct motor_cmd end = {
+		.mode = MOTOR_MODE_DRIVE,
+		.dir = ramp->dir,
+		.speed = (ramp->len > 0) ? ramp->speeds[ramp->len - 1] : 0,
+	};
+	int ret;
+
+	if (channel != 0 || ramp->len == 0 ||
+	    ramp->len > CONFIG_MOTOR_PIO_STEPPER_RAMP_LEN) {
+		return -EINVAL;
+	}
+
+	if (cfg->dma_dev == NULL) {
+		return -ENOTSUP;
+	}
+
+	ret = motor_pio_stepper_check(cfg, &end);
+	if (ret < 0) {
+		return ret;
+	}
+
+	for (size_t k = 0; k < ramp->len; k++) {
+		if (ramp->speeds[k] > MOTOR_SPEED_MAX) {
+			return -EINVAL;
+		}
+	}
+
+	k_mutex_lock(&data->lock, K_FOREVER);
+
+	motor_pio_stepper_ramp_stop(dev);
+
+	for (size_t k = 0; k < ramp->len; k++) {
+		data->ramp_words[k] = motor_pio_stepper_word(cfg, data, ramp->dir,
+							     ramp->speeds[k]);
+	}
+
+	data->dma_block = (struct dma_block_config){
+		.source_address = (uint32_t)data->ramp_words,
+		.dest_address = (uint32_t)&data->pio->txf[data->sm],
+		.block_size = ramp->len * sizeof(uint32_t),
+		.source_addr_adj = DMA_ADDR_ADJ_INCREMENT,
+		.dest_addr_adj = DMA_ADDR_ADJ_NO_CHANGE,
+	};
+
+	data->dma_cfg = (struct dma_config){
+		.dma_slot = cfg->dma_slot,
+		.channel_direction = MEMORY_TO_PERIPHERAL,
+		.source_data_size = sizeof(uint32_t),
+		.dest_data_size = sizeof(uint32_t),
+		.source_burst_length = 1U,
+		.dest_burst_length = 1U,
+		.block_count = 1U,
+		.head_block = &data->dma_block,
+		.user_data = (void *)dev,
+		.dma_callback = motor_pio_stepper_ramp_done,
+	};
+
+	data->ramp_cb = ramp->callback;
+	data->ramp_user_data = ramp->user_data;
+	data->cmd = end;
+
+	if (cfg->en.port != NULL) {
+		ret = gpio_pin_set_dt(&cfg->en, 1);
+	}
+
+	/* The ramp follows the step in progress, without a kick */
+	if (ret == 0) {
+		ret = dma_config(cfg->dma_dev, cfg->dma_channel, &data->dma_cfg);
+	}
+	if (ret == 0) {
+		atomic_set_bit(&data->ramping, 0);
+		ret = dma_start(cfg->dma_dev, cfg->dma_channel);
+		if (ret < 0) {
+			atomic_clear_bit(&data->ramping, 0);
+		}
+	}
+
+	k_mutex_unlock(&data->lock);
+
+	if (ret < 0) {
+		LOG_ERR("failed to start ramp: %d", ret);
+	}
+
+	return ret;
+}
+
+static int motor_pio_stepper_set(const struct device *dev, uint32_t channels,
+				 const struct motor_cmd *cmds)
+{
+	const struct motor_pio_stepper_config *cfg = dev->config;
+	struct motor_pio_stepper_data *data = dev->data;
+	const struct motor_cmd *cmd = &cmds[0];
+	uint32_t word;
+	int ret;
+
+	if (channels & ~BIT(0)) {
+		return -EINVAL;
+	}
+
+	if (channels == 0) {
+		return 0;
+	}
+
+	ret = motor_pio_stepper_check(cfg, cmd);
+	if (ret < 0) {
+		return ret;
+	}
+
+	k_mutex_lock(&data->lock, K_FOREVER);
+
+	/* Stopping keeps DIR where it is */
+	word = (cmd->mode == MOTOR_MODE_DRIVE) ?
+	       motor_pio_stepper_word(cfg, data, cmd->dir, cmd->speed) :
+	       motor_pio_stepper_word(cfg, data, data->cmd.dir, 0);
+
+	motor_pio_stepper_ramp_stop(dev);
+	pio_sm_put(data->pio, data->sm, word);
+	motor_pio_stepper_kick(data);
+
+	if (cfg->en.port != NULL) {
+		ret = gpio_pin_set_dt(&cfg->en, cmd->mode != MOTOR_MODE_COAST);
+	}
+	if (ret == 0) {
+		data->cmd = *cmd;
+	}
+
+	k_mutex_unlock(&data->lock);
+
+	if (ret < 0) {
+		LOG_ERR("failed to update enable: %d", ret);
+	}
+
+	return ret;
+}
+
+static int motor_pio_stepper_get(const struct device *dev, uint8_t channel,
+				 struct motor_cmd *cmd)
+{
+	struct motor_pio_stepper_data *data = dev->data;
+
+	if (channel != 0) {
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&data->lock, K_FOREVER);
+	*cmd = data->cmd;
+	k_mutex_unlock(&data->lock);
+
+	return 0;
+}
+
+static uint8_t motor_pio_stepper_channel_count(const struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	return 1;
+}
+
+static DEVICE_API(motor, motor_pio_stepper_api) = {
+	.set = motor_pio_stepper_set,
+	.get = motor_pio_stepper_get,
+	.channel_count = motor_pio_stepper_channel_count,
+	.ramp = motor_pio_stepper_ramp,
+};
+
+static int motor_pio_stepper_sm_init(const struct device *dev)
+{
+	const struct motor_pio_stepper_config *cfg = dev->config;
+	struct motor_pio_stepper_data *data = dev->data;
+	const uint32_t sys_hz = clock_get_hz(clk_sys);
+	pio_sm_config sm_config;
+	uint64_t div_q8;
+
+	if (!pio_can_add_program(data->pio, RPI_PICO_PIO_GET_PROGRAM(stepper))) {
+		return -EBUSY;
+	}
+
+	/* The 8 cycles of the pulse last at least pulse_ns, in 1/256 steps */
+	div_q8 = DIV_ROUND_UP((uint64_t)sys_hz * cfg->pulse_ns * 256U,
+			      (uint64_t)STEPPER_PULSE_CYCLES * NSEC_PER_SEC);
+	div_q8 = CLAMP(div_q8, 256U, (uint64_t)UINT16_MAX << 8);
+	data->sm_hz = (uint32_t)(((uint64_t)sys_hz << 8) / div_q8);
+
+	if (cfg->max_step_rate == 0 ||
+	    cfg->max_step_rate > data->sm_hz / (STEPPER_STEP_CYCLES + 1)) {
+		LOG_ERR("max step rate above %u Hz with %u ns pulses",
+			data->sm_hz / (STEPPER_STEP_CYCLES + 1), cfg->pulse_ns);
+		return -EINVAL;
+	}
+
+	data->offset = pio_add_program(data->pio, RPI_PICO_PIO_GET_PROGRAM(stepper));
+
+	pio_gpio_init(data->pio, cfg->step_pin);
+	pio_gpio_init(data->pio, cfg->dir_pin);
+	pio_sm_set_pins_with_mask(data->pio, data->sm, 0,
+				  BIT(cfg->step_pin) | BIT(cfg->dir_pin));
+	pio_sm_set_consecutive_pindirs(data->pio, data->sm, cfg->step_pin, 1, true);
+	pio_sm_set_consecutive_pindirs(data->pio, data->sm, cfg->dir_pin, 1, true);
+
+	sm_config = pio_get_default_sm_config();
+	sm_config_set_sideset(&sm_config, 1, false, false);
+	sm_config_set_sideset_pins(&sm_config, cfg->step_pin);
+	sm_config_set_out_pins(&sm_config, cfg->dir_pin, 1);
+	/* Shift right, DIR first, no autopull */
+	sm_config_set_out_shift(&sm_config, true, false, 32);
+	/* Only commands go in, twice the queue */
+	sm_config_set_fifo_join(&sm_config, PIO_FIFO_JOIN_TX);
+	sm_config_set_clkdiv_int_frac(&sm_config, (uint16_t)(div_q8 >> 8),
+				      (uint8_t)(div_q8 & 0xff));
+	sm_config_set_wrap(&sm_config,
+			   data->offset + RPI_PICO_PIO_GET_WRAP_TARGET(stepper),
+			   data->offset + RPI_PICO_PIO_GET_WRAP(stepper));
+
+	pio_sm_init(data->pio, data->sm, data->offset, &sm_config);
+
+	/* X is reloaded by the pull, start it stopped */
+	pio_sm_exec(data->pio, data->sm, pio_encode_set(pio_x, 0));
+	pio_sm_set_enabled(data->pio, data->sm, true);
+
+	return 0;
+}
+
+static int motor_pio_stepper_init(const struct device *dev)
+{
+	const struct motor_pio_stepper_config *cfg = dev->config;
+	struct motor_pio_stepper_data *data = dev->data;
+	int ret;
+
+	k_mutex_init(&data->lock);
+
+	if (cfg->dma_dev != NULL && !device_is_ready(cfg->dma_dev)) {
+		LOG_ERR("DMA not ready");
+		return -ENODEV;
+	}
+
+	if (cfg->en.port != NULL) {
+		if (!gpio_is_ready_dt(&cfg->en)) {
+			LOG_ERR("enable GPIO not ready");
+			return -ENODEV;
+		}
+
+		ret = gpio_pin_configure_dt(&cfg->en, GPIO_OUTPUT_INACTIVE);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	data->pio = pio_rpi_pico_get_pio(cfg->piodev);
+
+	if (pio_rpi_pico_allocate_sm(cfg->piodev, &data->sm) != 0) {
+		return -EBUSY;
+	}
+
+	if (cfg->dma_dev != NULL &&
+	    cfg->dma_slot != pio_get_dreq(data->pio, data->sm, true)) {
+		LOG_ERR("DMA slot is not the TX of state machine %u", data->sm);
+		return -EINVAL;
+	}
+
+	ret = motor_pio_stepper_sm_init(dev);
+	if (ret < 0) {
+		return ret;
+	}
+
+	data->cmd = (struct motor_cmd){
+		.mode = (cfg->en.port != NULL) ? MOTOR_MODE_COAST : MOTOR_MODE_BRAKE,
+	};
+
+	return pinctrl_apply_state(cfg->pcfg, PINCTRL_STATE_DEFAULT);
+}
+
+#define MOTOR_PIO_STEPPER_DMA(inst)							\
+	COND_CODE_1(DT_INST_DMAS_HAS_NAME(inst, ramp),					\
+		    (.dma_dev = DEVICE_DT_GET(DT_INST_DMAS_CTLR_BY_NAME(inst, ramp)),	\
+		     .dma_channel = DT_INST_DMAS_CELL_BY_NAME(inst, ramp, channel),	\
+		     .dma_slot = DT_INST_DMAS_CELL_BY_NAME(inst, ramp, slot),),	\
+		    ())
+
+#define MOTOR_PIO_STEPPER_INIT(inst)							\
+	PINCTRL_DT_INST_DEFINE(inst);							\
+											\
+	static const struct motor_pio_stepper_config motor_pio_stepper_config_##inst = {\
+		.piodev = DEVICE_DT_GET(DT_INST_PARENT(inst)),				\
+		.pcfg = PINCTRL_DT_INST_DEV_CONFIG_GET(inst),				\
+		.step_pin = DT_INST_RPI_PICO_PIO_PIN_BY_NAME(inst, default, 0,		\
+							     step_pin, 0),		\
+		.dir_pin = DT_INST_RPI_PICO_PIO_PIN_BY_NAME(inst, default, 0,		\
+							    dir_pin, 0),		\
+		.en = GPIO_DT_SPEC_INST_GET_OR(inst, enable_gpios, {0}),		\
+		.max_step_rate = DT_INST_PROP(inst, max_step_rate_hz),			\
+		.pulse_ns = DT_INST_PROP(inst, step_pulse_ns),				\
+		MOTOR_PIO_STEPPER_DMA(inst)						\
+	};										\
+											\
+	static struct motor_pio_stepper_data motor_pio_stepper_data_##inst;		\
+											\
+	DEVICE_DT_INST_DEFINE(inst, motor_pio_stepper_init, NULL,			\
+			      &motor_pio_stepper_data_##inst,				\
+			      &motor_pio_stepper_config_##inst,				\
+			      POST_KERNEL, CONFIG_MOTOR_INIT_PRIORITY,			\
+			      &motor_pio_stepper_api);
+
+DT_INST_FOREACH_STATUS_OKAY(MOTOR_PIO_STEPPER_INIT)
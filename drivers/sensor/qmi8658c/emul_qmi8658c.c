@@ -0,0 +1,418 @@
+/* QST QMI8658C 6-axis IMU sensor driver - I2C emulator
+ *
+ * Copyright (c) 2025 Jared Woolston
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define DT_DRV_COMPAT qst_qmi8658c
+
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/gpio/gpio_emul.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/drivers/i2c_emul.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/logging/log.h>
+
+#include <app/drivers/sensor/qmi8658c_emul.h>
+
+#include "qmi8658c.h"
+
+LOG_MODULE_REGISTER(qmi8658c_emul, CONFIG_SENSOR_LOG_LEVEL);
+
+#define EMUL_REG_COUNT			0x80
+
+/* FUNC_CFG_ACCESS[7:6] select the embedded function or sensor hub bank */
+#define EMUL_BANK_MASK			0xC0
+
+#define EMUL_CTRL3_SW_RESET		BIT(0)
+#define EMUL_CTRL3_IF_INC		BIT(2)
+
+#define EMUL_INT_DRDY_XL		BIT(0)
+#define EMUL_INT_DRDY_G			BIT(1)
+#define EMUL_INT2_DRDY_TEMP		BIT(2)
+#define EMUL_INT_FIFO_TH		BIT(3)
+#define EMUL_MD_WU			BIT(5)
+
+#define EMUL_WAKE_UP_SRC_WU_IA		BIT(3)
+
+#define EMUL_FIFO_MODE_MASK		0x07
+#define EMUL_FIFO_STATUS2_WTM_IA	BIT(7)
+#define EMUL_FIFO_STATUS2_OVR		BIT(6)
+#define EMUL_FIFO_STATUS2_FULL		BIT(5)
+
+#define EMUL_FIFO_DATA_END		(LSM6DSO_FIFO_DATA_OUT_TAG + LSM6DSO_FIFO_WORD_LEN)
+
+struct qmi8658c_emul_cfg {
+	struct gpio_dt_spec irq;
+	uint8_t int_pin;
+};
+
+struct qmi8658c_emul_data {
+	struct k_spinlock lock;
+	uint8_t regs[EMUL_REG_COUNT];
+	/* Embedded function and sensor hub banks are not modelled */
+	uint8_t bank_regs[EMUL_REG_COUNT];
+	uint8_t fifo[QMI8658C_EMUL_FIFO_WORDS][LSM6DSO_FIFO_WORD_LEN];
+	uint16_t fifo_head;
+	uint16_t fifo_count;
+	bool fifo_ovr;
+	uint8_t ptr;
+	int line;
+};
+
+static void emul_reset(struct qmi8658c_emul_data *data)
+{
+	memset(data->regs, 0, sizeof(data->regs));
+	memset(data->bank_regs, 0, sizeof(data->bank_regs));
+	data->regs[LSM6DSO_WHO_AM_I] = LSM6DSO_ID;
+	data->regs[LSM6DSO_CTRL3_C] = EMUL_CTRL3_IF_INC;
+	data->fifo_head = 0;
+	data->fifo_count = 0;
+	data->fifo_ovr = false;
+}
+
+static uint16_t emul_fifo_wtm(const struct qmi8658c_emul_data *data)
+{
+	return data->regs[LSM6DSO_FIFO_CTRL1] |
+	       ((data->regs[LSM6DSO_FIFO_CTRL2] & 0x01) << 8);
+}
+
+static bool emul_fifo_wtm_ia(const struct qmi8658c_emul_data *data)
+{
+	uint16_t wtm = emul_fifo_wtm(data);
+
+	return wtm != 0 && data->fifo_count >= wtm;
+}
+
+static void emul_fifo_status_update(struct qmi8658c_emul_data *data)
+{
+	uint8_t status2 = (data->fifo_count >> 8) & 0x03;
+
+	if (emul_fifo_wtm_ia(data)) {
+		status2 |= EMUL_FIFO_STATUS2_WTM_IA;
+	}
+	if (data->fifo_ovr) {
+		status2 |= EMUL_FIFO_STATUS2_OVR;
+	}
+	if (data->fifo_count == QMI8658C_EMUL_FIFO_WORDS) {
+		status2 |= EMUL_FIFO_STATUS2_FULL;
+	}
+
+	data->regs[LSM6DSO_FIFO_STATUS1] = data->fifo_count & 0xFF;
+	data->regs[LSM6DSO_FIFO_STATUS2] = status2;
+}
+
+static void emul_fifo_pop(struct qmi8658c_emul_data *data)
+{
+	uint8_t *out = &data->regs[LSM6DSO_FIFO_DATA_OUT_TAG];
+
+	if (data->fifo_count == 0) {
+		memset(out, 0, LSM6DSO_FIFO_WORD_LEN);
+		return;
+	}
+
+	memcpy(out, data->fifo[data->fifo_head], LSM6DSO_FIFO_WORD_LEN);
+	data->fifo_head = (data->fifo_head + 1) % QMI8658C_EMUL_FIFO_WORDS;
+	data->fifo_count--;
+	data->fifo_ovr = false;
+	emul_fifo_status_update(data);
+}
+
+/* Level of the interrupt line selected by int-pin */
+static int emul_line_level(const struct emul *target)
+{
+	const struct qmi8658c_emul_cfg *cfg = target->cfg;
+	struct qmi8658c_emul_data *data = target->data;
+	uint8_t status = data->regs[LSM6DSO_STATUS_REG];
+	uint8_t ctrl, md;
+	bool active = false;
+
+	if (cfg->int_pin == 1) {
+		ctrl = data->regs[LSM6DSO_INT1_CTRL];
+		md = data->regs[LSM6DSO_MD1_CFG];
+	} else {
+		ctrl = data->regs[LSM6DSO_INT2_CTRL];
+		md = data->regs[LSM6DSO_MD2_CFG];
+		active |= (ctrl & EMUL_INT2_DRDY_TEMP) && (status & LSM6DSO_STATUS_TDA);
+	}
+
+	active |= (ctrl & EMUL_INT_DRDY_XL) && (status & LSM6DSO_STATUS_XLDA);
+	active |= (ctrl & EMUL_INT_DRDY_G) && (status & LSM6DSO_STATUS_GDA);
+	active |= (ctrl & EMUL_INT_FIFO_TH) && emul_fifo_wtm_ia(data);
+	active |= (md & EMUL_MD_WU) &&
+		  (data->regs[LSM6DSO_WAKE_UP_SRC] & EMUL_WAKE_UP_SRC_WU_IA);
+
+	return active ? 1 : 0;
+}
+
+/* Called without the lock held, the GPIO callbacks may run the driver */
+static void emul_line_update(const struct emul *target)
+{
+	const struct qmi8658c_emul_cfg *cfg = target->cfg;
+	struct qmi8658c_emul_data *data = target->data;
+	k_spinlock_key_t key;
+	int level;
+
+	if (cfg->irq.port == NULL) {
+		return;
+	}
+
+	key = k_spin_lock(&data->lock);
+	level = emul_line_level(target);
+	if (level == data->line) {
+		k_spin_unlock(&data->lock, key);
+		return;
+	}
+	data->line = level;
+	k_spin_unlock(&data->lock, key);
+
+	gpio_emul_input_set(cfg->irq.port, cfg->irq.pin, level);
+}
+
+static uint8_t emul_reg_read(struct qmi8658c_emul_data *data, uint8_t reg)
+{
+	if (reg == LSM6DSO_FUNC_CFG_ACCESS) {
+		return data->regs[reg];
+	}
+
+	if (data->regs[LSM6DSO_FUNC_CFG_ACCESS] & EMUL_BANK_MASK) {
+		return data->bank_regs[reg];
+	}
+
+	switch (reg) {
+	case LSM6DSO_TIMESTAMP0: {
+		uint32_t ts = (uint32_t)(k_ticks_to_us_floor64(k_uptime_ticks()) /
+					 (QMI8658C_TIMESTAMP_NS / 1000));
+
+		sys_put_le32(ts, &data->regs[LSM6DSO_TIMESTAMP0]);
+		break;
+	}
+	case LSM6DSO_OUT_TEMP_L:
+		data->regs[LSM6DSO_STATUS_REG] &= ~LSM6DSO_STATUS_TDA;
+		break;
+	case LSM6DSO_OUTX_L_G:
+		data->regs[LSM6DSO_STATUS_REG] &= ~LSM6DSO_STATUS_GDA;
+		break;
+	case LSM6DSO_OUTX_L_A:
+		data->regs[LSM6DSO_STATUS_REG] &= ~LSM6DSO_STATUS_XLDA;
+		break;
+	case LSM6DSO_FIFO_DATA_OUT_TAG:
+		emul_fifo_pop(data);
+		break;
+	default:
+		break;
+	}
+
+	if (reg == LSM6DSO_WAKE_UP_SRC) {
+		uint8_t val = data->regs[reg];
+
+		/* Event flags clear on read */
+		data->regs[reg] = 0;
+		return val;
+	}
+
+	return data->regs[reg];
+}
+
+static void emul_reg_write(struct qmi8658c_emul_data *data, uint8_t reg,
+			   uint8_t val)
+{
+	if (reg != LSM6DSO_FUNC_CFG_ACCESS &&
+	    (data->regs[LSM6DSO_FUNC_CFG_ACCESS] & EMUL_BANK_MASK)) {
+		data->bank_regs[reg] = val;
+		return;
+	}
+
+	switch (reg) {
+	case LSM6DSO_WHO_AM_I:
+	case LSM6DSO_STATUS_REG:
+	case LSM6DSO_FIFO_STATUS1:
+	case LSM6DSO_FIFO_STATUS2:
+		/* Read only */
+		return;
+	case LSM6DSO_CTRL3_C:
+		if (val & EMUL_CTRL3_SW_RESET) {
+			emul_reset(data);
+			return;
+		}
+		break;
+	case LSM6DSO_FIFO_CTRL4:
+		if ((val & EMUL_FIFO_MODE_MASK) == LSM6DSO_BYPASS_MODE) {
+			data->fifo_count = 0;
+			data->fifo_ovr = false;
+		}
+		break;
+	default:
+		break;
+	}
+
+	data->regs[reg] = val;
+	emul_fifo_status_update(data);
+}
+
+/* The address pointer increments, wrapping inside the FIFO output words */
+static uint8_t emul_ptr_next(uint8_t reg)
+{
+	reg++;
+	if (reg == EMUL_FIFO_DATA_END) {
+		reg = LSM6DSO_FIFO_DATA_OUT_TAG;
+	}
+
+	return reg % EMUL_REG_COUNT;
+}
+
+static int qmi8658c_emul_transfer(const struct emul *target, struct i2c_msg *msgs,
+				  int num_msgs, int addr)
+{
+	struct qmi8658c_emul_data *data = target->data;
+	bool set_ptr = true;
+	k_spinlock_key_t key;
+
+	ARG_UNUSED(addr);
+
+	key = k_spin_lock(&data->lock);
+
+	for (int i = 0; i < num_msgs; i++) {
+		struct i2c_msg *msg = &msgs[i];
+		uint32_t j = 0;
+
+		if (msg->flags & I2C_MSG_RESTART) {
+			set_ptr = true;
+		}
+
+		if (msg->flags & I2C_MSG_READ) {
+			for (; j < msg->len; j++) {
+				msg->buf[j] = emul_reg_read(data, data->ptr);
+				data->ptr = emul_ptr_next(data->ptr);
+			}
+			set_ptr = true;
+			continue;
+		}
+
+		if (set_ptr && msg->len > 0) {
+			data->ptr = msg->buf[j++] % EMUL_REG_COUNT;
+			set_ptr = false;
+		}
+
+		for (; j < msg->len; j++) {
+			emul_reg_write(data, data->ptr, msg->buf[j]);
+			data->ptr = emul_ptr_next(data->ptr);
+		}
+	}
+
+	k_spin_unlock(&data->lock, key);
+
+	emul_line_update(target);
+
+	return 0;
+}
+
+void qmi8658c_emul_sample_set(const struct emul *target, const int16_t acc[3],
+			      const int16_t gyro[3], int16_t temp)
+{
+	struct qmi8658c_emul_data *data = target->data;
+	k_spinlock_key_t key = k_spin_lock(&data->lock);
+
+	sys_put_le16(temp, &data->regs[LSM6DSO_OUT_TEMP_L]);
+	for (int i = 0; i < 3; i++) {
+		sys_put_le16(gyro[i], &data->regs[LSM6DSO_OUTX_L_G + 2 * i]);
+		sys_put_le16(acc[i], &data->regs[LSM6DSO_OUTX_L_A + 2 * i]);
+	}
+	data->regs[LSM6DSO_STATUS_REG] |= LSM6DSO_STATUS_XLDA | LSM6DSO_STATUS_GDA |
+					  LSM6DSO_STATUS_TDA;
+
+	k_spin_unlock(&data->lock, key);
+
+	emul_line_update(target);
+}
+
+void qmi8658c_emul_fifo_push(const struct emul *target, enum qmi8658c_emul_tag tag,
+			     const int16_t val[3])
+{
+	struct qmi8658c_emul_data *data = target->data;
+	k_spinlock_key_t key = k_spin_lock(&data->lock);
+	uint8_t *word;
+
+	if ((data->regs[LSM6DSO_FIFO_CTRL4] & EMUL_FIFO_MODE_MASK) ==
+	    LSM6DSO_BYPASS_MODE) {
+		k_spin_unlock(&data->lock, key);
+		return;
+	}
+
+	if (data->fifo_count == QMI8658C_EMUL_FIFO_WORDS) {
+		data->fifo_head = (data->fifo_head + 1) % QMI8658C_EMUL_FIFO_WORDS;
+		data->fifo_count--;
+		data->fifo_ovr = true;
+	}
+
+	word = data->fifo[(data->fifo_head + data->fifo_count) %
+			  QMI8658C_EMUL_FIFO_WORDS];
+	word[0] = tag << 3;
+	for (int i = 0; i < 3; i++) {
+		sys_put_le16(val[i], &word[1 + 2 * i]);
+	}
+	data->fifo_count++;
+	emul_fifo_status_update(data);
+
+	k_spin_unlock(&data->lock, key);
+
+	emul_line_update(target);
+}
+
+uint16_t qmi8658c_emul_fifo_level(const struct emul *target)
+{
+	struct qmi8658c_emul_data *data = target->data;
+
+	return data->fifo_count;
+}
+
+void qmi8658c_emul_motion(const struct emul *target)
+{
+	struct qmi8658c_emul_data *data = target->data;
+	k_spinlock_key_t key = k_spin_lock(&data->lock);
+
+	data->regs[LSM6DSO_WAKE_UP_SRC] |= EMUL_WAKE_UP_SRC_WU_IA;
+
+	k_spin_unlock(&data->lock, key);
+
+	emul_line_update(target);
+}
+
+uint8_t qmi8658c_emul_reg_get(const struct emul *target, uint8_t reg)
+{
+	struct qmi8658c_emul_data *data = target->data;
+
+	return data->regs[reg % EMUL_REG_COUNT];
+}
+
+static int qmi8658c_emul_init(const struct emul *target, const struct device *parent)
+{
+	struct qmi8658c_emul_data *data = target->data;
+
+	ARG_UNUSED(parent);
+
+	emul_reset(data);
+	data->line = 0;
+
+	return 0;
+}
+
+static const struct i2c_emul_api qmi8658c_emul_api_i2c = {
+	.transfer = qmi8658c_emul_transfer,
+};
+
+#define QMI8658C_EMUL(n)						\
+	static struct qmi8658c_emul_data qmi8658c_emul_data_##n;	\
+	static const struct qmi8658c_emul_cfg qmi8658c_emul_cfg_##n = {	\
+		.irq = GPIO_DT_SPEC_INST_GET_OR(n, irq_gpios, {0}),	\
+		.int_pin = DT_INST_PROP(n, int_pin),			\
+	};								\
+	EMUL_DT_INST_DEFINE(n, qmi8658c_emul_init, &qmi8658c_emul_data_##n, \
+			    &qmi8658c_emul_cfg_##n, &qmi8658c_emul_api_i2c, NULL)
+
+DT_INST_FOREACH_STATUS_OKAY(QMI8658C_EMUL)
@@ -14,9 +14,14 @@
 #include <zephyr/init.h>
 #include <string.h>
 #include <zephyr/sys/__assert.h>
+#include <zephyr/sys/barrier.h>
+#include <zephyr/sys/byteorder.h>
 #include <zephyr/logging/log.h>
 
-#include "lsm6dso.h"
+#include "qmi8658c.h"
+#ifdef CONFIG_QMI8658C_ASYNC
+#include "qmi8658c_decoder.h"
+#endif
 
 LOG_MODULE_REGISTER(LSM6DSO, CONFIG_SENSOR_LOG_LEVEL);
 
@@ -107,10 +112,21 @@ static int lsm6dso_accel_set_odr_raw(const struct device *dev, uint8_t odr)
 	stmdev_ctx_t *ctx = (stmdev_ctx_t *)&cfg->ctx;
 	struct lsm6dso_data *data = dev->data;
 
+#if defined(CONFIG_QMI8658C_WAKEUP)
+	/* Applied when switching back to the active profile */
+	if (data->profile == QMI8658C_POWER_PROFILE_IDLE) {
+		goto done;
+	}
+#endif
+
 	if (lsm6dso_xl_data_rate_set(ctx, odr) < 0) {
 		return -EIO;
 	}
 
+#if defined(CONFIG_QMI8658C_WAKEUP)
+done:
+#endif
+	data->accel_odr = odr;
 	data->accel_freq = lsm6dso_odr_to_freq_val(odr);
 
 	return 0;
@@ -132,11 +148,25 @@ static int lsm6dso_gyro_set_odr_raw(const struct device *dev, uint8_t odr)
 {
 	const struct lsm6dso_config *cfg = dev->config;
 	stmdev_ctx_t *ctx = (stmdev_ctx_t *)&cfg->ctx;
+	struct lsm6dso_data *data = dev->data;
+
+#if defined(CONFIG_QMI8658C_WAKEUP)
+	/* The gyro stays off until switching back to the active profile */
+	if (data->profile == QMI8658C_POWER_PROFILE_IDLE) {
+		goto done;
+	}
+#endif
 
 	if (lsm6dso_gy_data_rate_set(ctx, odr) < 0) {
 		return -EIO;
 	}
 
+#if defined(CONFIG_QMI8658C_WAKEUP)
+done:
+#endif
+	data->gyro_odr = odr;
+	data->gyro_freq = lsm6dso_odr_to_freq_val(odr);
+
 	return 0;
 }
 
@@ -175,7 +205,12 @@ static int lsm6dso_accel_range_set(const struct device *dev, int32_t range)
 	}
 
 	data->acc_gain = lsm6dso_accel_fs_val_to_gain(fs, range_double);
+	lsm6dso_q31_scale_accel(data->acc_gain, &data->acc_scale);
+#if defined(CONFIG_QMI8658C_CALIBRATION)
+	return lsm6dso_calib_fold(data);
+#else
 	return 0;
+#endif
 }
 
 static int lsm6dso_accel_config(const struct device *dev,
@@ -229,7 +264,12 @@ static int lsm6dso_gyro_range_set(const struct device *dev, int32_t range)
 	}
 
 	data->gyro_gain = (lsm6dso_gyro_fs_sens[fs] * GAIN_UNIT_G);
+	lsm6dso_q31_scale_gyro(data->gyro_gain, &data->gyro_scale);
+#if defined(CONFIG_QMI8658C_CALIBRATION)
+	return lsm6dso_calib_fold(data);
+#else
 	return 0;
+#endif
 }
 
 static int lsm6dso_gyro_config(const struct device *dev,
@@ -255,16 +295,16 @@ static int lsm6dso_attr_set(const struct device *dev,
 			    enum sensor_attribute attr,
 			    const struct sensor_value *val)
 {
-#if defined(CONFIG_LSM6DSO_SENSORHUB)
+#if defined(CONFIG_QMI8658C_SENSORHUB)
 	struct lsm6dso_data *data = dev->data;
-#endif /* CONFIG_LSM6DSO_SENSORHUB */
+#endif /* CONFIG_QMI8658C_SENSORHUB */
 
 	switch (chan) {
 	case SENSOR_CHAN_ACCEL_XYZ:
 		return lsm6dso_accel_config(dev, chan, attr, val);
 	case SENSOR_CHAN_GYRO_XYZ:
 		return lsm6dso_gyro_config(dev, chan, attr, val);
-#if defined(CONFIG_LSM6DSO_SENSORHUB)
+#if defined(CONFIG_QMI8658C_SENSORHUB)
 	case SENSOR_CHAN_MAGN_XYZ:
 	case SENSOR_CHAN_PRESS:
 	case SENSOR_CHAN_HUMIDITY:
@@ -274,7 +314,7 @@ static int lsm6dso_attr_set(const struct device *dev,
 		}
 
 		return lsm6dso_shub_config(dev, chan, attr, val);
-#endif /* CONFIG_LSM6DSO_SENSORHUB */
+#endif /* CONFIG_QMI8658C_SENSORHUB */
 	default:
 		LOG_WRN("attr_set() not supported on this channel.");
 		return -ENOTSUP;
@@ -283,17 +323,72 @@ static int lsm6dso_attr_set(const struct device *dev,
 	return 0;
 }
 
+/*
+ * The last sample is published with a sequence counter: odd while it is
+ * being written, incremented again once complete. Readers copy it and retry
+ * until they saw the same even count before and after the copy. Writers are
+ * serialised by the spinlock, which also keeps them from being preempted by
+ * a reader mid-update on a single core.
+ */
+static k_spinlock_key_t lsm6dso_sample_publish_begin(struct lsm6dso_data *data)
+{
+	k_spinlock_key_t key = k_spin_lock(&data->sample_lock);
+
+	atomic_inc(&data->sample_seq);
+
+	return key;
+}
+
+static void lsm6dso_sample_publish_end(struct lsm6dso_data *data,
+				       k_spinlock_key_t key)
+{
+	atomic_inc(&data->sample_seq);
+	k_spin_unlock(&data->sample_lock, key);
+}
+
+void lsm6dso_sample_read(struct lsm6dso_data *data,
+			 struct qmi8658c_snapshot *snap)
+{
+	atomic_val_t seq;
+
+	do {
+		seq = atomic_get(&data->sample_seq);
+		*snap = data->sample;
+		barrier_dmem_fence_full();
+	} while ((seq & 1) || seq != atomic_get(&data->sample_seq));
+}
+
+int qmi8658c_snapshot_get(const struct device *dev,
+			  struct qmi8658c_snapshot *snap)
+{
+	struct lsm6dso_data *data = dev->data;
+
+	if (atomic_get(&data->sample_seq) == 0) {
+		return -ENODATA;
+	}
+
+	lsm6dso_sample_read(data, snap);
+
+	return 0;
+}
+
 static int lsm6dso_sample_fetch_accel(const struct device *dev)
 {
 	const struct lsm6dso_config *cfg = dev->config;
 	stmdev_ctx_t *ctx = (stmdev_ctx_t *)&cfg->ctx;
 	struct lsm6dso_data *data = dev->data;
+	k_spinlock_key_t key;
+	int16_t acc[3];
 
-	if (lsm6dso_acceleration_raw_get(ctx, data->acc) < 0) {
+	if (lsm6dso_acceleration_raw_get(ctx, acc) < 0) {
 		LOG_DBG("Failed to read sample");
 		return -EIO;
 	}
 
+	key = lsm6dso_sample_publish_begin(data);
+	memcpy(data->sample.acc, acc, sizeof(acc));
+	lsm6dso_sample_publish_end(data, key);
+
 	return 0;
 }
 
@@ -302,32 +397,47 @@ static int lsm6dso_sample_fetch_gyro(const struct device *dev)
 	const struct lsm6dso_config *cfg = dev->config;
 	stmdev_ctx_t *ctx = (stmdev_ctx_t *)&cfg->ctx;
 	struct lsm6dso_data *data = dev->data;
+	k_spinlock_key_t key;
+	int16_t gyro[3];
 
-	if (lsm6dso_angular_rate_raw_get(ctx, data->gyro) < 0) {
+	if (lsm6dso_angular_rate_raw_get(ctx, gyro) < 0) {
 		LOG_DBG("Failed to read sample");
 		return -EIO;
 	}
 
+	key = lsm6dso_sample_publish_begin(data);
+	memcpy(data->sample.gyro, gyro, sizeof(gyro));
+	lsm6dso_sample_publish_end(data, key);
+
 	return 0;
 }
 
-#if defined(CONFIG_LSM6DSO_ENABLE_TEMP)
+#if defined(CONFIG_QMI8658C_ENABLE_TEMP)
 static int lsm6dso_sample_fetch_temp(const struct device *dev)
 {
 	const struct lsm6dso_config *cfg = dev->config;
 	stmdev_ctx_t *ctx = (stmdev_ctx_t *)&cfg->ctx;
 	struct lsm6dso_data *data = dev->data;
+	k_spinlock_key_t key;
+	int16_t temp;
 
-	if (lsm6dso_temperature_raw_get(ctx, &data->temp_sample) < 0) {
+	if (lsm6dso_temperature_raw_get(ctx, &temp) < 0) {
 		LOG_DBG("Failed to read sample");
 		return -EIO;
 	}
 
+	key = lsm6dso_sample_publish_begin(data);
+	data->sample.temp = temp;
+	lsm6dso_sample_publish_end(data, key);
+#if defined(CONFIG_QMI8658C_CALIBRATION)
+	lsm6dso_calib_temp_update(data, temp);
+#endif
+
 	return 0;
 }
 #endif
 
-#if defined(CONFIG_LSM6DSO_SENSORHUB)
+#if defined(CONFIG_QMI8658C_SENSORHUB)
 static int lsm6dso_sample_fetch_shub(const struct device *dev)
 {
 	if (lsm6dso_shub_fetch_external_devs(dev) < 0) {
@@ -337,36 +447,175 @@ static int lsm6dso_sample_fetch_shub(const struct device *dev)
 
 	return 0;
 }
-#endif /* CONFIG_LSM6DSO_SENSORHUB */
+#endif /* CONFIG_QMI8658C_SENSORHUB */
+
+#if defined(CONFIG_QMI8658C_BUS_STATS)
+static void lsm6dso_bus_stats_update(struct lsm6dso_data *data,
+				     uint32_t start, int ret)
+{
+	struct qmi8658c_bus_stats *stats = &data->bus_stats;
+	uint32_t ns = (uint32_t)k_cyc_to_ns_floor64(k_cycle_get_32() - start);
+
+	if (ret < 0) {
+		stats->errors++;
+		return;
+	}
+
+	stats->count++;
+	stats->last_ns = ns;
+	stats->total_ns += ns;
+	stats->min_ns = MIN(stats->min_ns, ns);
+	stats->max_ns = MAX(stats->max_ns, ns);
+}
+
+int qmi8658c_bus_stats_get(const struct device *dev,
+			   struct qmi8658c_bus_stats *stats)
+{
+	struct lsm6dso_data *data = dev->data;
+	unsigned int key = irq_lock();
+
+	*stats = data->bus_stats;
+	irq_unlock(key);
+
+	return 0;
+}
+
+void qmi8658c_bus_stats_reset(const struct device *dev)
+{
+	struct lsm6dso_data *data = dev->data;
+	unsigned int key = irq_lock();
+
+	memset(&data->bus_stats, 0, sizeof(data->bus_stats));
+	data->bus_stats.min_ns = UINT32_MAX;
+	irq_unlock(key);
+}
+#endif /* CONFIG_QMI8658C_BUS_STATS */
+
+static void lsm6dso_out_decode(struct lsm6dso_data *data, const uint8_t *out)
+{
+	struct qmi8658c_snapshot *sample = &data->sample;
+	k_spinlock_key_t key;
+	int i;
+
+	key = lsm6dso_sample_publish_begin(data);
+#if defined(CONFIG_QMI8658C_ENABLE_TEMP)
+	sample->temp = sys_get_le16(&out[LSM6DSO_OUT_BURST_TEMP_OFS]);
+#endif
+	for (i = 0; i < 3; i++) {
+		sample->gyro[i] = sys_get_le16(&out[LSM6DSO_OUT_BURST_GYRO_OFS + 2 * i]);
+		sample->acc[i] = sys_get_le16(&out[LSM6DSO_OUT_BURST_ACCEL_OFS + 2 * i]);
+	}
+#if defined(CONFIG_QMI8658C_TIMESTAMP)
+	sample->time.chip_ticks = data->ts_chip;
+	sample->time.uptime_ns = (int64_t)data->ts_chip * QMI8658C_TIMESTAMP_NS +
+				 data->ts_offset_ns;
+#endif
+	lsm6dso_sample_publish_end(data, key);
+#if defined(CONFIG_QMI8658C_CALIBRATION) && defined(CONFIG_QMI8658C_ENABLE_TEMP)
+	lsm6dso_calib_temp_update(data, sample->temp);
+#endif
+}
+
+static int lsm6dso_read_out(const struct device *dev, uint8_t reg,
+			    uint8_t *buf, size_t len)
+{
+#if defined(CONFIG_QMI8658C_TIMESTAMP)
+	return lsm6dso_timestamp_read(dev, reg, buf, len);
+#else
+	const struct lsm6dso_config *cfg = dev->config;
+	stmdev_ctx_t *ctx = (stmdev_ctx_t *)&cfg->ctx;
+
+	return lsm6dso_read_reg(ctx, reg, buf, len);
+#endif
+}
+
+/*
+ * Read temperature, gyro and accel output registers in one bus transaction
+ * instead of one transaction per sensor. Without temperature support the
+ * burst starts at the gyro registers.
+ */
+static int lsm6dso_sample_fetch_burst(const struct device *dev)
+{
+	struct lsm6dso_data *data = dev->data;
+	uint8_t buf[LSM6DSO_OUT_BURST_LEN];
+#if defined(CONFIG_QMI8658C_ENABLE_TEMP)
+	const uint8_t first = 0;
+#else
+	const uint8_t first = LSM6DSO_OUT_BURST_GYRO_OFS;
+#endif
+
+	if (lsm6dso_read_out(dev, LSM6DSO_OUT_TEMP_L + first, &buf[first],
+			     sizeof(buf) - first) < 0) {
+		LOG_DBG("Failed to read sample");
+		return -EIO;
+	}
+
+	lsm6dso_out_decode(data, buf);
+
+	return 0;
+}
+
+/*
+ * Read the status register together with all output registers, used by the
+ * interrupt path so that data-ready handlers find their sample already
+ * fetched.
+ */
+int lsm6dso_sample_fetch_status(const struct device *dev, uint8_t *status)
+{
+	struct lsm6dso_data *data = dev->data;
+	uint8_t buf[LSM6DSO_STATUS_BURST_LEN];
+
+	if (lsm6dso_read_out(dev, LSM6DSO_STATUS_REG, buf, sizeof(buf)) < 0) {
+		LOG_DBG("Failed to read status and sample");
+		return -EIO;
+	}
+
+	*status = buf[0];
+	lsm6dso_out_decode(data, &buf[LSM6DSO_STATUS_BURST_OUT_OFS]);
+
+	return 0;
+}
 
 static int lsm6dso_sample_fetch(const struct device *dev,
 				enum sensor_channel chan)
 {
-#if defined(CONFIG_LSM6DSO_SENSORHUB)
+#if defined(CONFIG_QMI8658C_SENSORHUB) || defined(CONFIG_QMI8658C_BUS_STATS) || \
+	defined(CONFIG_QMI8658C_TRIGGER)
 	struct lsm6dso_data *data = dev->data;
-#endif /* CONFIG_LSM6DSO_SENSORHUB */
+#endif
+#if defined(CONFIG_QMI8658C_BUS_STATS)
+	uint32_t start = k_cycle_get_32();
+#endif
+	bool fetched = false;
+	int ret = 0;
+
+#if defined(CONFIG_QMI8658C_TRIGGER)
+	/*
+	 * Data-ready handlers get accel, gyro and temperature read along with
+	 * the status, only the channels of that burst are skipped
+	 */
+	fetched = (data->handler_thread == k_current_get());
+#endif
 
 	switch (chan) {
 	case SENSOR_CHAN_ACCEL_XYZ:
-		lsm6dso_sample_fetch_accel(dev);
+		ret = fetched ? 0 : lsm6dso_sample_fetch_accel(dev);
 		break;
 	case SENSOR_CHAN_GYRO_XYZ:
-		lsm6dso_sample_fetch_gyro(dev);
+		ret = fetched ? 0 : lsm6dso_sample_fetch_gyro(dev);
 		break;
-#if defined(CONFIG_LSM6DSO_ENABLE_TEMP)
+#if defined(CONFIG_QMI8658C_ENABLE_TEMP)
 	case SENSOR_CHAN_DIE_TEMP:
-		lsm6dso_sample_fetch_temp(dev);
+		ret = fetched ? 0 : lsm6dso_sample_fetch_temp(dev);
 		break;
 #endif
 	case SENSOR_CHAN_ALL:
-		lsm6dso_sample_fetch_accel(dev);
-		lsm6dso_sample_fetch_gyro(dev);
-#if defined(CONFIG_LSM6DSO_ENABLE_TEMP)
-		lsm6dso_sample_fetch_temp(dev);
-#endif
-#if defined(CONFIG_LSM6DSO_SENSORHUB)
-		if (data->shub_inited) {
+		ret = fetched ? 0 : lsm6dso_sample_fetch_burst(dev);
+#if defined(CONFIG_QMI8658C_SENSORHUB)
+		if (ret == 0 && data->shub_inited) {
 			lsm6dso_sample_fetch_shub(dev);
+			/* Read on the bus, counted in the statistics */
+			fetched = false;
 		}
 #endif
 		break;
@@ -374,7 +623,13 @@ static int lsm6dso_sample_fetch(const struct device *dev,
 		return -ENOTSUP;
 	}
 
-	return 0;
+#if defined(CONFIG_QMI8658C_BUS_STATS)
+	if (!fetched) {
+		lsm6dso_bus_stats_update(data, start, ret);
+	}
+#endif
+
+	return ret;
 }
 
 static inline void lsm6dso_accel_convert(struct sensor_value *val, int raw_val,
@@ -390,24 +645,24 @@ static inline void lsm6dso_accel_convert(struct sensor_value *val, int raw_val,
 
 static inline int lsm6dso_accel_get_channel(enum sensor_channel chan,
 					    struct sensor_value *val,
-					    struct lsm6dso_data *data,
+					    const int16_t acc[3],
 					    uint32_t sensitivity)
 {
 	uint8_t i;
 
 	switch (chan) {
 	case SENSOR_CHAN_ACCEL_X:
-		lsm6dso_accel_convert(val, data->acc[0], sensitivity);
+		lsm6dso_accel_convert(val, acc[0], sensitivity);
 		break;
 	case SENSOR_CHAN_ACCEL_Y:
-		lsm6dso_accel_convert(val, data->acc[1], sensitivity);
+		lsm6dso_accel_convert(val, acc[1], sensitivity);
 		break;
 	case SENSOR_CHAN_ACCEL_Z:
-		lsm6dso_accel_convert(val, data->acc[2], sensitivity);
+		lsm6dso_accel_convert(val, acc[2], sensitivity);
 		break;
 	case SENSOR_CHAN_ACCEL_XYZ:
 		for (i = 0; i < 3; i++) {
-			lsm6dso_accel_convert(val++, data->acc[i], sensitivity);
+			lsm6dso_accel_convert(val++, acc[i], sensitivity);
 		}
 		break;
 	default:
@@ -417,11 +672,39 @@ static inline int lsm6dso_accel_get_channel(enum sensor_channel chan,
 	return 0;
 }
 
+#if defined(CONFIG_QMI8658C_CALIBRATION)
+BUILD_ASSERT(SENSOR_CHAN_ACCEL_XYZ == SENSOR_CHAN_ACCEL_X + 3 &&
+	     SENSOR_CHAN_GYRO_XYZ == SENSOR_CHAN_GYRO_X + 3);
+
+/* @p idx is the channel offset from the x channel, 3 for x/y/z */
+static void lsm6dso_micro_get_channel(int idx, struct sensor_value *val,
+				      const int64_t micro[3])
+{
+	if (idx == 3) {
+		for (int i = 0; i < 3; i++) {
+			sensor_value_from_micro(val++, micro[i]);
+		}
+	} else {
+		sensor_value_from_micro(val, micro[idx]);
+	}
+}
+#endif
+
 static int lsm6dso_accel_channel_get(enum sensor_channel chan,
 				     struct sensor_value *val,
-				     struct lsm6dso_data *data)
+				     struct lsm6dso_data *data,
+				     const struct qmi8658c_snapshot *snap)
 {
-	return lsm6dso_accel_get_channel(chan, val, data, data->acc_gain);
+#if defined(CONFIG_QMI8658C_CALIBRATION)
+	int64_t micro[3];
+
+	lsm6dso_calib_convert(data, QMI8658C_SENSOR_ACCEL, snap->acc, micro);
+	lsm6dso_micro_get_channel(chan - SENSOR_CHAN_ACCEL_X, val, micro);
+
+	return 0;
+#else
+	return lsm6dso_accel_get_channel(chan, val, snap->acc, data->acc_gain);
+#endif
 }
 
 static inline void lsm6dso_gyro_convert(struct sensor_value *val, int raw_val,
@@ -437,24 +720,24 @@ static inline void lsm6dso_gyro_convert(struct sensor_value *val, int raw_val,
 
 static inline int lsm6dso_gyro_get_channel(enum sensor_channel chan,
 					   struct sensor_value *val,
-					   struct lsm6dso_data *data,
+					   const int16_t gyro[3],
 					   uint32_t sensitivity)
 {
 	uint8_t i;
 
 	switch (chan) {
 	case SENSOR_CHAN_GYRO_X:
-		lsm6dso_gyro_convert(val, data->gyro[0], sensitivity);
+		lsm6dso_gyro_convert(val, gyro[0], sensitivity);
 		break;
 	case SENSOR_CHAN_GYRO_Y:
-		lsm6dso_gyro_convert(val, data->gyro[1], sensitivity);
+		lsm6dso_gyro_convert(val, gyro[1], sensitivity);
 		break;
 	case SENSOR_CHAN_GYRO_Z:
-		lsm6dso_gyro_convert(val, data->gyro[2], sensitivity);
+		lsm6dso_gyro_convert(val, gyro[2], sensitivity);
 		break;
 	case SENSOR_CHAN_GYRO_XYZ:
 		for (i = 0; i < 3; i++) {
-			lsm6dso_gyro_convert(val++, data->gyro[i], sensitivity);
+			lsm6dso_gyro_convert(val++, gyro[i], sensitivity);
 		}
 		break;
 	default:
@@ -466,22 +749,32 @@ static inline int lsm6dso_gyro_get_channel(enum sensor_channel chan,
 
 static int lsm6dso_gyro_channel_get(enum sensor_channel chan,
 				    struct sensor_value *val,
-				    struct lsm6dso_data *data)
+				    struct lsm6dso_data *data,
+				    const struct qmi8658c_snapshot *snap)
 {
-	return lsm6dso_gyro_get_channel(chan, val, data, data->gyro_gain);
+#if defined(CONFIG_QMI8658C_CALIBRATION)
+	int64_t micro[3];
+
+	lsm6dso_calib_convert(data, QMI8658C_SENSOR_GYRO, snap->gyro, micro);
+	lsm6dso_micro_get_channel(chan - SENSOR_CHAN_GYRO_X, val, micro);
+
+	return 0;
+#else
+	return lsm6dso_gyro_get_channel(chan, val, snap->gyro, data->gyro_gain);
+#endif
 }
 
-#if defined(CONFIG_LSM6DSO_ENABLE_TEMP)
+#if defined(CONFIG_QMI8658C_ENABLE_TEMP)
 static void lsm6dso_gyro_channel_get_temp(struct sensor_value *val,
-					  struct lsm6dso_data *data)
+					  const struct qmi8658c_snapshot *snap)
 {
-	/* val = temp_sample / 256 + 25 */
-	val->val1 = data->temp_sample / 256 + 25;
-	val->val2 = (data->temp_sample % 256) * (1000000 / 256);
+	/* val = temp / 256 + 25 */
+	val->val1 = snap->temp / 256 + 25;
+	val->val2 = (snap->temp % 256) * (1000000 / 256);
 }
 #endif
 
-#if defined(CONFIG_LSM6DSO_SENSORHUB)
+#if defined(CONFIG_QMI8658C_SENSORHUB)
 static inline void lsm6dso_magn_convert(struct sensor_value *val, int raw_val,
 					uint16_t sensitivity)
 {
@@ -611,26 +904,30 @@ static int lsm6dso_channel_get(const struct device *dev,
 			       struct sensor_value *val)
 {
 	struct lsm6dso_data *data = dev->data;
+	struct qmi8658c_snapshot snap;
+
+	/* The x/y/z values must come from the same sample */
+	lsm6dso_sample_read(data, &snap);
 
 	switch (chan) {
 	case SENSOR_CHAN_ACCEL_X:
 	case SENSOR_CHAN_ACCEL_Y:
 	case SENSOR_CHAN_ACCEL_Z:
 	case SENSOR_CHAN_ACCEL_XYZ:
-		lsm6dso_accel_channel_get(chan, val, data);
+		lsm6dso_accel_channel_get(chan, val, data, &snap);
 		break;
 	case SENSOR_CHAN_GYRO_X:
 	case SENSOR_CHAN_GYRO_Y:
 	case SENSOR_CHAN_GYRO_Z:
 	case SENSOR_CHAN_GYRO_XYZ:
-		lsm6dso_gyro_channel_get(chan, val, data);
+		lsm6dso_gyro_channel_get(chan, val, data, &snap);
 		break;
-#if defined(CONFIG_LSM6DSO_ENABLE_TEMP)
+#if defined(CONFIG_QMI8658C_ENABLE_TEMP)
 	case SENSOR_CHAN_DIE_TEMP:
-		lsm6dso_gyro_channel_get_temp(val, data);
+		lsm6dso_gyro_channel_get_temp(val, &snap);
 		break;
 #endif
-#if defined(CONFIG_LSM6DSO_SENSORHUB)
+#if defined(CONFIG_QMI8658C_SENSORHUB)
 	case SENSOR_CHAN_MAGN_X:
 	case SENSOR_CHAN_MAGN_Y:
 	case SENSOR_CHAN_MAGN_Z:
@@ -677,13 +974,92 @@ static int lsm6dso_channel_get(const struct device *dev,
 	return 0;
 }
 
+#if !defined(CONFIG_QMI8658C_CALIBRATION)
+static const struct lsm6dso_q31_scale *lsm6dso_scale_get(const struct device *dev,
+							  enum qmi8658c_sensor sensor)
+{
+	struct lsm6dso_data *data = dev->data;
+
+	switch (sensor) {
+	case QMI8658C_SENSOR_ACCEL:
+		return &data->acc_scale;
+	case QMI8658C_SENSOR_GYRO:
+		return &data->gyro_scale;
+	default:
+		return NULL;
+	}
+}
+#endif
+
+int qmi8658c_convert_q31(const struct device *dev, enum qmi8658c_sensor sensor,
+			 const int16_t (*raw)[3], q31_t (*out)[3], size_t count,
+			 int8_t *shift)
+{
+#if defined(CONFIG_QMI8658C_CALIBRATION)
+	struct lsm6dso_q31_cal cal;
+
+	if (lsm6dso_calib_q31_get(dev->data, sensor, &cal) < 0) {
+		return -EINVAL;
+	}
+
+	lsm6dso_convert_q31_cal(raw, out, count, &cal);
+	*shift = cal.shift;
+
+	return 0;
+#else
+	const struct lsm6dso_q31_scale *scale = lsm6dso_scale_get(dev, sensor);
+
+	if (scale == NULL) {
+		return -EINVAL;
+	}
+
+	lsm6dso_convert_q31(&raw[0][0], &out[0][0], count * 3, scale->mult);
+	*shift = scale->shift;
+
+	return 0;
+#endif
+}
+
+int qmi8658c_convert_q15(const struct device *dev, enum qmi8658c_sensor sensor,
+			 const int16_t (*raw)[3], q15_t (*out)[3], size_t count,
+			 int8_t *shift)
+{
+#if defined(CONFIG_QMI8658C_CALIBRATION)
+	struct lsm6dso_q31_cal cal;
+
+	if (lsm6dso_calib_q31_get(dev->data, sensor, &cal) < 0) {
+		return -EINVAL;
+	}
+
+	lsm6dso_convert_q15_cal(raw, out, count, &cal);
+	*shift = cal.shift;
+
+	return 0;
+#else
+	const struct lsm6dso_q31_scale *scale = lsm6dso_scale_get(dev, sensor);
+
+	if (scale == NULL) {
+		return -EINVAL;
+	}
+
+	lsm6dso_convert_q15(&raw[0][0], &out[0][0], count * 3, scale->mult);
+	*shift = scale->shift;
+
+	return 0;
+#endif
+}
+
 static DEVICE_API(sensor, lsm6dso_driver_api) = {
 	.attr_set = lsm6dso_attr_set,
-#if CONFIG_LSM6DSO_TRIGGER
+#if CONFIG_QMI8658C_TRIGGER
 	.trigger_set = lsm6dso_trigger_set,
 #endif
 	.sample_fetch = lsm6dso_sample_fetch,
 	.channel_get = lsm6dso_channel_get,
+#ifdef CONFIG_QMI8658C_ASYNC
+	.submit = lsm6dso_submit,
+	.get_decoder = lsm6dso_get_decoder,
+#endif
 };
 
 static int lsm6dso_init_chip(const struct device *dev)
@@ -764,10 +1140,10 @@ static int lsm6dso_init_chip(const struct device *dev)
 		return -EIO;
 	}
 	lsm6dso->acc_gain = lsm6dso_accel_fs_val_to_gain(fs, cfg->accel_range & ACCEL_RANGE_DOUBLE);
+	lsm6dso_q31_scale_accel(lsm6dso->acc_gain, &lsm6dso->acc_scale);
 
 	odr = cfg->accel_odr;
 	LOG_DBG("accel odr is %d", odr);
-	lsm6dso->accel_freq = lsm6dso_odr_to_freq_val(odr);
 	if (lsm6dso_accel_set_odr_raw(dev, odr) < 0) {
 		LOG_ERR("failed to set accelerometer odr %d", odr);
 		return -EIO;
@@ -792,20 +1168,41 @@ static int lsm6dso_init_chip(const struct device *dev)
 		return -EIO;
 	}
 	lsm6dso->gyro_gain = (lsm6dso_gyro_fs_sens[fs] * GAIN_UNIT_G);
+	lsm6dso_q31_scale_gyro(lsm6dso->gyro_gain, &lsm6dso->gyro_scale);
 
 	odr = cfg->gyro_odr;
 	LOG_DBG("gyro odr is %d", odr);
-	lsm6dso->gyro_freq = lsm6dso_odr_to_freq_val(odr);
 	if (lsm6dso_gyro_set_odr_raw(dev, odr) < 0) {
 		LOG_ERR("failed to set gyroscope odr %d", odr);
 		return -EIO;
 	}
 
+#ifdef CONFIG_QMI8658C_TIMESTAMP
+	if (lsm6dso_timestamp_init(dev) < 0) {
+		LOG_DBG("failed to enable timestamp counter");
+		return -EIO;
+	}
+#endif
+
+#ifdef CONFIG_QMI8658C_WAKEUP
+	if (lsm6dso_wakeup_init(dev) < 0) {
+		LOG_DBG("failed to set wake-up detection");
+		return -EIO;
+	}
+#endif
+
+#ifdef CONFIG_QMI8658C_FIFO
+	if (lsm6dso_fifo_init(dev) < 0) {
+		LOG_DBG("failed to set FIFO mode");
+		return -EIO;
+	}
+#else
 	/* Set FIFO bypass mode */
 	if (lsm6dso_fifo_mode_set(ctx, LSM6DSO_BYPASS_MODE) < 0) {
 		LOG_DBG("failed to set FIFO mode");
 		return -EIO;
 	}
+#endif
 
 	if (lsm6dso_block_data_update_set(ctx, 1) < 0) {
 		LOG_DBG("failed to set BDU mode");
@@ -817,20 +1214,27 @@ static int lsm6dso_init_chip(const struct device *dev)
 
 static int lsm6dso_init(const struct device *dev)
 {
-#ifdef CONFIG_LSM6DSO_TRIGGER
+#ifdef CONFIG_QMI8658C_TRIGGER
 	const struct lsm6dso_config *cfg = dev->config;
 #endif
 	struct lsm6dso_data *data = dev->data;
 
 	LOG_INF("Initialize device %s", dev->name);
 	data->dev = dev;
+#if defined(CONFIG_QMI8658C_BUS_STATS)
+	qmi8658c_bus_stats_reset(dev);
+#endif
 
 	if (lsm6dso_init_chip(dev) < 0) {
 		LOG_DBG("failed to initialize chip");
 		return -EIO;
 	}
 
-#ifdef CONFIG_LSM6DSO_TRIGGER
+#ifdef CONFIG_QMI8658C_CALIBRATION
+	lsm6dso_calib_init(dev);
+#endif
+
+#ifdef CONFIG_QMI8658C_TRIGGER
 	if (cfg->trig_enabled) {
 		if (lsm6dso_init_interrupt(dev) < 0) {
 			LOG_ERR("Failed to initialize interrupt.");
@@ -839,7 +1243,7 @@ static int lsm6dso_init(const struct device *dev)
 	}
 #endif
 
-#ifdef CONFIG_LSM6DSO_SENSORHUB
+#ifdef CONFIG_QMI8658C_SENSORHUB
 	data->shub_inited = true;
 	if (lsm6dso_shub_init(dev) < 0) {
 		LOG_INF("shub: no external chips found");
@@ -869,14 +1273,39 @@ static int lsm6dso_init(const struct device *dev)
  * Instantiation macros used when a device is on a SPI bus.
  */
 
-#ifdef CONFIG_LSM6DSO_TRIGGER
+#ifdef CONFIG_QMI8658C_TRIGGER
 #define LSM6DSO_CFG_IRQ(inst)						\
 	.trig_enabled = true,						\
 	.gpio_drdy = GPIO_DT_SPEC_INST_GET(inst, irq_gpios),		\
 	.int_pin = DT_INST_PROP(inst, int_pin)
 #else
 #define LSM6DSO_CFG_IRQ(inst)
-#endif /* CONFIG_LSM6DSO_TRIGGER */
+#endif /* CONFIG_QMI8658C_TRIGGER */
+
+#ifdef CONFIG_QMI8658C_FIFO
+#define LSM6DSO_CFG_FIFO(inst)						\
+	.fifo_wtm = DT_INST_PROP(inst, fifo_watermark),			\
+	.accel_bdr = DT_INST_PROP(inst, accel_fifo_batch_rate),		\
+	.gyro_bdr = DT_INST_PROP(inst, gyro_fifo_batch_rate),		\
+	.fifo_ts_dec = DT_INST_PROP(inst, fifo_timestamp_decimation),
+
+#define LSM6DSO_CHECK_FIFO(inst)					\
+	BUILD_ASSERT(DT_INST_PROP(inst, fifo_watermark) <=		\
+		     CONFIG_QMI8658C_FIFO_MAX_WORDS,			\
+		     "fifo-watermark exceeds CONFIG_QMI8658C_FIFO_MAX_WORDS");
+#else
+#define LSM6DSO_CFG_FIFO(inst)
+#define LSM6DSO_CHECK_FIFO(inst)
+#endif /* CONFIG_QMI8658C_FIFO */
+
+#ifdef CONFIG_QMI8658C_WAKEUP
+#define LSM6DSO_CFG_WAKEUP(inst)					\
+	.wakeup_ths = DT_INST_PROP(inst, wakeup_threshold),		\
+	.wakeup_dur = DT_INST_PROP(inst, wakeup_duration),		\
+	.idle_accel_odr = DT_INST_PROP(inst, idle_accel_odr),
+#else
+#define LSM6DSO_CFG_WAKEUP(inst)
+#endif /* CONFIG_QMI8658C_WAKEUP */
 
 #define LSM6DSO_SPI_OP  (SPI_WORD_SET(8) |				\
 			 SPI_OP_MODE_MASTER |				\
@@ -886,16 +1315,38 @@ static int lsm6dso_init(const struct device *dev)
 #define LSM6DSO_CONFIG_COMMON(inst)					\
 	.accel_pm = DT_INST_PROP(inst, accel_pm),			\
 	.accel_odr = DT_INST_PROP(inst, accel_odr),			\
-	.accel_range = DT_INST_PROP(inst, accel_range) |		\
-		(DT_INST_NODE_HAS_COMPAT(inst, st_lsm6dso32) ?	        \
-			ACCEL_RANGE_DOUBLE : 0),			\
+	.accel_range = DT_INST_PROP(inst, accel_range),			\
 	.gyro_pm = DT_INST_PROP(inst, gyro_pm),				\
 	.gyro_odr = DT_INST_PROP(inst, gyro_odr),			\
 	.gyro_range = DT_INST_PROP(inst, gyro_range),			\
 	.drdy_pulsed = DT_INST_PROP(inst, drdy_pulsed),                 \
+	LSM6DSO_CFG_FIFO(inst)						\
+	LSM6DSO_CFG_WAKEUP(inst)					\
 	COND_CODE_1(DT_INST_NODE_HAS_PROP(inst, irq_gpios),		\
 		(LSM6DSO_CFG_IRQ(inst)), ())
 
+/*
+ * RTIO contexts used by the asynchronous read path.
+ */
+
+#ifdef CONFIG_QMI8658C_ASYNC
+#define LSM6DSO_RTIO_DEFINE(inst, model)				\
+	COND_CODE_1(DT_INST_ON_BUS(inst, spi),				\
+		(SPI_DT_IODEV_DEFINE(model##_iodev_##inst,		\
+				     DT_DRV_INST(inst),			\
+				     LSM6DSO_SPI_OP, 0U);),		\
+		(I2C_DT_IODEV_DEFINE(model##_iodev_##inst,		\
+				     DT_DRV_INST(inst));))		\
+	RTIO_DEFINE(model##_rtio_##inst, 4, 4);
+
+#define LSM6DSO_CFG_RTIO(inst, model)					\
+	.iodev = &model##_iodev_##inst,					\
+	.rtio_ctx = &model##_rtio_##inst,
+#else
+#define LSM6DSO_RTIO_DEFINE(inst, model)
+#define LSM6DSO_CFG_RTIO(inst, model)
+#endif /* CONFIG_QMI8658C_ASYNC */
+
 #define LSM6DSO_CONFIG_SPI(inst, model)					\
 	{								\
 		STMEMSC_CTX_SPI(&model##_config_##inst.stmemsc_cfg),	\
@@ -904,6 +1355,8 @@ static int lsm6dso_init(const struct device *dev)
 					   LSM6DSO_SPI_OP,		\
 					   0),				\
 		},							\
+		.bus_spi = true,					\
+		LSM6DSO_CFG_RTIO(inst, model)				\
 		LSM6DSO_CONFIG_COMMON(inst)				\
 	}
 
@@ -917,6 +1370,8 @@ static int lsm6dso_init(const struct device *dev)
 		.stmemsc_cfg = {					\
 			.i2c = I2C_DT_SPEC_INST_GET(inst),		\
 		},							\
+		.bus_spi = false,					\
+		LSM6DSO_CFG_RTIO(inst, model)				\
 		LSM6DSO_CONFIG_COMMON(inst)				\
 	}
 
@@ -926,6 +1381,8 @@ static int lsm6dso_init(const struct device *dev)
  */
 
 #define LSM6DSO_DEFINE(inst, model)					\
+	LSM6DSO_CHECK_FIFO(inst)					\
+	LSM6DSO_RTIO_DEFINE(inst, model)				\
 	static struct lsm6dso_data model##_data_##inst;			\
 	static const struct lsm6dso_config model##_config_##inst =	\
 		COND_CODE_1(DT_INST_ON_BUS(inst, spi),			\
@@ -933,10 +1390,6 @@ static int lsm6dso_init(const struct device *dev)
 			(LSM6DSO_CONFIG_I2C(inst, model)));		\
 	LSM6DSO_DEVICE_INIT(inst, model)
 
-#define DT_DRV_COMPAT st_lsm6dso
+#define DT_DRV_COMPAT qst_qmi8658c
 DT_INST_FOREACH_STATUS_OKAY_VARGS(LSM6DSO_DEFINE, lsm6dso)
 #undef DT_DRV_COMPAT
-
-#define DT_DRV_COMPAT st_lsm6dso32
-DT_INST_FOREACH_STATUS_OKAY_VARGS(LSM6DSO_DEFINE, lsm6dso32)
-#undef DT_DRV_COMPAT
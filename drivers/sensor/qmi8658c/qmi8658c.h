@@ -16,16 +16,24 @@
 #include <zephyr/drivers/gpio.h>
 #include <zephyr/drivers/spi.h>
 #include <zephyr/sys/util.h>
+#include <app/drivers/sensor/qmi8658c.h>
 #include <stmemsc.h>
 #include "lsm6dso_reg.h"
+#include "qmi8658c_convert.h"
 
-#if DT_HAS_COMPAT_ON_BUS_STATUS_OKAY(st_lsm6dso, spi) || \
-	DT_HAS_COMPAT_ON_BUS_STATUS_OKAY(st_lsm6dso32, spi)
+#if DT_HAS_COMPAT_ON_BUS_STATUS_OKAY(qst_qmi8658c, spi)
 #include <zephyr/drivers/spi.h>
 #endif
 
-#if DT_HAS_COMPAT_ON_BUS_STATUS_OKAY(st_lsm6dso, i2c) || \
-	DT_HAS_COMPAT_ON_BUS_STATUS_OKAY(st_lsm6dso32, i2c)
+#ifdef CONFIG_QMI8658C_ASYNC
+#include <zephyr/rtio/rtio.h>
+#endif
+
+#ifdef CONFIG_QMI8658C_TRIGGER_EVENT_LOOP
+#include <app/lib/sensor_event.h>
+#endif
+
+#if DT_HAS_COMPAT_ON_BUS_STATUS_OKAY(qst_qmi8658c, i2c)
 #include <zephyr/drivers/i2c.h>
 #endif
 
@@ -38,18 +46,43 @@
 /* Gyro sensor sensitivity grain is 4.375 udps/LSB */
 #define GAIN_UNIT_G				(4375LL)
 
+/*
+ * OUT_TEMP_L (0x20) up to OUTZ_H_A (0x2D) are contiguous, so temperature,
+ * gyro and accel can be read in a single auto-increment burst.
+ */
+#define LSM6DSO_OUT_BURST_LEN			14
+#define LSM6DSO_OUT_BURST_TEMP_OFS		0
+#define LSM6DSO_OUT_BURST_GYRO_OFS		2
+#define LSM6DSO_OUT_BURST_ACCEL_OFS		8
+
+/*
+ * STATUS_REG (0x1E) and one reserved byte precede OUT_TEMP_L, so the
+ * interrupt path reads status and data in the same burst.
+ */
+#define LSM6DSO_STATUS_BURST_LEN		(2 + LSM6DSO_OUT_BURST_LEN)
+#define LSM6DSO_STATUS_BURST_OUT_OFS		2
+#define LSM6DSO_STATUS_XLDA			BIT(0)
+#define LSM6DSO_STATUS_GDA			BIT(1)
+#define LSM6DSO_STATUS_TDA			BIT(2)
+
+/* A FIFO word is a tag byte followed by 6 bytes of data */
+#define LSM6DSO_FIFO_WORD_LEN			7
+
 struct lsm6dso_config {
 	stmdev_ctx_t ctx;
 	union {
-#if DT_HAS_COMPAT_ON_BUS_STATUS_OKAY(st_lsm6dso, i2c) || \
-	DT_HAS_COMPAT_ON_BUS_STATUS_OKAY(st_lsm6dso32, i2c)
+#if DT_HAS_COMPAT_ON_BUS_STATUS_OKAY(qst_qmi8658c, i2c)
 		const struct i2c_dt_spec i2c;
 #endif
-#if DT_HAS_COMPAT_ON_BUS_STATUS_OKAY(st_lsm6dso, spi) || \
-	DT_HAS_COMPAT_ON_BUS_STATUS_OKAY(st_lsm6dso32, spi)
+#if DT_HAS_COMPAT_ON_BUS_STATUS_OKAY(qst_qmi8658c, spi)
 		const struct spi_dt_spec spi;
 #endif
 	} stmemsc_cfg;
+#ifdef CONFIG_QMI8658C_ASYNC
+	struct rtio_iodev *iodev;
+	struct rtio *rtio_ctx;
+#endif /* CONFIG_QMI8658C_ASYNC */
+	bool bus_spi;
 	uint8_t accel_pm;
 	uint8_t accel_odr;
 #define ACCEL_RANGE_DOUBLE	BIT(7)
@@ -59,25 +92,58 @@ struct lsm6dso_config {
 	uint8_t gyro_odr;
 	uint8_t gyro_range;
 	uint8_t drdy_pulsed;
-#ifdef CONFIG_LSM6DSO_TRIGGER
+#ifdef CONFIG_QMI8658C_TRIGGER
 	const struct gpio_dt_spec gpio_drdy;
 	uint8_t int_pin;
 	bool trig_enabled;
-#endif /* CONFIG_LSM6DSO_TRIGGER */
+#endif /* CONFIG_QMI8658C_TRIGGER */
+#ifdef CONFIG_QMI8658C_FIFO
+	uint16_t fifo_wtm;
+	uint8_t accel_bdr;
+	uint8_t gyro_bdr;
+	uint8_t fifo_ts_dec;
+#endif /* CONFIG_QMI8658C_FIFO */
+#ifdef CONFIG_QMI8658C_WAKEUP
+	uint8_t wakeup_ths;
+	uint8_t wakeup_dur;
+	uint8_t idle_accel_odr;
+#endif /* CONFIG_QMI8658C_WAKEUP */
 };
 
 #define LSM6DSO_SHUB_MAX_NUM_TARGETS			3
 
+#if defined(CONFIG_QMI8658C_CALIBRATION)
+/* Calibration of one sensor folded for the current range and temperature */
+struct lsm6dso_calib_axes {
+	/* Scale factor, Q16 */
+	int32_t scale[3];
+	/* Offset after scaling, in micro m/s^2 or micro rad/s */
+	int64_t offset_micro[3];
+	struct lsm6dso_q31_cal q31;
+};
+#endif
+
 struct lsm6dso_data {
 	const struct device *dev;
-	int16_t acc[3];
+	/* Last sample, published under sample_seq, see lsm6dso_sample_publish */
+	struct qmi8658c_snapshot sample;
+	atomic_t sample_seq;
+	struct k_spinlock sample_lock;
 	uint32_t acc_gain;
-	int16_t gyro[3];
 	uint32_t gyro_gain;
-#if defined(CONFIG_LSM6DSO_ENABLE_TEMP)
-	int16_t temp_sample;
+	struct lsm6dso_q31_scale acc_scale;
+	struct lsm6dso_q31_scale gyro_scale;
+#if defined(CONFIG_QMI8658C_CALIBRATION)
+	/* Folded calibration, readers copy it under cal_lock */
+	struct qmi8658c_calibration cal;
+	struct lsm6dso_calib_axes acc_cal;
+	struct lsm6dso_calib_axes gyro_cal;
+	struct k_spinlock cal_lock;
+	/* Raw die temperature of the last fold */
+	int16_t cal_temp;
+	bool cal_tempco;
 #endif
-#if defined(CONFIG_LSM6DSO_SENSORHUB)
+#if defined(CONFIG_QMI8658C_SENSORHUB)
 	uint8_t ext_data[LSM6DSO_SHUB_MAX_NUM_TARGETS][6];
 	uint16_t magn_gain;
 
@@ -90,14 +156,26 @@ struct lsm6dso_data {
 	bool shub_inited;
 	uint8_t num_ext_dev;
 	uint8_t shub_ext[LSM6DSO_SHUB_MAX_NUM_TARGETS];
-#endif /* CONFIG_LSM6DSO_SENSORHUB */
+#endif /* CONFIG_QMI8658C_SENSORHUB */
+
+#if defined(CONFIG_QMI8658C_BUS_STATS)
+	struct qmi8658c_bus_stats bus_stats;
+#endif
+
+#if defined(CONFIG_QMI8658C_TIMESTAMP)
+	uint64_t ts_chip;
+	int64_t ts_offset_ns;
+	bool ts_synced;
+#endif
 
 	uint16_t accel_freq;
 	uint8_t accel_fs;
+	uint8_t accel_odr;
 	uint16_t gyro_freq;
 	uint8_t gyro_fs;
+	uint8_t gyro_odr;
 
-#ifdef CONFIG_LSM6DSO_TRIGGER
+#ifdef CONFIG_QMI8658C_TRIGGER
 	struct gpio_callback gpio_cb;
 	sensor_trigger_handler_t handler_drdy_acc;
 	const struct sensor_trigger *trig_drdy_acc;
@@ -105,27 +183,67 @@ struct lsm6dso_data {
 	const struct sensor_trigger *trig_drdy_gyr;
 	sensor_trigger_handler_t handler_drdy_temp;
 	const struct sensor_trigger *trig_drdy_temp;
+	int64_t irq_ticks;
+	/* Thread dispatching data-ready handlers, NULL outside of dispatch */
+	k_tid_t handler_thread;
+
+#if defined(CONFIG_QMI8658C_WAKEUP)
+	sensor_trigger_handler_t handler_motion;
+	const struct sensor_trigger *trig_motion;
+	enum qmi8658c_power_profile profile;
+#endif /* CONFIG_QMI8658C_WAKEUP */
 
-#if defined(CONFIG_LSM6DSO_TRIGGER_OWN_THREAD)
-	K_KERNEL_STACK_MEMBER(thread_stack, CONFIG_LSM6DSO_THREAD_STACK_SIZE);
+#if defined(CONFIG_QMI8658C_FIFO)
+	qmi8658c_fifo_handler_t fifo_handler;
+	void *fifo_user_data;
+	struct qmi8658c_fifo_batch fifo_batch;
+	uint8_t fifo_buf[CONFIG_QMI8658C_FIFO_MAX_WORDS * LSM6DSO_FIFO_WORD_LEN];
+	int16_t fifo_acc[CONFIG_QMI8658C_FIFO_MAX_WORDS][3];
+	int16_t fifo_gyro[CONFIG_QMI8658C_FIFO_MAX_WORDS][3];
+#endif /* CONFIG_QMI8658C_FIFO */
+
+#if defined(CONFIG_QMI8658C_TRIGGER_OWN_THREAD)
+	K_KERNEL_STACK_MEMBER(thread_stack, CONFIG_QMI8658C_THREAD_STACK_SIZE);
 	struct k_thread thread;
 	struct k_sem gpio_sem;
-#elif defined(CONFIG_LSM6DSO_TRIGGER_GLOBAL_THREAD)
+#elif defined(CONFIG_QMI8658C_TRIGGER_GLOBAL_THREAD)
 	struct k_work work;
+#elif defined(CONFIG_QMI8658C_TRIGGER_EVENT_LOOP)
+	struct sensor_event event;
 #endif
-#endif /* CONFIG_LSM6DSO_TRIGGER */
+#endif /* CONFIG_QMI8658C_TRIGGER */
 };
 
-#if defined(CONFIG_LSM6DSO_SENSORHUB)
+#if defined(CONFIG_QMI8658C_SENSORHUB)
 int lsm6dso_shub_init(const struct device *dev);
 int lsm6dso_shub_fetch_external_devs(const struct device *dev);
 int lsm6dso_shub_get_idx(const struct device *dev, enum sensor_channel type);
 int lsm6dso_shub_config(const struct device *dev, enum sensor_channel chan,
 			enum sensor_attribute attr,
 			const struct sensor_value *val);
-#endif /* CONFIG_LSM6DSO_SENSORHUB */
+#endif /* CONFIG_QMI8658C_SENSORHUB */
+
+int lsm6dso_sample_fetch_status(const struct device *dev, uint8_t *status);
+void lsm6dso_sample_read(struct lsm6dso_data *data,
+			 struct qmi8658c_snapshot *snap);
+
+#ifdef CONFIG_QMI8658C_CALIBRATION
+void lsm6dso_calib_init(const struct device *dev);
+int lsm6dso_calib_fold(struct lsm6dso_data *data);
+void lsm6dso_calib_temp_update(struct lsm6dso_data *data, int16_t temp);
+int lsm6dso_calib_q31_get(struct lsm6dso_data *data, enum qmi8658c_sensor sensor,
+			  struct lsm6dso_q31_cal *cal);
+void lsm6dso_calib_convert(struct lsm6dso_data *data, enum qmi8658c_sensor sensor,
+			   const int16_t raw[3], int64_t micro[3]);
+#endif
+
+#ifdef CONFIG_QMI8658C_TIMESTAMP
+int lsm6dso_timestamp_init(const struct device *dev);
+int lsm6dso_timestamp_read(const struct device *dev, uint8_t reg,
+			   uint8_t *buf, size_t len);
+#endif
 
-#ifdef CONFIG_LSM6DSO_TRIGGER
+#ifdef CONFIG_QMI8658C_TRIGGER
 int lsm6dso_trigger_set(const struct device *dev,
 			const struct sensor_trigger *trig,
 			sensor_trigger_handler_t handler);
@@ -133,4 +251,15 @@ int lsm6dso_trigger_set(const struct device *dev,
 int lsm6dso_init_interrupt(const struct device *dev);
 #endif
 
+#ifdef CONFIG_QMI8658C_WAKEUP
+int lsm6dso_wakeup_init(const struct device *dev);
+int lsm6dso_wakeup_enable_int(const struct device *dev, int enable);
+void lsm6dso_wakeup_handle(const struct device *dev);
+#endif
+
+#ifdef CONFIG_QMI8658C_FIFO
+int lsm6dso_fifo_init(const struct device *dev);
+void lsm6dso_fifo_drain(const struct device *dev);
+#endif
+
 #endif /* ZEPHYR_DRIVERS_SENSOR_LSM6DSO_LSM6DSO_H_ */
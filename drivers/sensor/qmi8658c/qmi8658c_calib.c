@@ -0,0 +1,501 @@
+/* QST QMI8658C 6-axis IMU sensor driver - bias and scale calibration
+ *
+ * Copyright (c) 2025 Jared Woolston
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+
+#include "qmi8658c.h"
+
+LOG_MODULE_DECLARE(LSM6DSO, CONFIG_SENSOR_LOG_LEVEL);
+
+#define LSM6DSO_CAL_UNITY		65536
+#define LSM6DSO_CAL_G_UG		1000000LL
+
+/* Die temperature is 256 LSB/degC around 25 degC */
+#define LSM6DSO_CAL_TEMP_LSB		256
+#define LSM6DSO_CAL_TEMP_OFS_MC		25000
+
+/* Temperature change refolding the calibration, a quarter degree */
+#define LSM6DSO_CAL_TEMP_STEP		(LSM6DSO_CAL_TEMP_LSB / 4)
+
+/* Peak to peak readings above these are taken as motion */
+#define LSM6DSO_CAL_STILL_ACC_UG	50000LL
+#define LSM6DSO_CAL_STILL_GYRO_UDPS	3000000LL
+
+#define LSM6DSO_CAL_SETTINGS_ROOT	"qmi8658c"
+
+static const struct qmi8658c_calibration lsm6dso_calib_none = {
+	.acc_scale = {LSM6DSO_CAL_UNITY, LSM6DSO_CAL_UNITY, LSM6DSO_CAL_UNITY},
+	.gyro_scale = {LSM6DSO_CAL_UNITY, LSM6DSO_CAL_UNITY, LSM6DSO_CAL_UNITY},
+	.temp_ref = LSM6DSO_CAL_TEMP_OFS_MC,
+};
+
+static int32_t lsm6dso_calib_temp_mc(int64_t temp_sum, int64_t count)
+{
+	return LSM6DSO_CAL_TEMP_OFS_MC +
+	       (int32_t)(temp_sum * 1000 / (LSM6DSO_CAL_TEMP_LSB * count));
+}
+
+static bool lsm6dso_calib_scale_valid(const int32_t scale[3])
+{
+	for (int i = 0; i < 3; i++) {
+		if (scale[i] < LSM6DSO_CAL_UNITY / 2 || scale[i] > LSM6DSO_CAL_UNITY * 2) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static int lsm6dso_calib_fold_sensor(const struct lsm6dso_q31_scale *q31_scale,
+				     const int32_t bias[3], const int32_t scale[3],
+				     const int32_t tempco[3], int32_t dt_mc, bool gyro,
+				     struct lsm6dso_calib_axes *axes)
+{
+	for (int i = 0; i < 3; i++) {
+		/* ug or udps at the current temperature */
+		int64_t b = bias[i] + (int64_t)tempco[i] * dt_mc / 1000;
+		int64_t micro = gyro ? b * SENSOR_PI / 180 / 1000000LL :
+				b * SENSOR_G / 1000000LL;
+
+		axes->scale[i] = scale[i];
+		axes->offset_micro[i] = -(micro * scale[i]) / LSM6DSO_CAL_UNITY;
+	}
+
+	return lsm6dso_q31_cal_fold(q31_scale, axes->scale, axes->offset_micro,
+				    &axes->q31);
+}
+
+static int lsm6dso_calib_fold_temp(struct lsm6dso_data *data,
+				   const struct qmi8658c_calibration *cal,
+				   int16_t temp, struct lsm6dso_calib_axes *acc,
+				   struct lsm6dso_calib_axes *gyro)
+{
+	int32_t dt_mc = lsm6dso_calib_temp_mc(temp, 1) - cal->temp_ref;
+	int ret;
+
+	ret = lsm6dso_calib_fold_sensor(&data->acc_scale, cal->acc_bias,
+					cal->acc_scale, cal->acc_tempco, dt_mc,
+					false, acc);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return lsm6dso_calib_fold_sensor(&data->gyro_scale, cal->gyro_bias,
+					 cal->gyro_scale, cal->gyro_tempco, dt_mc,
+					 true, gyro);
+}
+
+/* Caller holds cal_lock */
+static void lsm6dso_calib_commit(struct lsm6dso_data *data,
+				 const struct lsm6dso_calib_axes *acc,
+				 const struct lsm6dso_calib_axes *gyro,
+				 int16_t temp)
+{
+	data->acc_cal = *acc;
+	data->gyro_cal = *gyro;
+	data->cal_temp = temp;
+}
+
+/*
+ * Fold at @p temp and commit in one cal_lock section, a concurrent
+ * calibration_set() or refold cannot be overwritten by a fold of a stale
+ * copy. The fold is a few bounded loops. When it does not fit a range just
+ * set, the committed fold is for the previous range: the uncalibrated one
+ * replaces it, the calibration is kept for a range it fits.
+ */
+static int lsm6dso_calib_refold(struct lsm6dso_data *data, int16_t temp,
+				bool rescaled)
+{
+	struct lsm6dso_calib_axes acc, gyro;
+	k_spinlock_key_t key;
+	int ret;
+
+	key = k_spin_lock(&data->cal_lock);
+	ret = lsm6dso_calib_fold_temp(data, &data->cal, temp, &acc, &gyro);
+	if (ret == 0) {
+		lsm6dso_calib_commit(data, &acc, &gyro, temp);
+	} else if (rescaled) {
+		/* Without bias the fold always fits */
+		(void)lsm6dso_calib_fold_temp(data, &lsm6dso_calib_none, temp,
+					      &acc, &gyro);
+		lsm6dso_calib_commit(data, &acc, &gyro, temp);
+	}
+	k_spin_unlock(&data->cal_lock, key);
+
+	if (ret < 0) {
+		LOG_ERR("calibration does not fit the range");
+	}
+
+	return ret;
+}
+
+int lsm6dso_calib_fold(struct lsm6dso_data *data)
+{
+	struct qmi8658c_snapshot snap;
+
+	lsm6dso_sample_read(data, &snap);
+
+	return lsm6dso_calib_refold(data, snap.temp, true);
+}
+
+void lsm6dso_calib_temp_update(struct lsm6dso_data *data, int16_t temp)
+{
+	k_spinlock_key_t key;
+	bool stale;
+
+	key = k_spin_lock(&data->cal_lock);
+	stale = data->cal_tempco &&
+		abs(temp - data->cal_temp) >= LSM6DSO_CAL_TEMP_STEP;
+	k_spin_unlock(&data->cal_lock, key);
+
+	if (stale) {
+		(void)lsm6dso_calib_refold(data, temp, false);
+	}
+}
+
+void lsm6dso_calib_init(const struct device *dev)
+{
+	struct lsm6dso_data *data = dev->data;
+
+	data->cal = lsm6dso_calib_none;
+	data->cal_tempco = false;
+
+	(void)lsm6dso_calib_fold(data);
+}
+
+int lsm6dso_calib_q31_get(struct lsm6dso_data *data, enum qmi8658c_sensor sensor,
+			  struct lsm6dso_q31_cal *cal)
+{
+	k_spinlock_key_t key;
+
+	if (sensor != QMI8658C_SENSOR_ACCEL && sensor != QMI8658C_SENSOR_GYRO) {
+		return -EINVAL;
+	}
+
+	key = k_spin_lock(&data->cal_lock);
+	*cal = (sensor == QMI8658C_SENSOR_ACCEL) ? data->acc_cal.q31 :
+						   data->gyro_cal.q31;
+	k_spin_unlock(&data->cal_lock, key);
+
+	return 0;
+}
+
+void lsm6dso_calib_convert(struct lsm6dso_data *data, enum qmi8658c_sensor sensor,
+			   const int16_t raw[3], int64_t micro[3])
+{
+	bool gyro = (sensor == QMI8658C_SENSOR_GYRO);
+	struct lsm6dso_calib_axes axes;
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&data->cal_lock);
+	axes = gyro ? data->gyro_cal : data->acc_cal;
+	k_spin_unlock(&data->cal_lock, key);
+
+	for (int i = 0; i < 3; i++) {
+		int64_t v = gyro ?
+			(int64_t)raw[i] * data->gyro_gain * SENSOR_PI / 180 / 1000000LL :
+			(int64_t)raw[i] * data->acc_gain * SENSOR_G / 1000000LL;
+
+		micro[i] = v * axes.scale[i] / LSM6DSO_CAL_UNITY + axes.offset_micro[i];
+	}
+}
+
+int qmi8658c_calibration_set(const struct device *dev,
+			     const struct qmi8658c_calibration *cal)
+{
+	struct lsm6dso_data *data = dev->data;
+	struct lsm6dso_calib_axes acc, gyro;
+	struct qmi8658c_snapshot snap;
+	k_spinlock_key_t key;
+	bool tempco = false;
+	int ret;
+
+	if (!lsm6dso_calib_scale_valid(cal->acc_scale) ||
+	    !lsm6dso_calib_scale_valid(cal->gyro_scale)) {
+		return -EINVAL;
+	}
+
+	for (int i = 0; i < 3; i++) {
+		tempco |= cal->acc_tempco[i] != 0 || cal->gyro_tempco[i] != 0;
+	}
+
+	if (tempco && !IS_ENABLED(CONFIG_QMI8658C_ENABLE_TEMP)) {
+		return -ENOTSUP;
+	}
+
+	lsm6dso_sample_read(data, &snap);
+
+	/* Folded under the lock, against the range a refold would see */
+	key = k_spin_lock(&data->cal_lock);
+	ret = lsm6dso_calib_fold_temp(data, cal, snap.temp, &acc, &gyro);
+	if (ret == 0) {
+		data->cal = *cal;
+		data->cal_tempco = tempco;
+		lsm6dso_calib_commit(data, &acc, &gyro, snap.temp);
+	}
+	k_spin_unlock(&data->cal_lock, key);
+
+	return ret;
+}
+
+void qmi8658c_calibration_get(const struct device *dev,
+			      struct qmi8658c_calibration *cal)
+{
+	struct lsm6dso_data *data = dev->data;
+	k_spinlock_key_t key = k_spin_lock(&data->cal_lock);
+
+	*cal = data->cal;
+	k_spin_unlock(&data->cal_lock, key);
+}
+
+int qmi8658c_cal_collect(const struct device *dev, uint16_t samples,
+			 struct qmi8658c_cal_point *point)
+{
+	struct lsm6dso_data *data = dev->data;
+	int64_t acc_sum[3] = {0}, gyro_sum[3] = {0}, temp_sum = 0;
+	int16_t acc_min[3], acc_max[3], gyro_min[3], gyro_max[3];
+	struct qmi8658c_snapshot snap;
+	k_timeout_t period;
+	int ret;
+
+	if (samples == 0) {
+		return -EINVAL;
+	}
+
+	/* One new sample per output data period */
+	period = K_USEC(USEC_PER_SEC / MAX(data->accel_freq, 1));
+
+	for (uint16_t n = 0; n < samples; n++) {
+		if (n > 0) {
+			k_sleep(period);
+		}
+
+		ret = sensor_sample_fetch(dev);
+		if (ret < 0) {
+			return ret;
+		}
+
+		lsm6dso_sample_read(data, &snap);
+
+		for (int i = 0; i < 3; i++) {
+			if (n == 0) {
+				acc_min[i] = acc_max[i] = snap.acc[i];
+				gyro_min[i] = gyro_max[i] = snap.gyro[i];
+			}
+			acc_min[i] = MIN(acc_min[i], snap.acc[i]);
+			acc_max[i] = MAX(acc_max[i], snap.acc[i]);
+			gyro_min[i] = MIN(gyro_min[i], snap.gyro[i]);
+			gyro_max[i] = MAX(gyro_max[i], snap.gyro[i]);
+			acc_sum[i] += snap.acc[i];
+			gyro_sum[i] += snap.gyro[i];
+		}
+		temp_sum += snap.temp;
+	}
+
+	for (int i = 0; i < 3; i++) {
+		if ((int64_t)(acc_max[i] - acc_min[i]) * data->acc_gain >
+		    LSM6DSO_CAL_STILL_ACC_UG ||
+		    (int64_t)(gyro_max[i] - gyro_min[i]) * data->gyro_gain >
+		    LSM6DSO_CAL_STILL_GYRO_UDPS) {
+			return -EAGAIN;
+		}
+
+		point->acc[i] = (int32_t)(acc_sum[i] * data->acc_gain / samples);
+		point->gyro[i] = (int32_t)(gyro_sum[i] * data->gyro_gain / samples);
+	}
+	point->temp = lsm6dso_calib_temp_mc(temp_sum, samples);
+
+	return 0;
+}
+
+/* Gravity expected along @p axis, in g: the largest reading sees 1 g */
+static int8_t lsm6dso_cal_expected(const struct qmi8658c_cal_point *point,
+				   int axis)
+{
+	int up = 0;
+
+	for (int i = 1; i < 3; i++) {
+		if (abs(point->acc[i]) > abs(point->acc[up])) {
+			up = i;
+		}
+	}
+
+	if (up != axis) {
+		return 0;
+	}
+
+	return (point->acc[axis] < 0) ? -1 : 1;
+}
+
+/*
+ * Least squares fit of reading = sens * expected + bias + tempco * dT for
+ * one axis, in two steps: the sensitivity against the expected gravity,
+ * then bias and temperature coefficient on the residuals. Gyroscope axes
+ * expect no rate, which leaves the sensitivity at 1.
+ */
+static int lsm6dso_cal_fit_axis(const struct qmi8658c_cal_point *points,
+				size_t count, bool gyro, int axis, bool tempco,
+				int32_t temp_ref, int32_t *bias, int32_t *scale,
+				int32_t *tc)
+{
+	int64_t n = count, sx = 0, sy = 0, sxx = 0, sxy = 0, den;
+	int64_t sens = LSM6DSO_CAL_G_UG, sr = 0, stt = 0, str = 0, mean_r;
+
+	for (size_t i = 0; i < count; i++) {
+		int64_t x = gyro ? 0 : lsm6dso_cal_expected(&points[i], axis);
+		int64_t y = gyro ? points[i].gyro[axis] : points[i].acc[axis];
+
+		sx += x;
+		sy += y;
+		sxx += x * x;
+		sxy += x * y;
+	}
+
+	den = n * sxx - sx * sx;
+	if (den > 0) {
+		sens = (n * sxy - sx * sy) / den;
+		if (sens < LSM6DSO_CAL_G_UG / 2 || sens > LSM6DSO_CAL_G_UG * 2) {
+			return -ERANGE;
+		}
+	}
+	*scale = (int32_t)(LSM6DSO_CAL_G_UG * LSM6DSO_CAL_UNITY / sens);
+
+	for (size_t i = 0; i < count; i++) {
+		int64_t x = gyro ? 0 : lsm6dso_cal_expected(&points[i], axis);
+		int64_t y = gyro ? points[i].gyro[axis] : points[i].acc[axis];
+
+		sr += y - sens * x;
+	}
+	mean_r = sr / n;
+
+	*bias = (int32_t)mean_r;
+	*tc = 0;
+	if (!tempco) {
+		return 0;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		int64_t x = gyro ? 0 : lsm6dso_cal_expected(&points[i], axis);
+		int64_t y = gyro ? points[i].gyro[axis] : points[i].acc[axis];
+		int64_t dt = points[i].temp - temp_ref;
+
+		stt += dt * dt;
+		str += dt * (y - sens * x - mean_r);
+	}
+
+	/* Per millidegree to per degree */
+	*tc = (int32_t)(str * 1000 / stt);
+
+	return 0;
+}
+
+int qmi8658c_cal_fit(const struct qmi8658c_cal_point *points, size_t count,
+		     bool tempco, struct qmi8658c_calibration *cal)
+{
+	int64_t temp_sum = 0;
+	bool temp_span = false;
+	int ret;
+
+	if (count == 0) {
+		return -EINVAL;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		const struct qmi8658c_cal_point *p = &points[i];
+
+		if (MAX(MAX(abs(p->acc[0]), abs(p->acc[1])), abs(p->acc[2])) <
+		    LSM6DSO_CAL_G_UG / 2) {
+			return -EINVAL;
+		}
+
+		temp_sum += p->temp;
+		temp_span |= p->temp != points[0].temp;
+	}
+
+	if (tempco && !temp_span) {
+		return -EINVAL;
+	}
+
+	cal->temp_ref = (int32_t)(temp_sum / (int64_t)count);
+
+	for (int i = 0; i < 3; i++) {
+		ret = lsm6dso_cal_fit_axis(points, count, false, i, tempco,
+					   cal->temp_ref, &cal->acc_bias[i],
+					   &cal->acc_scale[i], &cal->acc_tempco[i]);
+		if (ret < 0) {
+			return ret;
+		}
+
+		ret = lsm6dso_cal_fit_axis(points, count, true, i, tempco,
+					   cal->temp_ref, &cal->gyro_bias[i],
+					   &cal->gyro_scale[i], &cal->gyro_tempco[i]);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+#if defined(CONFIG_QMI8658C_CALIBRATION_SETTINGS)
+#include <zephyr/settings/settings.h>
+
+int qmi8658c_calibration_save(const struct device *dev)
+{
+	struct qmi8658c_calibration cal;
+	char key[SETTINGS_MAX_NAME_LEN + 1];
+
+	if (snprintk(key, sizeof(key), LSM6DSO_CAL_SETTINGS_ROOT "/%s",
+		     dev->name) >= sizeof(key)) {
+		return -ENAMETOOLONG;
+	}
+
+	qmi8658c_calibration_get(dev, &cal);
+
+	return settings_save_one(key, &cal, sizeof(cal));
+}
+
+static int lsm6dso_calib_settings_set(const char *name, size_t len,
+				      settings_read_cb read_cb, void *cb_arg)
+{
+	struct qmi8658c_calibration cal;
+	const struct device *dev;
+	const char *next;
+	ssize_t ret;
+
+	/* The key is the device name, e.g. qmi8658c/qmi8658c@6a */
+	settings_name_next(name, &next);
+	if (next != NULL) {
+		return -ENOENT;
+	}
+
+	dev = device_get_binding(name);
+	if (dev == NULL) {
+		LOG_WRN("no device for calibration %s", name);
+		return -ENOENT;
+	}
+
+	if (len != sizeof(cal)) {
+		return -EINVAL;
+	}
+
+	ret = read_cb(cb_arg, &cal, sizeof(cal));
+	if (ret < 0) {
+		return ret;
+	}
+
+	return qmi8658c_calibration_set(dev, &cal);
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(qmi8658c, LSM6DSO_CAL_SETTINGS_ROOT, NULL,
+			       lsm6dso_calib_settings_set, NULL, NULL);
+#endif /* CONFIG_QMI8658C_CALIBRATION_SETTINGS */
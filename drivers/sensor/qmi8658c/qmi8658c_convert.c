@@ -0,0 +1,251 @@
+/* QST QMI8658C 6-axis IMU sensor driver - batch fixed-point conversion
+ *
+ * Copyright (c) 2025 Jared Woolston
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/toolchain.h>
+
+#include "qmi8658c_convert.h"
+
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+/* (a * b[15:0]) >> 16 */
+static ALWAYS_INLINE int32_t lsm6dso_smulwb(int32_t a, uint32_t b)
+{
+	int32_t r;
+
+	__asm__ ("smulwb %0, %1, %2" : "=r" (r) : "r" (a), "r" (b));
+	return r;
+}
+
+/* (a * b[31:16]) >> 16 */
+static ALWAYS_INLINE int32_t lsm6dso_smulwt(int32_t a, uint32_t b)
+{
+	int32_t r;
+
+	__asm__ ("smulwt %0, %1, %2" : "=r" (r) : "r" (a), "r" (b));
+	return r;
+}
+
+/* ((a * b[15:0]) >> 16) + c */
+static ALWAYS_INLINE int32_t lsm6dso_smlawb(int32_t a, uint32_t b, int32_t c)
+{
+	int32_t r;
+
+	__asm__ ("smlawb %0, %1, %2, %3" : "=r" (r) : "r" (a), "r" (b), "r" (c));
+	return r;
+}
+
+/* ((a * b[31:16]) >> 16) + c */
+static ALWAYS_INLINE int32_t lsm6dso_smlawt(int32_t a, uint32_t b, int32_t c)
+{
+	int32_t r;
+
+	__asm__ ("smlawt %0, %1, %2, %3" : "=r" (r) : "r" (a), "r" (b), "r" (c));
+	return r;
+}
+
+/* hi[31:16] : lo[31:16] */
+static ALWAYS_INLINE uint32_t lsm6dso_pack_hi(int32_t hi, int32_t lo)
+{
+	uint32_t r;
+
+	__asm__ ("pkhtb %0, %1, %2, asr #16" : "=r" (r) : "r" (hi), "r" (lo));
+	return r;
+}
+#else
+static ALWAYS_INLINE int32_t lsm6dso_smulwb(int32_t a, uint32_t b)
+{
+	return (int32_t)(((int64_t)a * (int16_t)(b & 0xFFFF)) >> 16);
+}
+
+static ALWAYS_INLINE int32_t lsm6dso_smulwt(int32_t a, uint32_t b)
+{
+	return (int32_t)(((int64_t)a * (int16_t)(b >> 16)) >> 16);
+}
+
+static ALWAYS_INLINE int32_t lsm6dso_smlawb(int32_t a, uint32_t b, int32_t c)
+{
+	return lsm6dso_smulwb(a, b) + c;
+}
+
+static ALWAYS_INLINE int32_t lsm6dso_smlawt(int32_t a, uint32_t b, int32_t c)
+{
+	return lsm6dso_smulwt(a, b) + c;
+}
+
+static ALWAYS_INLINE uint32_t lsm6dso_pack_hi(int32_t hi, int32_t lo)
+{
+	return ((uint32_t)hi & 0xFFFF0000) | ((uint32_t)lo >> 16);
+}
+#endif /* __ARM_FEATURE_DSP */
+
+static int8_t lsm6dso_micro_to_shift(int64_t max_micro)
+{
+	int8_t shift = 0;
+
+	while ((1000000LL << shift) <= max_micro) {
+		shift++;
+	}
+
+	return shift;
+}
+
+/* @p pico is the value of one LSB in 1e-12 units */
+static void lsm6dso_q31_scale_pico(int64_t pico, struct lsm6dso_q31_scale *scale)
+{
+	/* Full scale in micro units, plus one bit of headroom */
+	scale->shift = lsm6dso_micro_to_shift(pico * 32768 / 1000000LL) + 1;
+	/* mult = pico * 2^(47 - shift) / 1e12, split to stay within 64 bits */
+	scale->mult = (int32_t)((((pico << 20) / 1000000LL) << (27 - scale->shift)) /
+				1000000LL);
+}
+
+void lsm6dso_q31_scale_accel(uint32_t gain, struct lsm6dso_q31_scale *scale)
+{
+	lsm6dso_q31_scale_pico((int64_t)gain * SENSOR_G, scale);
+}
+
+void lsm6dso_q31_scale_gyro(uint32_t gain, struct lsm6dso_q31_scale *scale)
+{
+	lsm6dso_q31_scale_pico((int64_t)gain * SENSOR_PI / 180, scale);
+}
+
+/*
+ * Both kernels load two raw values per 32-bit access and convert each
+ * halfword with SMULWB/SMULWT, without any 64-bit arithmetic.
+ */
+void lsm6dso_convert_q31(const int16_t *raw, q31_t *out, size_t n, int32_t mult)
+{
+	size_t i;
+
+	for (i = 0; i + 4 <= n; i += 4) {
+		uint32_t w0 = UNALIGNED_GET((const uint32_t *)&raw[i]);
+		uint32_t w1 = UNALIGNED_GET((const uint32_t *)&raw[i + 2]);
+
+		out[i] = lsm6dso_smulwb(mult, w0);
+		out[i + 1] = lsm6dso_smulwt(mult, w0);
+		out[i + 2] = lsm6dso_smulwb(mult, w1);
+		out[i + 3] = lsm6dso_smulwt(mult, w1);
+	}
+
+	for (; i < n; i++) {
+		out[i] = lsm6dso_smulwb(mult, (uint16_t)raw[i]);
+	}
+}
+
+void lsm6dso_convert_q15(const int16_t *raw, q15_t *out, size_t n, int32_t mult)
+{
+	size_t i;
+
+	for (i = 0; i + 2 <= n; i += 2) {
+		uint32_t w = UNALIGNED_GET((const uint32_t *)&raw[i]);
+
+		UNALIGNED_PUT(lsm6dso_pack_hi(lsm6dso_smulwt(mult, w),
+					      lsm6dso_smulwb(mult, w)),
+			      (uint32_t *)&out[i]);
+	}
+
+	if (i < n) {
+		out[i] = (q15_t)(lsm6dso_smulwb(mult, (uint16_t)raw[i]) >> 16);
+	}
+}
+
+/* Largest shift added on top of the uncalibrated one, i.e. a scale of 16 */
+#define LSM6DSO_CAL_MAX_EXTRA_SHIFT	4
+
+int lsm6dso_q31_cal_fold(const struct lsm6dso_q31_scale *scale,
+			 const int32_t gain_q16[3], const int64_t offset_micro[3],
+			 struct lsm6dso_q31_cal *cal)
+{
+	for (int8_t extra = 0; extra <= LSM6DSO_CAL_MAX_EXTRA_SHIFT; extra++) {
+		int8_t shift = scale->shift + extra;
+		bool fits = true;
+
+		for (int i = 0; i < 3 && fits; i++) {
+			int64_t mult = ((int64_t)(scale->mult >> extra) * gain_q16[i]) >> 16;
+			int64_t offset = offset_micro[i] * ((int64_t)1 << (31 - shift)) /
+					 1000000LL;
+
+			/* Full scale is mult / 2, it must fit with the offset added */
+			fits = llabs(mult) <= INT32_MAX &&
+			       llabs(mult) / 2 + llabs(offset) < INT32_MAX;
+			cal->mult[i] = (int32_t)mult;
+			cal->offset[i] = (q31_t)offset;
+		}
+
+		if (fits) {
+			cal->shift = shift;
+			return 0;
+		}
+	}
+
+	return -ERANGE;
+}
+
+/*
+ * Two samples are six halfwords, loaded as three words: (x0, y0), (z0, x1)
+ * and (y1, z1). Every halfword is converted with SMLAWB/SMLAWT.
+ */
+void lsm6dso_convert_q31_cal(const int16_t (*raw)[3], q31_t (*out)[3],
+			     size_t count, const struct lsm6dso_q31_cal *cal)
+{
+	const int32_t *m = cal->mult;
+	const q31_t *o = cal->offset;
+	size_t i;
+
+	for (i = 0; i + 2 <= count; i += 2) {
+		uint32_t w0 = UNALIGNED_GET((const uint32_t *)&raw[i][0]);
+		uint32_t w1 = UNALIGNED_GET((const uint32_t *)&raw[i][2]);
+		uint32_t w2 = UNALIGNED_GET((const uint32_t *)&raw[i + 1][1]);
+
+		out[i][0] = lsm6dso_smlawb(m[0], w0, o[0]);
+		out[i][1] = lsm6dso_smlawt(m[1], w0, o[1]);
+		out[i][2] = lsm6dso_smlawb(m[2], w1, o[2]);
+		out[i + 1][0] = lsm6dso_smlawt(m[0], w1, o[0]);
+		out[i + 1][1] = lsm6dso_smlawb(m[1], w2, o[1]);
+		out[i + 1][2] = lsm6dso_smlawt(m[2], w2, o[2]);
+	}
+
+	if (i < count) {
+		for (int j = 0; j < 3; j++) {
+			out[i][j] = lsm6dso_smlawb(m[j], (uint16_t)raw[i][j], o[j]);
+		}
+	}
+}
+
+void lsm6dso_convert_q15_cal(const int16_t (*raw)[3], q15_t (*out)[3],
+			     size_t count, const struct lsm6dso_q31_cal *cal)
+{
+	const int32_t *m = cal->mult;
+	const q31_t *o = cal->offset;
+	size_t i;
+
+	for (i = 0; i + 2 <= count; i += 2) {
+		uint32_t w0 = UNALIGNED_GET((const uint32_t *)&raw[i][0]);
+		uint32_t w1 = UNALIGNED_GET((const uint32_t *)&raw[i][2]);
+		uint32_t w2 = UNALIGNED_GET((const uint32_t *)&raw[i + 1][1]);
+
+		UNALIGNED_PUT(lsm6dso_pack_hi(lsm6dso_smlawt(m[1], w0, o[1]),
+					      lsm6dso_smlawb(m[0], w0, o[0])),
+			      (uint32_t *)&out[i][0]);
+		UNALIGNED_PUT(lsm6dso_pack_hi(lsm6dso_smlawt(m[0], w1, o[0]),
+					      lsm6dso_smlawb(m[2], w1, o[2])),
+			      (uint32_t *)&out[i][2]);
+		UNALIGNED_PUT(lsm6dso_pack_hi(lsm6dso_smlawt(m[2], w2, o[2]),
+					      lsm6dso_smlawb(m[1], w2, o[1])),
+			      (uint32_t *)&out[i + 1][1]);
+	}
+
+	if (i < count) {
+		for (int j = 0; j < 3; j++) {
+			out[i][j] = (q15_t)(lsm6dso_smlawb(m[j], (uint16_t)raw[i][j],
+							   o[j]) >> 16);
+		}
+	}
+}
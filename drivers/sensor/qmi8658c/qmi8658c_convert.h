@@ -0,0 +1,75 @@
+/* QST QMI8658C 6-axis IMU sensor driver - batch fixed-point conversion
+ *
+ * Copyright (c) 2025 Jared Woolston
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_DRIVERS_SENSOR_QMI8658C_QMI8658C_CONVERT_H_
+#define ZEPHYR_DRIVERS_SENSOR_QMI8658C_QMI8658C_CONVERT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/dsp/types.h>
+
+/*
+ * Conversion of raw samples to q31 (or q15) with a shift, i.e.
+ * value = q31 * 2^shift / 2^31. One raw LSB is worth mult / 2^16 q31 LSBs,
+ * so a sample converts with a single 32x16 multiply (SMULWB/SMULWT).
+ * The shift keeps one bit of headroom above full scale so that mult
+ * always fits in 31 bits.
+ */
+struct lsm6dso_q31_scale {
+	int32_t mult;
+	int8_t shift;
+};
+
+/*
+ * Calibrated conversion, value = (mult[axis] * raw >> 16) + offset[axis] in
+ * q31 with the given shift. The per-axis scale factor and bias are folded
+ * into mult and offset, so a sample still converts with a single
+ * multiply-accumulate (SMLAWB/SMLAWT).
+ */
+struct lsm6dso_q31_cal {
+	int32_t mult[3];
+	q31_t offset[3];
+	int8_t shift;
+};
+
+/* Scale for an accelerometer gain in ug/LSB, output in m/s^2 */
+void lsm6dso_q31_scale_accel(uint32_t gain, struct lsm6dso_q31_scale *scale);
+
+/* Scale for a gyroscope gain in udps/LSB, output in rad/s */
+void lsm6dso_q31_scale_gyro(uint32_t gain, struct lsm6dso_q31_scale *scale);
+
+/* Convert @p n raw values (3 per sample) to q31 */
+void lsm6dso_convert_q31(const int16_t *raw, q31_t *out, size_t n, int32_t mult);
+
+/* Convert @p n raw values (3 per sample) to q15, same shift as q31 */
+void lsm6dso_convert_q15(const int16_t *raw, q15_t *out, size_t n, int32_t mult);
+
+/*
+ * Fold per-axis scale factors (Q16) and offsets (micro units of the
+ * output) into @p scale. The shift grows until the calibrated full scale
+ * and the offset fit in q31, -ERANGE if they do not.
+ */
+int lsm6dso_q31_cal_fold(const struct lsm6dso_q31_scale *scale,
+			 const int32_t gain_q16[3], const int64_t offset_micro[3],
+			 struct lsm6dso_q31_cal *cal);
+
+/* Convert one raw value of @p axis with the calibration, off the batch path */
+static inline q31_t lsm6dso_q31_cal_apply(const struct lsm6dso_q31_cal *cal,
+					  int axis, int16_t raw)
+{
+	return (q31_t)(((int64_t)cal->mult[axis] * raw) >> 16) + cal->offset[axis];
+}
+
+/* Convert @p count raw x/y/z samples to calibrated q31 */
+void lsm6dso_convert_q31_cal(const int16_t (*raw)[3], q31_t (*out)[3],
+			     size_t count, const struct lsm6dso_q31_cal *cal);
+
+/* Convert @p count raw x/y/z samples to calibrated q15, same shift as q31 */
+void lsm6dso_convert_q15_cal(const int16_t (*raw)[3], q15_t (*out)[3],
+			     size_t count, const struct lsm6dso_q31_cal *cal);
+
+#endif /* ZEPHYR_DRIVERS_SENSOR_QMI8658C_QMI8658C_CONVERT_H_ */
@@ -0,0 +1,242 @@
+/* QST QMI8658C 6-axis IMU sensor driver - q31 decoder
+ *
+ * Copyright (c) 2025 Jared Woolston
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define DT_DRV_COMPAT qst_qmi8658c
+
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/drivers/sensor_data_types.h>
+#include <zephyr/sys/byteorder.h>
+
+#include "qmi8658c_decoder.h"
+
+/* Die temperature is 256 LSB/degC around 25 degC, |T| < 2^8 */
+#define LSM6DSO_TEMP_SHIFT			8
+
+#if !defined(CONFIG_QMI8658C_CALIBRATION)
+/* Smallest shift for which 2^shift exceeds a value given in micro units */
+static int8_t lsm6dso_micro_to_shift(int64_t max_micro)
+{
+	int8_t shift = 0;
+
+	while ((1000000LL << shift) <= max_micro) {
+		shift++;
+	}
+
+	return shift;
+}
+
+static inline q31_t lsm6dso_micro_to_q31(int64_t micro, int8_t shift)
+{
+	return (q31_t)((micro * ((int64_t)1 << (31 - shift))) / 1000000LL);
+}
+
+/* ug/LSB to micro m/s^2 */
+static inline int64_t lsm6dso_accel_micro(int16_t raw, uint32_t gain)
+{
+	return (int64_t)raw * gain * SENSOR_G / 1000000LL;
+}
+
+/* udps/LSB to micro rad/s */
+static inline int64_t lsm6dso_gyro_micro(int16_t raw, uint32_t gain)
+{
+	return (int64_t)raw * gain * SENSOR_PI / 1000000LL / 180LL;
+}
+#endif
+
+static int lsm6dso_decoder_get_frame_count(const uint8_t *buffer,
+					   struct sensor_chan_spec chan_spec,
+					   uint16_t *frame_count)
+{
+	const struct lsm6dso_encoded_data *edata =
+		(const struct lsm6dso_encoded_data *)buffer;
+	uint8_t mask;
+
+	if (chan_spec.chan_idx != 0) {
+		return -ENOTSUP;
+	}
+
+	switch (chan_spec.chan_type) {
+	case SENSOR_CHAN_ACCEL_XYZ:
+		mask = LSM6DSO_ENCODED_ACCEL;
+		break;
+	case SENSOR_CHAN_GYRO_XYZ:
+		mask = LSM6DSO_ENCODED_GYRO;
+		break;
+	case SENSOR_CHAN_DIE_TEMP:
+		mask = LSM6DSO_ENCODED_TEMP;
+		break;
+	default:
+		return -ENOTSUP;
+	}
+
+	if (!(edata->header.channels & mask)) {
+		return -ENODATA;
+	}
+
+	*frame_count = 1;
+	return 0;
+}
+
+static int lsm6dso_decoder_get_size_info(struct sensor_chan_spec chan_spec,
+					 size_t *base_size, size_t *frame_size)
+{
+	switch (chan_spec.chan_type) {
+	case SENSOR_CHAN_ACCEL_XYZ:
+	case SENSOR_CHAN_GYRO_XYZ:
+		*base_size = sizeof(struct sensor_three_axis_data);
+		*frame_size = sizeof(struct sensor_three_axis_sample_data);
+		return 0;
+	case SENSOR_CHAN_DIE_TEMP:
+		*base_size = sizeof(struct sensor_q31_data);
+		*frame_size = sizeof(struct sensor_q31_sample_data);
+		return 0;
+	default:
+		return -ENOTSUP;
+	}
+}
+
+#if defined(CONFIG_QMI8658C_CALIBRATION)
+/* One multiply-accumulate per axis with the calibration folded at submit */
+static void lsm6dso_decode_axes(const struct lsm6dso_encoded_data *edata,
+				bool gyro, const uint8_t *raw,
+				struct sensor_three_axis_data *out)
+{
+	const struct lsm6dso_q31_cal *cal = gyro ? &edata->header.gyro_cal :
+						   &edata->header.acc_cal;
+	q31_t *axis = &out->readings[0].x;
+
+	out->shift = cal->shift;
+	for (int i = 0; i < 3; i++) {
+		axis[i] = lsm6dso_q31_cal_apply(cal, i, sys_get_le16(&raw[2 * i]));
+	}
+}
+#else
+static void lsm6dso_decode_axes(const struct lsm6dso_encoded_data *edata,
+				bool gyro, const uint8_t *raw,
+				struct sensor_three_axis_data *out)
+{
+	int64_t (*to_micro)(int16_t raw, uint32_t gain);
+	uint32_t gain;
+	q31_t *axis = &out->readings[0].x;
+
+	gain = gyro ? edata->header.gyro_gain : edata->header.acc_gain;
+	to_micro = gyro ? lsm6dso_gyro_micro : lsm6dso_accel_micro;
+
+	out->shift = lsm6dso_micro_to_shift(to_micro(INT16_MIN, gain) * -1);
+	for (int i = 0; i < 3; i++) {
+		axis[i] = lsm6dso_micro_to_q31(to_micro(sys_get_le16(&raw[2 * i]), gain),
+					       out->shift);
+	}
+}
+#endif /* CONFIG_QMI8658C_CALIBRATION */
+
+static int lsm6dso_decode_three_axis(const struct lsm6dso_encoded_data *edata,
+				     enum sensor_channel chan,
+				     struct sensor_three_axis_data *out)
+{
+	bool gyro = (chan == SENSOR_CHAN_GYRO_XYZ);
+	uint8_t mask = gyro ? LSM6DSO_ENCODED_GYRO : LSM6DSO_ENCODED_ACCEL;
+
+	if (!(edata->header.channels & mask)) {
+		return -ENODATA;
+	}
+
+	out->header.base_timestamp_ns = edata->header.timestamp;
+	out->header.reading_count = 1;
+	out->readings[0].timestamp_delta = 0;
+
+	lsm6dso_decode_axes(edata, gyro,
+			    &edata->out[gyro ? LSM6DSO_OUT_BURST_GYRO_OFS :
+					LSM6DSO_OUT_BURST_ACCEL_OFS],
+			    out);
+
+	return 0;
+}
+
+static int lsm6dso_decode_temp(const struct lsm6dso_encoded_data *edata,
+			       struct sensor_q31_data *out)
+{
+	int16_t raw;
+
+	if (!(edata->header.channels & LSM6DSO_ENCODED_TEMP)) {
+		return -ENODATA;
+	}
+
+	raw = sys_get_le16(&edata->out[LSM6DSO_OUT_BURST_TEMP_OFS]);
+
+	out->header.base_timestamp_ns = edata->header.timestamp;
+	out->header.reading_count = 1;
+	out->shift = LSM6DSO_TEMP_SHIFT;
+	out->readings[0].timestamp_delta = 0;
+	/* T = raw / 256 + 25, scaled by 2^(31 - shift) */
+	out->readings[0].temperature = (q31_t)raw * (1 << (23 - LSM6DSO_TEMP_SHIFT)) +
+				       ((q31_t)25 << (31 - LSM6DSO_TEMP_SHIFT));
+
+	return 0;
+}
+
+static int lsm6dso_decoder_decode(const uint8_t *buffer,
+				  struct sensor_chan_spec chan_spec,
+				  uint32_t *fit, uint16_t max_count,
+				  void *data_out)
+{
+	const struct lsm6dso_encoded_data *edata =
+		(const struct lsm6dso_encoded_data *)buffer;
+	int ret;
+
+	if (*fit != 0 || max_count == 0) {
+		return 0;
+	}
+
+	if (chan_spec.chan_idx != 0) {
+		return -ENOTSUP;
+	}
+
+	switch (chan_spec.chan_type) {
+	case SENSOR_CHAN_ACCEL_XYZ:
+	case SENSOR_CHAN_GYRO_XYZ:
+		ret = lsm6dso_decode_three_axis(edata, chan_spec.chan_type, data_out);
+		break;
+	case SENSOR_CHAN_DIE_TEMP:
+		ret = lsm6dso_decode_temp(edata, data_out);
+		break;
+	default:
+		return -ENOTSUP;
+	}
+
+	if (ret < 0) {
+		return ret;
+	}
+
+	*fit = 1;
+	return 1;
+}
+
+static bool lsm6dso_decoder_has_trigger(const uint8_t *buffer,
+					enum sensor_trigger_type trigger)
+{
+	ARG_UNUSED(buffer);
+	ARG_UNUSED(trigger);
+
+	return false;
+}
+
+SENSOR_DECODER_API_DT_DEFINE() = {
+	.get_frame_count = lsm6dso_decoder_get_frame_count,
+	.get_size_info = lsm6dso_decoder_get_size_info,
+	.decode = lsm6dso_decoder_decode,
+	.has_trigger = lsm6dso_decoder_has_trigger,
+};
+
+int lsm6dso_get_decoder(const struct device *dev,
+			const struct sensor_decoder_api **decoder)
+{
+	ARG_UNUSED(dev);
+	*decoder = &SENSOR_DECODER_NAME();
+
+	return 0;
+}
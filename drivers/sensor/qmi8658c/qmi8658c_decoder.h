@@ -0,0 +1,47 @@
+/* QST QMI8658C 6-axis IMU sensor driver - raw frame format
+ *
+ * Copyright (c) 2025 Jared Woolston
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_DRIVERS_SENSOR_QMI8658C_QMI8658C_DECODER_H_
+#define ZEPHYR_DRIVERS_SENSOR_QMI8658C_QMI8658C_DECODER_H_
+
+#include <stdint.h>
+#include <zephyr/drivers/sensor.h>
+
+#include "qmi8658c.h"
+
+#define LSM6DSO_ENCODED_ACCEL			BIT(0)
+#define LSM6DSO_ENCODED_GYRO			BIT(1)
+#define LSM6DSO_ENCODED_TEMP			BIT(2)
+
+/*
+ * Raw frame produced by lsm6dso_submit(). The output registers are stored
+ * exactly as read from the bus and only converted by the decoder, using the
+ * gains that were active when the frame was read. With calibration, the
+ * folded calibration of that moment is stored instead of being looked up
+ * at decode time.
+ */
+struct lsm6dso_encoded_data {
+	struct {
+		uint64_t timestamp;
+		uint32_t acc_gain;
+		uint32_t gyro_gain;
+#if defined(CONFIG_QMI8658C_CALIBRATION)
+		struct lsm6dso_q31_cal acc_cal;
+		struct lsm6dso_q31_cal gyro_cal;
+#endif
+		uint8_t channels;
+	} header;
+	uint8_t reg;
+	uint8_t out[LSM6DSO_OUT_BURST_LEN];
+};
+
+int lsm6dso_get_decoder(const struct device *dev,
+			const struct sensor_decoder_api **decoder);
+
+void lsm6dso_submit(const struct device *dev, struct rtio_iodev_sqe *iodev_sqe);
+
+#endif /* ZEPHYR_DRIVERS_SENSOR_QMI8658C_QMI8658C_DECODER_H_ */
@@ -0,0 +1,193 @@
+/* QST QMI8658C 6-axis IMU sensor driver - hardware FIFO batching
+ *
+ * Copyright (c) 2025 Jared Woolston
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/logging/log.h>
+
+#include "qmi8658c.h"
+
+LOG_MODULE_DECLARE(LSM6DSO, CONFIG_SENSOR_LOG_LEVEL);
+
+/* FIFO_DATA_OUT_TAG[7:3] identifies the sensor of a FIFO word */
+#define LSM6DSO_FIFO_TAG_SENSOR(tag)		((tag) >> 3)
+#define LSM6DSO_FIFO_TAG_GYRO			0x01
+#define LSM6DSO_FIFO_TAG_ACCEL			0x02
+#define LSM6DSO_FIFO_TAG_TEMP			0x03
+#define LSM6DSO_FIFO_TAG_TIMESTAMP		0x04
+
+/* FIFO_STATUS1/2 hold a 10 bit fill level and the watermark flag */
+#define LSM6DSO_FIFO_LEVEL(s1, s2)		((((s2) & 0x03) << 8) | (s1))
+#define LSM6DSO_FIFO_WTM_IA			BIT(7)
+
+/* Batch data rates in Hz, the slowest rate differs between accel and gyro */
+static const uint16_t lsm6dso_xl_bdr_map[] = {0, 12, 26, 52, 104, 208, 417, 833,
+					      1667, 3333, 6667, 2};
+static const uint16_t lsm6dso_gy_bdr_map[] = {0, 12, 26, 52, 104, 208, 417, 833,
+					      1667, 3333, 6667, 6};
+
+int lsm6dso_fifo_init(const struct device *dev)
+{
+	const struct lsm6dso_config *cfg = dev->config;
+	stmdev_ctx_t *ctx = (stmdev_ctx_t *)&cfg->ctx;
+
+	if (cfg->fifo_wtm == 0) {
+		return lsm6dso_fifo_mode_set(ctx, LSM6DSO_BYPASS_MODE);
+	}
+
+	LOG_DBG("fifo wtm %d, xl bdr %d, gy bdr %d, ts dec %d", cfg->fifo_wtm,
+		cfg->accel_bdr, cfg->gyro_bdr, cfg->fifo_ts_dec);
+
+	if (lsm6dso_fifo_watermark_set(ctx, cfg->fifo_wtm) < 0 ||
+	    lsm6dso_fifo_xl_batch_set(ctx, cfg->accel_bdr) < 0 ||
+	    lsm6dso_fifo_gy_batch_set(ctx, cfg->gyro_bdr) < 0) {
+		LOG_DBG("failed to set FIFO batching");
+		return -EIO;
+	}
+
+	if (cfg->fifo_ts_dec != LSM6DSO_NO_DECIMATION) {
+		if (lsm6dso_timestamp_set(ctx, 1) < 0 ||
+		    lsm6dso_fifo_timestamp_decimation_set(ctx, cfg->fifo_ts_dec) < 0) {
+			LOG_DBG("failed to set FIFO timestamp batching");
+			return -EIO;
+		}
+	}
+
+	/* Keep the newest samples if the consumer falls behind */
+	return lsm6dso_fifo_mode_set(ctx, LSM6DSO_STREAM_MODE);
+}
+
+static int lsm6dso_fifo_enable_int(const struct device *dev, int enable)
+{
+	const struct lsm6dso_config *cfg = dev->config;
+	stmdev_ctx_t *ctx = (stmdev_ctx_t *)&cfg->ctx;
+
+	if (cfg->int_pin == 1) {
+		lsm6dso_int1_ctrl_t int1_ctrl;
+
+		lsm6dso_read_reg(ctx, LSM6DSO_INT1_CTRL,
+				 (uint8_t *)&int1_ctrl, 1);
+		int1_ctrl.int1_fifo_th = enable;
+		return lsm6dso_write_reg(ctx, LSM6DSO_INT1_CTRL,
+					 (uint8_t *)&int1_ctrl, 1);
+	} else {
+		lsm6dso_int2_ctrl_t int2_ctrl;
+
+		lsm6dso_read_reg(ctx, LSM6DSO_INT2_CTRL,
+				 (uint8_t *)&int2_ctrl, 1);
+		int2_ctrl.int2_fifo_th = enable;
+		return lsm6dso_write_reg(ctx, LSM6DSO_INT2_CTRL,
+					 (uint8_t *)&int2_ctrl, 1);
+	}
+}
+
+int qmi8658c_fifo_handler_set(const struct device *dev,
+			      qmi8658c_fifo_handler_t handler,
+			      void *user_data)
+{
+	const struct lsm6dso_config *cfg = dev->config;
+	struct lsm6dso_data *lsm6dso = dev->data;
+
+	if (!cfg->trig_enabled || cfg->fifo_wtm == 0) {
+		LOG_ERR("FIFO mode not configured");
+		return -ENOTSUP;
+	}
+
+	lsm6dso->fifo_handler = handler;
+	lsm6dso->fifo_user_data = user_data;
+
+	return lsm6dso_fifo_enable_int(dev, handler != NULL ? LSM6DSO_EN_BIT :
+							      LSM6DSO_DIS_BIT);
+}
+
+static void lsm6dso_fifo_decode(const struct device *dev, size_t words)
+{
+	const struct lsm6dso_config *cfg = dev->config;
+	struct lsm6dso_data *lsm6dso = dev->data;
+	struct qmi8658c_fifo_batch *batch = &lsm6dso->fifo_batch;
+	const uint8_t *word = lsm6dso->fifo_buf;
+	size_t i;
+	int j;
+
+	batch->acc = (const int16_t (*)[3])lsm6dso->fifo_acc;
+	batch->gyro = (const int16_t (*)[3])lsm6dso->fifo_gyro;
+	batch->irq_ticks = lsm6dso->irq_ticks;
+	batch->acc_rate = lsm6dso_xl_bdr_map[cfg->accel_bdr];
+	batch->gyro_rate = lsm6dso_gy_bdr_map[cfg->gyro_bdr];
+	batch->acc_count = 0;
+	batch->gyro_count = 0;
+	batch->chip_timestamp = 0;
+
+	for (i = 0; i < words; i++, word += LSM6DSO_FIFO_WORD_LEN) {
+		const uint8_t *val = &word[1];
+
+		switch (LSM6DSO_FIFO_TAG_SENSOR(word[0])) {
+		case LSM6DSO_FIFO_TAG_ACCEL:
+			for (j = 0; j < 3; j++) {
+				lsm6dso->fifo_acc[batch->acc_count][j] =
+					sys_get_le16(&val[2 * j]);
+			}
+			batch->acc_count++;
+			break;
+		case LSM6DSO_FIFO_TAG_GYRO:
+			for (j = 0; j < 3; j++) {
+				lsm6dso->fifo_gyro[batch->gyro_count][j] =
+					sys_get_le16(&val[2 * j]);
+			}
+			batch->gyro_count++;
+			break;
+		case LSM6DSO_FIFO_TAG_TIMESTAMP:
+			batch->chip_timestamp = sys_get_le32(val);
+			break;
+		default:
+			/* Temperature and configuration change words are not batched */
+			break;
+		}
+	}
+}
+
+/*
+ * Drain the FIFO: one transaction for the fill level, then one burst of up to
+ * CONFIG_QMI8658C_FIFO_MAX_WORDS words. FIFO_DATA_OUT_* rolls back to the tag
+ * register, so a single auto-increment read returns consecutive words.
+ */
+void lsm6dso_fifo_drain(const struct device *dev)
+{
+	const struct lsm6dso_config *cfg = dev->config;
+	stmdev_ctx_t *ctx = (stmdev_ctx_t *)&cfg->ctx;
+	struct lsm6dso_data *lsm6dso = dev->data;
+	uint8_t status[2];
+	size_t level;
+
+	while (1) {
+		if (lsm6dso_read_reg(ctx, LSM6DSO_FIFO_STATUS1, status,
+				     sizeof(status)) < 0) {
+			LOG_DBG("failed reading FIFO status");
+			return;
+		}
+
+		if (!(status[1] & LSM6DSO_FIFO_WTM_IA)) {
+			return;
+		}
+
+		level = MIN(LSM6DSO_FIFO_LEVEL(status[0], status[1]),
+			    CONFIG_QMI8658C_FIFO_MAX_WORDS);
+		if (lsm6dso_read_reg(ctx, LSM6DSO_FIFO_DATA_OUT_TAG,
+				     lsm6dso->fifo_buf,
+				     level * LSM6DSO_FIFO_WORD_LEN) < 0) {
+			LOG_DBG("failed reading FIFO");
+			return;
+		}
+
+		lsm6dso_fifo_decode(dev, level);
+		if (lsm6dso->fifo_handler != NULL) {
+			lsm6dso->fifo_handler(dev, &lsm6dso->fifo_batch,
+					      lsm6dso->fifo_user_data);
+		}
+	}
+}
@@ -0,0 +1,160 @@
+/* QST QMI8658C 6-axis IMU sensor driver - asynchronous read
+ *
+ * Copyright (c) 2025 Jared Woolston
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/rtio/rtio.h>
+#include <zephyr/logging/log.h>
+
+#include "qmi8658c.h"
+#include "qmi8658c_decoder.h"
+
+LOG_MODULE_DECLARE(LSM6DSO, CONFIG_SENSOR_LOG_LEVEL);
+
+/* SPI register reads are flagged with the MSB of the address */
+#define LSM6DSO_SPI_READ			BIT(7)
+
+static void lsm6dso_complete_cb(struct rtio *r, const struct rtio_sqe *sqe,
+				void *arg)
+{
+	struct rtio_iodev_sqe *iodev_sqe = sqe->userdata;
+	int err;
+
+	ARG_UNUSED(arg);
+
+	err = rtio_flush_completion_queue(r);
+	if (err < 0) {
+		rtio_iodev_sqe_err(iodev_sqe, err);
+		return;
+	}
+
+	rtio_iodev_sqe_ok(iodev_sqe, 0);
+}
+
+static int lsm6dso_channels_to_mask(const struct sensor_read_config *read_cfg,
+				    uint8_t *mask)
+{
+	size_t i;
+
+	*mask = 0;
+	for (i = 0; i < read_cfg->count; i++) {
+		switch (read_cfg->channels[i].chan_type) {
+		case SENSOR_CHAN_ACCEL_XYZ:
+			*mask |= LSM6DSO_ENCODED_ACCEL;
+			break;
+		case SENSOR_CHAN_GYRO_XYZ:
+			*mask |= LSM6DSO_ENCODED_GYRO;
+			break;
+#if defined(CONFIG_QMI8658C_ENABLE_TEMP)
+		case SENSOR_CHAN_DIE_TEMP:
+			*mask |= LSM6DSO_ENCODED_TEMP;
+			break;
+#endif
+		case SENSOR_CHAN_ALL:
+			*mask |= LSM6DSO_ENCODED_ACCEL | LSM6DSO_ENCODED_GYRO;
+#if defined(CONFIG_QMI8658C_ENABLE_TEMP)
+			*mask |= LSM6DSO_ENCODED_TEMP;
+#endif
+			break;
+		default:
+			return -ENOTSUP;
+		}
+	}
+
+	return *mask != 0 ? 0 : -EINVAL;
+}
+
+static void lsm6dso_submit_one_shot(const struct device *dev,
+				    struct rtio_iodev_sqe *iodev_sqe)
+{
+	const struct lsm6dso_config *cfg = dev->config;
+	struct lsm6dso_data *data = dev->data;
+	const struct sensor_read_config *read_cfg = iodev_sqe->sqe.iodev->data;
+	struct lsm6dso_encoded_data *edata;
+	struct rtio_sqe *write_addr, *read_reg, *complete;
+	uint32_t buf_len;
+	uint8_t *buf;
+	uint8_t mask, first, last;
+	int ret;
+
+	ret = lsm6dso_channels_to_mask(read_cfg, &mask);
+	if (ret < 0) {
+		LOG_DBG("unsupported channel in read config");
+		rtio_iodev_sqe_err(iodev_sqe, ret);
+		return;
+	}
+
+	ret = rtio_sqe_rx_buf(iodev_sqe, sizeof(*edata), sizeof(*edata),
+			      &buf, &buf_len);
+	if (ret < 0) {
+		LOG_DBG("failed to get a read buffer of size %u",
+			(unsigned int)sizeof(*edata));
+		rtio_iodev_sqe_err(iodev_sqe, ret);
+		return;
+	}
+
+	edata = (struct lsm6dso_encoded_data *)buf;
+	edata->header.timestamp = k_ticks_to_ns_floor64(k_uptime_ticks());
+	edata->header.channels = mask;
+	edata->header.acc_gain = data->acc_gain;
+	edata->header.gyro_gain = data->gyro_gain;
+#if defined(CONFIG_QMI8658C_CALIBRATION)
+	lsm6dso_calib_q31_get(data, QMI8658C_SENSOR_ACCEL, &edata->header.acc_cal);
+	lsm6dso_calib_q31_get(data, QMI8658C_SENSOR_GYRO, &edata->header.gyro_cal);
+#endif
+
+	/*
+	 * Read the smallest register span covering the requested channels
+	 * straight into the caller's buffer, in one bus transaction.
+	 */
+	first = (mask & LSM6DSO_ENCODED_TEMP) ? LSM6DSO_OUT_BURST_TEMP_OFS :
+		(mask & LSM6DSO_ENCODED_GYRO) ? LSM6DSO_OUT_BURST_GYRO_OFS :
+		LSM6DSO_OUT_BURST_ACCEL_OFS;
+	last = (mask & LSM6DSO_ENCODED_ACCEL) ? LSM6DSO_OUT_BURST_LEN :
+	       (mask & LSM6DSO_ENCODED_GYRO) ? LSM6DSO_OUT_BURST_ACCEL_OFS :
+	       LSM6DSO_OUT_BURST_GYRO_OFS;
+	edata->reg = LSM6DSO_OUT_TEMP_L + first;
+	if (cfg->bus_spi) {
+		edata->reg |= LSM6DSO_SPI_READ;
+	}
+
+	write_addr = rtio_sqe_acquire(cfg->rtio_ctx);
+	read_reg = rtio_sqe_acquire(cfg->rtio_ctx);
+	complete = rtio_sqe_acquire(cfg->rtio_ctx);
+	if (write_addr == NULL || read_reg == NULL || complete == NULL) {
+		LOG_DBG("out of RTIO submission entries");
+		rtio_sqe_drop_all(cfg->rtio_ctx);
+		rtio_iodev_sqe_err(iodev_sqe, -ENOMEM);
+		return;
+	}
+
+	rtio_sqe_prep_tiny_write(write_addr, cfg->iodev, RTIO_PRIO_NORM,
+				 &edata->reg, 1, NULL);
+	write_addr->flags = RTIO_SQE_TRANSACTION;
+	rtio_sqe_prep_read(read_reg, cfg->iodev, RTIO_PRIO_NORM,
+			   &edata->out[first], last - first, NULL);
+	read_reg->flags = RTIO_SQE_CHAINED;
+	if (!cfg->bus_spi) {
+		read_reg->iodev_flags = RTIO_IODEV_I2C_STOP | RTIO_IODEV_I2C_RESTART;
+	}
+	rtio_sqe_prep_callback_no_cqe(complete, lsm6dso_complete_cb, NULL,
+				      iodev_sqe);
+
+	rtio_submit(cfg->rtio_ctx, 0);
+}
+
+void lsm6dso_submit(const struct device *dev, struct rtio_iodev_sqe *iodev_sqe)
+{
+	const struct sensor_read_config *read_cfg = iodev_sqe->sqe.iodev->data;
+
+	if (read_cfg->is_streaming) {
+		rtio_iodev_sqe_err(iodev_sqe, -ENOTSUP);
+		return;
+	}
+
+	lsm6dso_submit_one_shot(dev, iodev_sqe);
+}
@@ -0,0 +1,120 @@
+/* QST QMI8658C 6-axis IMU sensor driver - hardware sample timestamps
+ *
+ * Copyright (c) 2025 Jared Woolston
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/logging/log.h>
+
+#include "qmi8658c.h"
+
+LOG_MODULE_DECLARE(LSM6DSO, CONFIG_SENSOR_LOG_LEVEL);
+
+/*
+ * Weight, as a power of two, of a larger offset sample. Read latency only
+ * ever makes the offset look larger, so smaller samples are taken as is and
+ * larger ones only follow slow drift between the two clocks.
+ */
+#define LSM6DSO_TS_DRIFT_SHIFT			8
+
+int lsm6dso_timestamp_init(const struct device *dev)
+{
+	const struct lsm6dso_config *cfg = dev->config;
+	stmdev_ctx_t *ctx = (stmdev_ctx_t *)&cfg->ctx;
+	struct lsm6dso_data *data = dev->data;
+
+	data->ts_chip = 0;
+	data->ts_offset_ns = 0;
+	data->ts_synced = false;
+
+	return lsm6dso_timestamp_set(ctx, 1);
+}
+
+static void lsm6dso_timestamp_align(struct lsm6dso_data *data, uint32_t raw,
+				    int64_t uptime_ns)
+{
+	int64_t chip_ns, offset;
+
+	/* Extend the 32 bit counter, it wraps after about 30 hours */
+	data->ts_chip += (uint32_t)(raw - (uint32_t)data->ts_chip);
+	chip_ns = (int64_t)data->ts_chip * QMI8658C_TIMESTAMP_NS;
+	offset = uptime_ns - chip_ns;
+
+	if (!data->ts_synced || offset < data->ts_offset_ns) {
+		data->ts_offset_ns = offset;
+		data->ts_synced = true;
+	} else {
+		data->ts_offset_ns += (offset - data->ts_offset_ns) >>
+				      LSM6DSO_TS_DRIFT_SHIFT;
+	}
+}
+
+/*
+ * Read @p len output registers from @p reg followed by the timestamp
+ * counter. On I2C both reads share one transfer, separated by a repeated
+ * start, so the timestamp is latched right after the data. SPI needs a chip
+ * select toggle to change address, so it takes two transfers.
+ */
+int lsm6dso_timestamp_read(const struct device *dev, uint8_t reg,
+			   uint8_t *buf, size_t len)
+{
+	const struct lsm6dso_config *cfg = dev->config;
+	struct lsm6dso_data *data = dev->data;
+	uint8_t ts[4];
+	int ret;
+
+#if DT_HAS_COMPAT_ON_BUS_STATUS_OKAY(qst_qmi8658c, i2c)
+	if (!cfg->bus_spi) {
+		uint8_t ts_reg = LSM6DSO_TIMESTAMP0;
+		struct i2c_msg msgs[4] = {
+			{ .buf = &reg, .len = 1, .flags = I2C_MSG_WRITE },
+			{ .buf = buf, .len = len,
+			  .flags = I2C_MSG_RESTART | I2C_MSG_READ },
+			{ .buf = &ts_reg, .len = 1,
+			  .flags = I2C_MSG_RESTART | I2C_MSG_WRITE },
+			{ .buf = ts, .len = sizeof(ts),
+			  .flags = I2C_MSG_RESTART | I2C_MSG_READ | I2C_MSG_STOP },
+		};
+
+		ret = i2c_transfer_dt(&cfg->stmemsc_cfg.i2c, msgs, ARRAY_SIZE(msgs));
+	} else
+#endif
+	{
+		stmdev_ctx_t *ctx = (stmdev_ctx_t *)&cfg->ctx;
+
+		ret = lsm6dso_read_reg(ctx, reg, buf, len);
+		if (ret == 0) {
+			ret = lsm6dso_read_reg(ctx, LSM6DSO_TIMESTAMP0, ts, sizeof(ts));
+		}
+	}
+
+	if (ret < 0) {
+		return ret;
+	}
+
+	lsm6dso_timestamp_align(data, sys_get_le32(ts),
+				k_ticks_to_ns_floor64(k_uptime_ticks()));
+
+	return 0;
+}
+
+int qmi8658c_sample_time_get(const struct device *dev,
+			     struct qmi8658c_sample_time *time)
+{
+	struct lsm6dso_data *data = dev->data;
+	struct qmi8658c_snapshot snap;
+
+	if (!data->ts_synced) {
+		return -ENODATA;
+	}
+
+	/* Published along with the sample, see lsm6dso_out_decode() */
+	lsm6dso_sample_read(data, &snap);
+	*time = snap.time;
+
+	return 0;
+}
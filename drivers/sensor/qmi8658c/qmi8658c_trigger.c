@@ -8,18 +8,23 @@
  * https://www.st.com/resource/en/datasheet/lsm6dso.pdf
  */
 
-#define DT_DRV_COMPAT st_lsm6dso
+#define DT_DRV_COMPAT qst_qmi8658c
 
 #include <zephyr/kernel.h>
 #include <zephyr/drivers/sensor.h>
 #include <zephyr/drivers/gpio.h>
 #include <zephyr/logging/log.h>
 
-#include "lsm6dso.h"
+#include "qmi8658c.h"
 
 LOG_MODULE_DECLARE(LSM6DSO, CONFIG_SENSOR_LOG_LEVEL);
 
-#if defined(CONFIG_LSM6DSO_ENABLE_TEMP)
+#if defined(CONFIG_QMI8658C_TRIGGER_EVENT_LOOP)
+BUILD_ASSERT(CONFIG_QMI8658C_EVENT_PRIORITY < CONFIG_SENSOR_EVENT_PRIORITIES,
+	     "QMI8658C_EVENT_PRIORITY must be below SENSOR_EVENT_PRIORITIES");
+#endif
+
+#if defined(CONFIG_QMI8658C_ENABLE_TEMP)
 /**
  * lsm6dso_enable_t_int - TEMP enable selected int pin to generate interrupt
  */
@@ -134,6 +139,19 @@ int lsm6dso_trigger_set(const struct device *dev,
 		return -ENOTSUP;
 	}
 
+#if defined(CONFIG_QMI8658C_WAKEUP)
+	if (trig->type == SENSOR_TRIG_MOTION) {
+		if (trig->chan != SENSOR_CHAN_ACCEL_XYZ) {
+			return -ENOTSUP;
+		}
+
+		lsm6dso->handler_motion = handler;
+		lsm6dso->trig_motion = trig;
+		return lsm6dso_wakeup_enable_int(dev, handler != NULL ?
+						 LSM6DSO_EN_BIT : LSM6DSO_DIS_BIT);
+	}
+#endif
+
 	if (trig->chan == SENSOR_CHAN_ACCEL_XYZ) {
 		lsm6dso->handler_drdy_acc = handler;
 		lsm6dso->trig_drdy_acc = trig;
@@ -151,7 +169,7 @@ int lsm6dso_trigger_set(const struct device *dev,
 			return lsm6dso_enable_g_int(dev, LSM6DSO_DIS_BIT);
 		}
 	}
-#if defined(CONFIG_LSM6DSO_ENABLE_TEMP)
+#if defined(CONFIG_QMI8658C_ENABLE_TEMP)
 	else if (trig->chan == SENSOR_CHAN_DIE_TEMP) {
 		lsm6dso->handler_drdy_temp = handler;
 		lsm6dso->trig_drdy_temp = trig;
@@ -168,44 +186,72 @@ int lsm6dso_trigger_set(const struct device *dev,
 
 /**
  * lsm6dso_handle_interrupt - handle the drdy event
- * read data and call handler if registered any
+ * read status and data in one burst and call handler if registered any
  */
 static void lsm6dso_handle_interrupt(const struct device *dev)
 {
 	struct lsm6dso_data *lsm6dso = dev->data;
 	const struct lsm6dso_config *cfg = dev->config;
-	stmdev_ctx_t *ctx = (stmdev_ctx_t *)&cfg->ctx;
-	lsm6dso_status_reg_t status;
+	uint8_t drdy_mask = LSM6DSO_STATUS_XLDA | LSM6DSO_STATUS_GDA;
+	uint8_t status;
+
+#if defined(CONFIG_QMI8658C_ENABLE_TEMP)
+	drdy_mask |= LSM6DSO_STATUS_TDA;
+#endif
+
+#if defined(CONFIG_QMI8658C_WAKEUP)
+	if (lsm6dso->handler_motion != NULL) {
+		lsm6dso_wakeup_handle(dev);
+	}
+#endif
+
+#if defined(CONFIG_QMI8658C_FIFO)
+	if (lsm6dso->fifo_handler != NULL) {
+		lsm6dso_fifo_drain(dev);
+	}
+#endif
+
+	/* Nobody consumes data-ready events, do not spin on the status bits */
+	if ((lsm6dso->handler_drdy_acc == NULL) &&
+	    (lsm6dso->handler_drdy_gyr == NULL) &&
+	    (lsm6dso->handler_drdy_temp == NULL)) {
+		goto done;
+	}
 
 	while (1) {
-		if (lsm6dso_status_reg_get(ctx, &status) < 0) {
+		if (lsm6dso_sample_fetch_status(dev, &status) < 0) {
 			LOG_DBG("failed reading status reg");
-			return;
+			goto done;
 		}
 
-		if ((status.xlda == 0) && (status.gda == 0)
-#if defined(CONFIG_LSM6DSO_ENABLE_TEMP)
-					&& (status.tda == 0)
-#endif
-					) {
+		if ((status & drdy_mask) == 0) {
 			break;
 		}
 
-		if ((status.xlda) && (lsm6dso->handler_drdy_acc != NULL)) {
+		/* sample_fetch() from the handlers is served from this burst */
+		lsm6dso->handler_thread = k_current_get();
+
+		if ((status & LSM6DSO_STATUS_XLDA) &&
+		    (lsm6dso->handler_drdy_acc != NULL)) {
 			lsm6dso->handler_drdy_acc(dev, lsm6dso->trig_drdy_acc);
 		}
 
-		if ((status.gda) && (lsm6dso->handler_drdy_gyr != NULL)) {
+		if ((status & LSM6DSO_STATUS_GDA) &&
+		    (lsm6dso->handler_drdy_gyr != NULL)) {
 			lsm6dso->handler_drdy_gyr(dev, lsm6dso->trig_drdy_gyr);
 		}
 
-#if defined(CONFIG_LSM6DSO_ENABLE_TEMP)
-		if ((status.tda) && (lsm6dso->handler_drdy_temp != NULL)) {
+#if defined(CONFIG_QMI8658C_ENABLE_TEMP)
+		if ((status & LSM6DSO_STATUS_TDA) &&
+		    (lsm6dso->handler_drdy_temp != NULL)) {
 			lsm6dso->handler_drdy_temp(dev, lsm6dso->trig_drdy_temp);
 		}
 #endif
+
+		lsm6dso->handler_thread = NULL;
 	}
 
+done:
 	gpio_pin_interrupt_configure_dt(&cfg->gpio_drdy,
 					GPIO_INT_EDGE_TO_ACTIVE);
 }
@@ -219,16 +265,19 @@ static void lsm6dso_gpio_callback(const struct device *dev,
 
 	ARG_UNUSED(pins);
 
+	lsm6dso->irq_ticks = k_uptime_ticks();
 	gpio_pin_interrupt_configure_dt(&cfg->gpio_drdy, GPIO_INT_DISABLE);
 
-#if defined(CONFIG_LSM6DSO_TRIGGER_OWN_THREAD)
+#if defined(CONFIG_QMI8658C_TRIGGER_OWN_THREAD)
 	k_sem_give(&lsm6dso->gpio_sem);
-#elif defined(CONFIG_LSM6DSO_TRIGGER_GLOBAL_THREAD)
+#elif defined(CONFIG_QMI8658C_TRIGGER_GLOBAL_THREAD)
 	k_work_submit(&lsm6dso->work);
-#endif /* CONFIG_LSM6DSO_TRIGGER_OWN_THREAD */
+#elif defined(CONFIG_QMI8658C_TRIGGER_EVENT_LOOP)
+	sensor_event_post(&lsm6dso->event);
+#endif /* CONFIG_QMI8658C_TRIGGER_OWN_THREAD */
 }
 
-#ifdef CONFIG_LSM6DSO_TRIGGER_OWN_THREAD
+#ifdef CONFIG_QMI8658C_TRIGGER_OWN_THREAD
 static void lsm6dso_thread(void *p1, void *p2, void *p3)
 {
 	ARG_UNUSED(p2);
@@ -241,9 +290,9 @@ static void lsm6dso_thread(void *p1, void *p2, void *p3)
 		lsm6dso_handle_interrupt(lsm6dso->dev);
 	}
 }
-#endif /* CONFIG_LSM6DSO_TRIGGER_OWN_THREAD */
+#endif /* CONFIG_QMI8658C_TRIGGER_OWN_THREAD */
 
-#ifdef CONFIG_LSM6DSO_TRIGGER_GLOBAL_THREAD
+#ifdef CONFIG_QMI8658C_TRIGGER_GLOBAL_THREAD
 static void lsm6dso_work_cb(struct k_work *work)
 {
 	struct lsm6dso_data *lsm6dso =
@@ -251,7 +300,17 @@ static void lsm6dso_work_cb(struct k_work *work)
 
 	lsm6dso_handle_interrupt(lsm6dso->dev);
 }
-#endif /* CONFIG_LSM6DSO_TRIGGER_GLOBAL_THREAD */
+#endif /* CONFIG_QMI8658C_TRIGGER_GLOBAL_THREAD */
+
+#ifdef CONFIG_QMI8658C_TRIGGER_EVENT_LOOP
+static void lsm6dso_event_cb(struct sensor_event *evt)
+{
+	struct lsm6dso_data *lsm6dso =
+		CONTAINER_OF(evt, struct lsm6dso_data, event);
+
+	lsm6dso_handle_interrupt(lsm6dso->dev);
+}
+#endif /* CONFIG_QMI8658C_TRIGGER_EVENT_LOOP */
 
 int lsm6dso_init_interrupt(const struct device *dev)
 {
@@ -266,18 +325,21 @@ int lsm6dso_init_interrupt(const struct device *dev)
 		return -EINVAL;
 	}
 
-#if defined(CONFIG_LSM6DSO_TRIGGER_OWN_THREAD)
+#if defined(CONFIG_QMI8658C_TRIGGER_OWN_THREAD)
 	k_sem_init(&lsm6dso->gpio_sem, 0, K_SEM_MAX_LIMIT);
 
 	k_thread_create(&lsm6dso->thread, lsm6dso->thread_stack,
-			CONFIG_LSM6DSO_THREAD_STACK_SIZE,
+			CONFIG_QMI8658C_THREAD_STACK_SIZE,
 			lsm6dso_thread, lsm6dso,
-			NULL, NULL, K_PRIO_COOP(CONFIG_LSM6DSO_THREAD_PRIORITY),
+			NULL, NULL, K_PRIO_COOP(CONFIG_QMI8658C_THREAD_PRIORITY),
 			0, K_NO_WAIT);
 	k_thread_name_set(&lsm6dso->thread, "lsm6dso");
-#elif defined(CONFIG_LSM6DSO_TRIGGER_GLOBAL_THREAD)
+#elif defined(CONFIG_QMI8658C_TRIGGER_GLOBAL_THREAD)
 	lsm6dso->work.handler = lsm6dso_work_cb;
-#endif /* CONFIG_LSM6DSO_TRIGGER_OWN_THREAD */
+#elif defined(CONFIG_QMI8658C_TRIGGER_EVENT_LOOP)
+	sensor_event_init(&lsm6dso->event, lsm6dso_event_cb,
+			  CONFIG_QMI8658C_EVENT_PRIORITY);
+#endif /* CONFIG_QMI8658C_TRIGGER_OWN_THREAD */
 
 	ret = gpio_pin_configure_dt(&cfg->gpio_drdy, GPIO_INPUT);
 	if (ret < 0) {
@@ -0,0 +1,181 @@
+/* QST QMI8658C 6-axis IMU sensor driver - wake-on-motion and power profiles
+ *
+ * Copyright (c) 2025 Jared Woolston
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/logging/log.h>
+
+#include "qmi8658c.h"
+
+LOG_MODULE_DECLARE(LSM6DSO, CONFIG_SENSOR_LOG_LEVEL);
+
+#define LSM6DSO_ODR_OFF				0
+
+int lsm6dso_wakeup_init(const struct device *dev)
+{
+	const struct lsm6dso_config *cfg = dev->config;
+	stmdev_ctx_t *ctx = (stmdev_ctx_t *)&cfg->ctx;
+	struct lsm6dso_data *data = dev->data;
+	lsm6dso_tap_cfg2_t tap_cfg2;
+
+	data->profile = QMI8658C_POWER_PROFILE_ACTIVE;
+
+	LOG_DBG("wakeup ths %d, dur %d", cfg->wakeup_ths, cfg->wakeup_dur);
+	if (lsm6dso_wkup_threshold_set(ctx, cfg->wakeup_ths) < 0 ||
+	    lsm6dso_wkup_dur_set(ctx, cfg->wakeup_dur) < 0) {
+		return -EIO;
+	}
+
+	/* Embedded functions, including wake-up, only drive INTx when enabled */
+	if (lsm6dso_read_reg(ctx, LSM6DSO_TAP_CFG2, (uint8_t *)&tap_cfg2, 1) < 0) {
+		return -EIO;
+	}
+	tap_cfg2.interrupts_enable = 1;
+
+	return lsm6dso_write_reg(ctx, LSM6DSO_TAP_CFG2, (uint8_t *)&tap_cfg2, 1);
+}
+
+int lsm6dso_wakeup_enable_int(const struct device *dev, int enable)
+{
+	const struct lsm6dso_config *cfg = dev->config;
+	stmdev_ctx_t *ctx = (stmdev_ctx_t *)&cfg->ctx;
+
+	if (cfg->int_pin == 1) {
+		lsm6dso_md1_cfg_t md1_cfg;
+
+		lsm6dso_read_reg(ctx, LSM6DSO_MD1_CFG, (uint8_t *)&md1_cfg, 1);
+		md1_cfg.int1_wu = enable;
+		return lsm6dso_write_reg(ctx, LSM6DSO_MD1_CFG,
+					 (uint8_t *)&md1_cfg, 1);
+	} else {
+		lsm6dso_md2_cfg_t md2_cfg;
+
+		lsm6dso_read_reg(ctx, LSM6DSO_MD2_CFG, (uint8_t *)&md2_cfg, 1);
+		md2_cfg.int2_wu = enable;
+		return lsm6dso_write_reg(ctx, LSM6DSO_MD2_CFG,
+					 (uint8_t *)&md2_cfg, 1);
+	}
+}
+
+/* Reading WAKE_UP_SRC also clears a latched wake-up event */
+void lsm6dso_wakeup_handle(const struct device *dev)
+{
+	const struct lsm6dso_config *cfg = dev->config;
+	stmdev_ctx_t *ctx = (stmdev_ctx_t *)&cfg->ctx;
+	struct lsm6dso_data *lsm6dso = dev->data;
+	lsm6dso_wake_up_src_t src;
+
+	if (lsm6dso_read_reg(ctx, LSM6DSO_WAKE_UP_SRC, (uint8_t *)&src, 1) < 0) {
+		LOG_DBG("failed reading wake-up source");
+		return;
+	}
+
+	if (src.wu_ia && lsm6dso->handler_motion != NULL) {
+		lsm6dso->handler_motion(dev, lsm6dso->trig_motion);
+	}
+}
+
+/*
+ * Idle: gyro off first, as ultra-low-power mode may only be entered with the
+ * gyro powered down, then ULP on and the idle accel rate.
+ */
+static int lsm6dso_profile_idle(const struct device *dev)
+{
+	const struct lsm6dso_config *cfg = dev->config;
+	stmdev_ctx_t *ctx = (stmdev_ctx_t *)&cfg->ctx;
+	uint8_t ctrl[LSM6DSO_CTRL6_C - LSM6DSO_CTRL1_XL + 1];
+	lsm6dso_ctrl1_xl_t *ctrl1_xl = (lsm6dso_ctrl1_xl_t *)&ctrl[0];
+	lsm6dso_ctrl2_g_t *ctrl2_g = (lsm6dso_ctrl2_g_t *)&ctrl[1];
+	lsm6dso_ctrl5_c_t *ctrl5_c = (lsm6dso_ctrl5_c_t *)&ctrl[4];
+	lsm6dso_ctrl6_c_t *ctrl6_c = (lsm6dso_ctrl6_c_t *)&ctrl[5];
+
+	if (lsm6dso_read_reg(ctx, LSM6DSO_CTRL1_XL, ctrl, sizeof(ctrl)) < 0) {
+		return -EIO;
+	}
+
+	ctrl2_g->odr_g = LSM6DSO_ODR_OFF;
+	if (lsm6dso_write_reg(ctx, LSM6DSO_CTRL2_G, (uint8_t *)ctrl2_g, 1) < 0) {
+		return -EIO;
+	}
+
+	ctrl5_c->xl_ulp_en = 1;
+	ctrl6_c->xl_hm_mode = 0;
+	if (lsm6dso_write_reg(ctx, LSM6DSO_CTRL5_C, (uint8_t *)ctrl5_c, 2) < 0) {
+		return -EIO;
+	}
+
+	ctrl1_xl->odr_xl = cfg->idle_accel_odr;
+	return lsm6dso_write_reg(ctx, LSM6DSO_CTRL1_XL, (uint8_t *)ctrl1_xl, 1);
+}
+
+/*
+ * Active: leave ULP before the gyro is powered, then restore both rates with
+ * a single write as CTRL1_XL and CTRL2_G are adjacent.
+ */
+static int lsm6dso_profile_active(const struct device *dev)
+{
+	const struct lsm6dso_config *cfg = dev->config;
+	stmdev_ctx_t *ctx = (stmdev_ctx_t *)&cfg->ctx;
+	struct lsm6dso_data *data = dev->data;
+	uint8_t ctrl[LSM6DSO_CTRL6_C - LSM6DSO_CTRL1_XL + 1];
+	lsm6dso_ctrl1_xl_t *ctrl1_xl = (lsm6dso_ctrl1_xl_t *)&ctrl[0];
+	lsm6dso_ctrl2_g_t *ctrl2_g = (lsm6dso_ctrl2_g_t *)&ctrl[1];
+	lsm6dso_ctrl5_c_t *ctrl5_c = (lsm6dso_ctrl5_c_t *)&ctrl[4];
+	lsm6dso_ctrl6_c_t *ctrl6_c = (lsm6dso_ctrl6_c_t *)&ctrl[5];
+
+	if (lsm6dso_read_reg(ctx, LSM6DSO_CTRL1_XL, ctrl, sizeof(ctrl)) < 0) {
+		return -EIO;
+	}
+
+	/* accel_pm: 0 high performance, 1 low/normal power, 2 ultra-low-power */
+	ctrl5_c->xl_ulp_en = (cfg->accel_pm == 2);
+	ctrl6_c->xl_hm_mode = (cfg->accel_pm == 1);
+	if (lsm6dso_write_reg(ctx, LSM6DSO_CTRL5_C, (uint8_t *)ctrl5_c, 2) < 0) {
+		return -EIO;
+	}
+
+	ctrl1_xl->odr_xl = data->accel_odr;
+	ctrl2_g->odr_g = data->gyro_odr;
+	return lsm6dso_write_reg(ctx, LSM6DSO_CTRL1_XL, ctrl, 2);
+}
+
+int qmi8658c_power_profile_set(const struct device *dev,
+			       enum qmi8658c_power_profile profile)
+{
+	const struct lsm6dso_config *cfg = dev->config;
+	struct lsm6dso_data *data = dev->data;
+	int ret;
+
+	if (!cfg->trig_enabled) {
+		LOG_ERR("power profiles need the interrupt line");
+		return -ENOTSUP;
+	}
+
+	if (profile == data->profile) {
+		return 0;
+	}
+
+	switch (profile) {
+	case QMI8658C_POWER_PROFILE_ACTIVE:
+		ret = lsm6dso_profile_active(dev);
+		break;
+	case QMI8658C_POWER_PROFILE_IDLE:
+		ret = lsm6dso_profile_idle(dev);
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	if (ret < 0) {
+		LOG_ERR("failed to switch power profile");
+		return ret;
+	}
+
+	data->profile = profile;
+
+	return 0;
+}
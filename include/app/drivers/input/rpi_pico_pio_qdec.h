@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2025 Jared Woolston
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef APP_DRIVERS_INPUT_RPI_PICO_PIO_QDEC_H_
+#define APP_DRIVERS_INPUT_RPI_PICO_PIO_QDEC_H_
+
+#include <stdint.h>
+
+#include <zephyr/device.h>
+
+/**
+ * @defgroup drivers_rpi_pico_pio_qdec PIO quadrature encoder driver extensions
+ * @ingroup drivers
+ * @{
+ *
+ * @brief Driver specific extensions of the PIO quadrature encoder.
+ *
+ * Besides the relative input events, the absolute count kept by the state
+ * machine can be read directly, e.g. as the feedback of a control loop.
+ */
+
+/**
+ * @brief Get the encoder count.
+ *
+ * The count is the latest value pushed by the state machine and copied by
+ * DMA, reading it does not touch the PIO. It wraps around at 32 bits, the
+ * difference of two counts is the distance travelled in between.
+ *
+ * Can be called from an interrupt handler.
+ *
+ * @param dev PIO quadrature encoder device instance.
+ * @param count Destination of the count.
+ *
+ * @retval 0 if successful.
+ */
+int rpi_pico_pio_qdec_count_get(const struct device *dev, int32_t *count);
+
+/** @} */
+
+#endif /* APP_DRIVERS_INPUT_RPI_PICO_PIO_QDEC_H_ */
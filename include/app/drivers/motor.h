@@ -6,107 +6,493 @@
 #ifndef APP_DRIVERS_MOTOR_H_
 #define APP_DRIVERS_MOTOR_H_
 
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
 #include <zephyr/device.h>
+#include <zephyr/sys/util.h>
 #include <zephyr/toolchain.h>
 
 /**
- * @defgroup drivers_blink Blink drivers
+ * @defgroup drivers_motor Motor drivers
  * @ingroup drivers
  * @{
  *
- * @brief A custom driver class to blink LEDs
+ * @brief A driver class for motor drivers with one or more channels.
+ *
+ * Every channel of a motor driver drives one motor at a speed and direction,
+ * or stops it by braking or coasting. Several channels of the same device
+ * can be commanded in one call, which the driver applies together so that
+ * coordinated moves start at the same time.
  *
- * This driver class is provided as an example of how to create custom driver
- * classes. It provides an interface to blink an LED at a configurable rate.
- * Implementations could include simple GPIO-controlled LEDs, addressable LEDs,
- * etc.
+ * Drivers may also run speed ramps in hardware: a table of speeds, one per
+ * PWM period or, for stepper motors, one per step, applied without the CPU,
+ * see motor_ramp(). The speed of a stepper motor is its step rate. Drivers
+ * with current sensing stop a channel on overcurrent or stall by
+ * themselves and keep it stopped until motor_fault_clear(), and drivers
+ * with back-EMF sensing estimate the speed without
+ * an encoder, see motor_status_get().
  */
 
+/** @brief Full speed, i.e. a duty cycle of 100 %. */
+#define MOTOR_SPEED_MAX 10000U
+
+/** @brief Largest number of channels of a motor device. */
+#define MOTOR_MAX_CHANNELS 8
+
+/** @brief Operating modes of a motor channel. */
+enum motor_mode {
+	/** Driven at the commanded speed and direction. */
+	MOTOR_MODE_DRIVE,
+	/** Terminals shorted together, the motor stops quickly. */
+	MOTOR_MODE_BRAKE,
+	/** Terminals floating, the motor spins down freely. */
+	MOTOR_MODE_COAST,
+};
+
+/** @brief Directions of a motor channel. */
+enum motor_direction {
+	/** Forward direction. */
+	MOTOR_DIR_FORWARD,
+	/** Reverse direction. */
+	MOTOR_DIR_REVERSE,
+};
+
+/** @brief Command of one motor channel. */
+struct motor_cmd {
+	/** Operating mode. */
+	enum motor_mode mode;
+	/** Direction, used by @ref MOTOR_MODE_DRIVE. */
+	enum motor_direction dir;
+	/** Speed from 0 to @ref MOTOR_SPEED_MAX, used by @ref MOTOR_MODE_DRIVE. */
+	uint16_t speed;
+};
+
+/** @brief Faults stopping a channel. */
+enum motor_fault {
+	/** No fault. */
+	MOTOR_FAULT_NONE,
+	/** The current exceeded the overcurrent limit. */
+	MOTOR_FAULT_OVERCURRENT,
+	/** The current stayed above the stall limit. */
+	MOTOR_FAULT_STALL,
+};
+
+/** @brief Current and back-EMF sensing status of one channel. */
+struct motor_status {
+	/** The channel senses its current, the next fields are valid. */
+	bool current_valid;
+	/** Current of the last sample, in mA. */
+	uint32_t current_ma;
+	/** Fault that stopped the channel, until motor_fault_clear(). */
+	enum motor_fault fault;
+	/** Time from the first sample over the limit to the output off, in ns. */
+	uint32_t fault_latency_ns;
+	/** Longest fault latency so far, in ns. */
+	uint32_t fault_latency_max_ns;
+	/** The channel senses its back-EMF, the next field is valid. */
+	bool emf_valid;
+	/**
+	 * Back-EMF in mV, low pass filtered, positive when turning forward.
+	 * Proportional to the speed, with or without a drive.
+	 */
+	int32_t emf_mv;
+};
+
 /**
- * @defgroup drivers_blink_ops Blink driver operations
- * @{
+ * @brief Ramp completion callback, called from interrupt context.
  *
- * @brief Operations of the blink driver class.
+ * @param dev Motor device instance.
+ * @param channel Channel of the ramp.
+ * @param status 0 at the end of the ramp, negative errno code on failure.
+ * @param user_data User data of the ramp.
+ */
+typedef void (*motor_ramp_callback_t)(const struct device *dev, uint8_t channel,
+				      int status, void *user_data);
+
+/** @brief Speed ramp of one channel. */
+struct motor_ramp {
+	/** Direction, for the whole ramp. */
+	enum motor_direction dir;
+	/**
+	 * Speeds from 0 to @ref MOTOR_SPEED_MAX, one per PWM period, or one
+	 * per step for stepper motors.
+	 */
+	const uint16_t *speeds;
+	/** Number of speeds. */
+	size_t len;
+	/**
+	 * Called at the end of the ramp, may be NULL. Drivers queueing speeds
+	 * in hardware call it once the last one is queued, a few PWM periods
+	 * or steps before it applies.
+	 */
+	motor_ramp_callback_t callback;
+	/** Opaque pointer passed to @ref callback. */
+	void *user_data;
+};
+
+/**
+ * @defgroup drivers_motor_ops Motor driver operations
+ * @{
  *
- * Each driver class tipically provides a set of operations that need to be
- * implemented by each driver. These are used to implement the public API. If
- * support for system calls is needed, the operations structure must be tagged
- * with `__subsystem` and follow the `${class}_driver_api` naming scheme.
+ * @brief Operations of the motor driver class.
  */
 
-/** @brief Blink driver class operations */
-__subsystem struct blink_driver_api {
+/** @brief Motor driver class operations */
+__subsystem struct motor_driver_api {
+	/**
+	 * @brief Apply commands to a set of channels.
+	 *
+	 * @param dev Motor device instance.
+	 * @param channels Bit mask of the channels to command.
+	 * @param cmds Commands, indexed by channel number.
+	 *
+	 * @retval 0 if successful.
+	 * @retval -EINVAL if a channel or command is invalid.
+	 * @retval -ENOTSUP if a channel lacks the inputs for a command.
+	 * @retval -EIO if a channel to drive or brake has a fault.
+	 * @retval -errno Other negative errno code on failure.
+	 */
+	int (*set)(const struct device *dev, uint32_t channels,
+		   const struct motor_cmd *cmds);
+
+	/**
+	 * @brief Get the last command applied to a channel.
+	 *
+	 * @param dev Motor device instance.
+	 * @param channel Channel number.
+	 * @param cmd Destination of the command.
+	 *
+	 * @retval 0 if successful.
+	 * @retval -EINVAL if @p channel is invalid.
+	 */
+	int (*get)(const struct device *dev, uint8_t channel,
+		   struct motor_cmd *cmd);
+
+	/**
+	 * @brief Get the number of channels.
+	 *
+	 * @param dev Motor device instance.
+	 *
+	 * @return Number of channels.
+	 */
+	uint8_t (*channel_count)(const struct device *dev);
+
 	/**
-	 * @brief Configure the LED blink period.
+	 * @brief Start a hardware speed ramp, optional.
 	 *
-	 * @param dev Blink device instance.
-	 * @param period_ms Period of the LED blink in milliseconds, 0 to
-	 * disable blinking.
+	 * @param dev Motor device instance.
+	 * @param channel Channel number.
+	 * @param ramp Ramp.
 	 *
 	 * @retval 0 if successful.
-	 * @retval -EINVAL if @p period_ms can not be set.
+	 * @retval -EINVAL if the channel or ramp is invalid.
+	 * @retval -ENOTSUP if the channel cannot ramp.
+	 * @retval -EBUSY if a channel sharing its PWM hardware ramps.
+	 * @retval -EIO if the channel has a fault.
 	 * @retval -errno Other negative errno code on failure.
 	 */
-	int (*set_period_ms)(const struct device *dev, unsigned int period_ms);
+	int (*ramp)(const struct device *dev, uint8_t channel,
+		    const struct motor_ramp *ramp);
+
+	/**
+	 * @brief Get the current and back-EMF sensing status of a channel, optional.
+	 *
+	 * @param dev Motor device instance.
+	 * @param channel Channel number.
+	 * @param status Destination of the status.
+	 *
+	 * @retval 0 if successful.
+	 * @retval -EINVAL if @p channel is invalid.
+	 * @retval -ENOTSUP if the channel senses neither.
+	 */
+	int (*status_get)(const struct device *dev, uint8_t channel,
+			  struct motor_status *status);
+
+	/**
+	 * @brief Clear the fault of a channel, optional.
+	 *
+	 * @param dev Motor device instance.
+	 * @param channel Channel number.
+	 *
+	 * @retval 0 if successful.
+	 * @retval -EINVAL if @p channel is invalid.
+	 * @retval -ENOTSUP if the channel senses no current.
+	 */
+	int (*fault_clear)(const struct device *dev, uint8_t channel);
 };
 
 /** @} */
 
 /**
- * @defgroup drivers_blink_api Blink driver API
+ * @defgroup drivers_motor_api Motor driver API
  * @{
  *
- * @brief Public API provided by the blink driver class.
+ * @brief Public API provided by the motor driver class.
+ */
+
+/**
+ * @brief Apply commands to a set of channels at once.
+ *
+ * All commanded channels change together: drivers apply the commands within
+ * the same PWM period where the hardware allows it. Channels outside of
+ * @p channels keep their command.
  *
- * The public API is the interface that is used by applications to interact with
- * devices that implement the blink driver class. If support for system calls is
- * needed, functions accessing device fields need to be tagged with `__syscall`
- * and provide an implementation that follows the `z_impl_${function_name}`
- * naming scheme.
+ * @param dev Motor device instance.
+ * @param channels Bit mask of the channels to command, below
+ *        @ref MOTOR_MAX_CHANNELS.
+ * @param cmds Commands, indexed by channel number. Only the entries of the
+ *        channels in @p channels are read.
+ *
+ * @retval 0 if successful.
+ * @retval -EINVAL if a channel or command is invalid, nothing is applied.
+ * @retval -ENOTSUP if a channel lacks the inputs for a command, e.g. braking
+ *         without both direction inputs. Nothing is applied.
+ * @retval -EIO if a channel to drive or brake has a fault, see
+ *         motor_fault_clear(). Coasting a faulted channel succeeds.
+ * @retval -errno Other negative errno code on failure.
  */
+__syscall int motor_set(const struct device *dev, uint32_t channels,
+			const struct motor_cmd *cmds);
+
+static inline int z_impl_motor_set(const struct device *dev, uint32_t channels,
+				   const struct motor_cmd *cmds)
+{
+	__ASSERT_NO_MSG(DEVICE_API_IS(motor, dev));
+
+	return DEVICE_API_GET(motor, dev)->set(dev, channels, cmds);
+}
 
 /**
- * @brief Configure the LED blink period.
+ * @brief Get the last command applied to a channel.
  *
+ * @param dev Motor device instance.
+ * @param channel Channel number.
+ * @param cmd Destination of the command.
  *
- * @param dev Blink device instance.
- * @param period_ms Period of the LED blink in milliseconds.
+ * @retval 0 if successful.
+ * @retval -EINVAL if @p channel is invalid.
+ */
+__syscall int motor_get(const struct device *dev, uint8_t channel,
+			struct motor_cmd *cmd);
+
+static inline int z_impl_motor_get(const struct device *dev, uint8_t channel,
+				   struct motor_cmd *cmd)
+{
+	__ASSERT_NO_MSG(DEVICE_API_IS(motor, dev));
+
+	return DEVICE_API_GET(motor, dev)->get(dev, channel, cmd);
+}
+
+/**
+ * @brief Get the number of channels of a motor device.
+ *
+ * @param dev Motor device instance.
+ *
+ * @return Number of channels.
+ */
+__syscall uint8_t motor_channel_count(const struct device *dev);
+
+static inline uint8_t z_impl_motor_channel_count(const struct device *dev)
+{
+	__ASSERT_NO_MSG(DEVICE_API_IS(motor, dev));
+
+	return DEVICE_API_GET(motor, dev)->channel_count(dev);
+}
+
+/**
+ * @brief Drive one channel at a speed and direction.
+ *
+ * @param dev Motor device instance.
+ * @param channel Channel number.
+ * @param dir Direction.
+ * @param speed Speed from 0 to @ref MOTOR_SPEED_MAX.
+ *
+ * @return See motor_set().
+ */
+static inline int motor_drive(const struct device *dev, uint8_t channel,
+			      enum motor_direction dir, uint16_t speed)
+{
+	struct motor_cmd cmds[MOTOR_MAX_CHANNELS];
+
+	if (channel >= MOTOR_MAX_CHANNELS) {
+		return -EINVAL;
+	}
+
+	cmds[channel] = (struct motor_cmd){
+		.mode = MOTOR_MODE_DRIVE,
+		.dir = dir,
+		.speed = speed,
+	};
+
+	return motor_set(dev, BIT(channel), cmds);
+}
+
+/**
+ * @brief Brake one channel.
+ *
+ * @param dev Motor device instance.
+ * @param channel Channel number.
+ *
+ * @return See motor_set().
+ */
+static inline int motor_brake(const struct device *dev, uint8_t channel)
+{
+	struct motor_cmd cmds[MOTOR_MAX_CHANNELS];
+
+	if (channel >= MOTOR_MAX_CHANNELS) {
+		return -EINVAL;
+	}
+
+	cmds[channel] = (struct motor_cmd){.mode = MOTOR_MODE_BRAKE};
+
+	return motor_set(dev, BIT(channel), cmds);
+}
+
+/**
+ * @brief Let one channel coast.
+ *
+ * @param dev Motor device instance.
+ * @param channel Channel number.
+ *
+ * @return See motor_set().
+ */
+static inline int motor_coast(const struct device *dev, uint8_t channel)
+{
+	struct motor_cmd cmds[MOTOR_MAX_CHANNELS];
+
+	if (channel >= MOTOR_MAX_CHANNELS) {
+		return -EINVAL;
+	}
+
+	cmds[channel] = (struct motor_cmd){.mode = MOTOR_MODE_COAST};
+
+	return motor_set(dev, BIT(channel), cmds);
+}
+
+/**
+ * @brief Apply the same command to a set of channels at once.
+ *
+ * @param dev Motor device instance.
+ * @param channels Bit mask of the channels to command.
+ * @param cmd Command.
+ *
+ * @return See motor_set().
+ */
+static inline int motor_set_all(const struct device *dev, uint32_t channels,
+				const struct motor_cmd *cmd)
+{
+	struct motor_cmd cmds[MOTOR_MAX_CHANNELS];
+
+	for (int i = 0; i < MOTOR_MAX_CHANNELS; i++) {
+		cmds[i] = *cmd;
+	}
+
+	return motor_set(dev, channels, cmds);
+}
+
+/**
+ * @brief Run a speed ramp on one channel in hardware.
+ *
+ * The speeds are applied one per PWM period, at the period boundaries, or
+ * one per step by stepper motor drivers, without waking the CPU. The
+ * channel keeps the last speed at the end of the ramp, which motor_get()
+ * reports from the start. A new ramp of the channel replaces the one in
+ * progress, a motor_set() of the channel ends it at its current speed.
+ * Channels sharing its PWM hardware can be commanded meanwhile, but not
+ * ramp.
+ *
+ * @param dev Motor device instance.
+ * @param channel Channel number.
+ * @param ramp Ramp. The speeds are copied, the table may be reused after
+ *        the call.
  *
  * @retval 0 if successful.
- * @retval -EINVAL if @p period_ms can not be set.
+ * @retval -EINVAL if the channel or ramp is invalid, e.g. longer than the
+ *         driver can hold.
+ * @retval -ENOTSUP if the channel lacks the inputs for the direction, or
+ *         the hardware to ramp.
+ * @retval -EBUSY if a channel sharing its PWM hardware ramps.
+ * @retval -EIO if the channel has a fault, see motor_fault_clear().
+ * @retval -ENOSYS if the driver has no hardware ramps.
  * @retval -errno Other negative errno code on failure.
  */
-__syscall int blink_set_period_ms(const struct device *dev,
-				  unsigned int period_ms);
+static inline int motor_ramp(const struct device *dev, uint8_t channel,
+			     const struct motor_ramp *ramp)
+{
+	const struct motor_driver_api *api = DEVICE_API_GET(motor, dev);
+
+	__ASSERT_NO_MSG(DEVICE_API_IS(motor, dev));
+
+	if (api->ramp == NULL) {
+		return -ENOSYS;
+	}
+
+	return api->ramp(dev, channel, ramp);
+}
 
-static inline int z_impl_blink_set_period_ms(const struct device *dev,
-					     unsigned int period_ms)
+/**
+ * @brief Get the current and back-EMF sensing status of a channel.
+ *
+ * A channel with a fault is stopped and coasts. The fault is latched:
+ * commands driving or braking the channel fail until motor_fault_clear().
+ *
+ * @param dev Motor device instance.
+ * @param channel Channel number.
+ * @param status Destination of the status.
+ *
+ * @retval 0 if successful.
+ * @retval -EINVAL if @p channel is invalid.
+ * @retval -ENOTSUP if the channel senses neither.
+ * @retval -ENOSYS if the driver senses neither.
+ */
+static inline int motor_status_get(const struct device *dev, uint8_t channel,
+				   struct motor_status *status)
 {
-	__ASSERT_NO_MSG(DEVICE_API_IS(blink, dev));
+	const struct motor_driver_api *api = DEVICE_API_GET(motor, dev);
+
+	__ASSERT_NO_MSG(DEVICE_API_IS(motor, dev));
+
+	if (api->status_get == NULL) {
+		return -ENOSYS;
+	}
 
-	return DEVICE_API_GET(blink, dev)->set_period_ms(dev, period_ms);
+	return api->status_get(dev, channel, status);
 }
 
 /**
- * @brief Turn LED blinking off.
+ * @brief Clear the fault of a channel.
  *
- * This is a convenience function to turn off the LED blinking. It also shows
- * how to create convenience functions that re-use other driver functions, or
- * driver operations, to provide a higher-level API.
+ * The channel coasts until its next command. Clearing a channel without a
+ * fault does nothing.
  *
- * @param dev Blink device instance.
+ * @param dev Motor device instance.
+ * @param channel Channel number.
  *
- * @return See blink_set_period_ms().
+ * @retval 0 if successful.
+ * @retval -EINVAL if @p channel is invalid.
+ * @retval -ENOTSUP if the channel senses no current.
+ * @retval -ENOSYS if the driver senses no current.
  */
-static inline int blink_off(const struct device *dev)
+static inline int motor_fault_clear(const struct device *dev, uint8_t channel)
 {
-	return blink_set_period_ms(dev, 0);
+	const struct motor_driver_api *api = DEVICE_API_GET(motor, dev);
+
+	__ASSERT_NO_MSG(DEVICE_API_IS(motor, dev));
+
+	if (api->fault_clear == NULL) {
+		return -ENOSYS;
+	}
+
+	return api->fault_clear(dev, channel);
 }
 
-#include <syscalls/blink.h>
+#include <zephyr/syscalls/motor.h>
 
 /** @} */
 
 /** @} */
 
-#endif /* APP_DRIVERS_BLINK_H_ */
\ No newline at end of file
+#endif /* APP_DRIVERS_MOTOR_H_ */
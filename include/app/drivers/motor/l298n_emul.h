@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2025 Jared Woolston
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef APP_DRIVERS_MOTOR_L298N_EMUL_H_
+#define APP_DRIVERS_MOTOR_L298N_EMUL_H_
+
+#include <stdint.h>
+
+#include <zephyr/device.h>
+
+/**
+ * @defgroup drivers_l298n_emul L298N emulator
+ * @ingroup drivers_motor
+ * @{
+ *
+ * @brief DC motor plant behind an emulated L298N.
+ *
+ * The emulator is a PWM controller for the enable inputs of a
+ * @c motor-l298n node, whose direction inputs are on the GPIO emulator.
+ * Each of its two channels drives a first-order model of a DC motor with
+ * a Coulomb friction load:
+ *
+ *     tau * dw/dt = d * u - c * w - load * sign(w)
+ *
+ * with w the speed, d the duty cycle and u the no-load speed at full
+ * voltage, signed by the direction inputs. The back-EMF term c is 1 while
+ * driving, d while braking and 0 while coasting. The speed is in encoder
+ * counts/s and the model generates the matching counts.
+ *
+ * The model advances with the simulated time, in fixed steps, whenever
+ * the PWM is set or the state or the count is read. It runs as fast as the
+ * host allows, faster than real time unless native_sim slows down to it.
+ */
+
+/** @brief Model of one channel. */
+struct motor_l298n_emul_model {
+	/** No-load speed at full voltage, in counts/s. */
+	int32_t max_speed;
+	/** Mechanical time constant, in us. */
+	uint32_t time_constant_us;
+	/** Friction load, as the speed it costs while driving, in counts/s. */
+	int32_t load;
+};
+
+/** @brief State of one channel. */
+struct motor_l298n_emul_state {
+	/** Position in counts, the encoder count. */
+	int32_t position;
+	/** Speed in counts/s. */
+	int32_t speed;
+	/** Duty cycle of the enable input, from 0 to @ref MOTOR_SPEED_MAX. */
+	uint16_t duty;
+};
+
+/** @brief Encoder of one channel, the user data of motor_l298n_emul_encoder_read(). */
+struct motor_l298n_emul_encoder {
+	/** Emulator device. */
+	const struct device *dev;
+	/** Emulator channel, the PWM channel of the motor channel. */
+	uint8_t channel;
+};
+
+/**
+ * @brief Set the model of a channel.
+ *
+ * The motor keeps its state, a new load is a load step.
+ *
+ * @param dev Emulator device.
+ * @param channel Channel, 0 or 1.
+ * @param model Model.
+ *
+ * @retval 0 if successful.
+ * @retval -EINVAL if the channel or model is invalid.
+ */
+int motor_l298n_emul_model_set(const struct device *dev, uint8_t channel,
+			       const struct motor_l298n_emul_model *model);
+
+/**
+ * @brief Stop the motor of a channel at position 0, as if just powered.
+ *
+ * @param dev Emulator device.
+ * @param channel Channel, 0 or 1.
+ *
+ * @retval 0 if successful.
+ * @retval -EINVAL if the channel is invalid.
+ */
+int motor_l298n_emul_reset(const struct device *dev, uint8_t channel);
+
+/**
+ * @brief Get the state of a channel, at the current simulated time.
+ *
+ * @param dev Emulator device.
+ * @param channel Channel, 0 or 1.
+ * @param state Destination of the state.
+ *
+ * @retval 0 if successful.
+ * @retval -EINVAL if the channel is invalid.
+ */
+int motor_l298n_emul_state_get(const struct device *dev, uint8_t channel,
+			       struct motor_l298n_emul_state *state);
+
+/**
+ * @brief Encoder read function of a channel.
+ *
+ * Matches the encoder of the closed-loop motor control library, with a
+ * @ref motor_l298n_emul_encoder as the user data.
+ *
+ * @param user_data Encoder, @ref motor_l298n_emul_encoder.
+ * @param count Destination of the count.
+ *
+ * @retval 0 if successful.
+ * @retval -EINVAL if the channel is invalid.
+ */
+int motor_l298n_emul_encoder_read(void *user_data, int32_t *count);
+
+/** @} */
+
+#endif /* APP_DRIVERS_MOTOR_L298N_EMUL_H_ */
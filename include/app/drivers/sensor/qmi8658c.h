@@ -0,0 +1,406 @@
+/*
+ * Copyright (c) 2025 Jared Woolston
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef APP_DRIVERS_SENSOR_QMI8658C_H_
+#define APP_DRIVERS_SENSOR_QMI8658C_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <zephyr/device.h>
+#include <zephyr/dsp/types.h>
+
+/**
+ * @defgroup drivers_qmi8658c QMI8658C IMU driver extensions
+ * @ingroup drivers
+ * @{
+ *
+ * @brief Driver specific extensions of the QMI8658C 6-axis IMU.
+ *
+ * These functions complement the generic sensor API for features that do not
+ * map onto sensor attributes or channels.
+ */
+
+/** @brief Sensors of the QMI8658C. */
+enum qmi8658c_sensor {
+	/** Accelerometer, converted to m/s^2. */
+	QMI8658C_SENSOR_ACCEL,
+	/** Gyroscope, converted to rad/s. */
+	QMI8658C_SENSOR_GYRO,
+};
+
+/** @brief Bus time statistics of the sample fetch path. */
+struct qmi8658c_bus_stats {
+	/** Number of completed fetches. */
+	uint32_t count;
+	/** Number of failed fetches. */
+	uint32_t errors;
+	/** Bus time of the last fetch in nanoseconds. */
+	uint32_t last_ns;
+	/** Shortest fetch in nanoseconds. */
+	uint32_t min_ns;
+	/** Longest fetch in nanoseconds. */
+	uint32_t max_ns;
+	/** Accumulated bus time of all fetches in nanoseconds. */
+	uint64_t total_ns;
+};
+
+/**
+ * @brief Get the bus time statistics of the sample fetch path.
+ *
+ * Requires @kconfig{CONFIG_QMI8658C_BUS_STATS}.
+ *
+ * @param dev QMI8658C device instance.
+ * @param stats Destination of the statistics.
+ *
+ * @retval 0 if successful.
+ */
+int qmi8658c_bus_stats_get(const struct device *dev,
+			   struct qmi8658c_bus_stats *stats);
+
+/**
+ * @brief Reset the bus time statistics of the sample fetch path.
+ *
+ * Requires @kconfig{CONFIG_QMI8658C_BUS_STATS}.
+ *
+ * @param dev QMI8658C device instance.
+ */
+void qmi8658c_bus_stats_reset(const struct device *dev);
+
+/** @brief Resolution of the chip timestamp counter in nanoseconds. */
+#define QMI8658C_TIMESTAMP_NS 25000
+
+/** @brief Time of the last fetched sample. */
+struct qmi8658c_sample_time {
+	/** Chip timestamp counter, extended to 64 bits. */
+	uint64_t chip_ticks;
+	/** Chip timestamp aligned to the system uptime, in nanoseconds. */
+	int64_t uptime_ns;
+};
+
+/**
+ * @brief Get the time of the last fetched sample.
+ *
+ * Requires @kconfig{CONFIG_QMI8658C_TIMESTAMP}. The chip timestamp counter is
+ * read in the same bus transfer as every full sample fetch, including the
+ * fetch done by the data-ready interrupt path, so data-ready handlers can
+ * call this right after sensor_sample_fetch(). The counter is aligned to the
+ * system uptime with the smallest offset seen between the two clocks, which
+ * removes the bus and scheduling latency from the sample times.
+ *
+ * @param dev QMI8658C device instance.
+ * @param time Destination of the sample time.
+ *
+ * @retval 0 if successful.
+ * @retval -ENODATA if no sample has been fetched yet.
+ */
+int qmi8658c_sample_time_get(const struct device *dev,
+			     struct qmi8658c_sample_time *time);
+
+/** @brief Consistent copy of the last fetched sample. */
+struct qmi8658c_snapshot {
+	/** Raw accelerometer x/y/z. */
+	int16_t acc[3];
+	/** Raw gyroscope x/y/z. */
+	int16_t gyro[3];
+	/** Raw die temperature, 0 without temperature support. */
+	int16_t temp;
+	/**
+	 * Time of the last full sample fetch, zero without
+	 * @kconfig{CONFIG_QMI8658C_TIMESTAMP}.
+	 */
+	struct qmi8658c_sample_time time;
+};
+
+/**
+ * @brief Get a consistent copy of the last fetched sample.
+ *
+ * The driver publishes every fetched sample under a sequence counter. This
+ * function copies it without taking a lock and retries if a fetch updated it
+ * meanwhile, so all values come from the same fetch. It never blocks and
+ * costs a copy of a few dozen bytes, which makes it suitable for control
+ * loops reading the sample refreshed by the interrupt path. The raw values
+ * can be converted with qmi8658c_convert_q31().
+ *
+ * @param dev QMI8658C device instance.
+ * @param snap Destination of the sample.
+ *
+ * @retval 0 if successful.
+ * @retval -ENODATA if no sample has been fetched yet.
+ */
+int qmi8658c_snapshot_get(const struct device *dev,
+			  struct qmi8658c_snapshot *snap);
+
+/**
+ * @brief Convert a block of raw samples to q31.
+ *
+ * Converts @p count raw x/y/z triples, e.g. a FIFO batch, with the gain of
+ * the current full scale range. The result is in m/s^2 for the
+ * accelerometer and rad/s for the gyroscope, represented as
+ * value = out * 2^shift / 2^31. On cores with the DSP extension two values
+ * are converted per 32-bit load with one multiply instruction each. With
+ * @kconfig{CONFIG_QMI8658C_CALIBRATION} the calibration is applied by the
+ * same instruction, as a multiply-accumulate, and the shift can be larger.
+ *
+ * @param dev QMI8658C device instance.
+ * @param sensor Sensor the raw samples come from.
+ * @param raw Raw samples.
+ * @param out Converted samples, may not overlap @p raw.
+ * @param count Number of x/y/z triples.
+ * @param shift Shift of the converted samples.
+ *
+ * @retval 0 if successful.
+ * @retval -EINVAL if @p sensor is invalid.
+ */
+int qmi8658c_convert_q31(const struct device *dev, enum qmi8658c_sensor sensor,
+			 const int16_t (*raw)[3], q31_t (*out)[3], size_t count,
+			 int8_t *shift);
+
+/**
+ * @brief Convert a block of raw samples to q15.
+ *
+ * Same as qmi8658c_convert_q31(), keeping the upper 16 bits of the result.
+ * The shift is the same as for the q31 conversion.
+ *
+ * @param dev QMI8658C device instance.
+ * @param sensor Sensor the raw samples come from.
+ * @param raw Raw samples.
+ * @param out Converted samples, may not overlap @p raw.
+ * @param count Number of x/y/z triples.
+ * @param shift Shift of the converted samples.
+ *
+ * @retval 0 if successful.
+ * @retval -EINVAL if @p sensor is invalid.
+ */
+int qmi8658c_convert_q15(const struct device *dev, enum qmi8658c_sensor sensor,
+			 const int16_t (*raw)[3], q15_t (*out)[3], size_t count,
+			 int8_t *shift);
+
+/**
+ * @brief Bias and scale calibration of the QMI8658C.
+ *
+ * A reading is corrected as (reading - bias - tempco * (T - temp_ref)) *
+ * scale, per axis, with the die temperature T of the last fetched sample.
+ */
+struct qmi8658c_calibration {
+	/** Accelerometer bias at @ref temp_ref, in ug. */
+	int32_t acc_bias[3];
+	/** Accelerometer scale factor, 65536 is 1. */
+	int32_t acc_scale[3];
+	/** Accelerometer bias temperature coefficient, in ug/degC. */
+	int32_t acc_tempco[3];
+	/** Gyroscope bias at @ref temp_ref, in udps. */
+	int32_t gyro_bias[3];
+	/** Gyroscope scale factor, 65536 is 1. */
+	int32_t gyro_scale[3];
+	/** Gyroscope bias temperature coefficient, in udps/degC. */
+	int32_t gyro_tempco[3];
+	/** Reference temperature of the biases, in millidegC. */
+	int32_t temp_ref;
+};
+
+/** @brief Mean of a stationary sample collection, uncorrected. */
+struct qmi8658c_cal_point {
+	/** Accelerometer x/y/z, in ug. */
+	int32_t acc[3];
+	/** Gyroscope x/y/z, in udps. */
+	int32_t gyro[3];
+	/** Die temperature, in millidegC. */
+	int32_t temp;
+};
+
+/**
+ * @brief Set the calibration.
+ *
+ * Requires @kconfig{CONFIG_QMI8658C_CALIBRATION}. The correction is folded
+ * into per-axis multipliers and offsets of the current full scale range,
+ * and folded again when the range changes or, with temperature
+ * coefficients, when the die temperature moved by a quarter degree. Applying
+ * it costs nothing per sample: channel_get(), qmi8658c_convert_q31(),
+ * qmi8658c_convert_q15() and the decoder convert with one multiply-accumulate
+ * per value, as they did with one multiply before. A range the corrected full
+ * scale does not fit is set uncalibrated, the attribute set returns -ERANGE
+ * and the calibration applies again once the range is changed back.
+ *
+ * @param dev QMI8658C device instance.
+ * @param cal Calibration, copied.
+ *
+ * @retval 0 if successful.
+ * @retval -EINVAL if a scale factor is outside of 0.5 to 2.
+ * @retval -ENOTSUP if temperature coefficients are set without
+ *         @kconfig{CONFIG_QMI8658C_ENABLE_TEMP}.
+ * @retval -ERANGE if the corrected full scale does not fit in q31.
+ */
+int qmi8658c_calibration_set(const struct device *dev,
+			     const struct qmi8658c_calibration *cal);
+
+/**
+ * @brief Get the calibration.
+ *
+ * Requires @kconfig{CONFIG_QMI8658C_CALIBRATION}. Without a calibration
+ * set, biases and temperature coefficients are zero and scales are 1.
+ *
+ * @param dev QMI8658C device instance.
+ * @param cal Destination of the calibration.
+ */
+void qmi8658c_calibration_get(const struct device *dev,
+			      struct qmi8658c_calibration *cal);
+
+/**
+ * @brief Store the calibration with the settings subsystem.
+ *
+ * Requires @kconfig{CONFIG_QMI8658C_CALIBRATION_SETTINGS}. The calibration
+ * is stored under @c qmi8658c/<device name> and set again by settings_load().
+ *
+ * @param dev QMI8658C device instance.
+ *
+ * @retval 0 if successful.
+ * @retval -errno Negative errno code of settings_save_one() on failure.
+ */
+int qmi8658c_calibration_save(const struct device *dev);
+
+/**
+ * @brief Collect the mean of stationary samples.
+ *
+ * Requires @kconfig{CONFIG_QMI8658C_CALIBRATION}. Fetches @p samples
+ * samples at the accelerometer output data rate and averages the raw,
+ * uncorrected readings. The sensor must rest still in one orientation
+ * meanwhile.
+ *
+ * @param dev QMI8658C device instance.
+ * @param samples Number of samples to average.
+ * @param point Destination of the means.
+ *
+ * @retval 0 if successful.
+ * @retval -EINVAL if @p samples is zero.
+ * @retval -EAGAIN if the sensor moved during the collection.
+ * @retval -errno Other negative errno code on failure.
+ */
+int qmi8658c_cal_collect(const struct device *dev, uint16_t samples,
+			 struct qmi8658c_cal_point *point);
+
+/**
+ * @brief Fit a calibration to stationary collections.
+ *
+ * Requires @kconfig{CONFIG_QMI8658C_CALIBRATION}. Every point is expected
+ * to see 1 g along the axis with the largest reading and 0 g along the
+ * others, and no rotation. The accelerometer scale of an axis is fitted when
+ * the points hold it both up and down, e.g. the six faces of a cube,
+ * otherwise it is 1. The gyroscope scale needs a known rate and stays 1.
+ * With @p tempco, the bias temperature coefficients are fitted too, which
+ * needs points over a temperature span; the biases are then given at the
+ * mean temperature of the points.
+ *
+ * @param points Stationary collections, see qmi8658c_cal_collect().
+ * @param count Number of points.
+ * @param tempco Fit the bias temperature coefficients.
+ * @param cal Destination of the calibration.
+ *
+ * @retval 0 if successful.
+ * @retval -EINVAL if there are no points, a point sees no gravity, or
+ *         @p tempco is set and all points have the same temperature.
+ * @retval -ERANGE if the fitted accelerometer scale is outside of 0.5 to 2.
+ */
+int qmi8658c_cal_fit(const struct qmi8658c_cal_point *points, size_t count,
+		     bool tempco, struct qmi8658c_calibration *cal);
+
+/** @brief A batch of raw samples drained from the hardware FIFO. */
+struct qmi8658c_fifo_batch {
+	/** Raw accelerometer samples, oldest first. */
+	const int16_t (*acc)[3];
+	/** Raw gyroscope samples, oldest first. */
+	const int16_t (*gyro)[3];
+	/** Number of entries in @ref acc. */
+	uint16_t acc_count;
+	/** Number of entries in @ref gyro. */
+	uint16_t gyro_count;
+	/** Accelerometer batching rate in Hz. */
+	uint16_t acc_rate;
+	/** Gyroscope batching rate in Hz. */
+	uint16_t gyro_rate;
+	/** System uptime, in ticks, of the watermark interrupt. */
+	int64_t irq_ticks;
+	/**
+	 * Last chip timestamp batched in the FIFO (25 us/LSB), 0 if timestamp
+	 * batching is disabled.
+	 */
+	uint32_t chip_timestamp;
+};
+
+/**
+ * @brief FIFO batch handler.
+ *
+ * Called from the driver trigger context every time the FIFO watermark is
+ * reached. The batch buffers are reused for the next drain, so the handler
+ * must copy what it needs before returning.
+ *
+ * @param dev QMI8658C device instance.
+ * @param batch Samples drained from the FIFO.
+ * @param user_data User data given to qmi8658c_fifo_handler_set().
+ */
+typedef void (*qmi8658c_fifo_handler_t)(const struct device *dev,
+					const struct qmi8658c_fifo_batch *batch,
+					void *user_data);
+
+/**
+ * @brief Set the handler receiving FIFO batches.
+ *
+ * Requires @kconfig{CONFIG_QMI8658C_FIFO} and a non zero @c fifo-watermark in
+ * devicetree. Setting a handler routes the FIFO watermark interrupt to the
+ * configured interrupt pin, setting NULL disables it.
+ *
+ * @param dev QMI8658C device instance.
+ * @param handler Batch handler, NULL to disable.
+ * @param user_data Opaque pointer passed to @p handler.
+ *
+ * @retval 0 if successful.
+ * @retval -ENOTSUP if FIFO mode is not configured for @p dev.
+ * @retval -errno Other negative errno code on failure.
+ */
+int qmi8658c_fifo_handler_set(const struct device *dev,
+			      qmi8658c_fifo_handler_t handler,
+			      void *user_data);
+
+/** @brief Power profiles of the QMI8658C. */
+enum qmi8658c_power_profile {
+	/** Accelerometer and gyroscope at their configured rates and modes. */
+	QMI8658C_POWER_PROFILE_ACTIVE,
+	/**
+	 * Gyroscope off and accelerometer in ultra-low-power mode at the
+	 * devicetree @c idle-accel-odr, for wake-on-motion.
+	 */
+	QMI8658C_POWER_PROFILE_IDLE,
+};
+
+/**
+ * @brief Switch between the active and the idle power profile.
+ *
+ * Requires @kconfig{CONFIG_QMI8658C_WAKEUP} and an interrupt line. Only the
+ * rate and power mode bits are rewritten, in the order the chip requires, so
+ * ranges, filters, FIFO and interrupt routing are kept and the switch takes
+ * at most three register writes. Output data rates set with
+ * sensor_attr_set() while idle are stored and applied when switching back
+ * to the active profile. The gyroscope needs its turn-on time, about 70 ms,
+ * before its output is valid again.
+ *
+ * A motion trigger (@c SENSOR_TRIG_MOTION on @c SENSOR_CHAN_ACCEL_XYZ) fires
+ * in both profiles when the accelerometer slope exceeds the devicetree
+ * @c wakeup-threshold.
+ *
+ * @param dev QMI8658C device instance.
+ * @param profile Profile to switch to.
+ *
+ * @retval 0 if successful.
+ * @retval -ENOTSUP if @p dev has no interrupt line.
+ * @retval -EINVAL if @p profile is invalid.
+ * @retval -errno Other negative errno code on failure.
+ */
+int qmi8658c_power_profile_set(const struct device *dev,
+			       enum qmi8658c_power_profile profile);
+
+/** @} */
+
+#endif /* APP_DRIVERS_SENSOR_QMI8658C_H_ */
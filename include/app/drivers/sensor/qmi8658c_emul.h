@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2025 Jared Woolston
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef APP_DRIVERS_SENSOR_QMI8658C_EMUL_H_
+#define APP_DRIVERS_SENSOR_QMI8658C_EMUL_H_
+
+#include <stdint.h>
+
+#include <zephyr/drivers/emul.h>
+
+/**
+ * @defgroup drivers_qmi8658c_emul QMI8658C emulator
+ * @ingroup drivers_qmi8658c
+ * @{
+ *
+ * @brief Backend controls of the QMI8658C I2C emulator.
+ *
+ * The emulator models the register map used by the driver: WHO_AM_I,
+ * software reset, output and status registers, the timestamp counter, the
+ * FIFO and the wake-up source. The interrupt line of the devicetree node is
+ * driven through the GPIO emulator from the data-ready, FIFO watermark and
+ * wake-up routing bits, as a level.
+ */
+
+/** @brief Number of words the emulated FIFO holds. */
+#define QMI8658C_EMUL_FIFO_WORDS 512
+
+/** @brief FIFO word tags. */
+enum qmi8658c_emul_tag {
+	/** Gyroscope sample. */
+	QMI8658C_EMUL_TAG_GYRO = 0x01,
+	/** Accelerometer sample. */
+	QMI8658C_EMUL_TAG_ACCEL = 0x02,
+	/** Timestamp. */
+	QMI8658C_EMUL_TAG_TIMESTAMP = 0x04,
+};
+
+/**
+ * @brief Latch a new sample into the output registers.
+ *
+ * Sets the accelerometer, gyroscope and temperature data-ready flags.
+ *
+ * @param target Emulator instance.
+ * @param acc Raw accelerometer x/y/z.
+ * @param gyro Raw gyroscope x/y/z.
+ * @param temp Raw temperature.
+ */
+void qmi8658c_emul_sample_set(const struct emul *target, const int16_t acc[3],
+			      const int16_t gyro[3], int16_t temp);
+
+/**
+ * @brief Push a word into the FIFO.
+ *
+ * Ignored while the FIFO is in bypass mode. In stream mode the oldest word
+ * is dropped when the FIFO is full.
+ *
+ * @param target Emulator instance.
+ * @param tag Sensor the word comes from.
+ * @param data Six data bytes of the word, as three little endian values.
+ */
+void qmi8658c_emul_fifo_push(const struct emul *target, enum qmi8658c_emul_tag tag,
+			     const int16_t data[3]);
+
+/**
+ * @brief Get the number of words in the FIFO.
+ *
+ * @param target Emulator instance.
+ *
+ * @return FIFO level in words.
+ */
+uint16_t qmi8658c_emul_fifo_level(const struct emul *target);
+
+/**
+ * @brief Raise a wake-up event, as if the slope exceeded the threshold.
+ *
+ * @param target Emulator instance.
+ */
+void qmi8658c_emul_motion(const struct emul *target);
+
+/**
+ * @brief Get the value of a register.
+ *
+ * @param target Emulator instance.
+ * @param reg Register address in the user bank.
+ *
+ * @return Register value.
+ */
+uint8_t qmi8658c_emul_reg_get(const struct emul *target, uint8_t reg);
+
+/** @} */
+
+#endif /* APP_DRIVERS_SENSOR_QMI8658C_EMUL_H_ */
@@ -0,0 +1,321 @@
+/*
+ * Copyright (c) 2025 Jared Woolston
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef APP_LIB_FSM_H_
+#define APP_LIB_FSM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/spinlock.h>
+#include <zephyr/sys/util.h>
+
+/**
+ * @defgroup lib_fsm Table-driven state machine
+ * @ingroup lib
+ * @{
+ *
+ * @brief Run-to-completion state machine declared in constant tables.
+ *
+ * States and events are small integers, typically enumerations. A state
+ * table gives the entry and exit actions of every state and an optional
+ * timeout, a transition table indexed by state and event gives the next
+ * state and the action of every handled event. Both tables are constant
+ * and built at compile time, e.g. with designated initializers in a
+ * header; an event is dispatched with a single table lookup, whatever the
+ * size of the machine. Events a state does not handle are dropped.
+ *
+ * Events are posted to the queue of the machine, from any context, and
+ * dispatched one at a time by the thread calling fsm_process(). Entering a
+ * state with a timeout starts a timer posting the timeout event of the
+ * state, unless the state was left before it expired. A transition runs
+ * the exit action of the current state, the transition action and then
+ * the entry action of the next state, also when the next state is the
+ * current one.
+ *
+ * The time spent in every state is measured in system ticks, so that the
+ * slowest steps of a cycle stand out, see fsm_report().
+ *
+ * Example of a two state machine:
+ *
+ * @code{.c}
+ * enum { ST_IDLE, ST_FEED, ST_COUNT };
+ * enum { EV_START, EV_FED, EV_TIMEOUT, EV_COUNT };
+ *
+ * static const struct fsm_state states[ST_COUNT] = {
+ *	[ST_IDLE] = FSM_STATE("idle", NULL, NULL, 0, 0),
+ *	[ST_FEED] = FSM_STATE("feed", feed_start, feed_stop, 500, EV_TIMEOUT),
+ * };
+ *
+ * static const struct fsm_transition transitions[ST_COUNT][EV_COUNT] = {
+ *	[ST_IDLE] = {
+ *		[EV_START] = FSM_TRANSITION(ST_FEED, NULL),
+ *	},
+ *	[ST_FEED] = {
+ *		[EV_FED] = FSM_TRANSITION(ST_IDLE, NULL),
+ *		[EV_TIMEOUT] = FSM_TRANSITION(ST_IDLE, jam),
+ *	},
+ * };
+ * @endcode
+ */
+
+struct fsm;
+
+/**
+ * @brief Entry, exit or transition action, called from fsm_process().
+ *
+ * Actions may post events, they are dispatched after the transition.
+ *
+ * @param fsm State machine.
+ */
+typedef void (*fsm_action_t)(struct fsm *fsm);
+
+/** @brief State, one entry of the state table. */
+struct fsm_state {
+	/** Name, for the logs. */
+	const char *name;
+	/** Called when entering the state, may be NULL. */
+	fsm_action_t entry;
+	/** Called when leaving the state, may be NULL. */
+	fsm_action_t exit;
+	/** Time allowed in the state in ms, 0 for none. */
+	uint32_t timeout_ms;
+	/** Event posted when @ref timeout_ms elapses in the state. */
+	uint8_t timeout_event;
+};
+
+/** @brief Transition, one entry of the transition table. */
+struct fsm_transition {
+	/** The event is handled in the state, the next fields are valid. */
+	bool valid;
+	/** Next state. */
+	uint8_t next;
+	/** Called between the exit and entry actions, may be NULL. */
+	fsm_action_t action;
+};
+
+/**
+ * @brief Initializer of a state table entry.
+ *
+ * @param _name Name.
+ * @param _entry Entry action or NULL.
+ * @param _exit Exit action or NULL.
+ * @param _timeout_ms Time allowed in the state in ms, 0 for none.
+ * @param _timeout_event Event posted when the time elapses.
+ */
+#define FSM_STATE(_name, _entry, _exit, _timeout_ms, _timeout_event)		\
+	{									\
+		.name = (_name),						\
+		.entry = (_entry),						\
+		.exit = (_exit),						\
+		.timeout_ms = (_timeout_ms),					\
+		.timeout_event = (_timeout_event),				\
+	}
+
+/**
+ * @brief Initializer of a transition table entry.
+ *
+ * Entries left out of the table are zero and not handled.
+ *
+ * @param _next Next state.
+ * @param _action Transition action or NULL.
+ */
+#define FSM_TRANSITION(_next, _action)						\
+	{									\
+		.valid = true,							\
+		.next = (_next),						\
+		.action = (_action),						\
+	}
+
+/** @brief State machine configuration. */
+struct fsm_config {
+	/** State table, @ref num_states entries. */
+	const struct fsm_state *states;
+	/**
+	 * Transition table, @ref num_states rows of @ref num_events entries,
+	 * e.g. the first element of a two-dimensional array.
+	 */
+	const struct fsm_transition *transitions;
+	/** Number of states, at most 255. */
+	uint8_t num_states;
+	/** Number of events, at most 255. */
+	uint8_t num_events;
+	/** Initial state, entered by fsm_start(). */
+	uint8_t initial;
+	/** Name, for the logs. */
+	const char *name;
+	/** Opaque pointer for the actions, see fsm_user_data(). */
+	void *user_data;
+};
+
+/** @brief Time spent in a state, in system ticks. */
+struct fsm_state_stats {
+	/** Number of completed visits. */
+	uint32_t visits;
+	/** Number of visits ended by the timeout of the state. */
+	uint32_t timeouts;
+	/** Time of the last visit. */
+	uint32_t dwell_last;
+	/** Shortest visit. */
+	uint32_t dwell_min;
+	/** Longest visit. */
+	uint32_t dwell_max;
+	/** Sum of the visits. */
+	uint64_t dwell_sum;
+};
+
+/** @brief State machine statistics. */
+struct fsm_stats {
+	/** Number of dispatched events. */
+	uint32_t events;
+	/** Number of events not handled in the current state. */
+	uint32_t unhandled;
+	/** Number of events lost because the queue was full. */
+	uint32_t dropped;
+	/** Number of transitions. */
+	uint32_t transitions;
+};
+
+/** @cond INTERNAL_HIDDEN */
+struct fsm_event {
+	uint8_t event;
+	/* Visit of a timeout event, stale after a transition */
+	uint8_t timeout;
+	uint16_t visit;
+};
+/** @endcond */
+
+/** @brief State machine, statically allocated by the caller. */
+struct fsm {
+	/** @cond INTERNAL_HIDDEN */
+	struct fsm_config cfg;
+	struct k_msgq queue;
+	char buf[CONFIG_FSM_QUEUE_LEN * sizeof(struct fsm_event)];
+	struct k_timer timer;
+	struct k_spinlock lock;
+	uint8_t state;
+	bool started;
+	uint16_t visit;
+	int64_t entered;
+	struct fsm_stats stats;
+	struct fsm_state_stats *state_stats;
+	/** @endcond */
+};
+
+/**
+ * @brief Initialize a state machine.
+ *
+ * Checks that every transition and timeout stays within the tables. The
+ * machine is in no state until fsm_start().
+ *
+ * @param fsm State machine.
+ * @param cfg Configuration, copied. The tables are referenced.
+ * @param state_stats Array of @p cfg num_states statistics, for the dwell
+ *        times of the states.
+ *
+ * @retval 0 if successful.
+ * @retval -EINVAL if the configuration or the tables are invalid.
+ */
+int fsm_init(struct fsm *fsm, const struct fsm_config *cfg,
+	     struct fsm_state_stats *state_stats);
+
+/**
+ * @brief Enter the initial state.
+ *
+ * Drops the pending events and runs the entry action of the initial state,
+ * from the calling thread. Restarts a running machine without running the
+ * exit action of its state.
+ *
+ * @param fsm State machine.
+ */
+void fsm_start(struct fsm *fsm);
+
+/**
+ * @brief Leave the current state, without running its exit action.
+ *
+ * Stops the timeout and drops the pending events. The machine is in no
+ * state until the next fsm_start(), events are not queued meanwhile. Must
+ * be called before initializing a started machine again.
+ *
+ * @param fsm State machine.
+ */
+void fsm_stop(struct fsm *fsm);
+
+/**
+ * @brief Post an event.
+ *
+ * Can be called from an interrupt handler.
+ *
+ * @param fsm State machine.
+ * @param event Event.
+ *
+ * @retval 0 if the event was queued.
+ * @retval -EINVAL if the event is out of range.
+ * @retval -EPERM if the machine is stopped.
+ * @retval -ENOSPC if the queue is full.
+ */
+int fsm_post(struct fsm *fsm, uint8_t event);
+
+/**
+ * @brief Wait for an event and dispatch it.
+ *
+ * Runs the actions of the transition, if the current state handles the
+ * event. Called in a loop by the thread owning the machine.
+ *
+ * @param fsm State machine.
+ * @param timeout Time to wait for an event.
+ *
+ * @retval 0 if an event was dispatched, handled or not.
+ * @retval -EAGAIN if no event arrived in time.
+ */
+int fsm_process(struct fsm *fsm, k_timeout_t timeout);
+
+/**
+ * @brief Get the current state.
+ *
+ * @param fsm State machine.
+ *
+ * @return Current state.
+ */
+uint8_t fsm_state_get(struct fsm *fsm);
+
+/**
+ * @brief Get the user data of the configuration, from an action.
+ *
+ * @param fsm State machine.
+ *
+ * @return User data.
+ */
+static inline void *fsm_user_data(struct fsm *fsm)
+{
+	return fsm->cfg.user_data;
+}
+
+/**
+ * @brief Get and optionally reset the statistics of a state machine.
+ *
+ * @param fsm State machine.
+ * @param stats Destination of the machine statistics, may be NULL.
+ * @param state_stats Destination of the num_states state statistics, may
+ *        be NULL.
+ * @param reset Clear the statistics after reading them.
+ */
+void fsm_stats_get(struct fsm *fsm, struct fsm_stats *stats,
+		   struct fsm_state_stats *state_stats, bool reset);
+
+/**
+ * @brief Log the dwell times of the states.
+ *
+ * Logs the visits, the mean and longest dwell time and the share of the
+ * total time of every visited state, marking the state taking most of it.
+ *
+ * @param fsm State machine.
+ */
+void fsm_report(struct fsm *fsm);
+
+/** @} */
+
+#endif /* APP_LIB_FSM_H_ */
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2025 Jared Woolston
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef APP_LIB_IMU_FUSION_H_
+#define APP_LIB_IMU_FUSION_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <zephyr/dsp/types.h>
+
+/**
+ * @defgroup lib_imu_fusion IMU orientation fusion library
+ * @ingroup lib
+ * @{
+ *
+ * @brief Fixed-point Mahony orientation filter.
+ *
+ * Fuses gyroscope and accelerometer samples into an orientation quaternion
+ * using integer arithmetic only. Samples are consumed in blocks of q31
+ * values as produced by the IMU batch conversion, one filter step per
+ * sample. The gyroscope bias is compensated as a linear function of the die
+ * temperature, updated once per block rather than per sample.
+ *
+ * Unless stated otherwise, values are Q16.16: angles in rad, rates in rad/s,
+ * accelerations in m/s^2 and temperatures in degC.
+ */
+
+/** @brief Q16.16 representation of @p x. */
+#define IMU_FUSION_Q16(x) ((int32_t)((x) * 65536.0))
+
+/** @brief Filter configuration. */
+struct imu_fusion_config {
+	/** Sample rate in Hz. */
+	uint32_t rate_hz;
+	/** Proportional gain of the accelerometer correction. */
+	int32_t kp;
+	/** Integral gain of the accelerometer correction. */
+	int32_t ki;
+	/** Anti-windup limit of the integral term, in rad/s. */
+	int32_t integral_limit;
+	/**
+	 * Accelerometer samples whose magnitude differs from 1 g by more than
+	 * this, in m/s^2, are not used for correction. 0 disables gating.
+	 */
+	int32_t accel_gate;
+	/** Gyroscope bias at @ref temp_ref, in rad/s. */
+	int32_t gyro_bias[3];
+	/**
+	 * Gyroscope bias temperature coefficient, in urad/s/degC. Integer
+	 * rather than Q16.16 as typical coefficients are only a few LSB of
+	 * Q16.16.
+	 */
+	int32_t gyro_tempco[3];
+	/** Reference temperature of @ref gyro_bias. */
+	int32_t temp_ref;
+};
+
+/** @brief Filter state. */
+struct imu_fusion {
+	/** @cond INTERNAL_HIDDEN */
+	struct imu_fusion_config cfg;
+	int32_t q[4];
+	int32_t integral[3];
+	int32_t bias[3];
+	int32_t half_dt;
+	int64_t ki_dt;
+	bool aligned;
+	/** @endcond */
+};
+
+/** @brief Orientation as Euler angles and tilt. */
+struct imu_fusion_euler {
+	/** Rotation about x. */
+	int32_t roll;
+	/** Rotation about y. */
+	int32_t pitch;
+	/** Rotation about z. */
+	int32_t yaw;
+	/** Angle between the sensor z axis and the vertical. */
+	int32_t tilt;
+};
+
+/**
+ * @brief Initialize a filter.
+ *
+ * The orientation is aligned to gravity on the first usable accelerometer
+ * sample, or stays at identity if accelerometer correction is disabled. The
+ * gyroscope bias is set for @ref imu_fusion_config.temp_ref.
+ *
+ * @param f Filter state.
+ * @param cfg Filter configuration, copied.
+ *
+ * @retval 0 if successful.
+ * @retval -EINVAL if the configuration is invalid.
+ */
+int imu_fusion_init(struct imu_fusion *f, const struct imu_fusion_config *cfg);
+
+/**
+ * @brief Update the gyroscope bias for a new die temperature.
+ *
+ * @param f Filter state.
+ * @param temp Die temperature.
+ */
+void imu_fusion_set_temperature(struct imu_fusion *f, int32_t temp);
+
+/**
+ * @brief Run the filter over a block of samples.
+ *
+ * @p gyro and @p acc hold @p count samples taken at the configured rate,
+ * represented as value = q31 * 2^shift / 2^31.
+ *
+ * @param f Filter state.
+ * @param gyro Gyroscope samples in rad/s.
+ * @param gyro_shift Shift of @p gyro, at most 15.
+ * @param acc Accelerometer samples in m/s^2.
+ * @param acc_shift Shift of @p acc, at most 15.
+ * @param count Number of samples.
+ */
+void imu_fusion_update(struct imu_fusion *f,
+		       const q31_t (*gyro)[3], int8_t gyro_shift,
+		       const q31_t (*acc)[3], int8_t acc_shift,
+		       size_t count);
+
+/**
+ * @brief Get the orientation quaternion.
+ *
+ * @param f Filter state.
+ * @param q Destination of w, x, y, z in Q2.30.
+ */
+void imu_fusion_quaternion_get(const struct imu_fusion *f, int32_t q[4]);
+
+/**
+ * @brief Get the orientation as Euler angles.
+ *
+ * @param f Filter state.
+ * @param euler Destination of the angles.
+ */
+void imu_fusion_euler_get(const struct imu_fusion *f,
+			  struct imu_fusion_euler *euler);
+
+/** @} */
+
+#endif /* APP_LIB_IMU_FUSION_H_ */
@@ -0,0 +1,367 @@
+/*
+ * Copyright (c) 2025 Jared Woolston
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef APP_LIB_MOTOR_CTRL_H_
+#define APP_LIB_MOTOR_CTRL_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <zephyr/device.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/slist.h>
+
+#include <app/lib/pid.h>
+#include <app/lib/profile.h>
+
+/**
+ * @defgroup lib_motor_ctrl Closed-loop motor control library
+ * @ingroup lib
+ * @{
+ *
+ * @brief Speed and position control of motor channels with encoder feedback.
+ *
+ * Every controller closes the loop around one channel of a motor driver,
+ * see @ref drivers_motor, with the count of a quadrature encoder on the
+ * motor shaft, or with the speed estimated from the back-EMF by the motor
+ * driver, see motor_ctrl_emf_read(). All controllers run from a single
+ * cooperative thread, woken
+ * by a kernel timer at @kconfig{CONFIG_MOTOR_CTRL_RATE_HZ}.
+ *
+ * In speed mode a PID controller turns the speed error into a duty cycle.
+ * In position mode a second PID controller, limited to the maximum speed,
+ * turns the position error into the setpoint of the speed controller. The
+ * speed is the count difference of every period, low pass filtered. Moves
+ * follow a motion profile, see @ref lib_profile, the position loop tracking
+ * its setpoints with the profile speed fed forward.
+ *
+ * The interval between loop iterations, the delay from the timer to the
+ * loop and the CPU time of the iterations are measured in hardware cycles.
+ * The iterations are counted, a time base common to all controllers, and
+ * hooks run at every iteration before the controllers.
+ */
+
+/** @brief Operating modes of a controller. */
+enum motor_ctrl_mode {
+	/** Loop open, the motor coasts. */
+	MOTOR_CTRL_MODE_OFF,
+	/** Speed control. */
+	MOTOR_CTRL_MODE_SPEED,
+	/** Position control. */
+	MOTOR_CTRL_MODE_POSITION,
+	/** Position control along a motion profile. */
+	MOTOR_CTRL_MODE_MOVE,
+};
+
+/** @brief Loops of a controller, for the gains. */
+enum motor_ctrl_loop {
+	/** Speed error in counts/s to duty cycle. */
+	MOTOR_CTRL_LOOP_SPEED,
+	/** Position error in counts to speed in counts/s. */
+	MOTOR_CTRL_LOOP_POSITION,
+};
+
+/**
+ * @brief Encoder read function.
+ *
+ * Called from the control thread at every iteration, it must not block.
+ * The count may wrap around at 32 bits.
+ *
+ * @param user_data User data of the configuration.
+ * @param count Destination of the encoder count.
+ *
+ * @return 0 if successful, negative errno code on failure.
+ */
+typedef int (*motor_ctrl_encoder_t)(void *user_data, int32_t *count);
+
+/**
+ * @brief Back-EMF speed feedback of a channel, in place of an encoder.
+ *
+ * Used as the user data of motor_ctrl_emf_read().
+ */
+struct motor_ctrl_emf {
+	/** Motor driver device, sensing the back-EMF of @ref channel. */
+	const struct device *motor;
+	/** Motor channel. */
+	uint8_t channel;
+	/** Speed per volt of back-EMF, in counts/s. */
+	int32_t counts_per_volt;
+	/** @cond INTERNAL_HIDDEN */
+	bool started;
+	uint32_t cycles;
+	int32_t count;
+	int64_t rem;
+	/** @endcond */
+};
+
+/** @brief Controller configuration. */
+struct motor_ctrl_config {
+	/** Motor driver device. */
+	const struct device *motor;
+	/** Motor channel. */
+	uint8_t channel;
+	/** Encoder read function, counting up in the forward direction. */
+	motor_ctrl_encoder_t encoder;
+	/** Opaque pointer passed to @ref encoder. */
+	void *user_data;
+	/** Initial gains of the speed loop. */
+	struct pid_gains speed_gains;
+	/** Initial gains of the position loop. */
+	struct pid_gains position_gains;
+	/** Speed limit in position mode, in counts/s. */
+	int32_t max_speed;
+	/** Speed low pass time constant, in 2^n periods. */
+	uint8_t speed_filter_shift;
+	/**
+	 * Motion profile of motor_ctrl_move(), the rate is the loop rate. One
+	 * half of the table holds the move in progress, the other the next
+	 * one while it is planned. A NULL table disables moves.
+	 */
+	struct profile_config profile;
+};
+
+/** @brief Controller state. */
+struct motor_ctrl_state {
+	/** Operating mode. */
+	enum motor_ctrl_mode mode;
+	/** Position in counts since initialization. */
+	int32_t position;
+	/** Filtered speed in counts/s. */
+	int32_t speed;
+	/** Duty cycle, negative in reverse, see @ref MOTOR_SPEED_MAX. */
+	int32_t duty;
+	/** The last move took its first step, @ref move_start is valid. */
+	bool move_started;
+	/** The last move reached its target, @ref move_end is valid. */
+	bool move_done;
+	/** Loop tick of the first step of the last move. */
+	uint32_t move_start;
+	/** Loop tick following the last step of the last move. */
+	uint32_t move_end;
+};
+
+/** @brief Controller statistics, in hardware cycles. */
+struct motor_ctrl_stats {
+	/** Number of iterations. */
+	uint32_t count;
+	/** Number of failed encoder reads or motor updates. */
+	uint32_t errors;
+	/** CPU time of the last iteration. */
+	uint32_t cpu_last;
+	/** Maximum CPU time of an iteration. */
+	uint32_t cpu_max;
+	/** Sum of the CPU times. */
+	uint64_t cpu_sum;
+};
+
+/** @brief Control loop statistics, in hardware cycles. */
+struct motor_ctrl_loop_stats {
+	/** Number of iterations. */
+	uint32_t count;
+	/** Number of periods missed because the loop was still busy. */
+	uint32_t overruns;
+	/** Shortest interval between iterations. */
+	uint32_t interval_min;
+	/** Longest interval between iterations. */
+	uint32_t interval_max;
+	/** Maximum delay from the timer to the start of an iteration. */
+	uint32_t latency_max;
+	/** CPU time of the last iteration, all controllers. */
+	uint32_t cpu_last;
+	/** Maximum CPU time of an iteration. */
+	uint32_t cpu_max;
+	/** Sum of the CPU times. */
+	uint64_t cpu_sum;
+};
+
+/** @brief Hook run at every iteration of the control loop. */
+struct motor_ctrl_hook {
+	/**
+	 * Called from the control thread before the controllers run, it must
+	 * not block.
+	 *
+	 * @param hook The hook.
+	 * @param tick Iteration count, see motor_ctrl_tick_get().
+	 */
+	void (*fn)(struct motor_ctrl_hook *hook, uint32_t tick);
+	/** @cond INTERNAL_HIDDEN */
+	sys_snode_t node;
+	/** @endcond */
+};
+
+/** @brief Controller. */
+struct motor_ctrl {
+	/** @cond INTERNAL_HIDDEN */
+	sys_snode_t node;
+	struct motor_ctrl_config cfg;
+	struct pid speed_pid;
+	struct pid position_pid;
+	struct profile profile[2];
+	uint8_t active;
+	atomic_t planning;
+	uint32_t runs;
+	enum motor_ctrl_mode mode;
+	enum motor_ctrl_mode applied_mode;
+	bool reset;
+	int32_t target;
+	int32_t count;
+	int32_t position;
+	int32_t speed_q8;
+	int32_t duty;
+	bool move_started;
+	bool move_done;
+	uint32_t move_start;
+	uint32_t move_end;
+	struct motor_ctrl_stats stats;
+	/** @endcond */
+};
+
+/**
+ * @brief Initialize a controller and add it to the control loop.
+ *
+ * The controller starts in @ref MOTOR_CTRL_MODE_OFF, at position 0.
+ *
+ * @param ctrl Controller.
+ * @param cfg Configuration, copied.
+ *
+ * @retval 0 if successful.
+ * @retval -EINVAL if the configuration is invalid.
+ * @retval -ENODEV if the motor is not ready.
+ * @retval -errno Negative errno code of the first encoder read.
+ */
+int motor_ctrl_init(struct motor_ctrl *ctrl, const struct motor_ctrl_config *cfg);
+
+/**
+ * @brief Encoder read function of back-EMF speed feedback.
+ *
+ * Integrates the speed estimate of the motor driver, see motor_status_get(),
+ * into a count. Set it as the encoder with a @ref motor_ctrl_emf as the
+ * user data. Position control drifts without a real encoder, speed control
+ * is what it is for.
+ *
+ * @param user_data Back-EMF feedback, @ref motor_ctrl_emf.
+ * @param count Destination of the count.
+ *
+ * @retval 0 if successful.
+ * @retval -ENOTSUP if the channel does not sense its back-EMF.
+ * @retval -errno Negative errno code of motor_status_get().
+ */
+int motor_ctrl_emf_read(void *user_data, int32_t *count);
+
+/**
+ * @brief Run at a speed.
+ *
+ * @param ctrl Controller.
+ * @param speed Speed in counts/s, negative in reverse.
+ */
+void motor_ctrl_speed_set(struct motor_ctrl *ctrl, int32_t speed);
+
+/**
+ * @brief Move to and hold a position.
+ *
+ * @param ctrl Controller.
+ * @param position Position in counts.
+ */
+void motor_ctrl_position_set(struct motor_ctrl *ctrl, int32_t position);
+
+/**
+ * @brief Move to a position along a motion profile, then hold it.
+ *
+ * The move starts from the current position and speed, or blends into the
+ * move in progress. Planning runs in the caller, beside the move in
+ * progress, the control loop is only held off to swap the new move in. It
+ * then skips the setpoints of the iterations that ran meanwhile. The loop
+ * ticks of its first step and of its end are in motor_ctrl_state_get().
+ *
+ * @param ctrl Controller.
+ * @param position Position in counts.
+ * @param duration_ms Duration of the move, 0 for as fast as possible.
+ *
+ * @retval 0 if successful.
+ * @retval -ENOTSUP if the controller has no motion profile.
+ * @retval -EBUSY if another move of the controller is being planned.
+ * @retval -EAGAIN if the controller entered or left a move while planning,
+ *         the move was not started.
+ * @retval -errno Negative errno code of profile_move(), the controller
+ *         keeps its mode and setpoint.
+ */
+int motor_ctrl_move(struct motor_ctrl *ctrl, int32_t position, uint32_t duration_ms);
+
+/**
+ * @brief Open the loop and let the motor coast.
+ *
+ * @param ctrl Controller.
+ */
+void motor_ctrl_stop(struct motor_ctrl *ctrl);
+
+/**
+ * @brief Change the gains of a loop while running.
+ *
+ * @param ctrl Controller.
+ * @param loop Loop.
+ * @param gains New gains.
+ */
+void motor_ctrl_gains_set(struct motor_ctrl *ctrl, enum motor_ctrl_loop loop,
+			  const struct pid_gains *gains);
+
+/**
+ * @brief Get the gains of a loop.
+ *
+ * @param ctrl Controller.
+ * @param loop Loop.
+ * @param gains Destination of the gains.
+ */
+void motor_ctrl_gains_get(struct motor_ctrl *ctrl, enum motor_ctrl_loop loop,
+			  struct pid_gains *gains);
+
+/**
+ * @brief Get the state of a controller.
+ *
+ * @param ctrl Controller.
+ * @param state Destination of the state.
+ */
+void motor_ctrl_state_get(struct motor_ctrl *ctrl, struct motor_ctrl_state *state);
+
+/**
+ * @brief Get and optionally reset the statistics of a controller.
+ *
+ * @param ctrl Controller.
+ * @param stats Destination of the statistics.
+ * @param reset Clear the statistics after reading them.
+ */
+void motor_ctrl_stats_get(struct motor_ctrl *ctrl, struct motor_ctrl_stats *stats,
+			  bool reset);
+
+/**
+ * @brief Get and optionally reset the statistics of the control loop.
+ *
+ * The difference of the longest and shortest interval is the period
+ * jitter.
+ *
+ * @param stats Destination of the statistics.
+ * @param reset Clear the statistics after reading them.
+ */
+void motor_ctrl_loop_stats_get(struct motor_ctrl_loop_stats *stats, bool reset);
+
+/**
+ * @brief Get the iteration count of the control loop.
+ *
+ * Counts at @kconfig{CONFIG_MOTOR_CTRL_RATE_HZ} and wraps around at 32 bits.
+ * The iteration in progress when called from a hook or an encoder.
+ *
+ * @return Iteration count.
+ */
+uint32_t motor_ctrl_tick_get(void);
+
+/**
+ * @brief Add a hook to the control loop.
+ *
+ * @param hook Hook, with its function set. It runs from the next iteration.
+ */
+void motor_ctrl_hook_add(struct motor_ctrl_hook *hook);
+
+/** @} */
+
+#endif /* APP_LIB_MOTOR_CTRL_H_ */
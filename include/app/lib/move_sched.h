@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2025 Jared Woolston
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef APP_LIB_MOVE_SCHED_H_
+#define APP_LIB_MOVE_SCHED_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/spinlock.h>
+
+#include <app/lib/motor_ctrl.h>
+
+/**
+ * @defgroup lib_move_sched Multi-axis move scheduler
+ * @ingroup lib
+ * @{
+ *
+ * @brief Coordinated moves of several controllers on the control loop tick.
+ *
+ * Segments are queued with a start tick of the control loop, see
+ * motor_ctrl_tick_get(), and a target position for some of the axes. A
+ * hook of the loop starts each segment at its tick, planning the moves of
+ * all its axes in the same iteration with the same duration, before any
+ * controller runs. The axes then step their profiles on the same ticks and
+ * start and end together, whatever the number of motor driver instances.
+ *
+ * The moves of the last segment started are measured in loop ticks, once
+ * they all ended: the spread of their first steps and of their ends, and
+ * their delays after the start tick of the segment and, with a duration,
+ * after its end. A segment started meanwhile replaces the measured one, an
+ * axis stopped or retargeted out of its move is left out.
+ */
+
+/** @brief Move segment. */
+struct move_sched_seg {
+	/** Control loop tick to start at, may wrap around. */
+	uint32_t start;
+	/**
+	 * Duration of the moves in ms, for all the axes to end together. 0
+	 * for each as fast as possible.
+	 */
+	uint32_t duration_ms;
+	/** Bit mask of the axes moving, the others keep going. */
+	uint32_t axes;
+	/** Target position of each moving axis, in counts. */
+	int32_t position[CONFIG_MOVE_SCHED_MAX_AXES];
+};
+
+/** @brief Scheduler configuration. */
+struct move_sched_config {
+	/** Controllers of the axes, initialized. */
+	struct motor_ctrl *const *axes;
+	/** Number of @ref axes. */
+	uint8_t num_axes;
+};
+
+/** @brief Scheduler statistics. */
+struct move_sched_stats {
+	/** Segments started. */
+	uint32_t segments;
+	/** Moves refused by a controller, the other axes still moved. */
+	uint32_t errors;
+	/** Segments started after their tick. */
+	uint32_t late;
+	/** Longest delay of a late segment, in ticks. */
+	uint32_t late_max;
+	/** Segments measured, all their moves ended. */
+	uint32_t measured;
+	/** Spread of the first steps of the last measured segment, in ticks. */
+	uint32_t start_skew_last;
+	/** Largest spread of the first steps, in ticks. */
+	uint32_t start_skew_max;
+	/** Spread of the ends of the last measured segment, in ticks. */
+	uint32_t end_skew_last;
+	/** Largest spread of the ends, in ticks. */
+	uint32_t end_skew_max;
+	/** Longest delay of a first step after the start tick, in ticks. */
+	uint32_t start_delay_max;
+	/**
+	 * Longest delay of an end after the start tick plus the duration, in
+	 * ticks. Only segments with a duration count.
+	 */
+	uint32_t end_delay_max;
+};
+
+/** @brief Scheduler. */
+struct move_sched {
+	/** @cond INTERNAL_HIDDEN */
+	struct motor_ctrl_hook hook;
+	struct move_sched_config cfg;
+	struct k_spinlock lock;
+	struct k_msgq queue;
+	char buf[CONFIG_MOVE_SCHED_QUEUE_LEN * sizeof(struct move_sched_seg)];
+	struct move_sched_seg next;
+	bool pending;
+	bool queued;
+	uint32_t last_start;
+	uint32_t measure;
+	uint32_t measure_start;
+	uint32_t measure_ticks;
+	struct move_sched_stats stats;
+	/** @endcond */
+};
+
+/**
+ * @brief Initialize a scheduler and hook it to the control loop.
+ *
+ * The scheduler cannot be removed from the loop, keep it static.
+ *
+ * @param ms Scheduler.
+ * @param cfg Configuration, copied. The axes array is referenced.
+ *
+ * @retval 0 if successful.
+ * @retval -EINVAL if the configuration is invalid.
+ */
+int move_sched_init(struct move_sched *ms, const struct move_sched_config *cfg);
+
+/**
+ * @brief Queue a segment.
+ *
+ * Segments start in queue order. One starting after its tick, because the
+ * queue was filled too late, starts at the next tick and counts as late.
+ *
+ * @param ms Scheduler.
+ * @param seg Segment, copied.
+ *
+ * @retval 0 if successful.
+ * @retval -EINVAL if the segment has no axis, an unknown axis or starts
+ *         before the previous one.
+ * @retval -ENOSPC if the queue is full.
+ */
+int move_sched_queue(struct move_sched *ms, const struct move_sched_seg *seg);
+
+/**
+ * @brief Drop the queued segments.
+ *
+ * The moves already started keep going.
+ *
+ * @param ms Scheduler.
+ */
+void move_sched_flush(struct move_sched *ms);
+
+/**
+ * @brief Get the statistics of a scheduler.
+ *
+ * @param ms Scheduler.
+ * @param stats Destination of the statistics.
+ * @param reset Reset the statistics after reading.
+ */
+void move_sched_stats_get(struct move_sched *ms, struct move_sched_stats *stats,
+			  bool reset);
+
+/** @} */
+
+#endif /* APP_LIB_MOVE_SCHED_H_ */
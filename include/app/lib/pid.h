@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2025 Jared Woolston
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef APP_LIB_PID_H_
+#define APP_LIB_PID_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @defgroup lib_pid Fixed-point PID controller library
+ * @ingroup lib
+ * @{
+ *
+ * @brief Integer PID controller for fixed rate control loops.
+ *
+ * Gains are Q16.16 and per update, i.e. the integral gain includes the loop
+ * period and the derivative gain its inverse. The integrator accumulates
+ * the integral gain times the error rather than the error, so changing the
+ * gains while running does not make the output jump.
+ *
+ * Two measures keep the integrator from winding up while the output is
+ * saturated: the integrator is clamped to the output limits, and it stops
+ * integrating an error which would drive the output further into the limit.
+ *
+ * The derivative acts on the measurement rather than on the error, so
+ * setpoint steps do not kick the output, and can be low pass filtered.
+ *
+ * An update costs a few 32x32 multiplies and no division.
+ */
+
+/** @brief One in the Q16.16 gains. */
+#define PID_GAIN_ONE (1 << 16)
+
+/** @brief Controller gains, Q16.16 per update. */
+struct pid_gains {
+	/** Proportional gain. */
+	int32_t kp;
+	/** Integral gain, times the update period. */
+	int32_t ki;
+	/** Derivative gain, divided by the update period. */
+	int32_t kd;
+};
+
+/** @brief Controller configuration. */
+struct pid_config {
+	/** Initial gains. */
+	struct pid_gains gains;
+	/** Lowest output. */
+	int32_t out_min;
+	/** Highest output. */
+	int32_t out_max;
+	/** Derivative low pass time constant, in 2^n updates, 0 for none. */
+	uint8_t d_filter_shift;
+};
+
+/** @brief Controller state. */
+struct pid {
+	/** @cond INTERNAL_HIDDEN */
+	struct pid_config cfg;
+	int64_t integ;
+	int64_t deriv;
+	int32_t prev;
+	bool primed;
+	/** @endcond */
+};
+
+/**
+ * @brief Initialize a controller.
+ *
+ * @param pid Controller state.
+ * @param cfg Configuration, copied.
+ *
+ * @retval 0 if successful.
+ * @retval -EINVAL if the configuration is invalid.
+ */
+int pid_init(struct pid *pid, const struct pid_config *cfg);
+
+/**
+ * @brief Clear the integrator and derivative history.
+ *
+ * @param pid Controller state.
+ */
+void pid_reset(struct pid *pid);
+
+/**
+ * @brief Change the gains of a running controller.
+ *
+ * The integrator is kept, the output does not jump.
+ *
+ * @param pid Controller state.
+ * @param gains New gains.
+ */
+void pid_gains_set(struct pid *pid, const struct pid_gains *gains);
+
+/**
+ * @brief Get the gains of a controller.
+ *
+ * @param pid Controller state.
+ * @param gains Destination of the gains.
+ */
+void pid_gains_get(const struct pid *pid, struct pid_gains *gains);
+
+/**
+ * @brief Run one controller update.
+ *
+ * @param pid Controller state.
+ * @param setpoint Setpoint.
+ * @param measurement Measurement, in the units of the setpoint.
+ *
+ * @return Output, between the configured limits.
+ */
+int32_t pid_update(struct pid *pid, int32_t setpoint, int32_t measurement);
+
+/** @} */
+
+#endif /* APP_LIB_PID_H_ */
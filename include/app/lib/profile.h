@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2025 Jared Woolston
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef APP_LIB_PROFILE_H_
+#define APP_LIB_PROFILE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @defgroup lib_profile Motion profile library
+ * @ingroup lib
+ * @{
+ *
+ * @brief Trapezoidal and jerk limited motion profiles for fixed rate loops.
+ *
+ * A move is planned once, from the current position and speed to a target
+ * position, within speed, acceleration and, for S-curves, jerk limits. The
+ * speed ramps up to a cruise speed, cruises and ramps down to rest. S-curve
+ * ramps start and end with a constant jerk phase, so the acceleration has no
+ * steps either.
+ *
+ * Planning fills a table with the position increment of every tick of the
+ * two ramps. Each tick then costs a table read and an addition, the cruise
+ * needs no table. Positions are accumulated in 1/65536 counts and the last
+ * tick lands exactly on the target.
+ *
+ * A move can finish as fast as the limits allow or at a given time, by
+ * lowering the cruise speed. Planning a move while one is running blends
+ * into it from the current position and speed, reversing smoothly if the
+ * new target is behind the stopping point. An S-curve first finishes the
+ * ramp in progress, where the acceleration is back to zero, and blends from
+ * its end.
+ *
+ * Planning is integer arithmetic, linear in the ramp length. To keep it out
+ * of the loop, a move can be planned in a copy of the running profile, with
+ * its own table, and swapped in, see profile_copy().
+ */
+
+/** @brief Profile shapes. */
+enum profile_shape {
+	/** Constant acceleration ramps. */
+	PROFILE_TRAPEZOID,
+	/** Jerk limited ramps. */
+	PROFILE_SCURVE,
+};
+
+/** @brief Profile configuration. */
+struct profile_config {
+	/** Tick rate in Hz. */
+	uint32_t rate_hz;
+	/** Ramp shape. */
+	enum profile_shape shape;
+	/** Speed limit in counts/s. */
+	int32_t max_speed;
+	/** Acceleration limit in counts/s^2. */
+	int32_t max_accel;
+	/** Jerk limit in counts/s^3, for @ref PROFILE_SCURVE. */
+	int32_t max_jerk;
+	/** Ramp table, one entry per ramp tick. */
+	int32_t *table;
+	/**
+	 * Number of entries of @ref table, bounding the ramp durations. An
+	 * S-curve blend also keeps the rest of the ramp in progress.
+	 */
+	size_t table_len;
+};
+
+/** @brief Setpoint of one tick. */
+struct profile_point {
+	/** Position in counts. */
+	int32_t position;
+	/** Speed in counts/s. */
+	int32_t speed;
+};
+
+/** @brief Profile state. */
+struct profile {
+	/** @cond INTERNAL_HIDDEN */
+	struct profile_config cfg;
+	int64_t pos;
+	int32_t target;
+	int32_t inc;
+	int32_t cruise_inc;
+	/* Ticks and end increment of: rest of a ramp, accel, cruise, decel */
+	uint32_t seg_ticks[4];
+	int32_t seg_end[4];
+	uint32_t seg;
+	uint32_t tick;
+	uint32_t index;
+	uint32_t remaining;
+	/** @endcond */
+};
+
+/**
+ * @brief Initialize a profile, at rest.
+ *
+ * @param p Profile state.
+ * @param cfg Configuration, copied.
+ * @param position Initial position in counts.
+ *
+ * @retval 0 if successful.
+ * @retval -EINVAL if the configuration is invalid.
+ */
+int profile_init(struct profile *p, const struct profile_config *cfg,
+		 int32_t position);
+
+/**
+ * @brief Plan a move.
+ *
+ * @param p Profile state.
+ * @param from Start position and speed, NULL to start from the current
+ *        setpoint of @p p and blend into its move.
+ * @param target Target position in counts.
+ * @param duration_ms Duration of the move, 0 for as fast as possible.
+ *
+ * @retval 0 if successful.
+ * @retval -ERANGE if the move cannot finish within @p duration_ms, or the
+ *         start speed exceeds the speed limit.
+ * @retval -ENOMEM if the ramps do not fit the table.
+ */
+int profile_move(struct profile *p, const struct profile_point *from,
+		 int32_t target, uint32_t duration_ms);
+
+/**
+ * @brief Copy a profile into another one with its own table.
+ *
+ * The state and the rest of the ramps of the move in progress are copied,
+ * so that @p dst continues the move of @p src tick for tick, and a blend
+ * can be planned in @p dst while @p src keeps running. @p src is only
+ * read.
+ *
+ * @param dst Destination profile, initialized with the configuration of
+ *        @p src but another table of the same length.
+ * @param src Source profile.
+ */
+void profile_copy(struct profile *dst, const struct profile *src);
+
+/**
+ * @brief Advance by one tick.
+ *
+ * @param p Profile state.
+ * @param pt Destination of the setpoint of this tick.
+ *
+ * @retval true while the move runs, including its last tick.
+ * @retval false at rest on the target.
+ */
+bool profile_next(struct profile *p, struct profile_point *pt);
+
+/**
+ * @brief Get the current setpoint, without advancing.
+ *
+ * @param p Profile state.
+ * @param pt Destination of the setpoint.
+ */
+void profile_point_get(const struct profile *p, struct profile_point *pt);
+
+/**
+ * @brief Get the number of ticks left in the move.
+ *
+ * @param p Profile state.
+ *
+ * @return Remaining ticks, 0 at rest.
+ */
+uint32_t profile_remaining(const struct profile *p);
+
+/** @} */
+
+#endif /* APP_LIB_PROFILE_H_ */
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2025 Jared Woolston
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef APP_LIB_SENSOR_EVENT_H_
+#define APP_LIB_SENSOR_EVENT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <zephyr/sys/slist.h>
+
+/**
+ * @defgroup lib_sensor_event Shared sensor event loop
+ * @ingroup lib
+ * @{
+ *
+ * @brief One thread running the interrupt bottom halves of all sensors.
+ *
+ * Drivers embed a @ref sensor_event in their data, post it from their
+ * interrupt handler and get their handler called from a single cooperative
+ * thread. Pending events are dispatched by priority, 0 first, and in post
+ * order within a priority. Posting an event that is already pending is
+ * coalesced into the pending one.
+ *
+ * The delay from post to handler entry is measured for every event in
+ * hardware cycles.
+ */
+
+struct sensor_event;
+
+/**
+ * @brief Event handler, called from the event loop thread.
+ *
+ * @param evt Posted event.
+ */
+typedef void (*sensor_event_handler_t)(struct sensor_event *evt);
+
+/** @brief Event statistics, in hardware cycles. */
+struct sensor_event_stats {
+	/** Number of dispatches. */
+	uint32_t count;
+	/** Number of posts coalesced into a pending event. */
+	uint32_t coalesced;
+	/** Post to handler delay of the last dispatch. */
+	uint32_t latency_last;
+	/** Maximum post to handler delay. */
+	uint32_t latency_max;
+	/** Sum of the post to handler delays. */
+	uint64_t latency_sum;
+};
+
+/** @brief Event, embedded in the driver data. */
+struct sensor_event {
+	/** @cond INTERNAL_HIDDEN */
+	sys_snode_t node;
+	sensor_event_handler_t handler;
+	uint8_t prio;
+	bool pending;
+	uint32_t post_cycles;
+	struct sensor_event_stats stats;
+	/** @endcond */
+};
+
+/**
+ * @brief Initialize an event.
+ *
+ * @param evt Event.
+ * @param handler Handler run by the event loop.
+ * @param prio Priority, less than @kconfig{CONFIG_SENSOR_EVENT_PRIORITIES}.
+ */
+void sensor_event_init(struct sensor_event *evt, sensor_event_handler_t handler,
+		       uint8_t prio);
+
+/**
+ * @brief Post an event to the loop.
+ *
+ * Can be called from an interrupt handler.
+ *
+ * @param evt Event.
+ *
+ * @retval 0 if the event was queued.
+ * @retval -EALREADY if the event was already pending.
+ */
+int sensor_event_post(struct sensor_event *evt);
+
+/**
+ * @brief Get and optionally reset the statistics of an event.
+ *
+ * @param evt Event.
+ * @param stats Destination of the statistics.
+ * @param reset Clear the statistics after reading them.
+ */
+void sensor_event_stats_get(struct sensor_event *evt,
+			    struct sensor_event_stats *stats, bool reset);
+
+/** @} */
+
+#endif /* APP_LIB_SENSOR_EVENT_H_ */
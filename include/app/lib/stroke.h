@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2025 Jared Woolston
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef APP_LIB_STROKE_H_
+#define APP_LIB_STROKE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @defgroup lib_stroke Press stroke detection library
+ * @ingroup lib
+ * @{
+ *
+ * @brief Streaming press cycle detection from accelerometer samples.
+ *
+ * Samples of the axis along the ram travel are compared against a slowly
+ * tracking baseline, which removes gravity and mounting offsets. A stroke
+ * starts when the deviation from the baseline exceeds an adaptive threshold,
+ * the largest of:
+ *
+ * - the configured minimum,
+ * - a multiple of the average deviation while idle, i.e. the noise level,
+ * - a fraction of the average peak of the previous strokes.
+ *
+ * A stroke ends once the deviation stayed below half the threshold for the
+ * configured quiet time. Its start and end are moved to where the deviation
+ * left and returned to the noise band around the baseline, so the duration
+ * does not depend on the threshold. Strokes shorter than the minimum
+ * duration are discarded as knocks, strokes longer than the maximum are
+ * taken as a change of mounting offset and the baseline restarts.
+ *
+ * Every sample costs a fixed amount of integer arithmetic, no history is
+ * kept.
+ */
+
+/** @brief Detected press stroke. */
+struct stroke_event {
+	/** Number of strokes detected so far, including this one. */
+	uint32_t count;
+	/** Sample index of the start of the stroke. */
+	uint32_t start;
+	/** Stroke duration in samples. */
+	uint32_t samples;
+	/** Stroke duration in milliseconds. */
+	uint32_t duration_ms;
+	/** Peak absolute deviation from the baseline, in raw LSB. */
+	int32_t peak;
+	/** Number of zero crossings of the deviation during the stroke. */
+	uint16_t crossings;
+};
+
+/**
+ * @brief Stroke handler.
+ *
+ * Called from stroke_feed() at the end of every stroke.
+ *
+ * @param evt Detected stroke.
+ * @param user_data User data of the configuration.
+ */
+typedef void (*stroke_handler_t)(const struct stroke_event *evt,
+				 void *user_data);
+
+/** @brief Detector configuration. */
+struct stroke_config {
+	/** Sample rate in Hz. */
+	uint32_t rate_hz;
+	/** Axis along the ram travel, 0 to 2 for x to z. */
+	uint8_t axis;
+	/** Baseline averaging time constant while idle, in 2^n samples. */
+	uint8_t baseline_shift;
+	/** Noise level averaging time constant, in 2^n samples. */
+	uint8_t noise_shift;
+	/** Threshold as a multiple of the noise level, in 1/256. */
+	uint16_t noise_ratio;
+	/** Threshold as a fraction of the average stroke peak, in 1/256. */
+	uint16_t peak_ratio;
+	/** Minimum threshold, in raw LSB. */
+	int32_t min_threshold;
+	/** Quiet time ending a stroke, in milliseconds. */
+	uint16_t quiet_ms;
+	/** Strokes shorter than this are discarded, in milliseconds. */
+	uint16_t min_stroke_ms;
+	/** Strokes longer than this are discarded, in milliseconds. */
+	uint16_t max_stroke_ms;
+	/** Stroke handler, may be NULL. */
+	stroke_handler_t handler;
+	/** Opaque pointer passed to @ref handler. */
+	void *user_data;
+};
+
+/** @brief Detector state. */
+struct stroke {
+	/** @cond INTERNAL_HIDDEN */
+	struct stroke_config cfg;
+	uint32_t quiet_samples;
+	uint32_t min_samples;
+	uint32_t max_samples;
+	int32_t baseline;
+	int32_t noise;
+	int32_t peak_avg;
+	uint32_t n;
+	uint32_t count;
+	uint32_t last_quiet;
+	uint32_t start;
+	uint32_t end;
+	uint32_t below;
+	int32_t peak;
+	int32_t threshold;
+	uint16_t crossings;
+	int8_t sign;
+	bool active;
+	bool settled;
+	bool primed;
+	/** @endcond */
+};
+
+/**
+ * @brief Initialize a detector.
+ *
+ * @param s Detector state.
+ * @param cfg Configuration, copied.
+ *
+ * @retval 0 if successful.
+ * @retval -EINVAL if the configuration is invalid.
+ */
+int stroke_init(struct stroke *s, const struct stroke_config *cfg);
+
+/**
+ * @brief Feed raw accelerometer samples.
+ *
+ * @param s Detector state.
+ * @param acc Raw x/y/z samples, oldest first.
+ * @param count Number of samples.
+ *
+ * @return Number of strokes completed by these samples.
+ */
+int stroke_feed(struct stroke *s, const int16_t (*acc)[3], size_t count);
+
+/**
+ * @brief Get the number of strokes detected so far.
+ *
+ * @param s Detector state.
+ *
+ * @return Stroke count.
+ */
+uint32_t stroke_count(const struct stroke *s);
+
+/** @} */
+
+#endif /* APP_LIB_STROKE_H_ */
@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2025 Jared Woolston
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef APP_LIB_VIBRATION_H_
+#define APP_LIB_VIBRATION_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/dsp/types.h>
+
+/**
+ * @defgroup lib_vibration Vibration spectrum analysis library
+ * @ingroup lib
+ * @{
+ *
+ * @brief Streaming band energy analysis of accelerometer samples.
+ *
+ * Raw accelerometer samples, e.g. IMU FIFO batches, are collected into
+ * blocks of @kconfig{CONFIG_VIBRATION_BLOCK_SIZE} samples of one axis. Each
+ * complete block is handed over to a low priority work queue which removes
+ * the mean, applies a Hann window, runs a q15 real FFT and sums the squared
+ * magnitudes of the bins of every configured band.
+ *
+ * Every band keeps an exponential moving average of its energy as baseline.
+ * A block whose band energy exceeds the baseline by the configured ratio
+ * raises an alarm and does not update the baseline, so a developing fault is
+ * not learned as normal.
+ *
+ * Blocks are normalised before the FFT to make the most of the q15 range.
+ * Energies are scaled back so they are comparable across blocks, but are
+ * otherwise unitless.
+ */
+
+/** @brief Frequency band, bounds included. */
+struct vibration_band {
+	/** Lower bound in Hz. */
+	uint16_t low_hz;
+	/** Upper bound in Hz. */
+	uint16_t high_hz;
+};
+
+/** @brief Band alarm. */
+struct vibration_alarm {
+	/** Index of the band in @ref vibration_config.bands. */
+	uint8_t band;
+	/** Energy of the block. */
+	uint64_t energy;
+	/** Baseline energy of the band. */
+	uint64_t baseline;
+};
+
+struct vibration;
+
+/**
+ * @brief Alarm handler.
+ *
+ * Called from the analysis work queue for every band in alarm, once per
+ * block.
+ *
+ * @param vib Analyser instance.
+ * @param alarm Alarm details.
+ * @param user_data User data of the configuration.
+ */
+typedef void (*vibration_alarm_handler_t)(struct vibration *vib,
+					  const struct vibration_alarm *alarm,
+					  void *user_data);
+
+/** @brief Analyser configuration. */
+struct vibration_config {
+	/** Sample rate in Hz. */
+	uint32_t rate_hz;
+	/** Analysed axis, 0 to 2 for x to z. */
+	uint8_t axis;
+	/** Bands, at most @kconfig{CONFIG_VIBRATION_MAX_BANDS}. */
+	const struct vibration_band *bands;
+	/** Number of bands. */
+	uint8_t num_bands;
+	/** Baseline averaging time constant, in 2^n blocks. */
+	uint8_t baseline_shift;
+	/** Alarm threshold as a ratio to the baseline, in 1/256. */
+	uint16_t alarm_ratio;
+	/** Blocks averaged into the baseline before alarms are raised. */
+	uint16_t warmup_blocks;
+	/** Energies below this never raise an alarm. */
+	uint64_t min_energy;
+	/** Alarm handler, may be NULL. */
+	vibration_alarm_handler_t handler;
+	/** Opaque pointer passed to @ref handler. */
+	void *user_data;
+};
+
+/** @brief Analyser statistics. */
+struct vibration_stats {
+	/** Analysed blocks. */
+	uint32_t blocks;
+	/** Blocks dropped because the previous one was still queued. */
+	uint32_t overruns;
+	/** Cycles spent on the last block. */
+	uint32_t cycles_last;
+	/** Maximum cycles spent on a block. */
+	uint32_t cycles_max;
+};
+
+/** @brief Analyser instance. */
+struct vibration {
+	/** @cond INTERNAL_HIDDEN */
+	struct vibration_config cfg;
+	struct k_work work;
+	q15_t block[2][CONFIG_VIBRATION_BLOCK_SIZE];
+	uint16_t fill;
+	uint8_t active;
+	atomic_t busy;
+	uint16_t bin_low[CONFIG_VIBRATION_MAX_BANDS];
+	uint16_t bin_high[CONFIG_VIBRATION_MAX_BANDS];
+	uint64_t energy[CONFIG_VIBRATION_MAX_BANDS];
+	uint64_t baseline[CONFIG_VIBRATION_MAX_BANDS];
+	struct vibration_stats stats;
+	/** @endcond */
+};
+
+/**
+ * @brief Initialize an analyser.
+ *
+ * @param vib Analyser instance.
+ * @param cfg Configuration, copied. The band array must stay valid.
+ *
+ * @retval 0 if successful.
+ * @retval -EINVAL if the configuration is invalid.
+ */
+int vibration_init(struct vibration *vib, const struct vibration_config *cfg);
+
+/**
+ * @brief Feed raw accelerometer samples.
+ *
+ * Cheap enough to be called from the IMU FIFO handler: samples are only
+ * copied, the analysis runs on the work queue. Must not be called
+ * concurrently for the same instance.
+ *
+ * @param vib Analyser instance.
+ * @param acc Raw x/y/z samples, oldest first.
+ * @param count Number of samples.
+ *
+ * @retval 0 if successful.
+ * @retval -EBUSY if a block was dropped because the analysis lags behind.
+ */
+int vibration_feed(struct vibration *vib, const int16_t (*acc)[3],
+		   size_t count);
+
+/**
+ * @brief Get the band energies of the last block and their baselines.
+ *
+ * Either array may be NULL. Values may mix two blocks if the analysis runs
+ * concurrently, call from the alarm handler for a consistent set.
+ *
+ * @param vib Analyser instance.
+ * @param energy Destination of @ref vibration_config.num_bands energies.
+ * @param baseline Destination of @ref vibration_config.num_bands baselines.
+ */
+void vibration_energy_get(const struct vibration *vib, uint64_t *energy,
+			  uint64_t *baseline);
+
+/**
+ * @brief Get the analyser statistics.
+ *
+ * @param vib Analyser instance.
+ * @param stats Destination of the statistics.
+ */
+void vibration_stats_get(const struct vibration *vib,
+			 struct vibration_stats *stats);
+
+/** @} */
+
+#endif /* APP_LIB_VIBRATION_H_ */
@@ -0,0 +1,291 @@
+/*
+ * Copyright (c) 2025 Jared Woolston
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/spinlock.h>
+#include <zephyr/sys/util.h>
+
+#include <app/lib/fsm.h>
+
+LOG_MODULE_REGISTER(fsm, CONFIG_FSM_LOG_LEVEL);
+
+static void fsm_timer_expiry(struct k_timer *timer)
+{
+	struct fsm *fsm = k_timer_user_data_get(timer);
+	struct fsm_event evt = {.timeout = 1};
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&fsm->lock);
+	evt.event = fsm->cfg.states[fsm->state].timeout_event;
+	evt.visit = fsm->visit;
+	if (k_msgq_put(&fsm->queue, &evt, K_NO_WAIT) != 0) {
+		fsm->stats.dropped++;
+	}
+	k_spin_unlock(&fsm->lock, key);
+}
+
+/* Starts a visit of the current state */
+static void fsm_enter(struct fsm *fsm)
+{
+	const struct fsm_state *st = &fsm->cfg.states[fsm->state];
+
+	fsm->entered = k_uptime_ticks();
+	if (st->timeout_ms != 0) {
+		k_timer_start(&fsm->timer, K_MSEC(st->timeout_ms), K_NO_WAIT);
+	}
+
+	if (st->entry != NULL) {
+		st->entry(fsm);
+	}
+}
+
+/* Ends the visit of the current state, its stale timeout events with it */
+static void fsm_leave(struct fsm *fsm, bool timeout)
+{
+	struct fsm_state_stats *ss = &fsm->state_stats[fsm->state];
+	uint32_t dwell = (uint32_t)(k_uptime_ticks() - fsm->entered);
+	k_spinlock_key_t key;
+
+	k_timer_stop(&fsm->timer);
+
+	key = k_spin_lock(&fsm->lock);
+	fsm->visit++;
+	ss->visits++;
+	ss->timeouts += timeout ? 1 : 0;
+	ss->dwell_last = dwell;
+	ss->dwell_min = (ss->visits == 1) ? dwell : MIN(ss->dwell_min, dwell);
+	ss->dwell_max = MAX(ss->dwell_max, dwell);
+	ss->dwell_sum += dwell;
+	k_spin_unlock(&fsm->lock, key);
+
+	LOG_DBG("%s: left %s after %u us%s", fsm->cfg.name,
+		fsm->cfg.states[fsm->state].name, k_ticks_to_us_floor32(dwell),
+		timeout ? " on timeout" : "");
+}
+
+int fsm_init(struct fsm *fsm, const struct fsm_config *cfg,
+	     struct fsm_state_stats *state_stats)
+{
+	if (cfg->states == NULL || cfg->transitions == NULL ||
+	    state_stats == NULL || cfg->num_states == 0 ||
+	    cfg->num_events == 0 || cfg->initial >= cfg->num_states) {
+		return -EINVAL;
+	}
+
+	/* Checked once here, dispatching then trusts the tables */
+	for (uint8_t s = 0; s < cfg->num_states; s++) {
+		const struct fsm_state *st = &cfg->states[s];
+
+		if (st->timeout_ms != 0 && st->timeout_event >= cfg->num_events) {
+			return -EINVAL;
+		}
+
+		for (uint8_t e = 0; e < cfg->num_events; e++) {
+			const struct fsm_transition *t =
+				&cfg->transitions[s * cfg->num_events + e];
+
+			if (t->valid && t->next >= cfg->num_states) {
+				return -EINVAL;
+			}
+		}
+	}
+
+	memset(fsm, 0, sizeof(*fsm));
+	fsm->cfg = *cfg;
+	if (fsm->cfg.name == NULL) {
+		fsm->cfg.name = "fsm";
+	}
+	fsm->state_stats = state_stats;
+	memset(state_stats, 0, cfg->num_states * sizeof(*state_stats));
+
+	k_msgq_init(&fsm->queue, fsm->buf, sizeof(struct fsm_event),
+		    CONFIG_FSM_QUEUE_LEN);
+	k_timer_init(&fsm->timer, fsm_timer_expiry, NULL);
+	k_timer_user_data_set(&fsm->timer, fsm);
+
+	return 0;
+}
+
+void fsm_start(struct fsm *fsm)
+{
+	k_spinlock_key_t key;
+
+	k_timer_stop(&fsm->timer);
+
+	key = k_spin_lock(&fsm->lock);
+	k_msgq_purge(&fsm->queue);
+	fsm->visit++;
+	fsm->state = fsm->cfg.initial;
+	fsm->started = true;
+	k_spin_unlock(&fsm->lock, key);
+
+	LOG_DBG("%s: start in %s", fsm->cfg.name,
+		fsm->cfg.states[fsm->state].name);
+	fsm_enter(fsm);
+}
+
+void fsm_stop(struct fsm *fsm)
+{
+	k_spinlock_key_t key;
+
+	k_timer_stop(&fsm->timer);
+
+	key = k_spin_lock(&fsm->lock);
+	fsm->started = false;
+	fsm->visit++;
+	k_msgq_purge(&fsm->queue);
+	k_spin_unlock(&fsm->lock, key);
+}
+
+int fsm_post(struct fsm *fsm, uint8_t event)
+{
+	struct fsm_event evt = {.event = event};
+	k_spinlock_key_t key;
+	int ret = 0;
+
+	if (event >= fsm->cfg.num_events) {
+		return -EINVAL;
+	}
+
+	if (!fsm->started) {
+		return -EPERM;
+	}
+
+	if (k_msgq_put(&fsm->queue, &evt, K_NO_WAIT) != 0) {
+		key = k_spin_lock(&fsm->lock);
+		fsm->stats.dropped++;
+		k_spin_unlock(&fsm->lock, key);
+		ret = -ENOSPC;
+	}
+
+	return ret;
+}
+
+int fsm_process(struct fsm *fsm, k_timeout_t timeout)
+{
+	const struct fsm_transition *t;
+	struct fsm_event evt;
+	k_spinlock_key_t key;
+	uint8_t from;
+
+	if (k_msgq_get(&fsm->queue, &evt, timeout) != 0) {
+		return -EAGAIN;
+	}
+
+	/* Timed out a visit that already ended, or before any start */
+	if (!fsm->started || (evt.timeout && evt.visit != fsm->visit)) {
+		return 0;
+	}
+
+	/* O(1): one row per state, one entry per event */
+	t = &fsm->cfg.transitions[fsm->state * fsm->cfg.num_events + evt.event];
+
+	key = k_spin_lock(&fsm->lock);
+	fsm->stats.events++;
+	if (!t->valid) {
+		fsm->stats.unhandled++;
+	} else {
+		fsm->stats.transitions++;
+	}
+	k_spin_unlock(&fsm->lock, key);
+
+	if (!t->valid) {
+		LOG_DBG("%s: event %u not handled in %s", fsm->cfg.name, evt.event,
+			fsm->cfg.states[fsm->state].name);
+		return 0;
+	}
+
+	from = fsm->state;
+	if (fsm->cfg.states[from].exit != NULL) {
+		fsm->cfg.states[from].exit(fsm);
+	}
+	fsm_leave(fsm, evt.timeout);
+
+	if (t->action != NULL) {
+		t->action(fsm);
+	}
+
+	key = k_spin_lock(&fsm->lock);
+	fsm->state = t->next;
+	k_spin_unlock(&fsm->lock, key);
+
+	fsm_enter(fsm);
+
+	return 0;
+}
+
+uint8_t fsm_state_get(struct fsm *fsm)
+{
+	return fsm->state;
+}
+
+void fsm_stats_get(struct fsm *fsm, struct fsm_stats *stats,
+		   struct fsm_state_stats *state_stats, bool reset)
+{
+	k_spinlock_key_t key = k_spin_lock(&fsm->lock);
+
+	if (stats != NULL) {
+		*stats = fsm->stats;
+	}
+	if (state_stats != NULL) {
+		memcpy(state_stats, fsm->state_stats,
+		       fsm->cfg.num_states * sizeof(*state_stats));
+	}
+	if (reset) {
+		memset(&fsm->stats, 0, sizeof(fsm->stats));
+		memset(fsm->state_stats, 0,
+		       fsm->cfg.num_states * sizeof(*fsm->state_stats));
+	}
+	k_spin_unlock(&fsm->lock, key);
+}
+
+void fsm_report(struct fsm *fsm)
+{
+	struct fsm_state_stats ss;
+	uint64_t total = 0, slowest_sum = 0;
+	uint8_t slowest = 0;
+	k_spinlock_key_t key;
+
+	/* Two passes, one state at a time, to keep the lock short */
+	for (uint8_t s = 0; s < fsm->cfg.num_states; s++) {
+		key = k_spin_lock(&fsm->lock);
+		ss = fsm->state_stats[s];
+		k_spin_unlock(&fsm->lock, key);
+
+		total += ss.dwell_sum;
+		if (ss.dwell_sum > slowest_sum) {
+			slowest_sum = ss.dwell_sum;
+			slowest = s;
+		}
+	}
+
+	if (total == 0) {
+		LOG_INF("%s: no completed visit", fsm->cfg.name);
+		return;
+	}
+
+	for (uint8_t s = 0; s < fsm->cfg.num_states; s++) {
+		key = k_spin_lock(&fsm->lock);
+		ss = fsm->state_stats[s];
+		k_spin_unlock(&fsm->lock, key);
+
+		if (ss.visits == 0) {
+			continue;
+		}
+
+		LOG_INF("%s: %s %u visits, %u timeouts, mean %u us, max %u us, "
+			"%u%% of the time%s",
+			fsm->cfg.name, fsm->cfg.states[s].name, ss.visits, ss.timeouts,
+			k_ticks_to_us_floor32(ss.dwell_sum / ss.visits),
+			k_ticks_to_us_floor32(ss.dwell_max),
+			(uint32_t)((ss.dwell_sum * 100U) / total),
+			(s == slowest) ? " (longest)" : "");
+	}
+}
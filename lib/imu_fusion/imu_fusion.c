@@ -0,0 +1,313 @@
+/*
+ * Copyright (c) 2025 Jared Woolston
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include <zephyr/sys/util.h>
+
+#include <app/lib/imu_fusion.h>
+
+/* Quaternion and unit vectors are Q2.30 */
+#define Q30_ONE		(1 << 30)
+
+/* Standard gravity in Q16.16 m/s^2 */
+#define GRAVITY_Q16	642689
+
+/* Angles returned by the CORDIC are Q3.29 rad */
+#define PI_Q29		1686629713
+#define CORDIC_ITERATIONS 24
+
+/* atan(2^-i) in Q3.29 rad */
+static const int32_t cordic_atan[CORDIC_ITERATIONS] = {
+	421657428, 248918915, 131521918, 66762579, 33510843, 16771758,
+	8387925, 4194219, 2097141, 1048575, 524288, 262144,
+	131072, 65536, 32768, 16384, 8192, 4096,
+	2048, 1024, 512, 256, 128, 64,
+};
+
+static uint32_t isqrt64(uint64_t x)
+{
+	uint64_t res = 0;
+	uint64_t bit = 1ULL << 62;
+
+	while (bit > x) {
+		bit >>= 2;
+	}
+
+	while (bit != 0) {
+		if (x >= res + bit) {
+			x -= res + bit;
+			res = (res >> 1) + bit;
+		} else {
+			res >>= 1;
+		}
+		bit >>= 2;
+	}
+
+	return (uint32_t)res;
+}
+
+/* atan2 in Q3.29 rad of two values of the same scale, |y|, |x| <= 2^30 */
+static int32_t cordic_atan2(int32_t y, int32_t x)
+{
+	int32_t angle = 0;
+
+	if (x == 0 && y == 0) {
+		return 0;
+	}
+
+	/* Two bits of headroom for the CORDIC gain */
+	x >>= 2;
+	y >>= 2;
+
+	if (x < 0) {
+		angle = (y >= 0) ? PI_Q29 : -PI_Q29;
+		x = -x;
+		y = -y;
+	}
+
+	for (int i = 0; i < CORDIC_ITERATIONS; i++) {
+		int32_t xi = x;
+
+		if (y > 0) {
+			x += y >> i;
+			y -= xi >> i;
+			angle += cordic_atan[i];
+		} else {
+			x -= y >> i;
+			y += xi >> i;
+			angle -= cordic_atan[i];
+		}
+	}
+
+	return angle;
+}
+
+static inline int32_t q29_to_q16(int32_t angle)
+{
+	return (angle + (1 << 12)) >> 13;
+}
+
+static inline int32_t mul_q30(int32_t a, int32_t b)
+{
+	return (int32_t)(((int64_t)a * b) >> 30);
+}
+
+static inline int32_t to_q16(q31_t val, int8_t shift)
+{
+	return val >> (15 - shift);
+}
+
+int imu_fusion_init(struct imu_fusion *f, const struct imu_fusion_config *cfg)
+{
+	if (cfg->rate_hz == 0 || cfg->kp < 0 || cfg->ki < 0 ||
+	    cfg->integral_limit < 0 || cfg->accel_gate < 0) {
+		return -EINVAL;
+	}
+
+	f->cfg = *cfg;
+	f->q[0] = Q30_ONE;
+	f->q[1] = 0;
+	f->q[2] = 0;
+	f->q[3] = 0;
+	f->integral[0] = 0;
+	f->integral[1] = 0;
+	f->integral[2] = 0;
+	f->aligned = false;
+
+	/* dt / 2 in Q4.28 and ki * dt in Q16.32 */
+	f->half_dt = (int32_t)((1U << 27) / cfg->rate_hz);
+	f->ki_dt = ((int64_t)cfg->ki << 16) / cfg->rate_hz;
+
+	imu_fusion_set_temperature(f, cfg->temp_ref);
+
+	return 0;
+}
+
+void imu_fusion_set_temperature(struct imu_fusion *f, int32_t temp)
+{
+	int64_t delta = (int64_t)temp - f->cfg.temp_ref;
+
+	for (int i = 0; i < 3; i++) {
+		f->bias[i] = f->cfg.gyro_bias[i] +
+			     (int32_t)(f->cfg.gyro_tempco[i] * delta / 1000000);
+	}
+}
+
+/*
+ * Normalize a Q16.16 accelerometer sample to a Q2.30 unit vector, returns
+ * false if the sample is not usable as a gravity reference.
+ */
+static bool imu_fusion_accel_unit(const struct imu_fusion *f, const int32_t a[3],
+				  int32_t u[3])
+{
+	uint64_t n2 = 0;
+	int64_t inv;
+	int32_t norm;
+
+	for (int i = 0; i < 3; i++) {
+		n2 += (int64_t)a[i] * a[i];
+	}
+
+	norm = (int32_t)isqrt64(n2);
+	if (norm == 0) {
+		return false;
+	}
+
+	if (f->cfg.accel_gate != 0 && abs(norm - GRAVITY_Q16) > f->cfg.accel_gate) {
+		return false;
+	}
+
+	/* 2^46 / |a| scales a Q16.16 vector to a Q2.30 unit vector */
+	inv = (1LL << 46) / norm;
+	for (int i = 0; i < 3; i++) {
+		u[i] = (int32_t)((a[i] * inv) >> 16);
+	}
+
+	return true;
+}
+
+/*
+ * Start from the shortest rotation that takes the vertical onto the measured
+ * gravity, rather than converging from identity with the integral wound up.
+ */
+static void imu_fusion_align(struct imu_fusion *f, const int32_t u[3])
+{
+	int64_t c[4] = {(int64_t)Q30_ONE + u[2], u[1], -(int64_t)u[0], 0};
+	uint64_t norm;
+
+	if (c[0] == 0) {
+		/* Upside down, any horizontal axis will do */
+		c[0] = 0;
+		c[1] = Q30_ONE;
+		c[2] = 0;
+	}
+
+	norm = isqrt64(c[0] * c[0] + c[1] * c[1] + c[2] * c[2]);
+	for (int i = 0; i < 4; i++) {
+		f->q[i] = (int32_t)((c[i] << 30) / (int64_t)norm);
+	}
+
+	f->aligned = true;
+}
+
+/*
+ * Accelerometer correction of the rate in @p g, Q16.16 rad/s. The error is
+ * the cross product of the measured and the estimated direction of gravity.
+ */
+static void imu_fusion_correct(struct imu_fusion *f, const int32_t u[3],
+			       int32_t g[3])
+{
+	const int32_t *q = f->q;
+	/* Integral is kept in Q8.24 for resolution at small ki * dt */
+	const int32_t limit = (int32_t)MIN((int64_t)f->cfg.integral_limit << 8,
+					   INT32_MAX);
+	int32_t v[3], e[3];
+
+	/* Third row of the rotation matrix */
+	v[0] = (int32_t)(((int64_t)q[1] * q[3] - (int64_t)q[0] * q[2]) >> 29);
+	v[1] = (int32_t)(((int64_t)q[0] * q[1] + (int64_t)q[2] * q[3]) >> 29);
+	v[2] = (int32_t)(((int64_t)q[0] * q[0] - (int64_t)q[1] * q[1] -
+			  (int64_t)q[2] * q[2] + (int64_t)q[3] * q[3]) >> 30);
+
+	e[0] = mul_q30(u[1], v[2]) - mul_q30(u[2], v[1]);
+	e[1] = mul_q30(u[2], v[0]) - mul_q30(u[0], v[2]);
+	e[2] = mul_q30(u[0], v[1]) - mul_q30(u[1], v[0]);
+
+	for (int i = 0; i < 3; i++) {
+		if (f->ki_dt != 0) {
+			int64_t acc = f->integral[i] + ((e[i] * f->ki_dt) >> 38);
+
+			f->integral[i] = (int32_t)CLAMP(acc, -limit, limit);
+		}
+
+		g[i] += (int32_t)(((int64_t)f->cfg.kp * e[i]) >> 30) +
+			(f->integral[i] >> 8);
+	}
+}
+
+static void imu_fusion_step(struct imu_fusion *f, const int32_t g[3])
+{
+	int32_t *q = f->q;
+	int64_t d[4];
+	int64_t n2 = 0;
+	int32_t inv;
+
+	/* q' = q + q * (0, g) * dt / 2 */
+	d[0] = -(int64_t)q[1] * g[0] - (int64_t)q[2] * g[1] - (int64_t)q[3] * g[2];
+	d[1] = (int64_t)q[0] * g[0] + (int64_t)q[2] * g[2] - (int64_t)q[3] * g[1];
+	d[2] = (int64_t)q[0] * g[1] - (int64_t)q[1] * g[2] + (int64_t)q[3] * g[0];
+	d[3] = (int64_t)q[0] * g[2] + (int64_t)q[1] * g[1] - (int64_t)q[2] * g[0];
+
+	for (int i = 0; i < 4; i++) {
+		q[i] += (int32_t)(((d[i] >> 20) * f->half_dt) >> 24);
+		n2 += (int64_t)q[i] * q[i];
+	}
+
+	/* The norm stays close to one, a single Newton step of 1/sqrt is enough */
+	inv = (int32_t)((3LL * Q30_ONE - (n2 >> 30)) >> 1);
+	for (int i = 0; i < 4; i++) {
+		q[i] = mul_q30(q[i], inv);
+	}
+}
+
+void imu_fusion_update(struct imu_fusion *f,
+		       const q31_t (*gyro)[3], int8_t gyro_shift,
+		       const q31_t (*acc)[3], int8_t acc_shift,
+		       size_t count)
+{
+	for (size_t n = 0; n < count; n++) {
+		int32_t g[3], a[3], u[3];
+
+		for (int i = 0; i < 3; i++) {
+			g[i] = to_q16(gyro[n][i], gyro_shift) - f->bias[i];
+			a[i] = to_q16(acc[n][i], acc_shift);
+		}
+
+		if ((f->cfg.kp != 0 || f->cfg.ki != 0) &&
+		    imu_fusion_accel_unit(f, a, u)) {
+			if (!f->aligned) {
+				imu_fusion_align(f, u);
+			}
+			imu_fusion_correct(f, u, g);
+		}
+
+		imu_fusion_step(f, g);
+	}
+}
+
+void imu_fusion_quaternion_get(const struct imu_fusion *f, int32_t q[4])
+{
+	for (int i = 0; i < 4; i++) {
+		q[i] = f->q[i];
+	}
+}
+
+void imu_fusion_euler_get(const struct imu_fusion *f,
+			  struct imu_fusion_euler *euler)
+{
+	const int32_t *q = f->q;
+	int64_t w = q[0], x = q[1], y = q[2], z = q[3];
+	int32_t sin_pitch, cos_pitch, up_x, up_y, up_z;
+
+	/* Sensor frame direction of the vertical, Q2.30 */
+	up_x = (int32_t)((x * z - w * y) >> 29);
+	up_y = (int32_t)((w * x + y * z) >> 29);
+	up_z = (int32_t)((w * w - x * x - y * y + z * z) >> 30);
+
+	sin_pitch = CLAMP(-up_x, -Q30_ONE, Q30_ONE);
+	cos_pitch = (int32_t)isqrt64((1ULL << 60) - (int64_t)sin_pitch * sin_pitch);
+
+	euler->roll = q29_to_q16(cordic_atan2(up_y, up_z));
+	euler->pitch = q29_to_q16(cordic_atan2(sin_pitch, cos_pitch));
+	euler->yaw = q29_to_q16(cordic_atan2((int32_t)((w * z + x * y) >> 29),
+					     (int32_t)((w * w + x * x - y * y - z * z) >> 30)));
+	euler->tilt = q29_to_q16(cordic_atan2((int32_t)isqrt64((int64_t)up_x * up_x +
+							       (int64_t)up_y * up_y),
+					      up_z));
+}
@@ -0,0 +1,533 @@
+/*
+ * Copyright (c) 2025 Jared Woolston
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/spinlock.h>
+#include <zephyr/sys/slist.h>
+#include <zephyr/sys/util.h>
+
+#include <app/drivers/motor.h>
+#include <app/lib/motor_ctrl.h>
+
+LOG_MODULE_REGISTER(motor_ctrl, CONFIG_MOTOR_CTRL_LOG_LEVEL);
+
+#define RATE_HZ		CONFIG_MOTOR_CTRL_RATE_HZ
+
+/* The filtered speed is Q24.8 counts/s */
+#define Q8_SHIFT	8
+
+/* Derivative low pass of the speed loop, the speed is noisy */
+#define SPEED_D_FILTER_SHIFT	2
+
+static struct k_spinlock lock;
+static sys_slist_t ctrls;
+static sys_slist_t hooks;
+static uint32_t ticks;
+static struct motor_ctrl_loop_stats loop_stats;
+static uint32_t expiry_cycles;
+static K_SEM_DEFINE(tick, 0, 1);
+
+static void motor_ctrl_expiry(struct k_timer *timer)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	ARG_UNUSED(timer);
+
+	/* The previous period has not been picked up yet */
+	if (k_sem_count_get(&tick) != 0) {
+		loop_stats.overruns++;
+	}
+	expiry_cycles = k_cycle_get_32();
+	k_spin_unlock(&lock, key);
+
+	k_sem_give(&tick);
+}
+
+static K_TIMER_DEFINE(timer, motor_ctrl_expiry, NULL);
+
+int motor_ctrl_init(struct motor_ctrl *ctrl, const struct motor_ctrl_config *cfg)
+{
+	struct pid_config speed = {
+		.gains = cfg->speed_gains,
+		.out_min = -(int32_t)MOTOR_SPEED_MAX,
+		.out_max = MOTOR_SPEED_MAX,
+		.d_filter_shift = SPEED_D_FILTER_SHIFT,
+	};
+	struct pid_config position = {
+		.gains = cfg->position_gains,
+		.out_min = -cfg->max_speed,
+		.out_max = cfg->max_speed,
+	};
+	struct profile_config profile = cfg->profile;
+	k_spinlock_key_t key;
+	bool first;
+	int ret;
+
+	if (cfg->encoder == NULL || cfg->max_speed <= 0 ||
+	    cfg->speed_filter_shift > 16) {
+		return -EINVAL;
+	}
+
+	if (!device_is_ready(cfg->motor)) {
+		return -ENODEV;
+	}
+
+	if (cfg->channel >= motor_channel_count(cfg->motor)) {
+		return -EINVAL;
+	}
+
+	memset(ctrl, 0, sizeof(*ctrl));
+	ctrl->cfg = *cfg;
+
+	ret = pid_init(&ctrl->speed_pid, &speed);
+	if (ret < 0) {
+		return ret;
+	}
+
+	ret = pid_init(&ctrl->position_pid, &position);
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (profile.table != NULL) {
+		/* One half runs, the next move is planned in the other */
+		profile.rate_hz = RATE_HZ;
+		profile.table_len /= 2;
+		for (int i = 0; i < ARRAY_SIZE(ctrl->profile); i++) {
+			ret = profile_init(&ctrl->profile[i], &profile, 0);
+			if (ret < 0) {
+				return ret;
+			}
+			profile.table += profile.table_len;
+		}
+	}
+
+	ret = cfg->encoder(cfg->user_data, &ctrl->count);
+	if (ret < 0) {
+		return ret;
+	}
+
+	ret = motor_coast(cfg->motor, cfg->channel);
+	if (ret < 0) {
+		return ret;
+	}
+
+	key = k_spin_lock(&lock);
+	first = sys_slist_is_empty(&ctrls);
+	sys_slist_append(&ctrls, &ctrl->node);
+	k_spin_unlock(&lock, key);
+
+	if (first) {
+		k_timer_start(&timer, K_USEC(USEC_PER_SEC / RATE_HZ),
+			      K_USEC(USEC_PER_SEC / RATE_HZ));
+	}
+
+	return 0;
+}
+
+static void motor_ctrl_mode_set(struct motor_ctrl *ctrl, enum motor_ctrl_mode mode,
+				int32_t target)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	/* Start from a clean integrator when the loop closes or changes */
+	if (ctrl->mode != mode) {
+		ctrl->reset = true;
+	}
+	ctrl->mode = mode;
+	ctrl->target = target;
+	k_spin_unlock(&lock, key);
+}
+
+int motor_ctrl_emf_read(void *user_data, int32_t *count)
+{
+	struct motor_ctrl_emf *emf = user_data;
+	const int64_t den = (int64_t)MSEC_PER_SEC * sys_clock_hw_cycles_per_sec();
+	uint32_t now = k_cycle_get_32();
+	struct motor_status status;
+	int ret;
+
+	ret = motor_status_get(emf->motor, emf->channel, &status);
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (!status.emf_valid) {
+		return -ENOTSUP;
+	}
+
+	/* mV times counts/s per V over the interval, carrying the remainder */
+	if (emf->started) {
+		emf->rem += (int64_t)status.emf_mv * emf->counts_per_volt *
+			    (uint32_t)(now - emf->cycles);
+		emf->count += (int32_t)(emf->rem / den);
+		emf->rem %= den;
+	}
+	emf->started = true;
+	emf->cycles = now;
+	*count = emf->count;
+
+	return 0;
+}
+
+void motor_ctrl_speed_set(struct motor_ctrl *ctrl, int32_t speed)
+{
+	motor_ctrl_mode_set(ctrl, MOTOR_CTRL_MODE_SPEED, speed);
+}
+
+void motor_ctrl_position_set(struct motor_ctrl *ctrl, int32_t position)
+{
+	motor_ctrl_mode_set(ctrl, MOTOR_CTRL_MODE_POSITION, position);
+}
+
+int motor_ctrl_move(struct motor_ctrl *ctrl, int32_t position, uint32_t duration_ms)
+{
+	const int32_t max_speed = ctrl->cfg.profile.max_speed;
+	struct profile *next;
+	struct profile running;
+	struct profile_point from, pt;
+	k_spinlock_key_t key;
+	uint32_t runs;
+	bool blend;
+	int ret;
+
+	if (ctrl->cfg.profile.table == NULL) {
+		return -ENOTSUP;
+	}
+
+	/* Only the planner writes the spare half, one at a time */
+	if (atomic_test_and_set_bit(&ctrl->planning, 0)) {
+		return -EBUSY;
+	}
+	next = &ctrl->profile[!ctrl->active];
+
+	key = k_spin_lock(&lock);
+	blend = (ctrl->mode == MOTOR_CTRL_MODE_MOVE);
+	running = ctrl->profile[ctrl->active];
+	from.position = ctrl->position;
+	from.speed = CLAMP(ctrl->speed_q8 >> Q8_SHIFT, -max_speed, max_speed);
+	runs = ctrl->runs;
+	k_spin_unlock(&lock, key);
+
+	/* The running table is only read by the loop meanwhile */
+	if (blend) {
+		profile_copy(next, &running);
+		ret = profile_move(next, NULL, position, duration_ms);
+	} else {
+		ret = profile_move(next, &from, position, duration_ms);
+	}
+
+	if (ret == 0) {
+		key = k_spin_lock(&lock);
+		if ((ctrl->mode == MOTOR_CTRL_MODE_MOVE) != blend) {
+			ret = -EAGAIN;
+		} else {
+			/* Catch up with the iterations run while planning */
+			for (uint32_t n = ctrl->runs - runs; n > 0; n--) {
+				profile_next(next, &pt);
+			}
+			ctrl->active = !ctrl->active;
+			ctrl->move_started = false;
+			ctrl->move_done = false;
+			if (!blend) {
+				ctrl->reset = true;
+				ctrl->mode = MOTOR_CTRL_MODE_MOVE;
+			}
+		}
+		k_spin_unlock(&lock, key);
+	}
+
+	atomic_clear_bit(&ctrl->planning, 0);
+
+	return ret;
+}
+
+void motor_ctrl_stop(struct motor_ctrl *ctrl)
+{
+	motor_ctrl_mode_set(ctrl, MOTOR_CTRL_MODE_OFF, 0);
+}
+
+static struct pid *motor_ctrl_pid(struct motor_ctrl *ctrl, enum motor_ctrl_loop loop)
+{
+	return (loop == MOTOR_CTRL_LOOP_POSITION) ? &ctrl->position_pid :
+						    &ctrl->speed_pid;
+}
+
+void motor_ctrl_gains_set(struct motor_ctrl *ctrl, enum motor_ctrl_loop loop,
+			  const struct pid_gains *gains)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	pid_gains_set(motor_ctrl_pid(ctrl, loop), gains);
+	k_spin_unlock(&lock, key);
+}
+
+void motor_ctrl_gains_get(struct motor_ctrl *ctrl, enum motor_ctrl_loop loop,
+			  struct pid_gains *gains)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	pid_gains_get(motor_ctrl_pid(ctrl, loop), gains);
+	k_spin_unlock(&lock, key);
+}
+
+void motor_ctrl_state_get(struct motor_ctrl *ctrl, struct motor_ctrl_state *state)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	state->mode = ctrl->mode;
+	state->position = ctrl->position;
+	state->speed = ctrl->speed_q8 >> Q8_SHIFT;
+	state->duty = ctrl->duty;
+	state->move_started = ctrl->move_started;
+	state->move_done = ctrl->move_done;
+	state->move_start = ctrl->move_start;
+	state->move_end = ctrl->move_end;
+	k_spin_unlock(&lock, key);
+}
+
+void motor_ctrl_stats_get(struct motor_ctrl *ctrl, struct motor_ctrl_stats *stats,
+			  bool reset)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	*stats = ctrl->stats;
+	if (reset) {
+		memset(&ctrl->stats, 0, sizeof(ctrl->stats));
+	}
+	k_spin_unlock(&lock, key);
+}
+
+void motor_ctrl_loop_stats_get(struct motor_ctrl_loop_stats *stats, bool reset)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	*stats = loop_stats;
+	if (reset) {
+		memset(&loop_stats, 0, sizeof(loop_stats));
+	}
+	k_spin_unlock(&lock, key);
+}
+
+static int motor_ctrl_apply(struct motor_ctrl *ctrl, enum motor_ctrl_mode mode,
+			    int32_t duty)
+{
+	const struct motor_ctrl_config *cfg = &ctrl->cfg;
+	int ret;
+
+	/* Most periods change nothing, skip the driver */
+	if (mode == ctrl->applied_mode && duty == ctrl->duty) {
+		return 0;
+	}
+
+	if (mode == MOTOR_CTRL_MODE_OFF) {
+		ret = motor_coast(cfg->motor, cfg->channel);
+	} else {
+		ret = motor_drive(cfg->motor, cfg->channel,
+				  (duty < 0) ? MOTOR_DIR_REVERSE : MOTOR_DIR_FORWARD,
+				  (uint16_t)abs(duty));
+	}
+
+	if (ret == 0) {
+		ctrl->applied_mode = mode;
+		ctrl->duty = duty;
+	}
+
+	return ret;
+}
+
+/*
+ * Loop ticks of the first step of a move and after its last one, a move
+ * caught up to its end while planned ends at its first iteration. Called
+ * with the lock held.
+ */
+static void motor_ctrl_move_track(struct motor_ctrl *ctrl)
+{
+	if (!ctrl->move_started) {
+		ctrl->move_start = ticks;
+		ctrl->move_started = true;
+	}
+
+	if (profile_remaining(&ctrl->profile[ctrl->active]) == 0) {
+		ctrl->move_end = ticks + 1;
+		ctrl->move_done = true;
+	}
+}
+
+static void motor_ctrl_run(struct motor_ctrl *ctrl)
+{
+	const struct motor_ctrl_config *cfg = &ctrl->cfg;
+	uint32_t start = k_cycle_get_32();
+	struct profile_point pt;
+	enum motor_ctrl_mode mode;
+	k_spinlock_key_t key;
+	int32_t count, delta, speed, duty = 0;
+	int ret;
+
+	ret = cfg->encoder(cfg->user_data, &count);
+
+	key = k_spin_lock(&lock);
+	ctrl->runs++;
+	if (ret == 0) {
+		delta = (int32_t)((uint32_t)count - (uint32_t)ctrl->count);
+		ctrl->count = count;
+		ctrl->position += delta;
+		ctrl->speed_q8 += ((delta * RATE_HZ << Q8_SHIFT) - ctrl->speed_q8) >>
+				  cfg->speed_filter_shift;
+	}
+	speed = ctrl->speed_q8 >> Q8_SHIFT;
+
+	if (ctrl->reset) {
+		pid_reset(&ctrl->speed_pid);
+		pid_reset(&ctrl->position_pid);
+		ctrl->reset = false;
+	}
+
+	/* Without feedback the loop is open */
+	mode = (ret == 0) ? ctrl->mode : MOTOR_CTRL_MODE_OFF;
+
+	switch (mode) {
+	case MOTOR_CTRL_MODE_SPEED:
+		duty = pid_update(&ctrl->speed_pid, ctrl->target, speed);
+		break;
+	case MOTOR_CTRL_MODE_POSITION:
+		duty = pid_update(&ctrl->speed_pid,
+				  pid_update(&ctrl->position_pid, ctrl->target,
+					     ctrl->position),
+				  speed);
+		break;
+	case MOTOR_CTRL_MODE_MOVE:
+		/* Feed forward the profile speed, the position loop corrects */
+		profile_next(&ctrl->profile[ctrl->active], &pt);
+		if (!ctrl->move_done) {
+			motor_ctrl_move_track(ctrl);
+		}
+		duty = pid_update(&ctrl->speed_pid,
+				  pt.speed + pid_update(&ctrl->position_pid, pt.position,
+							ctrl->position),
+				  speed);
+		break;
+	default:
+		break;
+	}
+	k_spin_unlock(&lock, key);
+
+	if (ret == 0) {
+		ret = motor_ctrl_apply(ctrl, mode, duty);
+	}
+
+	key = k_spin_lock(&lock);
+	if (ret < 0) {
+		ctrl->stats.errors++;
+	}
+	ctrl->stats.count++;
+	ctrl->stats.cpu_last = k_cycle_get_32() - start;
+	ctrl->stats.cpu_max = MAX(ctrl->stats.cpu_max, ctrl->stats.cpu_last);
+	ctrl->stats.cpu_sum += ctrl->stats.cpu_last;
+	k_spin_unlock(&lock, key);
+}
+
+uint32_t motor_ctrl_tick_get(void)
+{
+	return ticks;
+}
+
+void motor_ctrl_hook_add(struct motor_ctrl_hook *hook)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	sys_slist_append(&hooks, &hook->node);
+	k_spin_unlock(&lock, key);
+}
+
+static void motor_ctrl_loop(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	struct motor_ctrl_hook *hook;
+	struct motor_ctrl *ctrl;
+	k_spinlock_key_t key;
+	uint32_t start, prev = 0, cpu;
+
+	while (1) {
+		k_sem_take(&tick, K_FOREVER);
+		start = k_cycle_get_32();
+
+		/* Hooks and controllers are only ever appended, after the tail */
+		SYS_SLIST_FOR_EACH_CONTAINER(&hooks, hook, node) {
+			hook->fn(hook, ticks);
+		}
+
+		SYS_SLIST_FOR_EACH_CONTAINER(&ctrls, ctrl, node) {
+			motor_ctrl_run(ctrl);
+		}
+
+		cpu = k_cycle_get_32() - start;
+
+		key = k_spin_lock(&lock);
+		if (loop_stats.count == 0) {
+			loop_stats.interval_min = UINT32_MAX;
+		} else {
+			loop_stats.interval_min = MIN(loop_stats.interval_min,
+						      start - prev);
+			loop_stats.interval_max = MAX(loop_stats.interval_max,
+						      start - prev);
+		}
+		loop_stats.count++;
+		loop_stats.latency_max = MAX(loop_stats.latency_max,
+					     start - expiry_cycles);
+		loop_stats.cpu_last = cpu;
+		loop_stats.cpu_max = MAX(loop_stats.cpu_max, cpu);
+		loop_stats.cpu_sum += cpu;
+		k_spin_unlock(&lock, key);
+
+		prev = start;
+		ticks++;
+	}
+}
+
+K_THREAD_DEFINE(motor_ctrl_thread, CONFIG_MOTOR_CTRL_THREAD_STACK_SIZE,
+		motor_ctrl_loop, NULL, NULL, NULL,
+		K_PRIO_COOP(CONFIG_MOTOR_CTRL_THREAD_PRIORITY), 0, 0);
+
+#if CONFIG_MOTOR_CTRL_REPORT_INTERVAL > 0
+static void motor_ctrl_report(struct k_work *work)
+{
+	struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+	struct motor_ctrl_loop_stats stats;
+
+	motor_ctrl_loop_stats_get(&stats, true);
+
+	if (stats.count > 1) {
+		LOG_INF("%u iterations, %u overruns, jitter %u ns, latency max %u ns, "
+			"cpu avg %u ns max %u ns", stats.count, stats.overruns,
+			(uint32_t)k_cyc_to_ns_floor64(stats.interval_max - stats.interval_min),
+			(uint32_t)k_cyc_to_ns_floor64(stats.latency_max),
+			(uint32_t)k_cyc_to_ns_floor64(stats.cpu_sum / stats.count),
+			(uint32_t)k_cyc_to_ns_floor64(stats.cpu_max));
+	}
+
+	k_work_reschedule(dwork, K_SECONDS(CONFIG_MOTOR_CTRL_REPORT_INTERVAL));
+}
+
+static K_WORK_DELAYABLE_DEFINE(report_work, motor_ctrl_report);
+
+static int motor_ctrl_report_init(void)
+{
+	k_work_reschedule(&report_work, K_SECONDS(CONFIG_MOTOR_CTRL_REPORT_INTERVAL));
+
+	return 0;
+}
+
+SYS_INIT(motor_ctrl_report_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
+#endif
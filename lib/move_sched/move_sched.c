@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2025 Jared Woolston
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/spinlock.h>
+#include <zephyr/sys/util.h>
+
+#include <app/lib/motor_ctrl.h>
+#include <app/lib/move_sched.h>
+
+LOG_MODULE_REGISTER(move_sched, CONFIG_MOVE_SCHED_LOG_LEVEL);
+
+/* Ticks of the moves of the last segment, once they all ended */
+static void move_sched_measure(struct move_sched *ms)
+{
+	int32_t start_lo = INT32_MAX, start_hi = INT32_MIN;
+	int32_t end_lo = INT32_MAX, end_hi = INT32_MIN;
+	struct motor_ctrl_state state;
+	k_spinlock_key_t key;
+	uint32_t axes = 0;
+
+	for (uint8_t i = 0; i < ms->cfg.num_axes; i++) {
+		if ((ms->measure & BIT(i)) == 0) {
+			continue;
+		}
+
+		motor_ctrl_state_get(ms->cfg.axes[i], &state);
+		if (state.mode != MOTOR_CTRL_MODE_MOVE) {
+			/* Stopped or retargeted since, not our move anymore */
+			ms->measure &= ~BIT(i);
+			continue;
+		}
+		if (!state.move_done) {
+			return;
+		}
+
+		start_lo = MIN(start_lo, (int32_t)(state.move_start - ms->measure_start));
+		start_hi = MAX(start_hi, (int32_t)(state.move_start - ms->measure_start));
+		end_lo = MIN(end_lo, (int32_t)(state.move_end - ms->measure_start));
+		end_hi = MAX(end_hi, (int32_t)(state.move_end - ms->measure_start));
+		axes++;
+	}
+
+	ms->measure = 0;
+	if (axes == 0) {
+		return;
+	}
+
+	key = k_spin_lock(&ms->lock);
+	ms->stats.measured++;
+	ms->stats.start_skew_last = (uint32_t)(start_hi - start_lo);
+	ms->stats.start_skew_max = MAX(ms->stats.start_skew_max,
+				       ms->stats.start_skew_last);
+	ms->stats.end_skew_last = (uint32_t)(end_hi - end_lo);
+	ms->stats.end_skew_max = MAX(ms->stats.end_skew_max, ms->stats.end_skew_last);
+	ms->stats.start_delay_max = MAX(ms->stats.start_delay_max,
+					(uint32_t)MAX(start_hi, 0));
+	if (ms->measure_ticks != 0) {
+		ms->stats.end_delay_max =
+			MAX(ms->stats.end_delay_max,
+			    (uint32_t)MAX(end_hi - (int32_t)ms->measure_ticks, 0));
+	}
+	k_spin_unlock(&ms->lock, key);
+}
+
+static void move_sched_tick(struct motor_ctrl_hook *hook, uint32_t tick)
+{
+	struct move_sched *ms = CONTAINER_OF(hook, struct move_sched, hook);
+	struct move_sched_seg seg;
+	k_spinlock_key_t key;
+	uint32_t errors = 0, moved = 0, late;
+
+	if (ms->measure != 0) {
+		move_sched_measure(ms);
+	}
+
+	key = k_spin_lock(&ms->lock);
+	if (!ms->pending) {
+		ms->pending = k_msgq_get(&ms->queue, &ms->next, K_NO_WAIT) == 0;
+	}
+	if (!ms->pending || (int32_t)(tick - ms->next.start) < 0) {
+		k_spin_unlock(&ms->lock, key);
+		return;
+	}
+	seg = ms->next;
+	ms->pending = false;
+	k_spin_unlock(&ms->lock, key);
+
+	/* All the axes plan in this iteration, before any controller runs */
+	for (uint8_t i = 0; i < ms->cfg.num_axes; i++) {
+		if ((seg.axes & BIT(i)) == 0) {
+			continue;
+		}
+
+		if (motor_ctrl_move(ms->cfg.axes[i], seg.position[i],
+				    seg.duration_ms) != 0) {
+			errors++;
+		} else {
+			moved |= BIT(i);
+		}
+	}
+	ms->measure = moved;
+	ms->measure_start = seg.start;
+	ms->measure_ticks = DIV_ROUND_UP((uint64_t)seg.duration_ms *
+					 CONFIG_MOTOR_CTRL_RATE_HZ, MSEC_PER_SEC);
+	late = tick - seg.start;
+
+	key = k_spin_lock(&ms->lock);
+	ms->stats.segments++;
+	ms->stats.errors += errors;
+	if (late != 0) {
+		ms->stats.late++;
+		ms->stats.late_max = MAX(ms->stats.late_max, late);
+	}
+	k_spin_unlock(&ms->lock, key);
+
+	if (errors != 0) {
+		LOG_WRN("segment at tick %u: %u axes refused the move", seg.start,
+			errors);
+	}
+}
+
+int move_sched_init(struct move_sched *ms, const struct move_sched_config *cfg)
+{
+	if (cfg->axes == NULL || cfg->num_axes == 0 ||
+	    cfg->num_axes > CONFIG_MOVE_SCHED_MAX_AXES) {
+		return -EINVAL;
+	}
+
+	for (uint8_t i = 0; i < cfg->num_axes; i++) {
+		if (cfg->axes[i] == NULL) {
+			return -EINVAL;
+		}
+	}
+
+	memset(ms, 0, sizeof(*ms));
+	ms->cfg = *cfg;
+	k_msgq_init(&ms->queue, ms->buf, sizeof(struct move_sched_seg),
+		    CONFIG_MOVE_SCHED_QUEUE_LEN);
+
+	ms->hook.fn = move_sched_tick;
+	motor_ctrl_hook_add(&ms->hook);
+
+	return 0;
+}
+
+int move_sched_queue(struct move_sched *ms, const struct move_sched_seg *seg)
+{
+	k_spinlock_key_t key;
+	int ret = 0;
+
+	if (seg->axes == 0 || (seg->axes & ~BIT_MASK(ms->cfg.num_axes)) != 0) {
+		return -EINVAL;
+	}
+
+	key = k_spin_lock(&ms->lock);
+	if (ms->queued && (int32_t)(seg->start - ms->last_start) < 0) {
+		ret = -EINVAL;
+	} else if (k_msgq_put(&ms->queue, seg, K_NO_WAIT) != 0) {
+		ret = -ENOSPC;
+	} else {
+		ms->last_start = seg->start;
+		ms->queued = true;
+	}
+	k_spin_unlock(&ms->lock, key);
+
+	return ret;
+}
+
+void move_sched_flush(struct move_sched *ms)
+{
+	k_spinlock_key_t key = k_spin_lock(&ms->lock);
+
+	k_msgq_purge(&ms->queue);
+	ms->pending = false;
+	ms->queued = false;
+	k_spin_unlock(&ms->lock, key);
+}
+
+void move_sched_stats_get(struct move_sched *ms, struct move_sched_stats *stats,
+			  bool reset)
+{
+	k_spinlock_key_t key = k_spin_lock(&ms->lock);
+
+	*stats = ms->stats;
+	if (reset) {
+		memset(&ms->stats, 0, sizeof(ms->stats));
+	}
+	k_spin_unlock(&ms->lock, key);
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2025 Jared Woolston
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/sys/util.h>
+
+#include <app/lib/pid.h>
+
+/* Integrator, derivative and output sums are Q48.16 */
+#define Q16_SHIFT	16
+
+static int32_t sat32(int64_t x)
+{
+	return (int32_t)CLAMP(x, INT32_MIN, INT32_MAX);
+}
+
+int pid_init(struct pid *pid, const struct pid_config *cfg)
+{
+	if (cfg->out_min >= cfg->out_max || cfg->d_filter_shift > 16) {
+		return -EINVAL;
+	}
+
+	memset(pid, 0, sizeof(*pid));
+	pid->cfg = *cfg;
+
+	return 0;
+}
+
+void pid_reset(struct pid *pid)
+{
+	pid->integ = 0;
+	pid->deriv = 0;
+	pid->primed = false;
+}
+
+void pid_gains_set(struct pid *pid, const struct pid_gains *gains)
+{
+	pid->cfg.gains = *gains;
+}
+
+void pid_gains_get(const struct pid *pid, struct pid_gains *gains)
+{
+	*gains = pid->cfg.gains;
+}
+
+int32_t pid_update(struct pid *pid, int32_t setpoint, int32_t measurement)
+{
+	const struct pid_config *cfg = &pid->cfg;
+	const int64_t min = (int64_t)cfg->out_min << Q16_SHIFT;
+	const int64_t max = (int64_t)cfg->out_max << Q16_SHIFT;
+	int32_t err = sat32((int64_t)setpoint - measurement);
+	int64_t p, d, integ, out;
+
+	if (!pid->primed) {
+		pid->prev = measurement;
+		pid->primed = true;
+	}
+
+	p = (int64_t)cfg->gains.kp * err;
+
+	/* On the measurement: setpoint steps do not kick the output */
+	d = -(int64_t)cfg->gains.kd * sat32((int64_t)measurement - pid->prev);
+	pid->prev = measurement;
+	pid->deriv += (d - pid->deriv) >> cfg->d_filter_shift;
+	d = pid->deriv;
+
+	integ = CLAMP(pid->integ + (int64_t)cfg->gains.ki * err, min, max);
+	out = p + integ + d;
+
+	/* Conditional integration: hold while pushing further into a limit */
+	if ((out > max && err > 0) || (out < min && err < 0)) {
+		out = p + pid->integ + d;
+	} else {
+		pid->integ = integ;
+	}
+
+	out = CLAMP(out, min, max);
+
+	return (int32_t)((out + (1 << (Q16_SHIFT - 1))) >> Q16_SHIFT);
+}
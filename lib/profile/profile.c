@@ -0,0 +1,429 @@
+/*
+ * Copyright (c) 2025 Jared Woolston
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/sys/util.h>
+
+#include <app/lib/profile.h>
+
+/* Positions and increments are Q16 counts, increments per tick */
+#define Q16_SHIFT	16
+
+/* Longest ramp, keeps the shape arithmetic within 64 bits */
+#define RAMP_MAX_TICKS	UINT16_MAX
+
+/* Fraction of the speed change of a ramp tick, Q24 */
+#define FRAC_SHIFT	24
+
+enum {
+	SEG_PRE,
+	SEG_ACCEL,
+	SEG_CRUISE,
+	SEG_DECEL,
+	SEG_DONE,
+};
+
+/* Ramp from u0 to u1 over n ticks, with m ticks of constant jerk at both ends */
+struct ramp {
+	int64_t u0;
+	int64_t u1;
+	uint64_t n;
+	uint64_t m;
+};
+
+static uint32_t isqrt64(uint64_t x)
+{
+	uint64_t res = 0;
+	uint64_t bit = 1ULL << 62;
+
+	while (bit > x) {
+		bit >>= 2;
+	}
+
+	while (bit != 0) {
+		if (x >= res + bit) {
+			x -= res + bit;
+			res = (res >> 1) + bit;
+		} else {
+			res >>= 1;
+		}
+		bit >>= 2;
+	}
+
+	return (uint32_t)res;
+}
+
+static int64_t speed_to_inc(const struct profile_config *cfg, int64_t speed)
+{
+	return ((speed << Q16_SHIFT) + (int64_t)cfg->rate_hz / 2) / (int64_t)cfg->rate_hz;
+}
+
+static uint64_t div_ceil64(uint64_t n, uint64_t d)
+{
+	return (n + d - 1) / d;
+}
+
+/*
+ * Ramp between two increments. The speed change is rounded up to counts/s
+ * and the ticks are rounded up, so the acceleration and jerk of the ramp
+ * stay at or below the limits.
+ */
+static void ramp_plan(const struct profile_config *cfg, int64_t u0, int64_t u1,
+		      struct ramp *r)
+{
+	const uint64_t rate = cfg->rate_hz;
+	const uint64_t a = cfg->max_accel;
+	const uint64_t j = cfg->max_jerk;
+	uint64_t dv = div_ceil64((uint64_t)((u1 > u0) ? u1 - u0 : u0 - u1) * rate,
+				 BIT(Q16_SHIFT));
+	uint64_t x;
+
+	r->u0 = u0;
+	r->u1 = u1;
+	r->m = 0;
+
+	if (dv == 0) {
+		r->n = 0;
+	} else if (cfg->shape == PROFILE_TRAPEZOID) {
+		r->n = div_ceil64(dv * rate, a);
+	} else if (dv >= a * a / j) {
+		/* Reaches the acceleration limit */
+		r->m = div_ceil64(a * rate, j);
+		r->n = MAX(r->m + div_ceil64(dv * rate, a), 2 * r->m);
+	} else {
+		/* Jerk phases only, m = sqrt(dv / j) ticks */
+		x = div_ceil64(dv * rate * rate, j);
+		r->m = isqrt64(x);
+		if (r->m * r->m < x) {
+			r->m++;
+		}
+		r->n = 2 * r->m;
+	}
+}
+
+/* Midpoint sums of ramps symmetric about their center */
+static int64_t ramp_dist(const struct ramp *r)
+{
+	return (r->u0 + r->u1) * (int64_t)r->n / 2;
+}
+
+/*
+ * Increment of tick k, the ramp speed at its midpoint. In half ticks, with
+ * T = 2k + 1, M = 2m and N = 2n, the fraction of the speed change is
+ * T^2 / D over the first jerk phase, (2T - M) M / D at constant
+ * acceleration and 1 - (N - T)^2 / D over the last jerk phase, with
+ * D = 2 M (N - M).
+ */
+static int32_t ramp_inc(const struct ramp *r, uint32_t k)
+{
+	const int64_t t = 2 * (int64_t)k + 1;
+	const int64_t m = 2 * (int64_t)r->m;
+	const int64_t n = 2 * (int64_t)r->n;
+	int64_t g, den;
+
+	if (m == 0) {
+		g = t;
+		den = n;
+	} else {
+		den = 2 * m * (n - m);
+		if (t <= m) {
+			g = t * t;
+		} else if (t <= n - m) {
+			g = (2 * t - m) * m;
+		} else {
+			g = den - (n - t) * (n - t);
+		}
+	}
+
+	return (int32_t)(r->u0 + (((r->u1 - r->u0) * ((g << FRAC_SHIFT) / den) +
+				   (1LL << (FRAC_SHIFT - 1))) >> FRAC_SHIFT));
+}
+
+/* Ramps up to the cruise increment vc then down to rest, returns the cruise distance */
+static int64_t move_plan(const struct profile_config *cfg, int64_t u0, int64_t vc,
+			 int64_t dist, struct ramp r[2])
+{
+	ramp_plan(cfg, u0, vc, &r[0]);
+	ramp_plan(cfg, vc, 0, &r[1]);
+
+	return dist - ramp_dist(&r[0]) - ramp_dist(&r[1]);
+}
+
+static uint64_t move_ticks(int64_t vc, int64_t cruise, const struct ramp r[2])
+{
+	return r[0].n + r[1].n + ((cruise > 0) ? div_ceil64(cruise, vc) : 0);
+}
+
+/*
+ * Cover the distance with whole cruise ticks, a partial tick would be a
+ * speed step. The ramp lengths of cruise vc are kept and the cruise solved
+ * for them, which lowers it a little. A ramp whose speed change then grows
+ * is lengthened and the cruise solved again. Returns the cruise ticks.
+ */
+static uint64_t move_fit(const struct profile_config *cfg, int64_t u0, int64_t *vc,
+			 int64_t dist, struct ramp r[2])
+{
+	int64_t cruise = move_plan(cfg, u0, *vc, dist, r);
+	uint64_t k = (cruise > 0) ? div_ceil64(cruise, *vc) : 0;
+	uint64_t n0 = r[0].n;
+	uint64_t n1 = r[1].n;
+
+	for (;;) {
+		*vc = MAX((2 * dist - u0 * (int64_t)n0) / (int64_t)(n0 + n1 + 2 * k), 1);
+		move_plan(cfg, u0, *vc, dist, r);
+		if (r[0].n <= n0 && r[1].n <= n1) {
+			break;
+		}
+		n0 = MAX(n0, r[0].n);
+		n1 = MAX(n1, r[1].n);
+	}
+
+	r[0].n = n0;
+	r[1].n = n1;
+
+	return k;
+}
+
+static int64_t ramp_fill(int32_t *table, const struct ramp *r, int dir)
+{
+	int64_t sum = 0;
+
+	for (uint32_t k = 0; k < r->n; k++) {
+		table[k] = dir * ramp_inc(r, k);
+		sum += table[k];
+	}
+
+	return sum;
+}
+
+int profile_init(struct profile *p, const struct profile_config *cfg,
+		 int32_t position)
+{
+	if (cfg->rate_hz == 0 || cfg->rate_hz > UINT16_MAX || cfg->max_speed <= 0 ||
+	    cfg->max_accel <= 0 || (cfg->shape == PROFILE_SCURVE && cfg->max_jerk <= 0) ||
+	    cfg->table == NULL || cfg->table_len == 0 ||
+	    speed_to_inc(cfg, cfg->max_speed) > INT32_MAX / 4) {
+		return -EINVAL;
+	}
+
+	memset(p, 0, sizeof(*p));
+	p->cfg = *cfg;
+	p->pos = (int64_t)position << Q16_SHIFT;
+	p->target = position;
+	p->seg = SEG_DONE;
+
+	return 0;
+}
+
+void profile_point_get(const struct profile *p, struct profile_point *pt)
+{
+	pt->position = (int32_t)((p->pos + (1LL << (Q16_SHIFT - 1))) >> Q16_SHIFT);
+	pt->speed = (int32_t)(((int64_t)p->inc * p->cfg.rate_hz +
+			       (1LL << (Q16_SHIFT - 1))) >> Q16_SHIFT);
+}
+
+int profile_move(struct profile *p, const struct profile_point *from,
+		 int32_t target, uint32_t duration_ms)
+{
+	const struct profile_config *cfg = &p->cfg;
+	int32_t *table = cfg->table;
+	struct ramp r[2] = {0};
+	int64_t pos, dist, cruise, rest, sum[2];
+	int64_t v0, u0, lo, hi, vc = 0;
+	uint64_t ticks = UINT32_MAX / 2, cruise_ticks = 0;
+	uint32_t pre = 0;
+	int dir;
+
+	if (from != NULL) {
+		if (from->speed > cfg->max_speed || from->speed < -cfg->max_speed) {
+			return -ERANGE;
+		}
+		pos = (int64_t)from->position << Q16_SHIFT;
+		v0 = speed_to_inc(cfg, from->speed);
+	} else {
+		pos = p->pos;
+		v0 = p->inc;
+
+		/* S-curves blend at the end of the ramp in progress */
+		if (cfg->shape == PROFILE_SCURVE && p->seg != SEG_CRUISE &&
+		    p->seg != SEG_DONE) {
+			pre = p->seg_ticks[p->seg] - p->tick;
+			for (uint32_t k = 0; k < pre; k++) {
+				pos += table[p->index + k];
+			}
+			v0 = p->seg_end[p->seg];
+		}
+	}
+
+	if (duration_ms > 0) {
+		ticks = div_ceil64((uint64_t)duration_ms * cfg->rate_hz, MSEC_PER_SEC);
+		if (ticks < pre) {
+			return -ERANGE;
+		}
+		ticks -= pre;
+	}
+
+	dist = ((int64_t)target << Q16_SHIFT) - pos;
+	dir = (dist > 0) ? 1 : (dist < 0) ? -1 : (v0 > 0) ? -1 : 1;
+	u0 = dir * v0;
+
+	/* Overshooting anyway: the move turns around after stopping */
+	if (u0 > 0) {
+		move_plan(cfg, u0, 0, 0, r);
+		if (ramp_dist(&r[0]) > dir * dist) {
+			dir = -dir;
+			u0 = -u0;
+		}
+	}
+	dist *= dir;
+
+	if (dist != 0 || u0 != 0) {
+		/* Fastest cruise whose ramps fit the distance */
+		lo = 1;
+		hi = speed_to_inc(cfg, cfg->max_speed);
+		while (lo < hi) {
+			vc = lo + (hi - lo + 1) / 2;
+			if (move_plan(cfg, u0, vc, dist, r) >= 0) {
+				lo = vc;
+			} else {
+				hi = vc - 1;
+			}
+		}
+
+		cruise = move_plan(cfg, u0, lo, dist, r);
+		if (move_ticks(lo, cruise, r) > ticks) {
+			return -ERANGE;
+		}
+
+		if (duration_ms > 0) {
+			/* Slowest cruise still on time */
+			hi = lo;
+			lo = 1;
+			while (lo < hi) {
+				vc = lo + (hi - lo) / 2;
+				cruise = move_plan(cfg, u0, vc, dist, r);
+				if (move_ticks(vc, cruise, r) <= ticks) {
+					hi = vc;
+				} else {
+					lo = vc + 1;
+				}
+			}
+		}
+
+		vc = lo;
+		cruise_ticks = move_fit(cfg, u0, &vc, dist, r);
+	}
+
+	/* Checked before the table changes, a running move stays intact */
+	if (r[0].n > RAMP_MAX_TICKS || r[1].n > RAMP_MAX_TICKS ||
+	    (size_t)pre + r[0].n + r[1].n > cfg->table_len) {
+		return -ENOMEM;
+	}
+	if (pre + r[0].n + r[1].n + cruise_ticks > UINT32_MAX / 2) {
+		return -ERANGE;
+	}
+
+	memmove(table, &table[p->index], pre * sizeof(*table));
+	sum[0] = ramp_fill(&table[pre], &r[0], dir);
+	sum[1] = ramp_fill(&table[pre + r[0].n], &r[1], dir);
+
+	/*
+	 * The rounding left over is spread over the ramps, one unit per tick,
+	 * the cruise takes up the rest.
+	 */
+	rest = dist - dir * (sum[0] + sum[1]) - (int64_t)cruise_ticks * vc;
+	for (uint32_t k = 0; k < r[0].n + r[1].n && rest != 0; k++) {
+		table[pre + k] += (rest > 0) ? dir : -dir;
+		rest += (rest > 0) ? -1 : 1;
+	}
+	p->cruise_inc = (cruise_ticks > 0) ?
+			(int32_t)(dir * (vc + rest / (int64_t)cruise_ticks)) : 0;
+
+	p->seg_ticks[SEG_PRE] = pre;
+	p->seg_ticks[SEG_ACCEL] = r[0].n;
+	p->seg_ticks[SEG_CRUISE] = cruise_ticks;
+	p->seg_ticks[SEG_DECEL] = r[1].n;
+	p->seg_end[SEG_PRE] = (int32_t)v0;
+	p->seg_end[SEG_ACCEL] = (int32_t)(dir * vc);
+	p->seg_end[SEG_CRUISE] = p->cruise_inc;
+	p->seg_end[SEG_DECEL] = 0;
+	p->seg = SEG_PRE;
+	p->tick = 0;
+	p->index = 0;
+	p->target = target;
+	p->remaining = pre + r[0].n + cruise_ticks + r[1].n;
+
+	if (from != NULL) {
+		p->pos = (int64_t)from->position << Q16_SHIFT;
+		p->inc = (int32_t)v0;
+	}
+
+	if (p->remaining == 0) {
+		p->pos = (int64_t)target << Q16_SHIFT;
+		p->inc = 0;
+		p->seg = SEG_DONE;
+	}
+
+	return 0;
+}
+
+void profile_copy(struct profile *dst, const struct profile *src)
+{
+	int32_t *table = dst->cfg.table;
+	uint32_t used = src->seg_ticks[SEG_PRE] + src->seg_ticks[SEG_ACCEL] +
+			src->seg_ticks[SEG_DECEL];
+
+	*dst = *src;
+	dst->cfg.table = table;
+
+	/* Only the ticks still to run, from the start of the table */
+	memcpy(table, &src->cfg.table[src->index],
+	       (used - src->index) * sizeof(*table));
+	dst->index = 0;
+}
+
+bool profile_next(struct profile *p, struct profile_point *pt)
+{
+	int32_t inc;
+
+	if (p->remaining == 0) {
+		profile_point_get(p, pt);
+		return false;
+	}
+
+	while (p->tick >= p->seg_ticks[p->seg]) {
+		p->seg++;
+		p->tick = 0;
+	}
+
+	inc = (p->seg == SEG_CRUISE) ? p->cruise_inc : p->cfg.table[p->index++];
+
+	p->tick++;
+	p->remaining--;
+	p->pos += inc;
+	p->inc = inc;
+
+	if (p->remaining == 0) {
+		p->pos = (int64_t)p->target << Q16_SHIFT;
+		p->seg = SEG_DONE;
+	}
+
+	profile_point_get(p, pt);
+
+	/* At rest from the next tick on */
+	if (p->remaining == 0) {
+		p->inc = 0;
+	}
+
+	return true;
+}
+
+uint32_t profile_remaining(const struct profile *p)
+{
+	return p->remaining;
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2025 Jared Woolston
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/spinlock.h>
+#include <zephyr/sys/__assert.h>
+#include <zephyr/sys/util.h>
+
+#include <app/lib/sensor_event.h>
+
+#define NUM_PRIOS	CONFIG_SENSOR_EVENT_PRIORITIES
+
+static struct k_spinlock lock;
+static sys_slist_t pending[NUM_PRIOS];
+/* Bit n is set when pending[n] is not empty */
+static uint32_t pending_mask;
+static K_SEM_DEFINE(wake, 0, 1);
+
+void sensor_event_init(struct sensor_event *evt, sensor_event_handler_t handler,
+		       uint8_t prio)
+{
+	__ASSERT_NO_MSG(prio < NUM_PRIOS);
+
+	memset(evt, 0, sizeof(*evt));
+	evt->handler = handler;
+	evt->prio = prio;
+}
+
+int sensor_event_post(struct sensor_event *evt)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	if (evt->pending) {
+		evt->stats.coalesced++;
+		k_spin_unlock(&lock, key);
+		return -EALREADY;
+	}
+
+	evt->pending = true;
+	evt->post_cycles = k_cycle_get_32();
+	sys_slist_append(&pending[evt->prio], &evt->node);
+	pending_mask |= BIT(evt->prio);
+	k_spin_unlock(&lock, key);
+
+	k_sem_give(&wake);
+
+	return 0;
+}
+
+static struct sensor_event *sensor_event_next(void)
+{
+	struct sensor_event *evt = NULL;
+	k_spinlock_key_t key;
+	uint32_t latency;
+	uint8_t prio;
+
+	key = k_spin_lock(&lock);
+	if (pending_mask != 0) {
+		prio = find_lsb_set(pending_mask) - 1;
+		evt = CONTAINER_OF(sys_slist_get_not_empty(&pending[prio]),
+				   struct sensor_event, node);
+		if (sys_slist_is_empty(&pending[prio])) {
+			pending_mask &= ~BIT(prio);
+		}
+
+		latency = k_cycle_get_32() - evt->post_cycles;
+		evt->stats.count++;
+		evt->stats.latency_last = latency;
+		evt->stats.latency_max = MAX(evt->stats.latency_max, latency);
+		evt->stats.latency_sum += latency;
+
+		/* Posts from here on queue the event again */
+		evt->pending = false;
+	}
+	k_spin_unlock(&lock, key);
+
+	return evt;
+}
+
+void sensor_event_stats_get(struct sensor_event *evt,
+			    struct sensor_event_stats *stats, bool reset)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	*stats = evt->stats;
+	if (reset) {
+		memset(&evt->stats, 0, sizeof(evt->stats));
+	}
+	k_spin_unlock(&lock, key);
+}
+
+static void sensor_event_loop(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	struct sensor_event *evt;
+
+	while (1) {
+		k_sem_take(&wake, K_FOREVER);
+
+		while ((evt = sensor_event_next()) != NULL) {
+			evt->handler(evt);
+		}
+	}
+}
+
+K_THREAD_DEFINE(sensor_event_thread, CONFIG_SENSOR_EVENT_THREAD_STACK_SIZE,
+		sensor_event_loop, NULL, NULL, NULL,
+		K_PRIO_COOP(CONFIG_SENSOR_EVENT_THREAD_PRIORITY), 0, 0);
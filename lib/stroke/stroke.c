@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2025 Jared Woolston
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <zephyr/sys/util.h>
+
+#include <app/lib/stroke.h>
+
+/* Baseline and noise level are Q24.8 raw LSB */
+#define Q8_SHIFT	8
+
+/* Averaging of the stroke peaks, in 2^n strokes */
+#define PEAK_AVG_SHIFT	2
+
+static uint32_t ms_to_samples(const struct stroke_config *cfg, uint32_t ms)
+{
+	return MAX(DIV_ROUND_UP(ms * cfg->rate_hz, 1000U), 1U);
+}
+
+int stroke_init(struct stroke *s, const struct stroke_config *cfg)
+{
+	if (cfg->rate_hz == 0 || cfg->axis > 2 || cfg->baseline_shift > 20 ||
+	    cfg->noise_shift > 20 || cfg->min_threshold <= 0 ||
+	    cfg->max_stroke_ms <= cfg->min_stroke_ms) {
+		return -EINVAL;
+	}
+
+	memset(s, 0, sizeof(*s));
+	s->cfg = *cfg;
+	s->quiet_samples = ms_to_samples(cfg, cfg->quiet_ms);
+	s->min_samples = ms_to_samples(cfg, cfg->min_stroke_ms);
+	s->max_samples = ms_to_samples(cfg, cfg->max_stroke_ms);
+
+	return 0;
+}
+
+static int32_t stroke_threshold(const struct stroke *s)
+{
+	const struct stroke_config *cfg = &s->cfg;
+	int32_t noise = (int32_t)(((int64_t)s->noise * cfg->noise_ratio) >>
+				  (2 * Q8_SHIFT));
+	int32_t peak = (int32_t)(((int64_t)s->peak_avg * cfg->peak_ratio) >>
+				 Q8_SHIFT);
+
+	return MAX(cfg->min_threshold, MAX(noise, peak));
+}
+
+static bool stroke_end(struct stroke *s)
+{
+	struct stroke_event evt;
+	uint32_t end = s->settled ? s->end : s->n;
+
+	s->active = false;
+	s->last_quiet = s->n;
+
+	if (end - s->start < s->min_samples) {
+		return false;
+	}
+
+	s->peak_avg = (s->count == 0) ? s->peak :
+		      s->peak_avg + ((s->peak - s->peak_avg) >> PEAK_AVG_SHIFT);
+	s->count++;
+
+	if (s->cfg.handler != NULL) {
+		evt.count = s->count;
+		evt.start = s->start;
+		evt.samples = end - s->start;
+		evt.duration_ms = (uint32_t)(((uint64_t)evt.samples * 1000U) /
+					     s->cfg.rate_hz);
+		evt.peak = s->peak;
+		evt.crossings = s->crossings;
+		s->cfg.handler(&evt, s->cfg.user_data);
+	}
+
+	return true;
+}
+
+static bool stroke_sample(struct stroke *s, int32_t x)
+{
+	const struct stroke_config *cfg = &s->cfg;
+	int32_t dev, mag, band;
+	int8_t sign;
+	bool done = false;
+
+	if (!s->primed) {
+		s->baseline = x << Q8_SHIFT;
+		s->primed = true;
+	}
+
+	dev = x - (s->baseline >> Q8_SHIFT);
+	mag = abs(dev);
+
+	/* Twice the mean absolute noise is about its peak */
+	band = MAX(s->noise >> (Q8_SHIFT - 1), 1);
+
+	/* Zero crossings with the noise band as hysteresis */
+	sign = (dev > band) ? 1 : (dev < -band) ? -1 : s->sign;
+	if (sign != s->sign) {
+		if (s->active && s->sign != 0) {
+			s->crossings++;
+		}
+		s->sign = sign;
+	}
+
+	if (!s->active) {
+		int32_t threshold = stroke_threshold(s);
+
+		if (mag > threshold) {
+			s->active = true;
+			s->settled = false;
+			s->start = s->last_quiet;
+			s->threshold = threshold;
+			s->peak = mag;
+			s->below = 0;
+			s->crossings = 0;
+		} else {
+			if (mag <= band) {
+				s->last_quiet = s->n;
+			}
+			s->baseline += ((x << Q8_SHIFT) - s->baseline) >>
+				       cfg->baseline_shift;
+			s->noise += ((mag << Q8_SHIFT) - s->noise) >> cfg->noise_shift;
+		}
+	} else {
+		s->peak = MAX(s->peak, mag);
+
+		if (mag >= s->threshold / 2) {
+			s->below = 0;
+			s->settled = false;
+		} else {
+			if (!s->settled && mag <= band) {
+				s->end = s->n;
+				s->settled = true;
+			}
+			if (++s->below >= s->quiet_samples) {
+				done = stroke_end(s);
+			}
+		}
+
+		if (s->active && s->n - s->start > s->max_samples) {
+			/* Not a stroke, the offset changed: start over */
+			s->active = false;
+			s->primed = false;
+			s->last_quiet = s->n;
+		}
+	}
+
+	s->n++;
+
+	return done;
+}
+
+int stroke_feed(struct stroke *s, const int16_t (*acc)[3], size_t count)
+{
+	int strokes = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		if (stroke_sample(s, acc[i][s->cfg.axis])) {
+			strokes++;
+		}
+	}
+
+	return strokes;
+}
+
+uint32_t stroke_count(const struct stroke *s)
+{
+	return s->count;
+}
@@ -0,0 +1,235 @@
+/*
+ * Copyright (c) 2025 Jared Woolston
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <arm_math.h>
+
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+#include <app/lib/vibration.h>
+
+#define BLOCK_SIZE	CONFIG_VIBRATION_BLOCK_SIZE
+#define NUM_BINS	(BLOCK_SIZE / 2 + 1)
+
+BUILD_ASSERT(IS_POWER_OF_TWO(BLOCK_SIZE) && BLOCK_SIZE >= 32 &&
+	     BLOCK_SIZE <= 4096, "unsupported FFT block size");
+
+/* Normalised block peak, leaving one bit of headroom for the window */
+#define PEAK_SHIFT	14
+
+static K_THREAD_STACK_DEFINE(vibration_stack, CONFIG_VIBRATION_THREAD_STACK_SIZE);
+static struct k_work_q vibration_wq;
+
+/*
+ * The work queue runs one block at a time, the FFT buffers and tables are
+ * shared by all instances.
+ */
+static arm_rfft_instance_q15 rfft;
+static q15_t hann[BLOCK_SIZE];
+static q15_t spectrum[2 * BLOCK_SIZE];
+
+static uint64_t threshold(uint64_t baseline, uint16_t ratio)
+{
+	if (baseline < BIT64(40)) {
+		return (baseline * ratio) >> 8;
+	}
+
+	return (baseline >> 8) * ratio;
+}
+
+static void vibration_baseline(struct vibration *vib, uint8_t band)
+{
+	const struct vibration_config *cfg = &vib->cfg;
+	int64_t delta = (int64_t)(vib->energy[band] - vib->baseline[band]);
+	uint32_t n = vib->stats.blocks;
+	struct vibration_alarm alarm;
+
+	if (n < cfg->warmup_blocks) {
+		/* Running mean until the EMA has enough history */
+		vib->baseline[band] += delta / (int64_t)(n + 1);
+		return;
+	}
+
+	if (vib->energy[band] > threshold(vib->baseline[band], cfg->alarm_ratio) &&
+	    vib->energy[band] >= cfg->min_energy) {
+		if (cfg->handler != NULL) {
+			alarm.band = band;
+			alarm.energy = vib->energy[band];
+			alarm.baseline = vib->baseline[band];
+			cfg->handler(vib, &alarm, cfg->user_data);
+		}
+		return;
+	}
+
+	vib->baseline[band] += delta >> cfg->baseline_shift;
+}
+
+static void vibration_process(struct k_work *work)
+{
+	struct vibration *vib = CONTAINER_OF(work, struct vibration, work);
+	q15_t *in = vib->block[vib->active ^ 1];
+	uint32_t start = k_cycle_get_32();
+	uint32_t cycles, index;
+	q15_t mean, peak;
+	int shift = 0;
+
+	arm_mean_q15(in, BLOCK_SIZE, &mean);
+	arm_offset_q15(in, -mean, in, BLOCK_SIZE);
+	arm_absmax_q15(in, BLOCK_SIZE, &peak, &index);
+
+	if (peak == 0) {
+		memset(spectrum, 0, sizeof(spectrum));
+	} else {
+		while (shift < PEAK_SHIFT && (peak << (shift + 1)) < BIT(PEAK_SHIFT)) {
+			shift++;
+		}
+
+		arm_shift_q15(in, shift, in, BLOCK_SIZE);
+		arm_mult_q15(in, hann, in, BLOCK_SIZE);
+		arm_rfft_q15(&rfft, in, spectrum);
+	}
+
+	for (uint8_t b = 0; b < vib->cfg.num_bands; b++) {
+		uint64_t energy = 0;
+
+		/*
+		 * Squared magnitudes are summed at full precision, the FFT output
+		 * is scaled down by N / 2 and arm_cmplx_mag_squared_q15() would
+		 * round small bins to zero.
+		 */
+		for (uint16_t k = vib->bin_low[b]; k <= vib->bin_high[b]; k++) {
+			int32_t re = spectrum[2 * k];
+			int32_t im = spectrum[2 * k + 1];
+
+			energy += (uint32_t)(re * re) + (uint32_t)(im * im);
+		}
+
+		/* Undo the normalisation, squared */
+		vib->energy[b] = energy << (2 * (PEAK_SHIFT - shift));
+
+		if (vib->stats.blocks == 0) {
+			vib->baseline[b] = vib->energy[b];
+		} else {
+			vibration_baseline(vib, b);
+		}
+	}
+
+	cycles = k_cycle_get_32() - start;
+	vib->stats.cycles_last = cycles;
+	vib->stats.cycles_max = MAX(vib->stats.cycles_max, cycles);
+	vib->stats.blocks++;
+
+	atomic_clear(&vib->busy);
+}
+
+int vibration_init(struct vibration *vib, const struct vibration_config *cfg)
+{
+	uint32_t bin_hz_num = cfg->rate_hz;
+
+	if (cfg->rate_hz == 0 || cfg->axis > 2 || cfg->bands == NULL ||
+	    cfg->num_bands == 0 || cfg->num_bands > CONFIG_VIBRATION_MAX_BANDS ||
+	    cfg->baseline_shift > 16) {
+		return -EINVAL;
+	}
+
+	memset(vib, 0, sizeof(*vib));
+	vib->cfg = *cfg;
+	k_work_init(&vib->work, vibration_process);
+
+	/* Bin k covers k * rate / N Hz */
+	for (uint8_t b = 0; b < cfg->num_bands; b++) {
+		const struct vibration_band *band = &cfg->bands[b];
+		uint32_t low = DIV_ROUND_UP(band->low_hz * BLOCK_SIZE, bin_hz_num);
+		uint32_t high = (band->high_hz * BLOCK_SIZE) / bin_hz_num;
+
+		if (band->low_hz > band->high_hz || high >= NUM_BINS) {
+			return -EINVAL;
+		}
+
+		/* The DC bin only holds what is left of the mean */
+		vib->bin_low[b] = MAX(low, 1);
+		vib->bin_high[b] = MAX(high, vib->bin_low[b]);
+	}
+
+	return 0;
+}
+
+int vibration_feed(struct vibration *vib, const int16_t (*acc)[3],
+		   size_t count)
+{
+	int ret = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		vib->block[vib->active][vib->fill++] = acc[i][vib->cfg.axis];
+
+		if (vib->fill < BLOCK_SIZE) {
+			continue;
+		}
+
+		vib->fill = 0;
+
+		/* Refill the same block if the previous one is still queued */
+		if (!atomic_cas(&vib->busy, 0, 1)) {
+			vib->stats.overruns++;
+			ret = -EBUSY;
+			continue;
+		}
+
+		vib->active ^= 1;
+		k_work_submit_to_queue(&vibration_wq, &vib->work);
+	}
+
+	return ret;
+}
+
+void vibration_energy_get(const struct vibration *vib, uint64_t *energy,
+			  uint64_t *baseline)
+{
+	for (uint8_t b = 0; b < vib->cfg.num_bands; b++) {
+		if (energy != NULL) {
+			energy[b] = vib->energy[b];
+		}
+		if (baseline != NULL) {
+			baseline[b] = vib->baseline[b];
+		}
+	}
+}
+
+void vibration_stats_get(const struct vibration *vib,
+			 struct vibration_stats *stats)
+{
+	*stats = vib->stats;
+}
+
+static int vibration_sys_init(void)
+{
+	const struct k_work_queue_config cfg = {
+		.name = "vibration",
+	};
+
+	if (arm_rfft_init_q15(&rfft, BLOCK_SIZE, 0, 1) != ARM_MATH_SUCCESS) {
+		return -EINVAL;
+	}
+
+	/* w[n] = (1 - cos(2 pi n / N)) / 2, the q15 cosine input spans one turn */
+	for (int n = 0; n < BLOCK_SIZE; n++) {
+		q15_t c = arm_cos_q15((q15_t)(n * (32768 / BLOCK_SIZE)));
+
+		hann[n] = (q15_t)((INT16_MAX - c) >> 1);
+	}
+
+	k_work_queue_start(&vibration_wq, vibration_stack,
+			   K_THREAD_STACK_SIZEOF(vibration_stack),
+			   CONFIG_VIBRATION_THREAD_PRIORITY, &cfg);
+
+	return 0;
+}
+
+SYS_INIT(vibration_sys_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
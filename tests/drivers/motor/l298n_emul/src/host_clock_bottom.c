@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2025 Jared Woolston
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Built with the native simulator runner against the host C library: the
+ * simulated cycle counter does not advance while code runs, the host
+ * clocks measure the CPU time it takes.
+ */
+
+#include <stdint.h>
+#include <time.h>
+
+static int64_t host_clock_ns(clockid_t id)
+{
+	struct timespec ts;
+
+	clock_gettime(id, &ts);
+
+	return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+int64_t test_host_cpu_ns(void)
+{
+	return host_clock_ns(CLOCK_PROCESS_CPUTIME_ID);
+}
+
+int64_t test_host_wall_ns(void)
+{
+	return host_clock_ns(CLOCK_MONOTONIC);
+}
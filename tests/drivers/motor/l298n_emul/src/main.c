@@ -0,0 +1,281 @@
+/*
+ * Copyright (c) 2025 Jared Woolston
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * @file test closed-loop motor control against the L298N emulator
+ *
+ * This suite drives the L298N driver into the DC motor model of the
+ * emulator: open-loop drive, brake and coast through the PWM and GPIO
+ * paths, then the control loops on the model counts, a speed step, a load
+ * step and a profiled move, with their settling times and overshoots. The
+ * model is a 6000 counts/s gearmotor with a 20 ms time constant and a
+ * 300 counts/s friction load. The host CPU time per control loop iteration
+ * and the speed against real time are reported, they are only meaningful
+ * as relative figures.
+ */
+
+#include <stdlib.h>
+
+#include <zephyr/device.h>
+#include <zephyr/ztest.h>
+
+#include <app/drivers/motor.h>
+#include <app/drivers/motor/l298n_emul.h>
+#include <app/lib/motor_ctrl.h>
+
+#define LOAD		300
+#define SPEED		3000
+#define DISTANCE	2000
+
+/* Settled within 2 % of the speed, or 2 counts of the position */
+#define SPEED_BAND	(SPEED / 50)
+#define POSITION_BAND	2
+
+/* From the host clocks, see host_clock_bottom.c */
+int64_t test_host_cpu_ns(void);
+int64_t test_host_wall_ns(void);
+
+static const struct device *const motor = DEVICE_DT_GET(DT_NODELABEL(motors));
+static const struct device *const plant = DEVICE_DT_GET(DT_NODELABEL(plant));
+
+static struct motor_l298n_emul_encoder encoder = {
+	.dev = DEVICE_DT_GET(DT_NODELABEL(plant)),
+	.channel = 0,
+};
+
+static const struct motor_l298n_emul_model model = {
+	.max_speed = 6000,
+	.time_constant_us = 20000,
+	.load = LOAD,
+};
+
+static int32_t table[1024];
+static struct motor_ctrl ctrl;
+
+static const struct motor_ctrl_config ctrl_cfg = {
+	.motor = DEVICE_DT_GET(DT_NODELABEL(motors)),
+	.channel = 0,
+	.encoder = motor_l298n_emul_encoder_read,
+	.user_data = &encoder,
+	.speed_gains = {
+		.kp = 2 * PID_GAIN_ONE,
+		.ki = PID_GAIN_ONE / 10,
+	},
+	.position_gains = {
+		.kp = 30 * PID_GAIN_ONE,
+	},
+	.max_speed = 5000,
+	.speed_filter_shift = 3,
+	.profile = {
+		.shape = PROFILE_TRAPEZOID,
+		.max_speed = 4000,
+		.max_accel = 20000,
+		.table = table,
+		.table_len = ARRAY_SIZE(table),
+	},
+};
+
+struct response {
+	int32_t peak;
+	int32_t final;
+	/* Last sample outside of the band, in ms */
+	int32_t settle_ms;
+};
+
+static int32_t plant_speed(uint8_t channel)
+{
+	struct motor_l298n_emul_state state;
+
+	zassert_ok(motor_l298n_emul_state_get(plant, channel, &state));
+
+	return state.speed;
+}
+
+static int32_t ctrl_position(void)
+{
+	struct motor_ctrl_state state;
+
+	motor_ctrl_state_get(&ctrl, &state);
+
+	return state.position;
+}
+
+/* Samples the speed or the position every ms, against a target */
+static void track(struct response *r, bool position, int32_t target,
+		  int32_t band, int ms)
+{
+	r->peak = position ? ctrl_position() : plant_speed(0);
+	r->settle_ms = 0;
+
+	for (int t = 1; t <= ms; t++) {
+		int32_t x;
+
+		k_sleep(K_MSEC(1));
+		x = position ? ctrl_position() : plant_speed(0);
+		r->peak = MAX(r->peak, x);
+		if (abs(x - target) > band) {
+			r->settle_ms = t;
+		}
+		r->final = x;
+	}
+}
+
+/* Time to a stop from the current speed, in ms */
+static int stop_time(uint8_t channel, int max_ms)
+{
+	for (int t = 0; t < max_ms; t++) {
+		if (plant_speed(channel) == 0) {
+			return t;
+		}
+		k_sleep(K_MSEC(1));
+	}
+
+	return max_ms;
+}
+
+static void *setup(void)
+{
+	zassert_true(device_is_ready(motor), "L298N did not probe the emulator");
+	zassert_ok(motor_ctrl_init(&ctrl, &ctrl_cfg));
+
+	return NULL;
+}
+
+static void before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	motor_ctrl_stop(&ctrl);
+	zassert_ok(motor_coast(motor, 1));
+	zassert_ok(motor_l298n_emul_model_set(plant, 0, &model));
+	zassert_ok(motor_l298n_emul_model_set(plant, 1, &model));
+
+	/* Friction brings both motors to rest */
+	k_sleep(K_MSEC(500));
+	zassert_equal(plant_speed(0), 0);
+	zassert_equal(plant_speed(1), 0);
+}
+
+ZTEST(l298n_emul, test_open_loop)
+{
+	int brake_ms, coast_ms;
+
+	/* Ten time constants at half voltage: half the no-load speed, less the load */
+	zassert_ok(motor_drive(motor, 1, MOTOR_DIR_FORWARD, MOTOR_SPEED_MAX / 2));
+	k_sleep(K_MSEC(200));
+	zassert_within(plant_speed(1), model.max_speed / 2 - LOAD, 30);
+
+	zassert_ok(motor_brake(motor, 1));
+	brake_ms = stop_time(1, 1000);
+
+	zassert_ok(motor_drive(motor, 1, MOTOR_DIR_REVERSE, MOTOR_SPEED_MAX / 2));
+	k_sleep(K_MSEC(200));
+	zassert_within(plant_speed(1), -(model.max_speed / 2 - LOAD), 30);
+
+	/* Only friction stops a coasting motor, the back-EMF brakes too */
+	zassert_ok(motor_coast(motor, 1));
+	coast_ms = stop_time(1, 1000);
+
+	zassert_true(brake_ms < coast_ms, "brake %d ms, coast %d ms", brake_ms,
+		     coast_ms);
+	zassert_within(coast_ms, 180, 20, "coast %d ms", coast_ms);
+
+	TC_PRINT("stop from %d counts/s: brake %d ms, coast %d ms\n",
+		 model.max_speed / 2 - LOAD, brake_ms, coast_ms);
+}
+
+ZTEST(l298n_emul, test_speed_step)
+{
+	struct response r;
+
+	motor_ctrl_speed_set(&ctrl, SPEED);
+	track(&r, false, SPEED, SPEED_BAND, 500);
+
+	zassert_within(r.final, SPEED, SPEED_BAND);
+	zassert_true(r.peak - SPEED <= SPEED / 10, "overshoot %d", r.peak - SPEED);
+	zassert_true(r.settle_ms <= 150, "settled in %d ms", r.settle_ms);
+
+	TC_PRINT("speed step to %d counts/s: %d ms settling, %d counts/s overshoot\n",
+		 SPEED, r.settle_ms, r.peak - SPEED);
+}
+
+ZTEST(l298n_emul, test_load_step)
+{
+	struct model_dip {
+		int32_t min;
+		int recover_ms;
+	} dip = {.min = SPEED};
+	struct motor_l298n_emul_model heavy = model;
+
+	motor_ctrl_speed_set(&ctrl, SPEED);
+	k_sleep(K_MSEC(500));
+
+	/* Five times the friction, e.g. a case jammed in the feeder */
+	heavy.load = 5 * LOAD;
+	zassert_ok(motor_l298n_emul_model_set(plant, 0, &heavy));
+
+	for (int t = 1; t <= 500; t++) {
+		int32_t v;
+
+		k_sleep(K_MSEC(1));
+		v = plant_speed(0);
+		dip.min = MIN(dip.min, v);
+		if (abs(v - SPEED) > SPEED_BAND) {
+			dip.recover_ms = t;
+		}
+	}
+
+	zassert_within(plant_speed(0), SPEED, SPEED_BAND);
+	zassert_true(dip.min >= SPEED * 3 / 4, "dipped to %d", dip.min);
+	zassert_true(dip.recover_ms <= 150, "recovered in %d ms", dip.recover_ms);
+
+	TC_PRINT("load step: dip to %d counts/s, recovered in %d ms\n", dip.min,
+		 dip.recover_ms);
+}
+
+ZTEST(l298n_emul, test_move)
+{
+	int32_t target = ctrl_position() + DISTANCE;
+	struct response r;
+
+	/* 200 ms ramps and 300 ms of cruise */
+	zassert_ok(motor_ctrl_move(&ctrl, target, 0));
+	track(&r, true, target, POSITION_BAND, 1500);
+
+	zassert_within(r.final, target, POSITION_BAND);
+	zassert_true(r.peak - target <= 20, "overshoot %d", r.peak - target);
+	zassert_true(r.settle_ms <= 1000, "settled in %d ms", r.settle_ms);
+
+	TC_PRINT("move of %d counts: %d ms settling, %d counts overshoot\n",
+		 DISTANCE, r.settle_ms, r.peak - target);
+}
+
+ZTEST(l298n_emul, test_benchmark)
+{
+	struct motor_ctrl_loop_stats stats;
+	int64_t cpu, wall;
+
+	motor_ctrl_speed_set(&ctrl, SPEED);
+	motor_ctrl_loop_stats_get(&stats, true);
+	cpu = test_host_cpu_ns();
+	wall = test_host_wall_ns();
+
+	k_sleep(K_SECONDS(2));
+
+	cpu = test_host_cpu_ns() - cpu;
+	wall = test_host_wall_ns() - wall;
+	motor_ctrl_loop_stats_get(&stats, false);
+
+	zassert_true(stats.count >= 2 * CONFIG_MOTOR_CTRL_RATE_HZ - 1,
+		     "%u iterations", stats.count);
+	zassert_equal(stats.overruns, 0);
+
+	/* The model steps are in, as the encoder reads advance it */
+	TC_PRINT("%u iterations, %lld ns host CPU per iteration, %lld x real time\n",
+		 stats.count, cpu / stats.count,
+		 (2LL * NSEC_PER_SEC) / MAX(wall, 1));
+}
+
+ZTEST_SUITE(l298n_emul, NULL, setup, before, NULL, NULL);
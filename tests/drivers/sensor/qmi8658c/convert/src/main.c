@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2025 Jared Woolston
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * @file test QMI8658C batch conversion
+ *
+ * This suite verifies the fixed-point batch conversion against the
+ * struct sensor_value conversion used by channel_get(), including the
+ * per-axis calibrated variant, and reports the cycles per sample of all
+ * paths. The cycle counts are only meaningful on
+ * real hardware.
+ */
+
+#include <stdlib.h>
+
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/random/random.h>
+#include <zephyr/timing/timing.h>
+#include <zephyr/ztest.h>
+
+#include "qmi8658c_convert.h"
+
+#define SAMPLES 256
+
+/* Gains of the ranges with the smallest and largest LSB */
+#define ACC_GAIN_2G	61U
+#define ACC_GAIN_16G	488U
+#define GYRO_GAIN_125	4375U
+#define GYRO_GAIN_2000	70000U
+
+static int16_t raw[SAMPLES][3];
+static q31_t out_q31[SAMPLES][3];
+static q15_t out_q15[SAMPLES][3];
+static struct sensor_value out_val[SAMPLES][3];
+
+/* Same conversion as lsm6dso_accel_convert() in the driver */
+static inline void accel_convert(struct sensor_value *val, int raw_val,
+				 uint32_t sensitivity)
+{
+	int64_t dval = (int64_t)(raw_val) * sensitivity;
+
+	sensor_ug_to_ms2(dval, val);
+}
+
+/* Same conversion as lsm6dso_gyro_convert() in the driver */
+static inline void gyro_convert(struct sensor_value *val, int raw_val,
+				uint32_t sensitivity)
+{
+	int64_t dval = (int64_t)(raw_val) * sensitivity / 10;
+
+	sensor_10udegrees_to_rad(dval, val);
+}
+
+static int64_t q31_to_micro(q31_t q, int8_t shift)
+{
+	return ((int64_t)q * 1000000LL * (1LL << shift)) >> 31;
+}
+
+static void fill_raw(void)
+{
+	sys_rand_get(raw, sizeof(raw));
+	raw[0][0] = INT16_MIN;
+	raw[0][1] = INT16_MAX;
+	raw[0][2] = 0;
+}
+
+static void check_q31(const struct lsm6dso_q31_scale *scale, bool gyro,
+		      uint32_t gain)
+{
+	for (int i = 0; i < SAMPLES; i++) {
+		for (int j = 0; j < 3; j++) {
+			struct sensor_value ref;
+			int64_t ref_micro, got_micro;
+			/* Truncation of both paths, a few q31 LSB and 1 micro unit */
+			int64_t tol = q31_to_micro(4, scale->shift) + 2;
+
+			if (gyro) {
+				gyro_convert(&ref, raw[i][j], gain);
+			} else {
+				accel_convert(&ref, raw[i][j], gain);
+			}
+			ref_micro = sensor_value_to_micro(&ref);
+			got_micro = q31_to_micro(out_q31[i][j], scale->shift);
+
+			zassert_true(llabs(ref_micro - got_micro) <= tol,
+				     "raw %d: expected %lld got %lld", raw[i][j],
+				     ref_micro, got_micro);
+			zassert_equal(out_q15[i][j], out_q31[i][j] >> 16,
+				      "q15 does not match q31");
+		}
+	}
+}
+
+static void run_conversion(bool gyro, uint32_t gain)
+{
+	struct lsm6dso_q31_scale scale;
+
+	if (gyro) {
+		lsm6dso_q31_scale_gyro(gain, &scale);
+	} else {
+		lsm6dso_q31_scale_accel(gain, &scale);
+	}
+
+	zassert_true(scale.mult > 0, "multiplier overflow");
+
+	fill_raw();
+	lsm6dso_convert_q31(&raw[0][0], &out_q31[0][0], SAMPLES * 3, scale.mult);
+	lsm6dso_convert_q15(&raw[0][0], &out_q15[0][0], SAMPLES * 3, scale.mult);
+	check_q31(&scale, gyro, gain);
+}
+
+ZTEST(qmi8658c_convert, test_accel)
+{
+	run_conversion(false, ACC_GAIN_2G);
+	run_conversion(false, ACC_GAIN_16G);
+	run_conversion(false, ACC_GAIN_16G * 2);
+}
+
+ZTEST(qmi8658c_convert, test_gyro)
+{
+	run_conversion(true, GYRO_GAIN_125);
+	run_conversion(true, GYRO_GAIN_2000);
+}
+
+ZTEST(qmi8658c_convert, test_odd_length)
+{
+	struct lsm6dso_q31_scale scale;
+	int16_t in[3] = {1000, -1000, 12345};
+	q31_t q31[3];
+	q15_t q15[3];
+
+	lsm6dso_q31_scale_accel(ACC_GAIN_2G, &scale);
+	lsm6dso_convert_q31(in, q31, ARRAY_SIZE(in), scale.mult);
+	lsm6dso_convert_q15(in, q15, ARRAY_SIZE(in), scale.mult);
+
+	zassert_true(abs(q31[0] + q31[1]) <= 1, "sign handling");
+	zassert_equal(q15[2], q31[2] >> 16, "odd tail");
+}
+
+ZTEST(qmi8658c_convert, test_calibrated)
+{
+	static const int32_t gain_q16[3] = {65536, 72090, 58982};
+	static const int64_t offset_micro[3] = {1500000, -250000, 0};
+	struct lsm6dso_q31_scale scale;
+	struct lsm6dso_q31_cal cal;
+	/* An odd count also runs the single sample tail */
+	const size_t count = SAMPLES - 1;
+
+	lsm6dso_q31_scale_accel(ACC_GAIN_16G, &scale);
+	zassert_ok(lsm6dso_q31_cal_fold(&scale, gain_q16, offset_micro, &cal));
+	zassert_true(cal.shift >= scale.shift, "calibration lost headroom");
+
+	fill_raw();
+	lsm6dso_convert_q31_cal(raw, out_q31, count, &cal);
+	lsm6dso_convert_q15_cal(raw, out_q15, count, &cal);
+
+	for (size_t i = 0; i < count; i++) {
+		for (int j = 0; j < 3; j++) {
+			struct sensor_value ref;
+			int64_t ref_micro, got_micro;
+			int64_t tol = q31_to_micro(8, cal.shift) + 2;
+
+			accel_convert(&ref, raw[i][j], ACC_GAIN_16G);
+			ref_micro = sensor_value_to_micro(&ref) * gain_q16[j] / 65536 +
+				    offset_micro[j];
+			got_micro = q31_to_micro(out_q31[i][j], cal.shift);
+
+			zassert_true(llabs(ref_micro - got_micro) <= tol,
+				     "raw %d: expected %lld got %lld", raw[i][j],
+				     ref_micro, got_micro);
+			zassert_equal(out_q31[i][j],
+				      lsm6dso_q31_cal_apply(&cal, j, raw[i][j]),
+				      "batch and single conversion differ");
+			zassert_equal(out_q15[i][j], out_q31[i][j] >> 16,
+				      "q15 does not match q31");
+		}
+	}
+}
+
+ZTEST(qmi8658c_convert, test_calibrated_range)
+{
+	static const int32_t gain_q16[3] = {65536, 65536, 65536};
+	static const int64_t huge[3] = {INT32_MAX * 1000000LL, 0, 0};
+	static const int64_t none[3] = {0, 0, 0};
+	struct lsm6dso_q31_scale scale;
+	struct lsm6dso_q31_cal cal;
+
+	lsm6dso_q31_scale_gyro(GYRO_GAIN_2000, &scale);
+	zassert_ok(lsm6dso_q31_cal_fold(&scale, gain_q16, none, &cal));
+	zassert_equal(cal.shift, scale.shift, "unity needs no extra shift");
+	zassert_equal(cal.mult[0], scale.mult, "unity changes the multiplier");
+	zassert_equal(lsm6dso_q31_cal_fold(&scale, gain_q16, huge, &cal), -ERANGE);
+}
+
+ZTEST(qmi8658c_convert, test_benchmark)
+{
+	static const int32_t gain_q16[3] = {65536, 65536, 65536};
+	static const int64_t offset_micro[3] = {100000, 100000, 100000};
+	struct lsm6dso_q31_scale scale;
+	struct lsm6dso_q31_cal cal;
+	timing_t start, end;
+	uint64_t legacy, q31, q15, q31_cal;
+
+	lsm6dso_q31_scale_accel(ACC_GAIN_16G, &scale);
+	zassert_ok(lsm6dso_q31_cal_fold(&scale, gain_q16, offset_micro, &cal));
+	fill_raw();
+
+	start = timing_counter_get();
+	for (int i = 0; i < SAMPLES; i++) {
+		for (int j = 0; j < 3; j++) {
+			accel_convert(&out_val[i][j], raw[i][j], ACC_GAIN_16G);
+		}
+	}
+	end = timing_counter_get();
+	legacy = timing_cycles_get(&start, &end);
+
+	start = timing_counter_get();
+	lsm6dso_convert_q31(&raw[0][0], &out_q31[0][0], SAMPLES * 3, scale.mult);
+	end = timing_counter_get();
+	q31 = timing_cycles_get(&start, &end);
+
+	start = timing_counter_get();
+	lsm6dso_convert_q15(&raw[0][0], &out_q15[0][0], SAMPLES * 3, scale.mult);
+	end = timing_counter_get();
+	q15 = timing_cycles_get(&start, &end);
+
+	start = timing_counter_get();
+	lsm6dso_convert_q31_cal(raw, out_q31, SAMPLES, &cal);
+	end = timing_counter_get();
+	q31_cal = timing_cycles_get(&start, &end);
+
+	TC_PRINT("cycles per x/y/z sample: sensor_value %llu, q31 %llu, q15 %llu, "
+		 "calibrated q31 %llu\n", legacy / SAMPLES, q31 / SAMPLES,
+		 q15 / SAMPLES, q31_cal / SAMPLES);
+}
+
+static void *qmi8658c_convert_setup(void)
+{
+	timing_init();
+	timing_start();
+
+	return NULL;
+}
+
+ZTEST_SUITE(qmi8658c_convert, NULL, qmi8658c_convert_setup, NULL, NULL, NULL);
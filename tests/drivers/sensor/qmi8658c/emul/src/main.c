@@ -0,0 +1,550 @@
+/*
+ * Copyright (c) 2025 Jared Woolston
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * @file test QMI8658C driver against the I2C emulator
+ *
+ * This suite runs the driver on an emulated chip: probing, conversions of
+ * fetched samples, the asynchronous read and its decoder, the data-ready and
+ * motion triggers, and FIFO draining of a scripted press stroke motion
+ * profile, and with calibration enabled its
+ * application, fitting and collection.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/rtio/rtio.h>
+#include <zephyr/ztest.h>
+
+#include <app/drivers/sensor/qmi8658c.h>
+#include <app/drivers/sensor/qmi8658c_emul.h>
+
+#define IMU_NODE	DT_NODELABEL(imu)
+
+/* Power-up ranges: 2 g and 250 dps */
+#define ACC_GAIN_UG	61LL
+#define GYRO_GAIN_UDPS	8750LL
+
+/* Sample pairs pushed at once, two words each, half the FIFO watermark */
+#define PUSH_PAIRS	(DT_PROP(IMU_NODE, fifo_watermark) / 4)
+
+static const struct device *const imu = DEVICE_DT_GET(IMU_NODE);
+static const struct emul *const emul = EMUL_DT_GET(IMU_NODE);
+
+static int64_t acc_micro(int16_t raw)
+{
+	return (int64_t)raw * ACC_GAIN_UG * SENSOR_G / 1000000LL;
+}
+
+static int64_t gyro_micro(int16_t raw)
+{
+	return (int64_t)raw * GYRO_GAIN_UDPS * SENSOR_PI / (180LL * 1000000LL);
+}
+
+static void assert_micro(const struct sensor_value *val, int64_t expected,
+			 int64_t tol)
+{
+	int64_t got = sensor_value_to_micro(val);
+
+	zassert_true(llabs(got - expected) <= tol, "expected %lld got %lld",
+		     expected, got);
+}
+
+ZTEST(qmi8658c_emul, test_probe)
+{
+	zassert_true(device_is_ready(imu), "driver did not probe the emulator");
+	zassert_equal(qmi8658c_emul_reg_get(emul, 0x0F), 0x6C, "WHO_AM_I");
+}
+
+ZTEST(qmi8658c_emul, test_fetch_convert)
+{
+	static const int16_t acc[3] = {16384, -8192, 1};
+	static const int16_t gyro[3] = {10000, -20000, 0};
+	struct sensor_value val[3];
+	struct qmi8658c_sample_time time;
+
+	qmi8658c_emul_sample_set(emul, acc, gyro, 256);
+	zassert_ok(sensor_sample_fetch(imu));
+
+	zassert_ok(sensor_channel_get(imu, SENSOR_CHAN_ACCEL_XYZ, val));
+	for (int i = 0; i < 3; i++) {
+		assert_micro(&val[i], acc_micro(acc[i]), 1);
+	}
+
+	zassert_ok(sensor_channel_get(imu, SENSOR_CHAN_GYRO_XYZ, val));
+	for (int i = 0; i < 3; i++) {
+		assert_micro(&val[i], gyro_micro(gyro[i]), 10);
+	}
+
+	zassert_ok(sensor_channel_get(imu, SENSOR_CHAN_DIE_TEMP, val));
+	zassert_equal(val[0].val1, 26);
+	zassert_equal(val[0].val2, 0);
+
+	zassert_ok(qmi8658c_sample_time_get(imu, &time));
+	zassert_true(time.chip_ticks > 0, "timestamp not read");
+}
+
+ZTEST(qmi8658c_emul, test_convert_q31)
+{
+	static const int16_t raw[2][3] = {{16384, -16384, 0}, {1000, 2000, -3000}};
+	q31_t out[2][3];
+	int8_t shift;
+
+	zassert_ok(qmi8658c_convert_q31(imu, QMI8658C_SENSOR_ACCEL, raw, out, 2,
+					&shift));
+	for (int i = 0; i < 2; i++) {
+		for (int j = 0; j < 3; j++) {
+			int64_t got = ((int64_t)out[i][j] * 1000000LL *
+				       (1LL << shift)) >> 31;
+
+			zassert_true(llabs(got - acc_micro(raw[i][j])) <= 20,
+				     "q31 accel %d", raw[i][j]);
+		}
+	}
+}
+
+#if defined(CONFIG_QMI8658C_ASYNC)
+SENSOR_DT_READ_IODEV(imu_iodev, IMU_NODE,
+		     {SENSOR_CHAN_ACCEL_XYZ, 0},
+		     {SENSOR_CHAN_GYRO_XYZ, 0},
+		     {SENSOR_CHAN_DIE_TEMP, 0});
+RTIO_DEFINE(imu_rtio, 1, 1);
+
+static int64_t q31_micro(q31_t val, int8_t shift)
+{
+	return ((int64_t)val * 1000000LL * (1LL << shift)) >> 31;
+}
+
+ZTEST(qmi8658c_emul, test_read_decode)
+{
+	static const int16_t acc[3] = {16384, -8192, 1};
+	static const int16_t gyro[3] = {10000, -20000, 0};
+	static uint8_t buf[256] __aligned(8);
+	const struct sensor_decoder_api *decoder;
+	struct sensor_decode_context ctx;
+	struct sensor_three_axis_data axes;
+	struct sensor_q31_data temp;
+	uint64_t before, after;
+	uint16_t frames;
+	q31_t *axis = &axes.readings[0].x;
+
+	qmi8658c_emul_sample_set(emul, acc, gyro, 256);
+
+	before = k_ticks_to_ns_floor64(k_uptime_ticks());
+	zassert_ok(sensor_read(&imu_iodev, &imu_rtio, buf, sizeof(buf)));
+	after = k_ticks_to_ns_floor64(k_uptime_ticks());
+
+	zassert_ok(sensor_get_decoder(imu, &decoder));
+	zassert_ok(decoder->get_frame_count(buf,
+					    (struct sensor_chan_spec){SENSOR_CHAN_ACCEL_XYZ, 0},
+					    &frames));
+	zassert_equal(frames, 1);
+
+	/* One frame per channel, iterating past it decodes nothing */
+	ctx = (struct sensor_decode_context)SENSOR_DECODE_CONTEXT_INIT(
+		decoder, buf, SENSOR_CHAN_ACCEL_XYZ, 0);
+	zassert_equal(sensor_decode(&ctx, &axes, 1), 1);
+	zassert_equal(sensor_decode(&ctx, &axes, 1), 0);
+	zassert_equal(axes.header.reading_count, 1);
+	zassert_between_inclusive(axes.header.base_timestamp_ns, before, after,
+				  "accel timestamp not taken at the read");
+	zassert_equal(axes.readings[0].timestamp_delta, 0);
+	for (int i = 0; i < 3; i++) {
+		zassert_within(q31_micro(axis[i], axes.shift), acc_micro(acc[i]), 20,
+			       "accel %d", i);
+	}
+
+	ctx = (struct sensor_decode_context)SENSOR_DECODE_CONTEXT_INIT(
+		decoder, buf, SENSOR_CHAN_GYRO_XYZ, 0);
+	zassert_equal(sensor_decode(&ctx, &axes, 1), 1);
+	zassert_between_inclusive(axes.header.base_timestamp_ns, before, after);
+	for (int i = 0; i < 3; i++) {
+		zassert_within(q31_micro(axis[i], axes.shift), gyro_micro(gyro[i]), 20,
+			       "gyro %d", i);
+	}
+
+	ctx = (struct sensor_decode_context)SENSOR_DECODE_CONTEXT_INIT(
+		decoder, buf, SENSOR_CHAN_DIE_TEMP, 0);
+	zassert_equal(sensor_decode(&ctx, &temp, 1), 1);
+	zassert_between_inclusive(temp.header.base_timestamp_ns, before, after);
+	zassert_within(q31_micro(temp.readings[0].temperature, temp.shift),
+		       26000000LL, 20);
+
+	/* Channels the chip does not have are refused */
+	zassert_equal(decoder->get_frame_count(buf,
+					       (struct sensor_chan_spec){SENSOR_CHAN_MAGN_XYZ, 0},
+					       &frames), -ENOTSUP);
+}
+#endif /* CONFIG_QMI8658C_ASYNC */
+
+ZTEST(qmi8658c_emul, test_snapshot)
+{
+	struct qmi8658c_snapshot snap;
+	uint64_t last_ticks = 0;
+
+	for (int16_t n = 1; n <= 8; n++) {
+		const int16_t acc[3] = {n, 2 * n, 3 * n};
+		const int16_t gyro[3] = {-n, -2 * n, -3 * n};
+
+		k_sleep(K_USEC(QMI8658C_TIMESTAMP_NS / 1000));
+		qmi8658c_emul_sample_set(emul, acc, gyro, n);
+		zassert_ok(sensor_sample_fetch(imu));
+		zassert_ok(qmi8658c_snapshot_get(imu, &snap));
+
+		for (int i = 0; i < 3; i++) {
+			zassert_equal(snap.acc[i], acc[i]);
+			zassert_equal(snap.gyro[i], gyro[i]);
+		}
+		zassert_equal(snap.temp, n);
+		zassert_true(snap.time.chip_ticks > last_ticks,
+			     "sample time not published with the sample");
+		last_ticks = snap.time.chip_ticks;
+	}
+}
+
+static K_SEM_DEFINE(drdy_sem, 0, 1);
+static struct sensor_value drdy_acc[3];
+
+static void drdy_handler(const struct device *dev,
+			 const struct sensor_trigger *trig)
+{
+	ARG_UNUSED(trig);
+
+	/* Served from the status burst of the interrupt path */
+	sensor_sample_fetch(dev);
+	sensor_channel_get(dev, SENSOR_CHAN_ACCEL_XYZ, drdy_acc);
+	k_sem_give(&drdy_sem);
+}
+
+ZTEST(qmi8658c_emul, test_drdy_trigger)
+{
+	static const struct sensor_trigger trig = {
+		.type = SENSOR_TRIG_DATA_READY,
+		.chan = SENSOR_CHAN_ACCEL_XYZ,
+	};
+	static const int16_t acc[3] = {100, 200, 300};
+	static const int16_t gyro[3] = {0, 0, 0};
+
+	zassert_ok(sensor_trigger_set(imu, &trig, drdy_handler));
+
+	for (int n = 0; n < 10; n++) {
+		int16_t sample[3] = {acc[0] + n, acc[1] + n, acc[2] + n};
+
+		qmi8658c_emul_sample_set(emul, sample, gyro, 0);
+		zassert_ok(k_sem_take(&drdy_sem, K_MSEC(100)), "no data-ready");
+		for (int i = 0; i < 3; i++) {
+			assert_micro(&drdy_acc[i], acc_micro(sample[i]), 1);
+		}
+	}
+
+	zassert_ok(sensor_trigger_set(imu, &trig, NULL));
+}
+
+static K_SEM_DEFINE(motion_sem, 0, 1);
+
+static void motion_handler(const struct device *dev,
+			   const struct sensor_trigger *trig)
+{
+	ARG_UNUSED(dev);
+	ARG_UNUSED(trig);
+
+	k_sem_give(&motion_sem);
+}
+
+ZTEST(qmi8658c_emul, test_motion_trigger)
+{
+	static const struct sensor_trigger trig = {
+		.type = SENSOR_TRIG_MOTION,
+		.chan = SENSOR_CHAN_ACCEL_XYZ,
+	};
+
+	zassert_ok(sensor_trigger_set(imu, &trig, motion_handler));
+	zassert_ok(qmi8658c_power_profile_set(imu, QMI8658C_POWER_PROFILE_IDLE));
+
+	qmi8658c_emul_motion(emul);
+	zassert_ok(k_sem_take(&motion_sem, K_MSEC(100)), "no motion trigger");
+
+	zassert_ok(qmi8658c_power_profile_set(imu, QMI8658C_POWER_PROFILE_ACTIVE));
+	zassert_ok(sensor_trigger_set(imu, &trig, NULL));
+}
+
+/* Press stroke: rest, ram down, dwell at the bottom, ram up, rest */
+struct profile_segment {
+	uint16_t samples;
+	int16_t acc_z;
+	int16_t gyro_y;
+};
+
+static const struct profile_segment stroke[] = {
+	{ 128, 16384, 0 },
+	{ 256, 14000, 1200 },
+	{ 128, 16384, 0 },
+	{ 256, 18800, -1200 },
+	{ 256, 16384, 0 },
+};
+
+static struct {
+	uint32_t acc_count;
+	uint32_t gyro_count;
+	int64_t gyro_sum;
+	int64_t acc_sum;
+	bool order_ok;
+} fifo_rx;
+
+static void fifo_handler(const struct device *dev,
+			 const struct qmi8658c_fifo_batch *batch, void *user_data)
+{
+	ARG_UNUSED(dev);
+	ARG_UNUSED(user_data);
+
+	for (int i = 0; i < batch->acc_count; i++) {
+		/* x carries the sample index to check ordering */
+		if (batch->acc[i][0] != (int16_t)(fifo_rx.acc_count + i)) {
+			fifo_rx.order_ok = false;
+		}
+		fifo_rx.acc_sum += batch->acc[i][2];
+	}
+	for (int i = 0; i < batch->gyro_count; i++) {
+		fifo_rx.gyro_sum += batch->gyro[i][1];
+	}
+
+	fifo_rx.acc_count += batch->acc_count;
+	fifo_rx.gyro_count += batch->gyro_count;
+}
+
+ZTEST(qmi8658c_emul, test_fifo_stroke_profile)
+{
+	uint32_t total = 0;
+	int64_t gyro_sum = 0, acc_sum = 0;
+
+	fifo_rx.order_ok = true;
+	zassert_ok(qmi8658c_fifo_handler_set(imu, fifo_handler, NULL));
+
+	for (int s = 0; s < ARRAY_SIZE(stroke); s++) {
+		for (int n = 0; n < stroke[s].samples; n++) {
+			int16_t acc[3] = {(int16_t)total, 0, stroke[s].acc_z};
+			int16_t gyro[3] = {0, stroke[s].gyro_y, 0};
+
+			qmi8658c_emul_fifo_push(emul, QMI8658C_EMUL_TAG_ACCEL, acc);
+			qmi8658c_emul_fifo_push(emul, QMI8658C_EMUL_TAG_GYRO, gyro);
+			acc_sum += acc[2];
+			gyro_sum += gyro[1];
+			total++;
+
+			/* Below the watermark, drained before the FIFO can fill */
+			if (total % PUSH_PAIRS == 0) {
+				k_sleep(K_MSEC(1));
+			}
+		}
+	}
+
+	/* Both words of every pair are batched, 2048 words drain completely */
+	for (int i = 0; i < 100 && fifo_rx.acc_count < total; i++) {
+		k_sleep(K_MSEC(1));
+	}
+
+	zassert_equal(fifo_rx.acc_count, total, "accel samples lost");
+	zassert_equal(fifo_rx.gyro_count, total, "gyro samples lost");
+	zassert_true(fifo_rx.order_ok, "accel samples out of order");
+	zassert_equal(fifo_rx.acc_sum, acc_sum);
+	zassert_equal(fifo_rx.gyro_sum, gyro_sum, "stroke angle mismatch");
+	zassert_equal(qmi8658c_emul_fifo_level(emul), 0);
+
+	zassert_ok(qmi8658c_fifo_handler_set(imu, NULL, NULL));
+}
+
+#if defined(CONFIG_QMI8658C_CALIBRATION)
+static void cal_unity(struct qmi8658c_calibration *cal)
+{
+	memset(cal, 0, sizeof(*cal));
+	for (int i = 0; i < 3; i++) {
+		cal->acc_scale[i] = 65536;
+		cal->gyro_scale[i] = 65536;
+	}
+	cal->temp_ref = 25000;
+}
+
+/* (reading - bias) * scale, reading and bias in ug */
+static int64_t acc_cal_micro(int16_t raw, int32_t bias, int32_t scale)
+{
+	return ((int64_t)raw * ACC_GAIN_UG - bias) * SENSOR_G / 1000000LL *
+	       scale / 65536;
+}
+
+/* (reading - bias) * scale, reading and bias in udps */
+static int64_t gyro_cal_micro(int16_t raw, int32_t bias, int32_t scale)
+{
+	return ((int64_t)raw * GYRO_GAIN_UDPS - bias) * SENSOR_PI /
+	       (180LL * 1000000LL) * scale / 65536;
+}
+
+ZTEST(qmi8658c_emul, test_calibration_apply)
+{
+	static const int16_t acc[3] = {16384, -8192, 1};
+	static const int16_t gyro[3] = {10000, -20000, 0};
+	struct qmi8658c_calibration cal;
+	struct sensor_value val[3];
+	q31_t out[1][3];
+	int8_t shift;
+
+	cal_unity(&cal);
+	cal.acc_bias[0] = 20000;
+	cal.acc_bias[1] = -10000;
+	cal.acc_bias[2] = 5000;
+	cal.acc_scale[1] = 66191;
+	cal.acc_scale[2] = 64881;
+	cal.gyro_bias[0] = 100000;
+	cal.gyro_bias[1] = -200000;
+	cal.gyro_scale[2] = 70000;
+	zassert_ok(qmi8658c_calibration_set(imu, &cal));
+
+	qmi8658c_emul_sample_set(emul, acc, gyro, 256);
+	zassert_ok(sensor_sample_fetch(imu));
+
+	zassert_ok(sensor_channel_get(imu, SENSOR_CHAN_ACCEL_XYZ, val));
+	for (int i = 0; i < 3; i++) {
+		assert_micro(&val[i], acc_cal_micro(acc[i], cal.acc_bias[i],
+						    cal.acc_scale[i]), 2);
+	}
+
+	zassert_ok(sensor_channel_get(imu, SENSOR_CHAN_GYRO_Y, val));
+	assert_micro(&val[0], gyro_cal_micro(gyro[1], cal.gyro_bias[1],
+					     cal.gyro_scale[1]), 10);
+
+	/* The batch conversion applies the same folded calibration */
+	zassert_ok(qmi8658c_convert_q31(imu, QMI8658C_SENSOR_ACCEL, &acc, out, 1,
+					&shift));
+	for (int i = 0; i < 3; i++) {
+		int64_t got = ((int64_t)out[0][i] * 1000000LL * (1LL << shift)) >> 31;
+
+		zassert_true(llabs(got - acc_cal_micro(acc[i], cal.acc_bias[i],
+						       cal.acc_scale[i])) <= 20,
+			     "q31 calibrated accel %d", acc[i]);
+	}
+
+	cal.acc_scale[0] = 0;
+	zassert_equal(qmi8658c_calibration_set(imu, &cal), -EINVAL);
+}
+
+ZTEST(qmi8658c_emul, test_calibration_tempco)
+{
+	static const int16_t zero[3];
+	struct qmi8658c_calibration cal;
+	struct sensor_value val;
+
+	cal_unity(&cal);
+	cal.gyro_tempco[0] = 1000;
+	zassert_ok(qmi8658c_calibration_set(imu, &cal));
+
+	/* 35 degC, the bias drifted by 10 mdps */
+	qmi8658c_emul_sample_set(emul, zero, zero, 10 * 256);
+	zassert_ok(sensor_sample_fetch(imu));
+	zassert_ok(sensor_channel_get(imu, SENSOR_CHAN_GYRO_X, &val));
+	assert_micro(&val, -10000LL * SENSOR_PI / (180LL * 1000000LL), 2);
+
+	/* Back at the reference temperature the fold follows */
+	qmi8658c_emul_sample_set(emul, zero, zero, 0);
+	zassert_ok(sensor_sample_fetch(imu));
+	zassert_ok(sensor_channel_get(imu, SENSOR_CHAN_GYRO_X, &val));
+	assert_micro(&val, 0, 2);
+}
+
+ZTEST(qmi8658c_emul, test_calibration_fit)
+{
+	static const int32_t sens[3] = {1010000, 990000, 1000000};
+	static const int32_t acc_bias[3] = {20000, -15000, 30000};
+	static const int32_t acc_tempco[3] = {100, 0, -50};
+	static const int32_t gyro_bias[3] = {50000, -20000, 10000};
+	static const int32_t gyro_tempco[3] = {2000, 0, 0};
+	struct qmi8658c_cal_point points[12];
+	struct qmi8658c_calibration cal;
+	int n = 0;
+
+	/* Six faces at 20 and 40 degC */
+	for (int t = 0; t < 2; t++) {
+		int32_t temp = 20000 + t * 20000;
+
+		for (int face = 0; face < 6; face++) {
+			struct qmi8658c_cal_point *p = &points[n++];
+
+			for (int i = 0; i < 3; i++) {
+				int g = (face / 2 == i) ? ((face & 1) ? -1 : 1) : 0;
+
+				p->acc[i] = g * sens[i] + acc_bias[i] +
+					    acc_tempco[i] * (temp - 30000) / 1000;
+				p->gyro[i] = gyro_bias[i] +
+					     gyro_tempco[i] * (temp - 30000) / 1000;
+			}
+			p->temp = temp;
+		}
+	}
+
+	zassert_ok(qmi8658c_cal_fit(points, n, true, &cal));
+	zassert_equal(cal.temp_ref, 30000);
+	for (int i = 0; i < 3; i++) {
+		zassert_within(cal.acc_bias[i], acc_bias[i], 2, "acc bias %d", i);
+		zassert_within(cal.acc_scale[i], 65536LL * 1000000 / sens[i], 2,
+			       "acc scale %d", i);
+		zassert_within(cal.acc_tempco[i], acc_tempco[i], 1, "acc tempco %d", i);
+		zassert_within(cal.gyro_bias[i], gyro_bias[i], 2, "gyro bias %d", i);
+		zassert_equal(cal.gyro_scale[i], 65536, "gyro scale %d", i);
+		zassert_within(cal.gyro_tempco[i], gyro_tempco[i], 1,
+			       "gyro tempco %d", i);
+	}
+
+	/* One temperature cannot give a temperature coefficient */
+	zassert_equal(qmi8658c_cal_fit(points, 6, true, &cal), -EINVAL);
+
+	/* One orientation leaves the scale at 1 */
+	zassert_ok(qmi8658c_cal_fit(points, 1, false, &cal));
+	zassert_equal(cal.acc_scale[0], 65536);
+	zassert_within(cal.acc_bias[0], points[0].acc[0] - 1000000, 1);
+}
+
+ZTEST(qmi8658c_emul, test_calibration_collect)
+{
+	static const int16_t acc[3] = {0, 0, 16384};
+	static const int16_t gyro[3] = {100, -100, 0};
+	struct qmi8658c_cal_point point;
+	struct qmi8658c_calibration cal;
+	struct sensor_value val;
+
+	qmi8658c_emul_sample_set(emul, acc, gyro, 512);
+	zassert_ok(qmi8658c_cal_collect(imu, 8, &point));
+
+	for (int i = 0; i < 3; i++) {
+		zassert_equal(point.acc[i], acc[i] * ACC_GAIN_UG);
+		zassert_equal(point.gyro[i], gyro[i] * GYRO_GAIN_UDPS);
+	}
+	zassert_equal(point.temp, 27000);
+
+	/* Resting flat, z reads exactly 1 g once calibrated */
+	zassert_ok(qmi8658c_cal_fit(&point, 1, false, &cal));
+	zassert_ok(qmi8658c_calibration_set(imu, &cal));
+	zassert_ok(sensor_sample_fetch(imu));
+	zassert_ok(sensor_channel_get(imu, SENSOR_CHAN_ACCEL_Z, &val));
+	assert_micro(&val, SENSOR_G, 2);
+	zassert_ok(sensor_channel_get(imu, SENSOR_CHAN_GYRO_X, &val));
+	assert_micro(&val, 0, 2);
+}
+#endif /* CONFIG_QMI8658C_CALIBRATION */
+
+static void qmi8658c_emul_after(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+#if defined(CONFIG_QMI8658C_CALIBRATION)
+	struct qmi8658c_calibration cal;
+
+	cal_unity(&cal);
+	qmi8658c_calibration_set(imu, &cal);
+#endif
+}
+
+ZTEST_SUITE(qmi8658c_emul, NULL, NULL, NULL, qmi8658c_emul_after, NULL);
@@ -0,0 +1,371 @@
+/*
+ * Copyright (c) 2025 Jared Woolston
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * @file test fsm library
+ *
+ * This suite runs a reloading cycle, index, feed, dispense and seat, with
+ * station timeouts leading to a fault state. It checks the order of the
+ * actions, the timeouts and the dropping of stale ones, the validation of
+ * the tables and the dwell times. On hardware, with CONFIG_TEST_CPU_BUDGET,
+ * the dispatch cost of a large table is compared with a small one.
+ */
+
+#include <string.h>
+
+#include <zephyr/timing/timing.h>
+#include <zephyr/ztest.h>
+
+#include <app/lib/fsm.h>
+
+enum { ST_IDLE, ST_INDEX, ST_FEED, ST_DISPENSE, ST_SEAT, ST_FAULT, ST_COUNT };
+enum { EV_START, EV_DONE, EV_TIMEOUT, EV_STOP, EV_RESET, EV_COUNT };
+
+static char trace[32];
+static int traced;
+
+static void mark(char c)
+{
+	if (traced < sizeof(trace) - 1) {
+		trace[traced++] = c;
+	}
+}
+
+static void feed_entry(struct fsm *fsm)
+{
+	ARG_UNUSED(fsm);
+	mark('F');
+}
+
+static void feed_exit(struct fsm *fsm)
+{
+	ARG_UNUSED(fsm);
+	mark('f');
+}
+
+static void count_case(struct fsm *fsm)
+{
+	int *cases = fsm_user_data(fsm);
+
+	(*cases)++;
+	mark('+');
+}
+
+static void jam(struct fsm *fsm)
+{
+	ARG_UNUSED(fsm);
+	mark('!');
+}
+
+/* Chains into the next station from the entry action */
+static void index_entry(struct fsm *fsm)
+{
+	mark('I');
+	fsm_post(fsm, EV_DONE);
+}
+
+static const struct fsm_state states[ST_COUNT] = {
+	[ST_IDLE] = FSM_STATE("idle", NULL, NULL, 0, 0),
+	[ST_INDEX] = FSM_STATE("index", index_entry, NULL, 0, 0),
+	[ST_FEED] = FSM_STATE("feed", feed_entry, feed_exit, 30, EV_TIMEOUT),
+	[ST_DISPENSE] = FSM_STATE("dispense", NULL, NULL, 30, EV_TIMEOUT),
+	[ST_SEAT] = FSM_STATE("seat", NULL, NULL, 30, EV_TIMEOUT),
+	[ST_FAULT] = FSM_STATE("fault", NULL, NULL, 0, 0),
+};
+
+static const struct fsm_transition transitions[ST_COUNT][EV_COUNT] = {
+	[ST_IDLE] = {
+		[EV_START] = FSM_TRANSITION(ST_INDEX, NULL),
+	},
+	[ST_INDEX] = {
+		[EV_DONE] = FSM_TRANSITION(ST_FEED, NULL),
+		[EV_STOP] = FSM_TRANSITION(ST_IDLE, NULL),
+	},
+	[ST_FEED] = {
+		[EV_DONE] = FSM_TRANSITION(ST_DISPENSE, NULL),
+		[EV_TIMEOUT] = FSM_TRANSITION(ST_FAULT, jam),
+	},
+	[ST_DISPENSE] = {
+		[EV_DONE] = FSM_TRANSITION(ST_SEAT, NULL),
+		[EV_TIMEOUT] = FSM_TRANSITION(ST_FAULT, jam),
+	},
+	[ST_SEAT] = {
+		[EV_DONE] = FSM_TRANSITION(ST_INDEX, count_case),
+		[EV_STOP] = FSM_TRANSITION(ST_IDLE, count_case),
+		[EV_TIMEOUT] = FSM_TRANSITION(ST_FAULT, jam),
+	},
+	[ST_FAULT] = {
+		[EV_RESET] = FSM_TRANSITION(ST_IDLE, NULL),
+	},
+};
+
+static int cases;
+static struct fsm fsm;
+static struct fsm_state_stats state_stats[ST_COUNT];
+
+/* Machine of the table checks, with statistics apart from the running one */
+static struct fsm other;
+static struct fsm_state_stats other_stats[2];
+
+static const struct fsm_config cfg = {
+	.states = states,
+	.transitions = &transitions[0][0],
+	.num_states = ST_COUNT,
+	.num_events = EV_COUNT,
+	.initial = ST_IDLE,
+	.name = "press",
+	.user_data = &cases,
+};
+
+/* Posts an event and dispatches everything it leads to */
+static void run(uint8_t event)
+{
+	zassert_ok(fsm_post(&fsm, event));
+	while (fsm_process(&fsm, K_NO_WAIT) == 0) {
+	}
+}
+
+static void before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	memset(trace, 0, sizeof(trace));
+	traced = 0;
+	cases = 0;
+	zassert_ok(fsm_init(&fsm, &cfg, state_stats));
+	fsm_start(&fsm);
+}
+
+static void after(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	fsm_stop(&fsm);
+}
+
+ZTEST(fsm, test_cycle)
+{
+	struct fsm_stats stats;
+
+	run(EV_START);
+	zassert_equal(fsm_state_get(&fsm), ST_FEED);
+
+	run(EV_DONE);
+	zassert_equal(fsm_state_get(&fsm), ST_DISPENSE);
+	run(EV_DONE);
+	zassert_equal(fsm_state_get(&fsm), ST_SEAT);
+
+	/* The next case is indexed and fed straight away */
+	run(EV_DONE);
+	zassert_equal(fsm_state_get(&fsm), ST_FEED);
+	zassert_equal(cases, 1);
+
+	run(EV_DONE);
+	run(EV_DONE);
+	run(EV_STOP);
+	zassert_equal(fsm_state_get(&fsm), ST_IDLE);
+	zassert_equal(cases, 2);
+
+	/* The entry, exit and transition actions, in order */
+	zassert_str_equal(trace, "IFf+IFf+");
+
+	fsm_stats_get(&fsm, &stats, NULL, false);
+	zassert_equal(stats.transitions, 9);
+	zassert_equal(stats.unhandled, 0);
+}
+
+ZTEST(fsm, test_unhandled)
+{
+	struct fsm_stats stats;
+
+	run(EV_DONE);
+	run(EV_RESET);
+	zassert_equal(fsm_state_get(&fsm), ST_IDLE);
+
+	fsm_stats_get(&fsm, &stats, NULL, true);
+	zassert_equal(stats.events, 2);
+	zassert_equal(stats.unhandled, 2);
+	zassert_equal(stats.transitions, 0);
+
+	fsm_stats_get(&fsm, &stats, NULL, false);
+	zassert_equal(stats.events, 0, "statistics not reset");
+
+	zassert_equal(fsm_post(&fsm, EV_COUNT), -EINVAL);
+}
+
+ZTEST(fsm, test_timeout)
+{
+	struct fsm_state_stats ss[ST_COUNT];
+
+	run(EV_START);
+	zassert_equal(fsm_state_get(&fsm), ST_FEED);
+
+	/* Nothing but the feed timeout arrives */
+	zassert_ok(fsm_process(&fsm, K_MSEC(100)));
+	zassert_equal(fsm_state_get(&fsm), ST_FAULT);
+	zassert_str_equal(trace, "IFf!");
+
+	/* No timeout in the fault state */
+	zassert_equal(fsm_process(&fsm, K_MSEC(100)), -EAGAIN);
+
+	run(EV_RESET);
+	zassert_equal(fsm_state_get(&fsm), ST_IDLE);
+
+	fsm_stats_get(&fsm, NULL, ss, false);
+	zassert_equal(ss[ST_FEED].visits, 1);
+	zassert_equal(ss[ST_FEED].timeouts, 1);
+	zassert_equal(ss[ST_FAULT].visits, 1);
+	zassert_equal(ss[ST_FAULT].timeouts, 0);
+}
+
+ZTEST(fsm, test_stale_timeout)
+{
+	run(EV_START);
+
+	/* Feed done, but the timeout expires before the dispatch */
+	zassert_ok(fsm_post(&fsm, EV_DONE));
+	k_sleep(K_MSEC(60));
+
+	zassert_ok(fsm_process(&fsm, K_NO_WAIT));
+	zassert_equal(fsm_state_get(&fsm), ST_DISPENSE);
+
+	/* The feed timeout does not end the dispense visit */
+	zassert_ok(fsm_process(&fsm, K_NO_WAIT));
+	zassert_equal(fsm_state_get(&fsm), ST_DISPENSE);
+	zassert_equal(fsm_process(&fsm, K_NO_WAIT), -EAGAIN);
+
+	run(EV_DONE);
+	zassert_equal(fsm_state_get(&fsm), ST_SEAT);
+}
+
+ZTEST(fsm, test_invalid_tables)
+{
+	static const struct fsm_transition bad_next[2][1] = {
+		[0] = {[0] = FSM_TRANSITION(2, NULL)},
+	};
+	static const struct fsm_state bad_timeout[2] = {
+		[1] = FSM_STATE("wait", NULL, NULL, 10, 1),
+	};
+	static const struct fsm_transition ok[2][1];
+	struct fsm_config c = {
+		.states = states,
+		.transitions = &bad_next[0][0],
+		.num_states = 2,
+		.num_events = 1,
+	};
+
+	zassert_equal(fsm_init(&other, &c, other_stats), -EINVAL);
+
+	c.transitions = &ok[0][0];
+	zassert_ok(fsm_init(&other, &c, other_stats));
+
+	c.states = bad_timeout;
+	zassert_equal(fsm_init(&other, &c, other_stats), -EINVAL);
+
+	c.states = states;
+	c.initial = 2;
+	zassert_equal(fsm_init(&other, &c, other_stats), -EINVAL);
+
+	zassert_equal(fsm_init(&other, &c, NULL), -EINVAL);
+}
+
+ZTEST(fsm, test_dwell)
+{
+	struct fsm_state_stats ss[ST_COUNT];
+	uint32_t tick_us = k_ticks_to_us_ceil32(1);
+
+	for (int i = 0; i < 3; i++) {
+		run(EV_START);
+		k_sleep(K_MSEC(10));
+		run(EV_DONE);
+		k_sleep(K_MSEC(20));
+		run(EV_DONE);
+		run(EV_STOP);
+	}
+
+	fsm_stats_get(&fsm, NULL, ss, false);
+	zassert_equal(ss[ST_FEED].visits, 3);
+	zassert_equal(ss[ST_DISPENSE].visits, 3);
+	zassert_within(k_ticks_to_us_floor32(ss[ST_FEED].dwell_min), 10000,
+		       2 * tick_us);
+	zassert_within(k_ticks_to_us_floor32(ss[ST_DISPENSE].dwell_max), 20000,
+		       2 * tick_us);
+	zassert_true(ss[ST_DISPENSE].dwell_sum > ss[ST_FEED].dwell_sum);
+
+	fsm_report(&fsm);
+}
+
+#if defined(CONFIG_TEST_CPU_BUDGET)
+#define ROUNDS	1000
+#define BIG	64
+
+/* Two states at the far corners of a BIG x BIG table */
+static const struct fsm_state big_states[BIG];
+static struct fsm_state_stats big_stats[BIG];
+
+static const struct fsm_transition big_transitions[BIG][BIG] = {
+	[0] = {[BIG - 1] = FSM_TRANSITION(BIG - 1, NULL)},
+	[BIG - 1] = {[BIG - 1] = FSM_TRANSITION(0, NULL)},
+};
+
+static const struct fsm_state small_states[2];
+
+static const struct fsm_transition small_transitions[2][1] = {
+	[0] = {[0] = FSM_TRANSITION(1, NULL)},
+	[1] = {[0] = FSM_TRANSITION(0, NULL)},
+};
+
+/* Mean timing counter cycles of fsm_process() over ROUNDS transitions */
+static uint64_t dispatch_cycles(const struct fsm_config *c,
+				struct fsm_state_stats *ss, uint8_t event)
+{
+	timing_t start, end;
+	uint64_t cycles = 0;
+
+	zassert_ok(fsm_init(&other, c, ss));
+	fsm_start(&other);
+
+	for (int i = 0; i < ROUNDS; i++) {
+		zassert_ok(fsm_post(&other, event));
+		start = timing_counter_get();
+		zassert_ok(fsm_process(&other, K_NO_WAIT));
+		end = timing_counter_get();
+		cycles += timing_cycles_get(&start, &end);
+	}
+	fsm_stop(&other);
+
+	return cycles / ROUNDS;
+}
+
+ZTEST(fsm, test_budget)
+{
+	const struct fsm_config big = {
+		.states = big_states,
+		.transitions = &big_transitions[0][0],
+		.num_states = BIG,
+		.num_events = BIG,
+	};
+	const struct fsm_config small = {
+		.states = small_states,
+		.transitions = &small_transitions[0][0],
+		.num_states = ARRAY_SIZE(small_states),
+		.num_events = 1,
+	};
+	uint64_t big_cycles, small_cycles;
+
+	timing_init();
+	timing_start();
+	big_cycles = dispatch_cycles(&big, big_stats, BIG - 1);
+	small_cycles = dispatch_cycles(&small, other_stats, 0);
+	timing_stop();
+
+	/* O(1): the size of the table does not show in the dispatch */
+	zassert_true(big_cycles <= small_cycles + small_cycles / 4,
+		     "%llu cycles with %u x %u entries, %llu with 2 x 1",
+		     big_cycles, BIG, BIG, small_cycles);
+}
+#endif
+
+ZTEST_SUITE(fsm, NULL, NULL, before, after, NULL);
@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2025 Jared Woolston
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * @file test imu_fusion library
+ *
+ * This suite feeds synthetic constant rate and static attitude batches
+ * through the filter and checks the resulting angles. On hardware, with
+ * CONFIG_TEST_CPU_BUDGET, it checks that an update takes at most 5% of the
+ * sample period of one core.
+ */
+
+#include <stdlib.h>
+
+#include <zephyr/timing/timing.h>
+#include <zephyr/ztest.h>
+
+#include <app/lib/imu_fusion.h>
+
+#define RATE_HZ		416
+#define GYRO_SHIFT	6
+#define ACC_SHIFT	8
+#define GRAVITY		9.80665
+
+/* Share of the sample period an update may take, 1 / 20 */
+#define BUDGET_SHARE	20
+
+/* Angle tolerance, about 0.1 degree */
+#define ANGLE_TOL	IMU_FUSION_Q16(0.002)
+
+static q31_t gyro[RATE_HZ][3];
+static q31_t acc[RATE_HZ][3];
+
+static const struct imu_fusion_config base_cfg = {
+	.rate_hz = RATE_HZ,
+	.kp = IMU_FUSION_Q16(2.0),
+	.ki = IMU_FUSION_Q16(0.05),
+	.integral_limit = IMU_FUSION_Q16(0.1),
+	.accel_gate = IMU_FUSION_Q16(2.0),
+	.temp_ref = IMU_FUSION_Q16(25.0),
+};
+
+static void fill(const int32_t g[3], const int32_t a[3])
+{
+	for (int i = 0; i < RATE_HZ; i++) {
+		for (int j = 0; j < 3; j++) {
+			gyro[i][j] = g[j] << (15 - GYRO_SHIFT);
+			acc[i][j] = a[j] << (15 - ACC_SHIFT);
+		}
+	}
+}
+
+static void run(struct imu_fusion *f, int seconds)
+{
+	for (int i = 0; i < seconds; i++) {
+		imu_fusion_update(f, gyro, GYRO_SHIFT, acc, ACC_SHIFT, RATE_HZ);
+	}
+}
+
+static void assert_angle(int32_t got, int32_t expected, const char *name)
+{
+	zassert_true(abs(got - expected) <= ANGLE_TOL, "%s: expected %d got %d",
+		     name, expected, got);
+}
+
+ZTEST(imu_fusion_lib, test_invalid_config)
+{
+	struct imu_fusion f;
+	struct imu_fusion_config cfg = base_cfg;
+
+	cfg.rate_hz = 0;
+	zassert_equal(imu_fusion_init(&f, &cfg), -EINVAL);
+
+	cfg = base_cfg;
+	cfg.kp = -1;
+	zassert_equal(imu_fusion_init(&f, &cfg), -EINVAL);
+}
+
+ZTEST(imu_fusion_lib, test_level)
+{
+	static const int32_t g[3] = {0, 0, 0};
+	static const int32_t a[3] = {0, 0, IMU_FUSION_Q16(GRAVITY)};
+	struct imu_fusion f;
+	struct imu_fusion_euler e;
+	int32_t q[4];
+
+	zassert_ok(imu_fusion_init(&f, &base_cfg));
+	fill(g, a);
+	run(&f, 2);
+
+	imu_fusion_quaternion_get(&f, q);
+	zassert_true(q[0] > (1 << 30) - 16, "not identity: %d", q[0]);
+
+	imu_fusion_euler_get(&f, &e);
+	assert_angle(e.roll, 0, "roll");
+	assert_angle(e.pitch, 0, "pitch");
+	assert_angle(e.yaw, 0, "yaw");
+	assert_angle(e.tilt, 0, "tilt");
+}
+
+ZTEST(imu_fusion_lib, test_static_tilt)
+{
+	static const int32_t g[3] = {0, 0, 0};
+	/* Roll 30 deg, pitch -20 deg */
+	static const int32_t a[3] = {
+		IMU_FUSION_Q16(3.354039),
+		IMU_FUSION_Q16(4.607614),
+		IMU_FUSION_Q16(7.980655),
+	};
+	struct imu_fusion f;
+	struct imu_fusion_euler e;
+
+	zassert_ok(imu_fusion_init(&f, &base_cfg));
+	fill(g, a);
+	run(&f, 10);
+
+	imu_fusion_euler_get(&f, &e);
+	assert_angle(e.roll, IMU_FUSION_Q16(0.523599), "roll");
+	assert_angle(e.pitch, IMU_FUSION_Q16(-0.349066), "pitch");
+	/* Yaw is not observable from gravity and is left as aligned */
+	assert_angle(e.tilt, IMU_FUSION_Q16(0.620139), "tilt");
+}
+
+ZTEST(imu_fusion_lib, test_accel_gate)
+{
+	static const int32_t g[3] = {0, 0, 0};
+	/* 2 g sideways, rejected by the gate */
+	static const int32_t a[3] = {IMU_FUSION_Q16(2 * GRAVITY), 0, 0};
+	struct imu_fusion f;
+	struct imu_fusion_euler e;
+
+	zassert_ok(imu_fusion_init(&f, &base_cfg));
+	fill(g, a);
+	run(&f, 1);
+
+	imu_fusion_euler_get(&f, &e);
+	assert_angle(e.tilt, 0, "tilt");
+}
+
+ZTEST(imu_fusion_lib, test_yaw_rate)
+{
+	/* 1 rad/s about z for one second */
+	static const int32_t g[3] = {0, 0, IMU_FUSION_Q16(1.0)};
+	static const int32_t a[3] = {0, 0, IMU_FUSION_Q16(GRAVITY)};
+	struct imu_fusion f;
+	struct imu_fusion_euler e;
+
+	zassert_ok(imu_fusion_init(&f, &base_cfg));
+	fill(g, a);
+	run(&f, 1);
+
+	imu_fusion_euler_get(&f, &e);
+	assert_angle(e.yaw, IMU_FUSION_Q16(1.0), "yaw");
+	assert_angle(e.tilt, 0, "tilt");
+}
+
+ZTEST(imu_fusion_lib, test_temperature_bias)
+{
+	/* Bias at 45 degC, without accelerometer correction */
+	static const int32_t g[3] = {
+		IMU_FUSION_Q16(0.03), IMU_FUSION_Q16(-0.01), IMU_FUSION_Q16(-0.035),
+	};
+	static const int32_t a[3] = {0, 0, IMU_FUSION_Q16(GRAVITY)};
+	struct imu_fusion f;
+	struct imu_fusion_euler e;
+	struct imu_fusion_config cfg = base_cfg;
+
+	cfg.kp = 0;
+	cfg.ki = 0;
+	cfg.gyro_bias[0] = IMU_FUSION_Q16(0.01);
+	cfg.gyro_bias[1] = IMU_FUSION_Q16(-0.02);
+	cfg.gyro_bias[2] = IMU_FUSION_Q16(0.005);
+	cfg.gyro_tempco[0] = 1000;
+	cfg.gyro_tempco[1] = 500;
+	cfg.gyro_tempco[2] = -2000;
+
+	zassert_ok(imu_fusion_init(&f, &cfg));
+	imu_fusion_set_temperature(&f, IMU_FUSION_Q16(45.0));
+	fill(g, a);
+	run(&f, 60);
+
+	imu_fusion_euler_get(&f, &e);
+	assert_angle(e.roll, 0, "roll");
+	assert_angle(e.pitch, 0, "pitch");
+	assert_angle(e.yaw, 0, "yaw");
+}
+
+#if defined(CONFIG_TEST_CPU_BUDGET)
+ZTEST(imu_fusion_lib, test_budget)
+{
+	static const int32_t g[3] = {
+		IMU_FUSION_Q16(0.3), IMU_FUSION_Q16(-0.2), IMU_FUSION_Q16(0.1),
+	};
+	static const int32_t a[3] = {
+		IMU_FUSION_Q16(3.354039),
+		IMU_FUSION_Q16(4.607614),
+		IMU_FUSION_Q16(7.980655),
+	};
+	struct imu_fusion f;
+	timing_t start, end;
+	uint64_t cycles, budget;
+
+	zassert_ok(imu_fusion_init(&f, &base_cfg));
+	fill(g, a);
+
+	/* One second of samples, tilted and turning so no term is skipped */
+	timing_init();
+	timing_start();
+	start = timing_counter_get();
+	imu_fusion_update(&f, gyro, GYRO_SHIFT, acc, ACC_SHIFT, RATE_HZ);
+	end = timing_counter_get();
+	timing_stop();
+
+	cycles = timing_cycles_get(&start, &end) / RATE_HZ;
+	budget = timing_freq_get() / RATE_HZ / BUDGET_SHARE;
+	zassert_true(cycles <= budget, "%llu cycles per sample, budget %llu",
+		     cycles, budget);
+}
+#endif
+
+ZTEST_SUITE(imu_fusion_lib, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2025 Jared Woolston
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * @file test motor control library
+ *
+ * This suite integrates the back-EMF of a fake motor driver into a count
+ * with motor_ctrl_emf_read(). The count must be the back-EMF times the
+ * counts per volt times the elapsed time, forward and reverse, with the
+ * remainder carried over reads far shorter than one count.
+ */
+
+#include <zephyr/device.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include <app/drivers/motor.h>
+#include <app/lib/motor_ctrl.h>
+
+/* Channel 0 senses its back-EMF, channel 1 only its current */
+static int32_t fake_emf_mv;
+
+static int fake_set(const struct device *dev, uint32_t channels,
+		    const struct motor_cmd *cmds)
+{
+	ARG_UNUSED(dev);
+	ARG_UNUSED(channels);
+	ARG_UNUSED(cmds);
+
+	return 0;
+}
+
+static int fake_get(const struct device *dev, uint8_t channel,
+		    struct motor_cmd *cmd)
+{
+	ARG_UNUSED(dev);
+	ARG_UNUSED(channel);
+
+	*cmd = (struct motor_cmd){.mode = MOTOR_MODE_COAST};
+
+	return 0;
+}
+
+static uint8_t fake_channel_count(const struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	return 2;
+}
+
+static int fake_status_get(const struct device *dev, uint8_t channel,
+			   struct motor_status *status)
+{
+	ARG_UNUSED(dev);
+
+	*status = (struct motor_status){.current_valid = true};
+	if (channel == 0) {
+		status->emf_mv = fake_emf_mv;
+		status->emf_valid = true;
+	}
+
+	return 0;
+}
+
+static DEVICE_API(motor, fake_api) = {
+	.set = fake_set,
+	.get = fake_get,
+	.channel_count = fake_channel_count,
+	.status_get = fake_status_get,
+};
+
+DEVICE_DEFINE(fake_motor, "fake_motor", NULL, NULL, NULL, NULL, POST_KERNEL,
+	      CONFIG_MOTOR_INIT_PRIORITY, &fake_api);
+
+static struct motor_ctrl_emf emf;
+
+/* Count of the elapsed cycles between two reads, rounded toward zero */
+static int32_t expected(uint32_t from, uint32_t to)
+{
+	const int64_t den = (int64_t)MSEC_PER_SEC * sys_clock_hw_cycles_per_sec();
+
+	return (int32_t)(((int64_t)fake_emf_mv * emf.counts_per_volt *
+			  (uint32_t)(to - from)) / den);
+}
+
+static void before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	emf = (struct motor_ctrl_emf){
+		.motor = DEVICE_GET(fake_motor),
+		.channel = 0,
+		.counts_per_volt = 1000,
+	};
+}
+
+ZTEST(motor_ctrl_lib, test_emf_forward)
+{
+	uint32_t from;
+	int32_t count;
+
+	/* 1.5 V at 1000 counts/s per V, one count every 667 us */
+	fake_emf_mv = 1500;
+
+	zassert_ok(motor_ctrl_emf_read(&emf, &count));
+	zassert_equal(count, 0, "counted before an interval");
+	from = emf.cycles;
+
+	for (int i = 0; i < 20; i++) {
+		k_sleep(K_MSEC(5));
+		zassert_ok(motor_ctrl_emf_read(&emf, &count));
+	}
+
+	zassert_true(count > 0);
+	zassert_equal(count, expected(from, emf.cycles));
+}
+
+ZTEST(motor_ctrl_lib, test_emf_reverse)
+{
+	uint32_t from;
+	int32_t count;
+
+	fake_emf_mv = -800;
+	emf.counts_per_volt = 2000;
+
+	zassert_ok(motor_ctrl_emf_read(&emf, &count));
+	from = emf.cycles;
+
+	for (int i = 0; i < 20; i++) {
+		k_sleep(K_MSEC(5));
+		zassert_ok(motor_ctrl_emf_read(&emf, &count));
+	}
+
+	zassert_true(count < 0);
+	zassert_equal(count, expected(from, emf.cycles));
+}
+
+ZTEST(motor_ctrl_lib, test_emf_remainder)
+{
+	uint32_t from;
+	int32_t count;
+
+	/* Every read is a hundredth of a count, none counts on its own */
+	fake_emf_mv = 1500;
+
+	zassert_ok(motor_ctrl_emf_read(&emf, &count));
+	from = emf.cycles;
+
+	for (int i = 0; i < 2000; i++) {
+		k_busy_wait(7);
+		zassert_ok(motor_ctrl_emf_read(&emf, &count));
+	}
+
+	zassert_true(count > 0, "remainder dropped");
+	zassert_equal(count, expected(from, emf.cycles));
+}
+
+ZTEST(motor_ctrl_lib, test_emf_not_sensed)
+{
+	int32_t count = 42;
+
+	emf.channel = 1;
+
+	zassert_equal(motor_ctrl_emf_read(&emf, &count), -ENOTSUP);
+	zassert_equal(count, 42);
+	zassert_false(emf.started);
+}
+
+ZTEST_SUITE(motor_ctrl_lib, NULL, NULL, before, NULL, NULL);
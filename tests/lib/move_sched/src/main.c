@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2025 Jared Woolston
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * @file test multi-axis move scheduler against the L298N emulator
+ *
+ * This suite runs two axes on the channels of one emulated L298N, with the
+ * position loops closed on the counts of the DC motor model. A segment
+ * queued ahead of time must start both moves on its tick and end them
+ * together, after its duration. A segment queued after its tick must count
+ * as late, its moves starting and ending late by as many ticks.
+ */
+
+#include <zephyr/device.h>
+#include <zephyr/ztest.h>
+
+#include <app/drivers/motor.h>
+#include <app/drivers/motor/l298n_emul.h>
+#include <app/lib/motor_ctrl.h>
+#include <app/lib/move_sched.h>
+
+#define AXES		2
+#define DISTANCE	1000
+#define DURATION_MS	500
+#define DURATION_TICKS	(DURATION_MS * CONFIG_MOTOR_CTRL_RATE_HZ / MSEC_PER_SEC)
+
+/* Loop ticks between the queueing and the start of a segment */
+#define LEAD		20
+
+static const struct device *const motor = DEVICE_DT_GET(DT_NODELABEL(motors));
+
+static struct motor_l298n_emul_encoder encoders[AXES] = {
+	{.dev = DEVICE_DT_GET(DT_NODELABEL(plant)), .channel = 0},
+	{.dev = DEVICE_DT_GET(DT_NODELABEL(plant)), .channel = 1},
+};
+
+static int32_t tables[AXES][1024];
+static struct motor_ctrl ctrls[AXES];
+static struct motor_ctrl *const axes[AXES] = {&ctrls[0], &ctrls[1]};
+static struct move_sched ms;
+
+static void ctrl_config(struct motor_ctrl_config *cfg, uint8_t axis)
+{
+	*cfg = (struct motor_ctrl_config){
+		.motor = motor,
+		.channel = axis,
+		.encoder = motor_l298n_emul_encoder_read,
+		.user_data = &encoders[axis],
+		.speed_gains = {
+			.kp = 2 * PID_GAIN_ONE,
+			.ki = PID_GAIN_ONE / 10,
+		},
+		.position_gains = {
+			.kp = 30 * PID_GAIN_ONE,
+		},
+		.max_speed = 5000,
+		.speed_filter_shift = 3,
+		.profile = {
+			.shape = PROFILE_TRAPEZOID,
+			.max_speed = 4000,
+			.max_accel = 20000,
+			.table = tables[axis],
+			.table_len = ARRAY_SIZE(tables[axis]),
+		},
+	};
+}
+
+/* A segment of both axes, DISTANCE ahead of where they are */
+static void seg_init(struct move_sched_seg *seg, uint32_t start)
+{
+	struct motor_ctrl_state state;
+
+	*seg = (struct move_sched_seg){
+		.start = start,
+		.duration_ms = DURATION_MS,
+		.axes = BIT_MASK(AXES),
+	};
+
+	for (int i = 0; i < AXES; i++) {
+		motor_ctrl_state_get(axes[i], &state);
+		seg->position[i] = state.position + DISTANCE;
+	}
+}
+
+static void *setup(void)
+{
+	const struct move_sched_config cfg = {
+		.axes = axes,
+		.num_axes = AXES,
+	};
+	struct motor_ctrl_config ctrl_cfg;
+
+	zassert_true(device_is_ready(motor), "L298N did not probe the emulator");
+	for (int i = 0; i < AXES; i++) {
+		ctrl_config(&ctrl_cfg, i);
+		zassert_ok(motor_ctrl_init(&ctrls[i], &ctrl_cfg));
+	}
+	zassert_ok(move_sched_init(&ms, &cfg));
+
+	return NULL;
+}
+
+static void before(void *fixture)
+{
+	struct move_sched_stats stats;
+
+	ARG_UNUSED(fixture);
+
+	move_sched_flush(&ms);
+	for (int i = 0; i < AXES; i++) {
+		motor_ctrl_stop(axes[i]);
+	}
+
+	/* Friction brings both motors to rest, the stopped axes are dropped */
+	k_sleep(K_MSEC(500));
+	move_sched_stats_get(&ms, &stats, true);
+}
+
+ZTEST(move_sched, test_together)
+{
+	struct move_sched_stats stats;
+	struct motor_ctrl_state state;
+	struct move_sched_seg seg;
+
+	seg_init(&seg, motor_ctrl_tick_get() + LEAD);
+	zassert_ok(move_sched_queue(&ms, &seg));
+
+	k_sleep(K_MSEC(LEAD + DURATION_MS + 300));
+
+	for (int i = 0; i < AXES; i++) {
+		motor_ctrl_state_get(axes[i], &state);
+		zassert_true(state.move_done, "axis %d still moving", i);
+		zassert_equal(state.move_start, seg.start, "axis %d started late", i);
+		zassert_equal(state.move_end, seg.start + DURATION_TICKS,
+			      "axis %d ended off time", i);
+		zassert_within(state.position, seg.position[i], 20, "axis %d at %d", i,
+			       state.position);
+	}
+
+	move_sched_stats_get(&ms, &stats, false);
+	zassert_equal(stats.segments, 1);
+	zassert_equal(stats.errors, 0);
+	zassert_equal(stats.late, 0);
+	zassert_equal(stats.measured, 1);
+	zassert_equal(stats.start_skew_last, 0);
+	zassert_equal(stats.end_skew_last, 0);
+	zassert_equal(stats.start_delay_max, 0);
+	zassert_equal(stats.end_delay_max, 0);
+}
+
+ZTEST(move_sched, test_late)
+{
+	struct move_sched_stats stats;
+	struct move_sched_seg seg;
+
+	/* Queued after its tick, e.g. by a stalled producer */
+	seg_init(&seg, motor_ctrl_tick_get() - LEAD);
+	zassert_ok(move_sched_queue(&ms, &seg));
+
+	k_sleep(K_MSEC(DURATION_MS + 300));
+
+	move_sched_stats_get(&ms, &stats, false);
+	zassert_equal(stats.segments, 1);
+	zassert_equal(stats.late, 1);
+	zassert_true(stats.late_max >= LEAD, "late by %u ticks", stats.late_max);
+	zassert_equal(stats.measured, 1);
+
+	/* Both axes start together, late, and keep the duration */
+	zassert_equal(stats.start_skew_last, 0);
+	zassert_equal(stats.end_skew_last, 0);
+	zassert_equal(stats.start_delay_max, stats.late_max);
+	zassert_equal(stats.end_delay_max, stats.late_max);
+}
+
+ZTEST_SUITE(move_sched, NULL, setup, before, NULL, NULL);
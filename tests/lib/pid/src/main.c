@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2025 Jared Woolston
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * @file test PID library
+ *
+ * This suite checks the terms of the controller one at a time, the
+ * anti-windup and bumpless gain changes, then closes the loop around a
+ * first order plant with an output limit, the model of a DC motor speed
+ * loop driven by a PWM duty cycle. On hardware, with CONFIG_TEST_CPU_BUDGET,
+ * an update must take at most 1% of the 1 kHz control period.
+ */
+
+#include <stdlib.h>
+
+#include <zephyr/timing/timing.h>
+#include <zephyr/ztest.h>
+
+#include <app/lib/pid.h>
+
+#define OUT_MAX		10000
+
+/* Control loop rate, and the share of its period an update may take */
+#define LOOP_HZ		1000
+#define BUDGET_SHARE	100
+
+/* Plant: speed = gain x duty, time constant of 2^PLANT_SHIFT updates */
+#define PLANT_GAIN	3
+#define PLANT_SHIFT	5
+
+static struct pid pid;
+static int32_t plant;
+static int32_t load;
+
+static struct pid_config cfg = {
+	.out_min = -OUT_MAX,
+	.out_max = OUT_MAX,
+};
+
+static void before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	cfg.gains = (struct pid_gains){0};
+	cfg.d_filter_shift = 0;
+	plant = 0;
+	load = 0;
+}
+
+static int32_t plant_step(int32_t duty)
+{
+	plant += (PLANT_GAIN * duty - load - plant) >> PLANT_SHIFT;
+
+	return plant;
+}
+
+ZTEST(pid, test_invalid_config)
+{
+	struct pid_config bad = cfg;
+
+	bad.out_min = bad.out_max;
+	zassert_equal(pid_init(&pid, &bad), -EINVAL);
+
+	bad = cfg;
+	bad.d_filter_shift = 17;
+	zassert_equal(pid_init(&pid, &bad), -EINVAL);
+}
+
+ZTEST(pid, test_proportional)
+{
+	cfg.gains.kp = 2 * PID_GAIN_ONE + PID_GAIN_ONE / 2;
+	zassert_ok(pid_init(&pid, &cfg));
+
+	zassert_equal(pid_update(&pid, 100, 0), 250);
+	zassert_equal(pid_update(&pid, 0, 100), -250);
+	zassert_equal(pid_update(&pid, 100000, 0), OUT_MAX, "not limited");
+	zassert_equal(pid_update(&pid, INT32_MIN, INT32_MAX), -OUT_MAX,
+		      "error overflow");
+}
+
+ZTEST(pid, test_integral)
+{
+	cfg.gains.ki = PID_GAIN_ONE / 4;
+	zassert_ok(pid_init(&pid, &cfg));
+
+	for (int i = 1; i <= 8; i++) {
+		zassert_equal(pid_update(&pid, 40, 0), 10 * i);
+	}
+
+	/* The integrator holds its value at zero error */
+	zassert_equal(pid_update(&pid, 40, 40), 80);
+
+	pid_reset(&pid);
+	zassert_equal(pid_update(&pid, 0, 0), 0);
+}
+
+ZTEST(pid, test_derivative_on_measurement)
+{
+	cfg.gains.kd = 10 * PID_GAIN_ONE;
+	zassert_ok(pid_init(&pid, &cfg));
+
+	/* A setpoint step does not kick the output */
+	zassert_equal(pid_update(&pid, 0, 0), 0);
+	zassert_equal(pid_update(&pid, 500, 0), 0);
+
+	/* A rising measurement is damped */
+	zassert_equal(pid_update(&pid, 500, 20), -200);
+	zassert_equal(pid_update(&pid, 500, 20), 0);
+
+	/* Filtered, the kick spreads over the following updates */
+	cfg.d_filter_shift = 2;
+	zassert_ok(pid_init(&pid, &cfg));
+	zassert_equal(pid_update(&pid, 0, 0), 0);
+	zassert_equal(pid_update(&pid, 0, 20), -50);
+	zassert_true(pid_update(&pid, 0, 20) < 0);
+}
+
+ZTEST(pid, test_anti_windup)
+{
+	int32_t out;
+	int i;
+
+	cfg.gains.kp = PID_GAIN_ONE;
+	cfg.gains.ki = PID_GAIN_ONE / 8;
+	zassert_ok(pid_init(&pid, &cfg));
+
+	/* Stalled motor: the error stays large for a long time */
+	for (i = 0; i < 10000; i++) {
+		zassert_equal(pid_update(&pid, 50000, 0), OUT_MAX);
+	}
+
+	/* Released: the output leaves the limit as soon as the error reverses */
+	out = pid_update(&pid, 50000, 50100);
+	zassert_true(out < OUT_MAX, "wound up, output %d", out);
+
+	/* A small error inside the limit still integrates */
+	pid_reset(&pid);
+	for (i = 0; i < 10; i++) {
+		out = pid_update(&pid, 8, 0);
+	}
+	zassert_equal(out, 8 + 10);
+}
+
+ZTEST(pid, test_bumpless_gains)
+{
+	struct pid_gains gains;
+	int32_t before, after;
+
+	cfg.gains.kp = PID_GAIN_ONE / 2;
+	cfg.gains.ki = PID_GAIN_ONE / 16;
+	zassert_ok(pid_init(&pid, &cfg));
+
+	for (int i = 0; i < 64; i++) {
+		pid_update(&pid, 1000, 500);
+	}
+	before = pid_update(&pid, 1000, 1000);
+
+	pid_gains_get(&pid, &gains);
+	zassert_equal(gains.ki, PID_GAIN_ONE / 16);
+	gains.kp *= 4;
+	gains.ki *= 4;
+	pid_gains_set(&pid, &gains);
+
+	after = pid_update(&pid, 1000, 1000);
+	zassert_equal(before, after, "output jumped from %d to %d", before, after);
+}
+
+ZTEST(pid, test_closed_loop)
+{
+	const int32_t setpoint = 12000;
+	int32_t speed = 0, peak = 0;
+	int settled = -1;
+	int i;
+
+	cfg.gains.kp = PID_GAIN_ONE / 2;
+	cfg.gains.ki = PID_GAIN_ONE / 32;
+	zassert_ok(pid_init(&pid, &cfg));
+
+	for (i = 0; i < 1000; i++) {
+		speed = plant_step(pid_update(&pid, setpoint, speed));
+		peak = MAX(peak, speed);
+
+		if (abs(speed - setpoint) > setpoint / 50) {
+			settled = -1;
+		} else if (settled < 0) {
+			settled = i;
+		}
+	}
+
+	zassert_true(settled >= 0 && settled < 300, "settled after %d updates",
+		     settled);
+	zassert_true(peak < setpoint + setpoint / 10, "overshoot to %d", peak);
+
+	/* Load step: the integrator restores the speed */
+	load = 6000;
+	for (i = 0; i < 500; i++) {
+		speed = plant_step(pid_update(&pid, setpoint, speed));
+	}
+	zassert_true(abs(speed - setpoint) < setpoint / 50, "speed %d under load",
+		     speed);
+}
+
+#if defined(CONFIG_TEST_CPU_BUDGET)
+ZTEST(pid, test_budget)
+{
+	const int32_t setpoint = 12000;
+	int32_t speed = 0, out;
+	timing_t start, end;
+	uint64_t cycles = 0, budget;
+
+	/* Every term and the output limit active */
+	cfg.gains.kp = PID_GAIN_ONE / 2;
+	cfg.gains.ki = PID_GAIN_ONE / 32;
+	cfg.gains.kd = PID_GAIN_ONE / 8;
+	zassert_ok(pid_init(&pid, &cfg));
+
+	timing_init();
+	timing_start();
+	for (int i = 0; i < LOOP_HZ; i++) {
+		start = timing_counter_get();
+		out = pid_update(&pid, setpoint, speed);
+		end = timing_counter_get();
+		cycles += timing_cycles_get(&start, &end);
+
+		speed = plant_step(out);
+	}
+	timing_stop();
+
+	cycles /= LOOP_HZ;
+	budget = timing_freq_get() / LOOP_HZ / BUDGET_SHARE;
+	zassert_true(cycles <= budget, "%llu cycles per update, budget %llu",
+		     cycles, budget);
+}
+#endif
+
+ZTEST_SUITE(pid, NULL, NULL, before, NULL, NULL);
@@ -0,0 +1,325 @@
+/*
+ * Copyright (c) 2025 Jared Woolston
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * @file test motion profile library
+ *
+ * This suite runs moves of the case feeder drive through the generator, at
+ * the 1 kHz control rate, and checks every tick against the limits: speed,
+ * acceleration from the speed differences and, for S-curves, jerk from the
+ * acceleration differences. Moves must land exactly on the target, on time
+ * when a duration is given, and blend without steps when retargeted, also
+ * when planned in a copy of the running profile. On hardware, with
+ * CONFIG_TEST_CPU_BUDGET, a setpoint must take at most 1% of the control
+ * period.
+ */
+
+#include <stdlib.h>
+
+#include <zephyr/timing/timing.h>
+#include <zephyr/ztest.h>
+
+#include <app/lib/profile.h>
+
+#define RATE_HZ		1000
+#define MAX_SPEED	20000
+#define MAX_ACCEL	100000
+#define MAX_JERK	2000000
+#define TABLE_LEN	1024
+
+/* Share of the control period a setpoint may take, 1 / 100 */
+#define BUDGET_SHARE	100
+
+/* Speeds are rounded to counts/s, allow for it in the differences */
+#define SPEED_TOL	2
+
+static int32_t table[TABLE_LEN];
+static struct profile prof;
+static struct profile_config cfg;
+
+struct trace {
+	uint32_t ticks;
+	int32_t first;
+	int32_t last;
+	int32_t min;
+	int32_t max;
+	int32_t peak_speed;
+	int32_t max_dv;
+	int32_t max_da;
+	int32_t speed;
+	int32_t accel;
+};
+
+static void before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	cfg = (struct profile_config){
+		.rate_hz = RATE_HZ,
+		.shape = PROFILE_TRAPEZOID,
+		.max_speed = MAX_SPEED,
+		.max_accel = MAX_ACCEL,
+		.max_jerk = MAX_JERK,
+		.table = table,
+		.table_len = TABLE_LEN,
+	};
+	zassert_ok(profile_init(&prof, &cfg, 0));
+}
+
+static void trace_start(struct trace *t)
+{
+	struct profile_point pt;
+
+	profile_point_get(&prof, &pt);
+	*t = (struct trace){
+		.first = pt.position,
+		.min = pt.position,
+		.max = pt.position,
+		.speed = pt.speed,
+	};
+}
+
+/* Run up to max ticks, or to the end of the move with max 0 */
+static void trace_run(struct trace *t, uint32_t max)
+{
+	struct profile_point pt;
+	int32_t accel;
+
+	while ((max == 0 || t->ticks < max) && profile_next(&prof, &pt)) {
+		accel = pt.speed - t->speed;
+		t->ticks++;
+		t->last = pt.position;
+		t->min = MIN(t->min, pt.position);
+		t->max = MAX(t->max, pt.position);
+		t->peak_speed = MAX(t->peak_speed, abs(pt.speed));
+		t->max_dv = MAX(t->max_dv, abs(accel));
+		t->max_da = MAX(t->max_da, abs(accel - t->accel));
+		t->speed = pt.speed;
+		t->accel = accel;
+	}
+}
+
+ZTEST(profile, test_invalid_config)
+{
+	struct profile_config bad = cfg;
+
+	bad.max_accel = 0;
+	zassert_equal(profile_init(&prof, &bad, 0), -EINVAL);
+
+	bad = cfg;
+	bad.shape = PROFILE_SCURVE;
+	bad.max_jerk = 0;
+	zassert_equal(profile_init(&prof, &bad, 0), -EINVAL);
+
+	bad = cfg;
+	bad.table = NULL;
+	zassert_equal(profile_init(&prof, &bad, 0), -EINVAL);
+}
+
+ZTEST(profile, test_trapezoid)
+{
+	struct trace t;
+
+	zassert_ok(profile_move(&prof, NULL, 50000, 0));
+	zassert_equal(profile_remaining(&prof), 2700, "%u ticks",
+		      profile_remaining(&prof));
+
+	trace_start(&t);
+	trace_run(&t, 0);
+
+	zassert_equal(t.last, 50000, "ended at %d", t.last);
+	zassert_equal(t.max, 50000, "overshoot to %d", t.max);
+	zassert_true(t.peak_speed <= MAX_SPEED, "speed %d", t.peak_speed);
+	zassert_true(t.peak_speed >= MAX_SPEED - SPEED_TOL);
+	zassert_true(t.max_dv <= MAX_ACCEL / RATE_HZ + SPEED_TOL, "accel %d",
+		     t.max_dv);
+	zassert_equal(profile_remaining(&prof), 0);
+}
+
+ZTEST(profile, test_short_move)
+{
+	struct trace t;
+
+	/* Too short to reach the speed limit, and backwards */
+	zassert_ok(profile_move(&prof, NULL, -1000, 0));
+
+	trace_start(&t);
+	trace_run(&t, 0);
+
+	zassert_equal(t.last, -1000);
+	zassert_equal(t.min, -1000, "overshoot to %d", t.min);
+	zassert_true(t.peak_speed < MAX_SPEED / 2, "speed %d", t.peak_speed);
+	zassert_true(t.max_dv <= MAX_ACCEL / RATE_HZ + SPEED_TOL);
+
+	/* Already there */
+	zassert_ok(profile_move(&prof, NULL, -1000, 0));
+	zassert_equal(profile_remaining(&prof), 0);
+}
+
+ZTEST(profile, test_scurve)
+{
+	struct trace t;
+
+	cfg.shape = PROFILE_SCURVE;
+	zassert_ok(profile_init(&prof, &cfg, 1000));
+	zassert_ok(profile_move(&prof, NULL, 51000, 0));
+
+	trace_start(&t);
+	trace_run(&t, 0);
+
+	zassert_equal(t.last, 51000);
+	zassert_equal(t.max, 51000);
+	zassert_true(t.peak_speed <= MAX_SPEED);
+	zassert_true(t.max_dv <= MAX_ACCEL / RATE_HZ + SPEED_TOL, "accel %d",
+		     t.max_dv);
+	zassert_true(t.max_da <= MAX_JERK / RATE_HZ / RATE_HZ + 2 * SPEED_TOL,
+		     "jerk %d", t.max_da);
+}
+
+ZTEST(profile, test_duration)
+{
+	struct trace t;
+
+	/* The same move, slower to finish in 4 s */
+	zassert_equal(profile_move(&prof, NULL, 50000, 2000), -ERANGE);
+	zassert_ok(profile_move(&prof, NULL, 50000, 4000));
+
+	trace_start(&t);
+	trace_run(&t, 0);
+
+	zassert_equal(t.last, 50000);
+	zassert_true(t.ticks <= 4000 && t.ticks > 3980, "%u ticks", t.ticks);
+	zassert_true(t.peak_speed < MAX_SPEED);
+}
+
+ZTEST(profile, test_blend)
+{
+	struct trace t;
+
+	cfg.shape = PROFILE_SCURVE;
+	zassert_ok(profile_init(&prof, &cfg, 0));
+	zassert_ok(profile_move(&prof, NULL, 50000, 0));
+
+	trace_start(&t);
+	trace_run(&t, 1000);
+	zassert_true(t.speed == MAX_SPEED, "speed %d", t.speed);
+
+	/* Further: keep cruising, no step */
+	zassert_ok(profile_move(&prof, NULL, 60000, 0));
+	trace_run(&t, 1500);
+	zassert_true(t.max_dv <= MAX_ACCEL / RATE_HZ + SPEED_TOL);
+
+	/* Behind the stopping point: stop, turn around and come back */
+	zassert_ok(profile_move(&prof, NULL, 10000, 0));
+	trace_run(&t, 0);
+
+	zassert_equal(t.last, 10000);
+	zassert_true(t.max > 29500, "turned around at %d", t.max);
+	zassert_true(t.max_dv <= MAX_ACCEL / RATE_HZ + SPEED_TOL, "accel %d",
+		     t.max_dv);
+	zassert_true(t.max_da <= MAX_JERK / RATE_HZ / RATE_HZ + 2 * SPEED_TOL,
+		     "jerk %d", t.max_da);
+}
+
+ZTEST(profile, test_copy)
+{
+	static int32_t other_table[TABLE_LEN];
+	struct profile_config other_cfg;
+	struct profile other;
+	struct profile_point a, b;
+	struct trace t;
+	uint32_t rest;
+
+	cfg.shape = PROFILE_SCURVE;
+	zassert_ok(profile_init(&prof, &cfg, 0));
+	other_cfg = cfg;
+	other_cfg.table = other_table;
+	zassert_ok(profile_init(&other, &other_cfg, 0));
+
+	/* Within the first ramp, the blend keeps the rest of it */
+	zassert_ok(profile_move(&prof, NULL, 50000, 0));
+	trace_start(&t);
+	trace_run(&t, 50);
+
+	rest = profile_remaining(&prof);
+	profile_copy(&other, &prof);
+	zassert_ok(profile_move(&other, NULL, 20000, 0));
+
+	/* The original runs on until the swap, untouched by the plan */
+	for (int i = 0; i < 5; i++) {
+		zassert_true(profile_next(&prof, &a));
+		zassert_true(profile_next(&other, &b));
+		zassert_equal(a.position, b.position, "tick %d", i);
+		zassert_equal(a.speed, b.speed, "tick %d", i);
+	}
+
+	while (profile_next(&other, &b)) {
+	}
+	zassert_equal(b.position, 20000);
+	zassert_equal(profile_remaining(&prof), rest - 5);
+}
+
+ZTEST(profile, test_limits)
+{
+	struct profile_point from = {.position = 0, .speed = MAX_SPEED + 1};
+	struct trace t;
+
+	zassert_equal(profile_move(&prof, &from, 1000, 0), -ERANGE);
+
+	/* A failed retarget keeps the running move */
+	zassert_ok(profile_move(&prof, NULL, 50000, 0));
+	trace_start(&t);
+	trace_run(&t, 100);
+	zassert_equal(profile_move(&prof, NULL, 90000, 1000), -ERANGE);
+	trace_run(&t, 0);
+	zassert_equal(t.last, 50000);
+	zassert_equal(t.ticks, 2700);
+	zassert_true(t.max_dv <= MAX_ACCEL / RATE_HZ + SPEED_TOL);
+
+	/* Ramps longer than the table */
+	cfg.max_accel = MAX_ACCEL / 4;
+	zassert_ok(profile_init(&prof, &cfg, 0));
+	zassert_equal(profile_move(&prof, NULL, 50000, 0), -ENOMEM);
+}
+
+#if defined(CONFIG_TEST_CPU_BUDGET)
+ZTEST(profile, test_budget)
+{
+	struct profile_point pt;
+	timing_t start, end;
+	uint64_t cycles = 0, budget;
+	uint32_t ticks = 0;
+	bool more;
+
+	/* S-curve, blended halfway: every segment kind of the table */
+	cfg.shape = PROFILE_SCURVE;
+	zassert_ok(profile_init(&prof, &cfg, 0));
+	zassert_ok(profile_move(&prof, NULL, 50000, 0));
+
+	timing_init();
+	timing_start();
+	do {
+		if (ticks == 500) {
+			zassert_ok(profile_move(&prof, NULL, 20000, 0));
+		}
+
+		start = timing_counter_get();
+		more = profile_next(&prof, &pt);
+		end = timing_counter_get();
+		cycles += timing_cycles_get(&start, &end);
+		ticks++;
+	} while (more);
+	timing_stop();
+
+	zassert_equal(pt.position, 20000, "ended at %d", pt.position);
+
+	cycles /= ticks;
+	budget = timing_freq_get() / RATE_HZ / BUDGET_SHARE;
+	zassert_true(cycles <= budget, "%llu cycles per setpoint over %u, budget %llu",
+		     cycles, ticks, budget);
+}
+#endif
+
+ZTEST_SUITE(profile, NULL, NULL, before, NULL, NULL);
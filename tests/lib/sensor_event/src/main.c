@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2025 Jared Woolston
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * @file test sensor_event library
+ *
+ * This suite checks priority ordering, coalescing and re-posting of events,
+ * and compares the interrupt to handler latency of the event loop with a
+ * dedicated thread woken by a semaphore, the driver own-thread mode. The
+ * latencies are compared on hardware only.
+ */
+
+#include <zephyr/irq_offload.h>
+#include <zephyr/ztest.h>
+
+#include <app/lib/sensor_event.h>
+
+#define ROUNDS 64
+
+/*
+ * The event loop may add the lookup of the next event to the wake-up of a
+ * thread, a quarter of it plus the resolution of the cycle counter.
+ */
+#define LATENCY_MARGIN(own)	((own) / 4 + k_us_to_cyc_ceil32(2))
+
+static struct sensor_event events[4];
+static int order[ARRAY_SIZE(events)];
+static int dispatched;
+static K_SEM_DEFINE(done, 0, 1);
+
+static void record_handler(struct sensor_event *evt)
+{
+	order[dispatched++] = evt - events;
+	k_sem_give(&done);
+}
+
+static void before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	dispatched = 0;
+	k_sem_reset(&done);
+}
+
+ZTEST(sensor_event, test_priority_order)
+{
+	static const uint8_t prios[] = {3, 1, 2, 1};
+	static const int expected[] = {1, 3, 2, 0};
+
+	for (int i = 0; i < ARRAY_SIZE(events); i++) {
+		sensor_event_init(&events[i], record_handler, prios[i]);
+	}
+
+	k_sched_lock();
+	for (int i = 0; i < ARRAY_SIZE(events); i++) {
+		zassert_ok(sensor_event_post(&events[i]));
+	}
+	k_sched_unlock();
+
+	k_sleep(K_MSEC(10));
+	zassert_equal(dispatched, ARRAY_SIZE(events));
+	for (int i = 0; i < ARRAY_SIZE(expected); i++) {
+		zassert_equal(order[i], expected[i], "dispatch %d", i);
+	}
+}
+
+ZTEST(sensor_event, test_coalesce)
+{
+	struct sensor_event_stats stats;
+
+	sensor_event_init(&events[0], record_handler, 0);
+
+	k_sched_lock();
+	zassert_ok(sensor_event_post(&events[0]));
+	zassert_equal(sensor_event_post(&events[0]), -EALREADY);
+	k_sched_unlock();
+
+	k_sleep(K_MSEC(10));
+	zassert_equal(dispatched, 1);
+
+	sensor_event_stats_get(&events[0], &stats, true);
+	zassert_equal(stats.count, 1);
+	zassert_equal(stats.coalesced, 1);
+
+	sensor_event_stats_get(&events[0], &stats, false);
+	zassert_equal(stats.count, 0, "statistics not reset");
+}
+
+static int reposts;
+
+static void repost_handler(struct sensor_event *evt)
+{
+	/* Pending is cleared before the handler runs, this queues it again */
+	if (++reposts < 5) {
+		sensor_event_post(evt);
+	} else {
+		k_sem_give(&done);
+	}
+}
+
+ZTEST(sensor_event, test_repost_from_handler)
+{
+	sensor_event_init(&events[0], repost_handler, 0);
+
+	reposts = 0;
+	zassert_ok(sensor_event_post(&events[0]));
+	zassert_ok(k_sem_take(&done, K_MSEC(100)));
+	zassert_equal(reposts, 5);
+}
+
+static void post_isr(const void *arg)
+{
+	sensor_event_post((struct sensor_event *)arg);
+}
+
+static K_SEM_DEFINE(own_sem, 0, 1);
+static uint32_t own_post_cycles;
+static uint32_t own_latency;
+
+static void own_thread(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (1) {
+		k_sem_take(&own_sem, K_FOREVER);
+		own_latency += k_cycle_get_32() - own_post_cycles;
+		k_sem_give(&done);
+	}
+}
+
+K_THREAD_DEFINE(own, 1024, own_thread, NULL, NULL, NULL,
+		K_PRIO_COOP(CONFIG_SENSOR_EVENT_THREAD_PRIORITY), 0, 0);
+
+static void own_isr(const void *arg)
+{
+	ARG_UNUSED(arg);
+
+	own_post_cycles = k_cycle_get_32();
+	k_sem_give(&own_sem);
+}
+
+static void latency_handler(struct sensor_event *evt)
+{
+	ARG_UNUSED(evt);
+
+	k_sem_give(&done);
+}
+
+ZTEST(sensor_event, test_isr_latency)
+{
+	struct sensor_event_stats stats;
+	uint32_t loop_mean, own_mean;
+
+	sensor_event_init(&events[0], latency_handler, 0);
+	own_latency = 0;
+
+	for (int i = 0; i < ROUNDS; i++) {
+		irq_offload(post_isr, &events[0]);
+		zassert_ok(k_sem_take(&done, K_MSEC(100)), "event not dispatched");
+
+		irq_offload(own_isr, NULL);
+		zassert_ok(k_sem_take(&done, K_MSEC(100)), "thread not woken");
+	}
+
+	sensor_event_stats_get(&events[0], &stats, false);
+	zassert_equal(stats.count, ROUNDS);
+	zassert_true(stats.latency_max >= stats.latency_last);
+
+	/*
+	 * The cycle counter of native_sim stands still while code runs and
+	 * the one of QEMU follows the host clock, compared on hardware only
+	 */
+	if (IS_ENABLED(CONFIG_ARCH_POSIX) || IS_ENABLED(CONFIG_QEMU_TARGET)) {
+		return;
+	}
+
+	loop_mean = (uint32_t)(stats.latency_sum / ROUNDS);
+	own_mean = own_latency / ROUNDS;
+	zassert_true(loop_mean <= own_mean + LATENCY_MARGIN(own_mean),
+		     "event loop mean %u cycles, own thread mean %u cycles",
+		     loop_mean, own_mean);
+}
+
+ZTEST_SUITE(sensor_event, NULL, NULL, before, NULL, NULL);
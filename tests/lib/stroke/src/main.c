@@ -0,0 +1,284 @@
+/*
+ * Copyright (c) 2025 Jared Woolston
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * @file test stroke library
+ *
+ * This suite replays press traces through the detector: strokes made of the
+ * ram acceleration and deceleration down, the sizing impulse at the bottom
+ * and the return, over noise and a drifting gravity offset. The traces are
+ * generated rather than stored to keep the suite small, with the shape and
+ * levels of recordings taken on the press at 416 Hz and 2 g range. On
+ * hardware, with CONFIG_TEST_CPU_BUDGET, every block fed is timed and the
+ * worst one must stay within 1% of its sample period per sample.
+ */
+
+#include <stdlib.h>
+
+#include <zephyr/timing/timing.h>
+#include <zephyr/ztest.h>
+
+#include <app/lib/stroke.h>
+
+#define RATE_HZ		416
+#define GRAVITY_LSB	16384
+#define NOISE_LSB	80
+#define BLOCK		32
+
+/* Share of the sample period a sample may take, 1 / 100 */
+#define BUDGET_SHARE	100
+
+/* Stroke phases in samples: down, sizing impulse, dwell, up */
+#define DOWN		166
+#define IMPULSE		21
+#define DWELL		42
+#define UP		166
+#define STROKE_SAMPLES	(DOWN + IMPULSE + DWELL + UP)
+#define STROKE_MS	(STROKE_SAMPLES * 1000 / RATE_HZ)
+
+struct trace_stroke {
+	/* Idle time before the stroke, in samples */
+	uint16_t gap;
+	/* Ram acceleration amplitude */
+	int16_t ram;
+	/* Sizing impulse amplitude, the force proxy */
+	int16_t force;
+};
+
+static const struct trace_stroke press_trace[] = {
+	{ 600, 2600, 6500 }, { 480, 2500, 7000 }, { 700, 2700, 6800 },
+	{ 520, 2600, 7200 }, { 610, 2400, 6000 }, { 450, 2800, 7500 },
+	{ 830, 2500, 6900 }, { 500, 2600, 6400 }, { 560, 2700, 7100 },
+	{ 470, 2500, 6600 }, { 640, 2600, 7000 }, { 590, 2400, 6200 },
+	/* Lighter cases: the thresholds must follow */
+	{ 700, 1800, 3500 }, { 520, 1700, 3200 }, { 480, 1800, 3400 },
+	{ 610, 1600, 3000 }, { 550, 1700, 3300 }, { 500, 1800, 3600 },
+	{ 650, 1700, 3100 }, { 900, 1800, 3400 },
+};
+
+static struct stroke det;
+static struct stroke_event events[ARRAY_SIZE(press_trace) + 4];
+static uint32_t num_events;
+static int16_t block[BLOCK][3];
+static int block_len;
+static uint32_t sample_index;
+static uint32_t lcg = 7;
+static int32_t offset;
+/* Most timing counter cycles per sample of a block */
+static uint64_t feed_max;
+
+static void handler(const struct stroke_event *evt, void *user_data)
+{
+	ARG_UNUSED(user_data);
+
+	if (num_events < ARRAY_SIZE(events)) {
+		events[num_events] = *evt;
+	}
+	num_events++;
+}
+
+static const struct stroke_config cfg = {
+	.rate_hz = RATE_HZ,
+	.axis = 2,
+	.baseline_shift = 9,
+	.noise_shift = 6,
+	.noise_ratio = 8 * 256,
+	.peak_ratio = 256 / 8,
+	.min_threshold = 400,
+	.quiet_ms = 150,
+	.min_stroke_ms = 300,
+	.max_stroke_ms = 3000,
+	.handler = handler,
+};
+
+static int32_t noise(void)
+{
+	lcg = lcg * 1664525U + 1013904223U;
+
+	return (int32_t)((lcg >> 16) % (2 * NOISE_LSB + 1)) - NOISE_LSB;
+}
+
+/* Half sine of amplitude a, sample i of n, with a parabola approximation */
+static int32_t half_sine(int32_t a, int i, int n)
+{
+	int64_t t = 2 * i - n;
+
+	return (int32_t)(a * ((int64_t)n * n - t * t) / ((int64_t)n * n));
+}
+
+/* Feed the pending samples, timed with CONFIG_TEST_CPU_BUDGET */
+static void flush(void)
+{
+#if defined(CONFIG_TEST_CPU_BUDGET)
+	timing_t start, end;
+
+	start = timing_counter_get();
+	stroke_feed(&det, block, block_len);
+	end = timing_counter_get();
+
+	if (block_len > 0) {
+		feed_max = MAX(feed_max, timing_cycles_get(&start, &end) / block_len);
+	}
+#else
+	stroke_feed(&det, block, block_len);
+#endif
+	block_len = 0;
+}
+
+static void push(int32_t z)
+{
+	/* The offset drifts by 1 LSB every 64 samples, e.g. with temperature */
+	z += GRAVITY_LSB + offset + (int32_t)(sample_index / 64) + noise();
+
+	block[block_len][0] = (int16_t)noise();
+	block[block_len][1] = (int16_t)noise();
+	block[block_len][2] = (int16_t)CLAMP(z, INT16_MIN, INT16_MAX);
+	sample_index++;
+
+	if (++block_len == BLOCK) {
+		flush();
+	}
+}
+
+static void push_idle(int samples)
+{
+	for (int i = 0; i < samples; i++) {
+		push(0);
+	}
+}
+
+static uint32_t push_stroke(const struct trace_stroke *st)
+{
+	uint32_t start = sample_index;
+
+	/* Accelerate then decelerate down, impulse, dwell, the reverse up */
+	for (int i = 0; i < DOWN; i++) {
+		push(i < DOWN / 2 ? half_sine(st->ram, i, DOWN / 2) :
+		     -half_sine(st->ram, i - DOWN / 2, DOWN / 2));
+	}
+	for (int i = 0; i < IMPULSE; i++) {
+		push(half_sine(st->force, i, IMPULSE));
+	}
+	push_idle(DWELL);
+	for (int i = 0; i < UP; i++) {
+		push(i < UP / 2 ? -half_sine(st->ram, i, UP / 2) :
+		     half_sine(st->ram, i - UP / 2, UP / 2));
+	}
+
+	return start;
+}
+
+static void before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	zassert_ok(stroke_init(&det, &cfg));
+	num_events = 0;
+	block_len = 0;
+	sample_index = 0;
+	offset = 0;
+	feed_max = 0;
+}
+
+ZTEST(stroke, test_invalid_config)
+{
+	struct stroke_config bad = cfg;
+
+	bad.axis = 3;
+	zassert_equal(stroke_init(&det, &bad), -EINVAL);
+
+	bad = cfg;
+	bad.max_stroke_ms = bad.min_stroke_ms;
+	zassert_equal(stroke_init(&det, &bad), -EINVAL);
+}
+
+ZTEST(stroke, test_press_trace)
+{
+	uint32_t starts[ARRAY_SIZE(press_trace)];
+
+	for (int i = 0; i < ARRAY_SIZE(press_trace); i++) {
+		push_idle(press_trace[i].gap);
+		starts[i] = push_stroke(&press_trace[i]);
+	}
+	push_idle(RATE_HZ);
+	flush();
+
+	zassert_equal(num_events, ARRAY_SIZE(press_trace), "strokes miscounted");
+	zassert_equal(stroke_count(&det), ARRAY_SIZE(press_trace));
+
+	for (int i = 0; i < ARRAY_SIZE(press_trace); i++) {
+		const struct stroke_event *evt = &events[i];
+
+		zassert_equal(evt->count, i + 1);
+		zassert_true(abs((int)evt->start - (int)starts[i]) <= 8,
+			     "stroke %d start %u expected %u", i, evt->start,
+			     starts[i]);
+		zassert_true(abs((int)evt->duration_ms - STROKE_MS) <= 40,
+			     "stroke %d lasted %u ms", i, evt->duration_ms);
+		zassert_true(abs(evt->peak - press_trace[i].force) <=
+			     2 * NOISE_LSB + 32, "stroke %d peak %d", i, evt->peak);
+		zassert_true(evt->crossings >= 3, "stroke %d crossings", i);
+	}
+}
+
+ZTEST(stroke, test_knocks_and_drift)
+{
+	/* Drift and 10 ms knocks on the bench are not strokes */
+	for (int i = 0; i < 10; i++) {
+		push_idle(RATE_HZ);
+		for (int j = 0; j < RATE_HZ / 100; j++) {
+			push(3000);
+		}
+	}
+	push_idle(RATE_HZ);
+	flush();
+
+	zassert_equal(num_events, 0, "knock counted as a stroke");
+}
+
+ZTEST(stroke, test_offset_change)
+{
+	/* The sensor bracket got moved: restart the baseline, then count */
+	push_idle(RATE_HZ);
+	offset = 1500;
+	push_idle(2 * RATE_HZ * cfg.max_stroke_ms / 1000);
+	flush();
+	zassert_equal(num_events, 0);
+
+	for (int i = 0; i < 3; i++) {
+		push_idle(RATE_HZ);
+		push_stroke(&press_trace[0]);
+	}
+	push_idle(RATE_HZ);
+	flush();
+
+	zassert_equal(num_events, 3, "strokes lost after offset change");
+}
+
+#if defined(CONFIG_TEST_CPU_BUDGET)
+ZTEST(stroke, test_budget)
+{
+	uint64_t budget;
+
+	timing_init();
+	timing_start();
+	for (int i = 0; i < ARRAY_SIZE(press_trace); i++) {
+		push_idle(press_trace[i].gap);
+		push_stroke(&press_trace[i]);
+	}
+	push_idle(RATE_HZ);
+	flush();
+	timing_stop();
+
+	zassert_equal(num_events, ARRAY_SIZE(press_trace), "strokes miscounted");
+
+	/* The same bound at every block, events included: O(1) per sample */
+	budget = timing_freq_get() / RATE_HZ / BUDGET_SHARE;
+	zassert_true(feed_max <= budget, "%llu cycles per sample, budget %llu",
+		     feed_max, budget);
+}
+#endif
+
+ZTEST_SUITE(stroke, NULL, NULL, before, NULL, NULL);
@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2025 Jared Woolston
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * @file test vibration library
+ *
+ * This suite learns a baseline from noisy gravity blocks, then injects a
+ * tone in one band and checks that only this band raises alarms. On
+ * hardware, with CONFIG_TEST_CPU_BUDGET, it checks that a block is analysed
+ * in at most 10% of the time it takes to sample.
+ */
+
+#include <arm_math.h>
+
+#include <zephyr/ztest.h>
+
+#include <app/lib/vibration.h>
+
+#define RATE_HZ		1000
+#define BLOCK_SIZE	CONFIG_VIBRATION_BLOCK_SIZE
+#define GRAVITY_LSB	16384
+#define NOISE_LSB	64
+#define WARMUP		8
+
+/* Share of the block period its analysis may take, 1 / 10 */
+#define BUDGET_SHARE	10
+
+static const struct vibration_band bands[] = {
+	{ 10, 100 },
+	{ 150, 250 },
+	{ 300, 450 },
+};
+
+static struct vibration vib;
+static int16_t acc[BLOCK_SIZE][3];
+static uint32_t alarms[ARRAY_SIZE(bands)];
+static uint32_t lcg = 1;
+static uint32_t phase;
+
+static void alarm_handler(struct vibration *v, const struct vibration_alarm *alarm,
+			  void *user_data)
+{
+	ARG_UNUSED(v);
+	ARG_UNUSED(user_data);
+
+	alarms[alarm->band]++;
+}
+
+static const struct vibration_config cfg = {
+	.rate_hz = RATE_HZ,
+	.axis = 2,
+	.bands = bands,
+	.num_bands = ARRAY_SIZE(bands),
+	.baseline_shift = 4,
+	.alarm_ratio = 4 * 256,
+	.warmup_blocks = WARMUP,
+	.handler = alarm_handler,
+};
+
+static int16_t noise(void)
+{
+	lcg = lcg * 1664525U + 1013904223U;
+
+	return (int16_t)((lcg >> 16) % (2 * NOISE_LSB + 1)) - NOISE_LSB;
+}
+
+/* Feed one block of gravity, noise and a tone, and wait for the analysis */
+static void feed_block(uint32_t tone_hz, int16_t amplitude)
+{
+	uint32_t step = (uint32_t)(((uint64_t)tone_hz << 32) / RATE_HZ);
+	struct vibration_stats stats;
+	uint32_t blocks;
+
+	vibration_stats_get(&vib, &stats);
+	blocks = stats.blocks;
+
+	for (int i = 0; i < BLOCK_SIZE; i++) {
+		int32_t tone = (arm_sin_q15((q15_t)(phase >> 17)) * amplitude) >> 15;
+
+		acc[i][0] = noise();
+		acc[i][1] = noise();
+		acc[i][2] = GRAVITY_LSB + noise() + tone;
+		phase += step;
+	}
+
+	zassert_ok(vibration_feed(&vib, acc, BLOCK_SIZE));
+
+	for (int i = 0; i < 100 && stats.blocks == blocks; i++) {
+		k_sleep(K_MSEC(1));
+		vibration_stats_get(&vib, &stats);
+	}
+	zassert_equal(stats.blocks, blocks + 1, "block not analysed");
+}
+
+static void before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	zassert_ok(vibration_init(&vib, &cfg));
+	memset(alarms, 0, sizeof(alarms));
+}
+
+ZTEST(vibration, test_invalid_config)
+{
+	static const struct vibration_band too_high[] = {{ 100, RATE_HZ }};
+	struct vibration_config bad = cfg;
+
+	bad.axis = 3;
+	zassert_equal(vibration_init(&vib, &bad), -EINVAL);
+
+	bad = cfg;
+	bad.bands = too_high;
+	bad.num_bands = 1;
+	zassert_equal(vibration_init(&vib, &bad), -EINVAL);
+}
+
+ZTEST(vibration, test_baseline_quiet)
+{
+	for (int i = 0; i < WARMUP + 16; i++) {
+		feed_block(0, 0);
+	}
+
+	for (int b = 0; b < ARRAY_SIZE(bands); b++) {
+		zassert_equal(alarms[b], 0, "false alarm in band %d", b);
+	}
+}
+
+ZTEST(vibration, test_tone_alarm)
+{
+	uint64_t energy[ARRAY_SIZE(bands)], baseline[ARRAY_SIZE(bands)];
+	struct vibration_stats stats;
+
+	for (int i = 0; i < WARMUP; i++) {
+		feed_block(0, 0);
+	}
+
+	/* Dry bearing like tone in the middle band */
+	for (int i = 0; i < 4; i++) {
+		feed_block(200, 2000);
+	}
+
+	zassert_equal(alarms[0], 0, "alarm in band 0");
+	zassert_equal(alarms[1], 4, "tone not detected");
+	zassert_equal(alarms[2], 0, "alarm in band 2");
+
+	/* The baseline does not learn the fault */
+	vibration_energy_get(&vib, energy, baseline);
+	zassert_true(energy[1] > 4 * baseline[1]);
+
+	vibration_stats_get(&vib, &stats);
+	zassert_equal(stats.overruns, 0);
+}
+
+ZTEST(vibration, test_overrun)
+{
+	struct vibration_stats stats;
+
+	/* Two blocks without yielding to the work queue, the second is dropped */
+	k_sched_lock();
+	vibration_feed(&vib, acc, BLOCK_SIZE);
+	zassert_equal(vibration_feed(&vib, acc, BLOCK_SIZE), -EBUSY);
+	k_sched_unlock();
+
+	k_sleep(K_MSEC(10));
+	vibration_stats_get(&vib, &stats);
+	zassert_equal(stats.overruns, 1);
+	zassert_equal(stats.blocks, 1);
+}
+
+#if defined(CONFIG_TEST_CPU_BUDGET)
+ZTEST(vibration, test_budget)
+{
+	const uint64_t budget = (uint64_t)sys_clock_hw_cycles_per_sec() *
+				BLOCK_SIZE / RATE_HZ / BUDGET_SHARE;
+	struct vibration_stats stats;
+
+	for (int i = 0; i < WARMUP + 4; i++) {
+		feed_block(200, 2000);
+	}
+
+	vibration_stats_get(&vib, &stats);
+	zassert_true(stats.cycles_max <= budget,
+		     "%u cycles per %d sample block, budget %llu",
+		     stats.cycles_max, BLOCK_SIZE, budget);
+}
+#endif
+
+ZTEST_SUITE(vibration, NULL, NULL, before, NULL, NULL);